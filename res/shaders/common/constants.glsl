@@ -20,3 +20,4 @@
 #define BLOCK_BINDING_VIEWPORT 1
 #define BLOCK_BINDING_MATERIAL 2
 #define BLOCK_BINDING_OBJECT 3
+#define BLOCK_BINDING_OBJECT_INDEX 4
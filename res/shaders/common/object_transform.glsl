@@ -0,0 +1,24 @@
+// Include before any declarations, the #extension directive must precede them
+#extension GL_ARB_shader_draw_parameters : require
+
+// Model matrices of the objects drawn this frame, one per object even if
+// the object is drawn in several viewports
+layout(std430, binding = BLOCK_BINDING_OBJECT) readonly buffer ObjectTransformBlock
+{
+	mat4x4 models[];
+}
+object_transforms;
+
+// Index into object_transforms for each object draw of the frame
+layout(std430, binding = BLOCK_BINDING_OBJECT_INDEX) readonly buffer ObjectIndexBlock
+{
+	uint indices[];
+}
+object_indices;
+
+// Draws pass the index of their first object draw as the base instance,
+// and instanced draws step through consecutive object draws
+mat4x4 object_model_matrix()
+{
+	return object_transforms.models[object_indices.indices[gl_BaseInstanceARB + gl_InstanceID]];
+}
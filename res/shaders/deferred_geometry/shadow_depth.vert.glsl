@@ -2,5 +2,5 @@ layout(location = 0) in vec3 position;
 
 void main()
 {
- 	gl_Position = transform.MVP * vec4(position, 1.0);
+ 	gl_Position = viewport.VP * (object_model_matrix() * vec4(position, 1.0));
 }
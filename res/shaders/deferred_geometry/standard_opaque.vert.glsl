@@ -10,11 +10,14 @@ out VS_TO_FS {
 
 void main()
 {
-	vec3 N = normalize(vec3(transform.MV * vec4(normal, 0.0)));
-	vec3 T = normalize(vec3(transform.MV * vec4(tangent, 0.0)));
+	mat4x4 M = object_model_matrix();
+	mat4x4 MV = viewport.V * M;
+
+	vec3 N = normalize(vec3(MV * vec4(normal, 0.0)));
+	vec3 T = normalize(vec3(MV * vec4(tangent, 0.0)));
 	vec3 B = cross(N, T);
 
-	gl_Position = transform.MVP * vec4(position, 1.0);
+	gl_Position = viewport.VP * (M * vec4(position, 1.0));
 	vs_out.tex_coord = tex_coord;
 	vs_out.TBN = mat3(T, B, N);
 }
@@ -5,6 +5,8 @@ out vec3 fs_world_norm;
 
 void main()
 {
-	gl_Position = transform.MVP * vec4(position, 1.0);
-	fs_world_norm = (transform.M * vec4(normal, 0.0)).xyz;
+	mat4x4 M = object_model_matrix();
+
+	gl_Position = viewport.VP * (M * vec4(position, 1.0));
+	fs_world_norm = (M * vec4(normal, 0.0)).xyz;
 }
@@ -4,6 +4,6 @@ out vec3 fs_w_direction;
 
 void main()
 {
-	gl_Position = transform.MVP * vec4(vert_pos, 1.0);
+	gl_Position = viewport.VP * (object_model_matrix() * vec4(vert_pos, 1.0));
 	fs_w_direction = vert_pos;
 }
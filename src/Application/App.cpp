@@ -25,7 +25,7 @@ App::App(Engine* engine, Allocator* allocator) :
 	allocator(allocator),
 	settings(allocator),
 	cameraController(engine->GetSceneManager(), engine->GetMainWindow()),
-	cameraControllerEnable(true)
+	cameraControllerEnable(engine->GetMainWindow() != nullptr)
 {
 	App::instance = this;
 }
@@ -62,13 +62,17 @@ void App::Initialize()
 		Entity mainCameraEntity = entityManager->Create();
 		mainCamera.SetEntity(mainCameraEntity);
 		SceneObjectId cameraSceneObject = scene->AddSceneObject(mainCameraEntity);
-		Mat4x4f cameraTransform = Mat4x4f::Translate(Vec3f(0.0f, 1.6f, 4.0f));
+		Transformf cameraTransform = Transformf::Translate(Vec3f(0.0f, 1.6f, 4.0f));
 		scene->SetLocalTransform(cameraSceneObject, cameraTransform);
 	}
 
 	{
+		// Without a window, the frame size comes from the engine settings
 		Window* window = engine->GetMainWindow();
-		Vec2f frameSize = window->GetFrameBufferSize().As<float>();
+		const Engine::Settings& settings = engine->GetSettings();
+		Vec2f frameSize = window != nullptr ?
+			window->GetFrameBufferSize().As<float>() :
+			Vec2f(static_cast<float>(settings.frameWidth), static_cast<float>(settings.frameHeight));
 		mainCamera.parameters.projection = ProjectionType::Perspective;
 		mainCamera.parameters.near = 0.1f;
 		mainCamera.parameters.far = 10000.0f;
@@ -104,12 +108,14 @@ void App::Initialize()
 			Entity entity = entityManager->Create();
 
 			SceneObjectId sceneObject = scene->AddSceneObject(entity);
-			Mat4x4f transform = Mat4x4f::Translate(Vec3f(std::sin(a) * r, -0.5f, std::cos(a) * r));
+			Transformf transform = Transformf::Translate(Vec3f(std::sin(a) * r, -0.5f, std::cos(a) * r));
 			scene->SetLocalTransform(sceneObject, transform);
 
 			RenderObjectId renderObj = renderer->AddRenderObject(entity);
 			renderer->SetOrderData(renderObj, renderOrderData);
 			renderer->SetMeshId(renderObj, meshId);
+
+			scene->AttachComponent(renderer, sceneObject, renderObj.i);
 		}
 	}
 }
@@ -6,7 +6,8 @@
 #include "Core/String.hpp"
 
 #include "Math/Mat3x3.hpp"
-#include "Math/Mat4x4.hpp"
+#include "Math/Quat.hpp"
+#include "Math/Transform.hpp"
 
 #include "Engine/Engine.hpp"
 #include "System/Time.hpp"
@@ -111,8 +112,7 @@ void CameraController::Update()
 
 	Entity cameraEntity = controlledCamera->GetEntity();
 	SceneObjectId cameraSceneObject = scene->Lookup(cameraEntity);
-	Mat4x4f currentTransform = scene->GetLocalTransform(cameraSceneObject);
-	Vec3f position = (currentTransform * Vec4f(0.0f, 0.0f, 0.0f, 1.0f)).xyz();
+	Vec3f position = scene->GetLocalTransform(cameraSceneObject).translation;
 
 	if (mouseLookActive == false)
 	{
@@ -151,6 +151,6 @@ void CameraController::Update()
 	cameraVelocity += (dir * targetSpeed - cameraVelocity) * 0.15f;
 	position += cameraVelocity * Time::GetDeltaTime();
 
-	Mat4x4f newTransform = Mat4x4f::Translate(position) * Mat4x4f(rotation);
+	Transformf newTransform(position, Quatf::FromMat3x3(rotation), Vec3f(1.0f, 1.0f, 1.0f));
 	scene->SetLocalTransform(cameraSceneObject, newTransform);
 }
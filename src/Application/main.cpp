@@ -1,12 +1,102 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
 #include "Application/App.hpp"
+#include "Debug/PerformanceTimer.hpp"
 #include "Engine/Engine.hpp"
 #include "Memory/Memory.hpp"
 #include "Memory/AllocatorManager.hpp"
+#include "Rendering/RenderDeviceRecorder.hpp"
 #include "System/Window.hpp"
 
-int main(void)
+struct RunOptions
+{
+	Engine::Settings engineSettings;
+
+	// Number of frames to run, zero runs until the window is closed
+	unsigned int frameCount;
+};
+
+static void PrintUsage()
+{
+	std::printf("Usage: kokko [-headless] [-frames <count>] [-capture <frame>] [-capturefile <path>]\n"
+		"             [-renderthread] [-queuedepth <count>]\n"
+		"  -headless            Run without a window or a GPU and print device stats per frame\n"
+		"  -frames <count>      Number of frames to run, default 100 when headless\n"
+		"  -capture <frame>     Write the device commands of the frame to a capture file\n"
+		"  -capturefile <path>  Path of the capture file, default frame.kcap\n"
+		"  -renderthread        Submit frames on a render thread, frames can't be captured\n"
+		"  -queuedepth <count>  Number of frames the render thread can lag behind, default 1\n");
+}
+
+static bool ParseOptions(int argc, char** argv, RunOptions& optionsOut)
+{
+	optionsOut.engineSettings = Engine::Settings();
+	optionsOut.frameCount = 0;
+
+	bool frameCountSet = false;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		if (std::strcmp(argv[i], "-headless") == 0)
+			optionsOut.engineSettings.headless = true;
+		else if (std::strcmp(argv[i], "-frames") == 0 && i + 1 < argc)
+		{
+			optionsOut.frameCount = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
+			frameCountSet = true;
+		}
+		else if (std::strcmp(argv[i], "-capture") == 0 && i + 1 < argc)
+			optionsOut.engineSettings.captureFrame = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
+		else if (std::strcmp(argv[i], "-capturefile") == 0 && i + 1 < argc)
+			optionsOut.engineSettings.captureFilename = argv[++i];
+		else if (std::strcmp(argv[i], "-renderthread") == 0)
+			optionsOut.engineSettings.renderThread = true;
+		else if (std::strcmp(argv[i], "-queuedepth") == 0 && i + 1 < argc)
+			optionsOut.engineSettings.renderQueueDepth = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
+		else
+			return false;
+	}
+
+	// Without a window there's nothing to close
+	if (optionsOut.engineSettings.headless && frameCountSet == false)
+		optionsOut.frameCount = 100;
+
+	return frameCountSet == false || optionsOut.frameCount > 0;
+}
+
+static void PrintFrameStats(const RenderDeviceRecorder::Stats& stats, unsigned int frameCount, double frameMilliseconds)
+{
+	using Call = RenderDeviceRecorder::Call;
+
+	std::printf("%-36s %12s\n", "Call", "Calls/frame");
+
+	for (size_t i = 0; i < static_cast<size_t>(Call::Count); ++i)
+	{
+		if (stats.callCounts[i] == 0)
+			continue;
+
+		std::printf("%-36s %12.1f\n", RenderDeviceRecorder::GetCallName(static_cast<Call>(i)),
+			stats.callCounts[i] / static_cast<double>(frameCount));
+	}
+
+	std::printf("Draw calls per frame: %.1f\n", stats.drawCalls / static_cast<double>(frameCount));
+	std::printf("Instances per frame: %.1f\n", stats.drawnInstances / static_cast<double>(frameCount));
+	std::printf("Bytes uploaded per frame: %.1f\n", stats.bytesUploaded / static_cast<double>(frameCount));
+	std::printf("CPU time per frame: %.4f ms\n", frameMilliseconds);
+}
+
+int main(int argc, char** argv)
 {
-	Engine engine;
+	RunOptions options;
+
+	if (ParseOptions(argc, argv, options) == false)
+	{
+		PrintUsage();
+		return -1;
+	}
+
+	Engine engine(options.engineSettings);
 
 	if (engine.Initialize())
 	{
@@ -18,14 +108,31 @@ int main(void)
 
 		app.Initialize();
 
-		while (engine.GetMainWindow()->ShouldClose() == false)
+		// Null when running headless
+		Window* window = engine.GetMainWindow();
+
+		// Loading the scene isn't part of the measured frames
+		RenderDeviceRecorder* recorder = engine.GetRenderDeviceRecorder();
+		if (recorder != nullptr)
+			recorder->ResetStats();
+
+		PerformanceTimer frameTimer;
+		unsigned int frame = 0;
+
+		while ((options.frameCount == 0 || frame < options.frameCount) &&
+			(window == nullptr || window->ShouldClose() == false))
 		{
 			engine.Update();
 			app.Update();
+
+			frame += 1;
 		}
+
+		if (options.engineSettings.headless && frame > 0)
+			PrintFrameStats(recorder->GetStats(), frame, frameTimer.ElapsedSeconds() * 1000.0 / frame);
 	}
 	else
 		return -1;
 
 	return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstdint>
+
+class Allocator;
+
+namespace Benchmark
+{
+	// Radix sort against shell sort of 64-bit render command keys
+	void RunSortBenchmark(Allocator* allocator);
+
+	// ParallelFor scaling with the number of worker threads and the grain size
+	void RunJobSystemBenchmark(Allocator* allocator);
+
+	// Scalar against SoA frustum culling of 100k bounding volumes
+	void RunCullingBenchmark(Allocator* allocator);
+
+	// Render command sort key encoding and decoding with runtime and compile-time field layouts
+	void RunRenderOrderBenchmark(Allocator* allocator);
+
+	// Deterministic 64-bit random numbers, so that runs can be compared
+	inline uint64_t NextRandom(uint64_t& state)
+	{
+		state ^= state << 13;
+		state ^= state >> 7;
+		state ^= state << 17;
+		return state;
+	}
+
+	inline float NextRandomFloat(uint64_t& state, float min, float max)
+	{
+		float unit = static_cast<float>(NextRandom(state) >> 40) / static_cast<float>(1 << 24);
+		return min + (max - min) * unit;
+	}
+}
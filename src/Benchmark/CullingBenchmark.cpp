@@ -0,0 +1,246 @@
+#include "Benchmark/Benchmark.hpp"
+
+#include <cstdio>
+#include <cstring>
+
+#include "Core/Array.hpp"
+#include "Core/BitPack.hpp"
+
+#include "Debug/PerformanceTimer.hpp"
+
+#include "Math/BoundingBox.hpp"
+#include "Math/Frustum.hpp"
+#include "Math/Intersect3D.hpp"
+#include "Math/Mat4x4.hpp"
+#include "Math/Projection.hpp"
+
+namespace Benchmark
+{
+
+namespace
+{
+	struct CullingScene
+	{
+		unsigned int count;
+
+		Array<BoundingBox> boxes;
+		Array<float> soaData;
+		BoundingBoxSoA soa;
+
+		Array<float> positionX;
+		Array<float> positionY;
+		Array<float> positionZ;
+		Array<Vec3f> positions;
+		Array<float> radii;
+
+		ProjectionParameters projection;
+		FrustumPlanes frustum;
+		Mat4x4f view;
+		Mat4x4f projectionMatrix;
+		Mat4x4f viewProjection;
+		Vec2f viewportSize;
+		float minimumSizePx;
+
+		CullingScene(Allocator* allocator) :
+			boxes(allocator),
+			soaData(allocator),
+			positionX(allocator),
+			positionY(allocator),
+			positionZ(allocator),
+			positions(allocator),
+			radii(allocator)
+		{
+		}
+	};
+
+	// Time <repeats> calls of <cull> and return the average in milliseconds
+	template <typename Fn>
+	double Measure(unsigned int repeats, Fn cull)
+	{
+		PerformanceTimer timer;
+
+		for (unsigned int repeat = 0; repeat < repeats; ++repeat)
+			cull();
+
+		return timer.ElapsedSeconds() * 1000.0 / repeats;
+	}
+
+	bool ResultsMatch(const Array<BitPack>& a, const Array<BitPack>& b)
+	{
+		return std::memcmp(a.GetData(), b.GetData(), a.GetCount() * sizeof(BitPack)) == 0;
+	}
+
+	// Boxes that <kept> rejects but <reference> keeps
+	unsigned int CountFalseRejections(Array<BitPack>& reference, Array<BitPack>& kept, unsigned int count)
+	{
+		unsigned int rejected = 0;
+
+		for (unsigned int i = 0; i < count; ++i)
+			if (BitPack::Get(reference.GetData(), i) && BitPack::Get(kept.GetData(), i) == false)
+				rejected += 1;
+
+		return rejected;
+	}
+
+	unsigned int CountVisible(Array<BitPack>& visibility, unsigned int count)
+	{
+		unsigned int visible = 0;
+
+		for (unsigned int i = 0; i < count; ++i)
+			if (BitPack::Get(visibility.GetData(), i))
+				visible += 1;
+
+		return visible;
+	}
+
+	void PrintRow(const char* name, double scalarMs, double soaMs, bool match, unsigned int visible)
+	{
+		std::printf("%-14s %10.3f %10.3f %8.1fx %8s %8u\n",
+			name, scalarMs, soaMs, scalarMs / soaMs, match ? "yes" : "NO", visible);
+	}
+}
+
+/**
+ * Random boxes around a camera at the origin looking down the negative z axis,
+ * so that part of them are outside the frustum and part of them are too small.
+ */
+static void CreateCullingScene(CullingScene& scene, unsigned int count, ProjectionType projectionType)
+{
+	scene.count = count;
+
+	scene.boxes.Resize(count);
+	scene.soaData.Resize(count * 6);
+	scene.soa = BoundingBoxSoA{
+		scene.soaData.GetData() + count * 0, scene.soaData.GetData() + count * 1,
+		scene.soaData.GetData() + count * 2, scene.soaData.GetData() + count * 3,
+		scene.soaData.GetData() + count * 4, scene.soaData.GetData() + count * 5
+	};
+
+	scene.positionX.Resize(count);
+	scene.positionY.Resize(count);
+	scene.positionZ.Resize(count);
+	scene.positions.Resize(count);
+	scene.radii.Resize(count);
+
+	uint64_t state = 0x2545f4914f6cdd1dULL;
+
+	for (unsigned int i = 0; i < count; ++i)
+	{
+		BoundingBox box;
+		box.center = Vec3f(NextRandomFloat(state, -150.0f, 150.0f),
+			NextRandomFloat(state, -50.0f, 50.0f), NextRandomFloat(state, -300.0f, 20.0f));
+		box.extents = Vec3f(NextRandomFloat(state, 0.02f, 3.0f),
+			NextRandomFloat(state, 0.02f, 3.0f), NextRandomFloat(state, 0.02f, 3.0f));
+
+		scene.boxes[i] = box;
+		scene.soa.Set(i, box);
+
+		scene.positionX[i] = box.center.x;
+		scene.positionY[i] = box.center.y;
+		scene.positionZ[i] = box.center.z;
+		scene.positions[i] = box.center;
+		scene.radii[i] = box.extents.Magnitude();
+	}
+
+	scene.projection.projection = projectionType;
+	scene.projection.height = projectionType == ProjectionType::Perspective ? 1.0f : 120.0f;
+	scene.projection.aspect = 16.0f / 9.0f;
+	scene.projection.near = 0.1f;
+	scene.projection.far = 250.0f;
+
+	Mat4x4f cameraTransform;
+	scene.frustum.Update(scene.projection, cameraTransform);
+	scene.view = cameraTransform.GetInverse();
+	scene.projectionMatrix = scene.projection.GetProjectionMatrix(true);
+	scene.viewProjection = scene.projectionMatrix * scene.view;
+	scene.viewportSize = Vec2f(1920.0f, 1080.0f);
+	scene.minimumSizePx = 7.0f;
+}
+
+static void RunCullingTests(Allocator* allocator, ProjectionType projectionType)
+{
+	const unsigned int count = 100000;
+	const unsigned int repeats = 20;
+
+	CullingScene scene(allocator);
+	CreateCullingScene(scene, count, projectionType);
+
+	Array<BitPack> scalarResult(allocator);
+	Array<BitPack> soaResult(allocator);
+	Array<BitPack> cornerResult(allocator);
+	scalarResult.Resize(BitPack::CalculateRequired(count));
+	soaResult.Resize(BitPack::CalculateRequired(count));
+	cornerResult.Resize(BitPack::CalculateRequired(count));
+
+	std::printf("%u boxes, %s projection, SoA width %u\n", count,
+		projectionType == ProjectionType::Perspective ? "perspective" : "orthographic", Intersect::SoAWidth);
+	std::printf("%-14s %10s %10s %9s %8s %8s\n", "Test", "Scalar ms", "SoA ms", "Speedup", "Match", "Visible");
+
+	double scalarMs, soaMs;
+
+	std::memset(scalarResult.GetData(), 0, scalarResult.GetCount() * sizeof(BitPack));
+	scalarMs = Measure(repeats, [&]()
+	{
+		Intersect::FrustumAABB(scene.frustum, count, scene.boxes.GetData(), scalarResult.GetData());
+	});
+	soaMs = Measure(repeats, [&]()
+	{
+		Intersect::FrustumAABBSoA(scene.frustum, count, scene.soa, soaResult.GetData());
+	});
+	PrintRow("AABB", scalarMs, soaMs, ResultsMatch(scalarResult, soaResult), CountVisible(soaResult, count));
+
+	std::memset(scalarResult.GetData(), 0, scalarResult.GetCount() * sizeof(BitPack));
+	scalarMs = Measure(repeats, [&]()
+	{
+		Intersect::FrustumAABBMinSize(scene.frustum, scene.viewProjection, scene.viewportSize,
+			scene.minimumSizePx, count, scene.boxes.GetData(), scalarResult.GetData());
+	});
+	soaMs = Measure(repeats, [&]()
+	{
+		Intersect::FrustumAABBMinSizeSoA(scene.frustum, scene.viewProjection, scene.viewportSize,
+			scene.minimumSizePx, count, scene.soa, soaResult.GetData());
+	});
+	PrintRow("AABB+corners", scalarMs, soaMs, ResultsMatch(scalarResult, soaResult), CountVisible(soaResult, count));
+	std::memcpy(cornerResult.GetData(), scalarResult.GetData(), cornerResult.GetCount() * sizeof(BitPack));
+
+	std::memset(scalarResult.GetData(), 0, scalarResult.GetCount() * sizeof(BitPack));
+	scalarMs = Measure(repeats, [&]()
+	{
+		Intersect::FrustumAABBMinSphereSize(scene.frustum, scene.view, scene.projectionMatrix,
+			scene.viewportSize, scene.minimumSizePx, count, scene.boxes.GetData(), scalarResult.GetData());
+	});
+	soaMs = Measure(repeats, [&]()
+	{
+		Intersect::FrustumAABBMinSphereSizeSoA(scene.frustum, scene.view, scene.projectionMatrix,
+			scene.viewportSize, scene.minimumSizePx, count, scene.soa, soaResult.GetData());
+	});
+	PrintRow("AABB+sphere", scalarMs, soaMs, ResultsMatch(scalarResult, soaResult), CountVisible(soaResult, count));
+
+	std::memset(scalarResult.GetData(), 0, scalarResult.GetCount() * sizeof(BitPack));
+	scalarMs = Measure(repeats, [&]()
+	{
+		Intersect::FrustumSphere(scene.frustum, count, scene.positions.GetData(),
+			scene.radii.GetData(), scalarResult.GetData());
+	});
+	soaMs = Measure(repeats, [&]()
+	{
+		Intersect::FrustumSphereSoA(scene.frustum, count, scene.positionX.GetData(), scene.positionY.GetData(),
+			scene.positionZ.GetData(), scene.radii.GetData(), soaResult.GetData());
+	});
+	PrintRow("Sphere", scalarMs, soaMs, ResultsMatch(scalarResult, soaResult), CountVisible(soaResult, count));
+
+	// The sphere size estimate must never reject a box the corner estimate keeps
+	Intersect::FrustumAABBMinSphereSize(scene.frustum, scene.view, scene.projectionMatrix,
+		scene.viewportSize, scene.minimumSizePx, count, scene.boxes.GetData(), scalarResult.GetData());
+	std::printf("Sphere estimate: %u false rejections, %u extra boxes kept\n\n",
+		CountFalseRejections(cornerResult, scalarResult, count),
+		CountFalseRejections(scalarResult, cornerResult, count));
+}
+
+void RunCullingBenchmark(Allocator* allocator)
+{
+	RunCullingTests(allocator, ProjectionType::Perspective);
+	RunCullingTests(allocator, ProjectionType::Orthographic);
+}
+
+}
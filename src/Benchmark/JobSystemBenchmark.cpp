@@ -0,0 +1,78 @@
+#include "Benchmark/Benchmark.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <thread>
+
+#include "Core/Array.hpp"
+#include "Core/JobSystem.hpp"
+
+#include "Debug/PerformanceTimer.hpp"
+
+namespace Benchmark
+{
+
+static double RunParallelFor(JobSystem& jobSystem, Array<float>& values, unsigned int grain, unsigned int repeats)
+{
+	float* data = values.GetData();
+
+	PerformanceTimer timer;
+
+	for (unsigned int repeat = 0; repeat < repeats; ++repeat)
+	{
+		jobSystem.ParallelFor(values.GetCount(), grain, [data](unsigned int begin, unsigned int end)
+		{
+			// Enough arithmetic per item that the scheduling overhead can be measured against it
+			for (unsigned int i = begin; i < end; ++i)
+			{
+				float x = data[i];
+
+				for (unsigned int iteration = 0; iteration < 32; ++iteration)
+					x = std::sqrt(x * x + 1.0f) * 0.5f;
+
+				data[i] = x;
+			}
+		});
+	}
+
+	return timer.ElapsedSeconds() * 1000.0 / repeats;
+}
+
+void RunJobSystemBenchmark(Allocator* allocator)
+{
+	const unsigned int itemCount = 1 << 20;
+	const unsigned int grains[] = { 256, 4096, 65536 };
+	const unsigned int repeats = 5;
+
+	unsigned int hardwareThreads = std::thread::hardware_concurrency();
+	unsigned int maxWorkerThreads = hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+
+	Array<float> values(allocator);
+	values.Resize(itemCount);
+
+	for (unsigned int i = 0; i < itemCount; ++i)
+		values[i] = static_cast<float>(i % 1000);
+
+	std::printf("Hardware threads: %u\n", hardwareThreads);
+	std::printf("%14s %8s %12s %10s\n", "Worker threads", "Grain", "ms", "Speedup");
+
+	for (unsigned int grain : grains)
+	{
+		double singleThreadMs = 0.0;
+
+		for (unsigned int workerThreads = 0; workerThreads <= maxWorkerThreads;
+			workerThreads = workerThreads == 0 ? 1 : workerThreads * 2)
+		{
+			JobSystem jobSystem(allocator, workerThreads);
+
+			double ms = RunParallelFor(jobSystem, values, grain, repeats);
+
+			if (workerThreads == 0)
+				singleThreadMs = ms;
+
+			std::printf("%14u %8u %12.3f %9.2fx\n", workerThreads, grain, ms, singleThreadMs / ms);
+		}
+	}
+}
+
+}
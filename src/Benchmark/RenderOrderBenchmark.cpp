@@ -0,0 +1,242 @@
+#include "Benchmark/Benchmark.hpp"
+
+#include <cstdio>
+
+#include "Core/Array.hpp"
+#include "Core/BitfieldVariable.hpp"
+
+#include "Debug/PerformanceTimer.hpp"
+
+#include "Rendering/RenderCommandList.hpp"
+
+namespace Benchmark
+{
+
+namespace
+{
+	/*
+	* The sort key layout built at runtime, the way RenderOrderConfiguration
+	* used to do it. Keys are identical to the compile-time layout with
+	* depth-major sorting.
+	*/
+	struct RuntimeRenderOrder
+	{
+		BitfieldVariable<uint64_t> viewportIndex;
+		BitfieldVariable<uint64_t> viewportPass;
+		BitfieldVariable<uint64_t> command;
+		BitfieldVariable<uint64_t> depth;
+		BitfieldVariable<uint64_t> materialId;
+		BitfieldVariable<uint64_t> meshId;
+		BitfieldVariable<uint64_t> renderObject;
+
+		uint64_t maxTransparentDepth;
+		uint64_t maxOpaqueDepth;
+		uint64_t opaqueDepthShift;
+
+		explicit RuntimeRenderOrder(const volatile unsigned int* widths)
+		{
+			using Config = RenderOrderConfiguration;
+
+			viewportIndex.SetDefinition(widths[0], 64);
+			viewportPass.SetDefinition(widths[1], viewportIndex.shift);
+			command.SetDefinition(widths[2], viewportPass.shift);
+			depth.SetDefinition(Config::DepthBits, command.shift);
+			materialId.SetDefinition(widths[3], depth.shift);
+			meshId.SetDefinition(widths[4], materialId.shift);
+			renderObject.SetDefinition(widths[5], widths[5]);
+
+			maxTransparentDepth = depth.mask;
+			maxOpaqueDepth = (1ULL << RenderOrderFieldWidths::OpaqueDepthBits) - 1;
+			opaqueDepthShift = depth.bits - RenderOrderFieldWidths::OpaqueDepthBits;
+		}
+
+		uint64_t EncodeDraw(unsigned int viewport, uint64_t pass, float depthValue,
+			unsigned int material, unsigned int mesh, unsigned int object) const
+		{
+			uint64_t intDepth;
+
+			if (RenderOrderConfiguration::IsTransparentPass(pass))
+				intDepth = static_cast<uint64_t>(maxTransparentDepth * (1.0f - depthValue));
+			else
+				intDepth = static_cast<uint64_t>(maxOpaqueDepth * depthValue) << opaqueDepthShift;
+
+			uint64_t c = 0;
+			viewportIndex.AssignValue(c, viewport);
+			viewportPass.AssignValue(c, pass);
+			command.AssignValue(c, static_cast<uint64_t>(RenderCommandType::Draw));
+			depth.AssignValue(c, intDepth);
+			materialId.AssignValue(c, material);
+			meshId.AssignValue(c, mesh);
+			renderObject.AssignValue(c, object);
+			return c;
+		}
+	};
+
+	struct DrawInput
+	{
+		unsigned int viewport;
+		RenderPass pass;
+		float depth;
+		unsigned int material;
+		unsigned int mesh;
+		unsigned int object;
+	};
+
+	// Time <repeats> calls of <fn> and return the average in milliseconds
+	template <typename Fn>
+	double Measure(unsigned int repeats, Fn fn)
+	{
+		PerformanceTimer timer;
+
+		for (unsigned int repeat = 0; repeat < repeats; ++repeat)
+			fn();
+
+		return timer.ElapsedSeconds() * 1000.0 / repeats;
+	}
+}
+
+// Prevents the compiler from seeing the field widths of the runtime layout
+static volatile unsigned int RuntimeFieldWidths[] = {
+	3, 3, 1, RenderOrderFieldWidths::MaterialBits, RenderOrderFieldWidths::MeshBits,
+	RenderOrderFieldWidths::RenderObjectBits
+};
+
+void RunRenderOrderBenchmark(Allocator* allocator)
+{
+	const unsigned int count = 1000000;
+	const unsigned int repeats = 20;
+
+	// Draws of a typical frame: few viewports and passes, many objects
+	Array<DrawInput> inputs(allocator);
+	inputs.Resize(count);
+
+	uint64_t state = 0x853c49e6748fea9bULL;
+	const RenderPass passes[] = { RenderPass::OpaqueGeometry, RenderPass::OpaqueGeometry, RenderPass::Transparent };
+
+	for (unsigned int i = 0; i < count; ++i)
+	{
+		DrawInput& input = inputs[i];
+		input.viewport = static_cast<unsigned int>(NextRandom(state) % 5);
+		input.pass = passes[NextRandom(state) % 3];
+		input.depth = NextRandomFloat(state, 0.0f, 1.0f);
+		input.material = 1 + static_cast<unsigned int>(NextRandom(state) % 200);
+		input.mesh = 1 + static_cast<unsigned int>(NextRandom(state) % 500);
+		input.object = i;
+	}
+
+	RuntimeRenderOrder* runtimeOrder = allocator->MakeNew<RuntimeRenderOrder>(RuntimeFieldWidths);
+	RenderCommandList commandList(allocator);
+	Array<uint64_t> runtimeKeys(allocator);
+
+	// Encoding, as done by Renderer::PopulateCommandList through RenderCommandList::AddDraw
+
+	double runtimeEncodeMs = Measure(repeats, [&]()
+	{
+		runtimeKeys.Clear();
+
+		for (unsigned int i = 0; i < count; ++i)
+		{
+			const DrawInput& in = inputs[i];
+			float depth = (in.depth > 1.0f ? 1.0f : (in.depth < 0.0f ? 0.0f : in.depth));
+
+			runtimeKeys.PushBack(runtimeOrder->EncodeDraw(in.viewport, static_cast<uint64_t>(in.pass),
+				depth, in.material, in.mesh, in.object));
+		}
+	});
+
+	const RenderOrderConfiguration& renderOrder = commandList.renderOrder;
+	Array<uint64_t> constKeys(allocator);
+
+	double constEncodeMs = Measure(repeats, [&]()
+	{
+		constKeys.Clear();
+
+		for (unsigned int i = 0; i < count; ++i)
+		{
+			const DrawInput& in = inputs[i];
+			float depth = (in.depth > 1.0f ? 1.0f : (in.depth < 0.0f ? 0.0f : in.depth));
+			uint64_t pass = static_cast<uint64_t>(in.pass);
+
+			uint64_t c = 0;
+			renderOrder.viewportIndex.AssignValue(c, in.viewport);
+			renderOrder.viewportPass.AssignValue(c, pass);
+			renderOrder.command.AssignValue(c, static_cast<uint64_t>(RenderCommandType::Draw));
+			renderOrder.AssignDraw(c, pass, depth, in.material, in.mesh);
+			renderOrder.renderObject.AssignValue(c, in.object);
+			constKeys.PushBack(c);
+		}
+	});
+
+	// The whole AddDraw call, including the material ID check
+	double addDrawMs = Measure(repeats, [&]()
+	{
+		commandList.Clear();
+
+		for (unsigned int i = 0; i < count; ++i)
+		{
+			const DrawInput& in = inputs[i];
+			commandList.AddDraw(in.viewport, in.pass, in.depth,
+				MaterialId{ in.material }, MeshId{ in.mesh }, in.object);
+		}
+	});
+
+	bool keysMatch = commandList.commands.GetCount() == count && constKeys.GetCount() == count;
+	for (unsigned int i = 0; keysMatch && i < count; ++i)
+		if (commandList.commands[i] != runtimeKeys[i] || constKeys[i] != runtimeKeys[i])
+			keysMatch = false;
+
+	// Decoding, as done by Renderer::Render for every command
+
+	uint64_t runtimeSum = 0;
+	double runtimeDecodeMs = Measure(repeats, [&]()
+	{
+		uint64_t sum = 0;
+
+		for (unsigned int i = 0; i < count; ++i)
+		{
+			uint64_t key = runtimeKeys[i];
+
+			if (runtimeOrder->command.GetValue(key) == static_cast<uint64_t>(RenderCommandType::Draw))
+			{
+				sum += runtimeOrder->viewportIndex.GetValue(key);
+				sum += runtimeOrder->materialId.GetValue(key);
+				sum += runtimeOrder->meshId.GetValue(key);
+				sum += runtimeOrder->renderObject.GetValue(key);
+			}
+		}
+
+		runtimeSum = sum;
+	});
+
+	uint64_t constSum = 0;
+	double constDecodeMs = Measure(repeats, [&]()
+	{
+		uint64_t sum = 0;
+
+		for (unsigned int i = 0; i < count; ++i)
+		{
+			uint64_t key = commandList.commands[i];
+
+			if (renderOrder.command.GetValue(key) == static_cast<uint64_t>(RenderCommandType::Draw))
+			{
+				sum += renderOrder.viewportIndex.GetValue(key);
+				sum += renderOrder.GetMaterialId(key);
+				sum += renderOrder.GetMeshId(key);
+				sum += renderOrder.renderObject.GetValue(key);
+			}
+		}
+
+		constSum = sum;
+	});
+
+	allocator->MakeDelete(runtimeOrder);
+
+	std::printf("%u draw keys, keys match: %s, decoded values match: %s\n",
+		count, keysMatch ? "yes" : "NO", runtimeSum == constSum ? "yes" : "NO");
+	std::printf("%-8s %12s %14s %9s\n", "Test", "Runtime ms", "Constexpr ms", "Speedup");
+	std::printf("%-8s %12.3f %14.3f %8.2fx\n", "Encode", runtimeEncodeMs, constEncodeMs, runtimeEncodeMs / constEncodeMs);
+	std::printf("%-8s %12.3f %14.3f %8.2fx\n", "Decode", runtimeDecodeMs, constDecodeMs, runtimeDecodeMs / constDecodeMs);
+	std::printf("AddDraw: %.3f ms\n", addDrawMs);
+}
+
+}
@@ -0,0 +1,66 @@
+#include "Benchmark/Benchmark.hpp"
+
+#include <cstdio>
+#include <cstring>
+
+#include "Core/Array.hpp"
+#include "Core/Sort.hpp"
+
+#include "Debug/PerformanceTimer.hpp"
+
+namespace Benchmark
+{
+
+void RunSortBenchmark(Allocator* allocator)
+{
+	const unsigned int counts[] = { 1000, 10000, 100000, 1000000 };
+
+	Array<uint64_t> keys(allocator);
+	Array<uint64_t> radixSorted(allocator);
+	Array<uint64_t> shellSorted(allocator);
+	Array<uint64_t> scratch(allocator);
+
+	std::printf("%10s %14s %14s %10s\n", "Keys", "Radix ms", "Shell ms", "Speedup");
+
+	for (unsigned int count : counts)
+	{
+		// Small counts are repeated so that the timer resolution doesn't matter
+		const unsigned int repeats = count >= 100000 ? 3 : 100000 / count;
+
+		keys.Resize(count);
+		radixSorted.Resize(count);
+		shellSorted.Resize(count);
+		scratch.Resize(count);
+
+		uint64_t state = 0x9e3779b97f4a7c15ULL;
+		for (unsigned int i = 0; i < count; ++i)
+			keys[i] = NextRandom(state);
+
+		double radixSeconds = 0.0;
+		double shellSeconds = 0.0;
+
+		for (unsigned int repeat = 0; repeat < repeats; ++repeat)
+		{
+			std::memcpy(radixSorted.GetData(), keys.GetData(), count * sizeof(uint64_t));
+			std::memcpy(shellSorted.GetData(), keys.GetData(), count * sizeof(uint64_t));
+
+			PerformanceTimer radixTimer;
+			RadixSortAsc(radixSorted.GetData(), scratch.GetData(), count);
+			radixSeconds += radixTimer.ElapsedSeconds();
+
+			PerformanceTimer shellTimer;
+			ShellSortAsc(shellSorted.GetData(), count);
+			shellSeconds += shellTimer.ElapsedSeconds();
+		}
+
+		if (std::memcmp(radixSorted.GetData(), shellSorted.GetData(), count * sizeof(uint64_t)) != 0)
+			std::printf("Sort results differ with %u keys\n", count);
+
+		double radixMs = radixSeconds * 1000.0 / repeats;
+		double shellMs = shellSeconds * 1000.0 / repeats;
+
+		std::printf("%10u %14.4f %14.4f %9.1fx\n", count, radixMs, shellMs, shellMs / radixMs);
+	}
+}
+
+}
@@ -0,0 +1,75 @@
+#include <cstdio>
+#include <cstring>
+
+#include "Benchmark/Benchmark.hpp"
+
+#include "Memory/Memory.hpp"
+
+struct BenchmarkInfo
+{
+	const char* name;
+	void(*function)(Allocator* allocator);
+};
+
+static const BenchmarkInfo benchmarks[] = {
+	{ "sort", Benchmark::RunSortBenchmark },
+	{ "jobs", Benchmark::RunJobSystemBenchmark },
+	{ "culling", Benchmark::RunCullingBenchmark },
+	{ "renderorder", Benchmark::RunRenderOrderBenchmark }
+};
+
+static const unsigned int BenchmarkCount = sizeof(benchmarks) / sizeof(benchmarks[0]);
+
+static void PrintUsage()
+{
+	std::printf("Usage: kokko_benchmark [name...]\n"
+		"Runs the named benchmarks, or all of them if no names are given:\n");
+
+	for (unsigned int i = 0; i < BenchmarkCount; ++i)
+		std::printf("  %s\n", benchmarks[i].name);
+}
+
+static const BenchmarkInfo* FindBenchmark(const char* name)
+{
+	for (unsigned int i = 0; i < BenchmarkCount; ++i)
+		if (std::strcmp(benchmarks[i].name, name) == 0)
+			return &benchmarks[i];
+
+	return nullptr;
+}
+
+int main(int argc, char** argv)
+{
+	for (int i = 1; i < argc; ++i)
+	{
+		if (FindBenchmark(argv[i]) == nullptr)
+		{
+			PrintUsage();
+			return -1;
+		}
+	}
+
+	Memory::InitializeMemorySystem();
+
+	Allocator* allocator = Memory::GetDefaultAllocator();
+
+	for (unsigned int i = 0; i < BenchmarkCount; ++i)
+	{
+		bool selected = argc <= 1;
+
+		for (int arg = 1; arg < argc; ++arg)
+			if (std::strcmp(argv[arg], benchmarks[i].name) == 0)
+				selected = true;
+
+		if (selected)
+		{
+			std::printf("== %s\n", benchmarks[i].name);
+			benchmarks[i].function(allocator);
+			std::printf("\n");
+		}
+	}
+
+	Memory::DeinitializeMemorySystem();
+
+	return 0;
+}
@@ -0,0 +1,351 @@
+#include "Core/AABBTree.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#include "Math/BoundingBox.hpp"
+#include "Memory/Allocator.hpp"
+
+static float SurfaceArea(const Vec3f& min, const Vec3f& max)
+{
+	Vec3f d = max - min;
+	return 2.0f * (d.x * d.y + d.y * d.z + d.z * d.x);
+}
+
+static Vec3f Min(const Vec3f& a, const Vec3f& b)
+{
+	return Vec3f(std::min(a.x, b.x), std::min(a.y, b.y), std::min(a.z, b.z));
+}
+
+static Vec3f Max(const Vec3f& a, const Vec3f& b)
+{
+	return Vec3f(std::max(a.x, b.x), std::max(a.y, b.y), std::max(a.z, b.z));
+}
+
+AABBTree::AABBTree(Allocator* allocator, float fatMarginRatio, float fatMarginMinimum) :
+	allocator(allocator),
+	nodes(nullptr),
+	nodeCount(0),
+	nodeCapacity(0),
+	root(Null),
+	freeList(Null),
+	fatMarginRatio(fatMarginRatio),
+	fatMarginMinimum(fatMarginMinimum)
+{
+}
+
+AABBTree::~AABBTree()
+{
+	allocator->Deallocate(nodes);
+}
+
+unsigned int AABBTree::AllocateNode()
+{
+	if (freeList == Null)
+	{
+		unsigned int newCapacity = nodeCapacity > 0 ? nodeCapacity * 2 : 64;
+		Node* newNodes = static_cast<Node*>(allocator->Allocate(sizeof(Node) * newCapacity));
+
+		if (nodes != nullptr)
+		{
+			std::memcpy(newNodes, nodes, sizeof(Node) * nodeCount);
+			allocator->Deallocate(nodes);
+		}
+
+		nodes = newNodes;
+		nodeCapacity = newCapacity;
+
+		// Link the new nodes into the free list
+		for (unsigned int i = nodeCount; i < newCapacity - 1; ++i)
+		{
+			nodes[i].parent = i + 1;
+			nodes[i].height = -1;
+		}
+
+		nodes[newCapacity - 1].parent = Null;
+		nodes[newCapacity - 1].height = -1;
+
+		freeList = nodeCount;
+	}
+
+	unsigned int nodeId = freeList;
+	Node& node = nodes[nodeId];
+	freeList = node.parent;
+
+	node.parent = Null;
+	node.child[0] = Null;
+	node.child[1] = Null;
+	node.height = 0;
+	node.userData = 0;
+
+	nodeCount += 1;
+
+	return nodeId;
+}
+
+void AABBTree::FreeNode(unsigned int nodeId)
+{
+	nodes[nodeId].parent = freeList;
+	nodes[nodeId].height = -1;
+	freeList = nodeId;
+
+	nodeCount -= 1;
+}
+
+void AABBTree::SetFatBounds(Node& node, const BoundingBox& bounds) const
+{
+	Vec3f margin = bounds.extents * fatMarginRatio +
+		Vec3f(fatMarginMinimum, fatMarginMinimum, fatMarginMinimum);
+
+	node.min = bounds.center - bounds.extents - margin;
+	node.max = bounds.center + bounds.extents + margin;
+}
+
+unsigned int AABBTree::CreateProxy(const BoundingBox& bounds, unsigned int userData)
+{
+	unsigned int proxyId = AllocateNode();
+
+	SetFatBounds(nodes[proxyId], bounds);
+	nodes[proxyId].userData = userData;
+
+	InsertLeaf(proxyId);
+
+	return proxyId;
+}
+
+void AABBTree::DestroyProxy(unsigned int proxyId)
+{
+	RemoveLeaf(proxyId);
+	FreeNode(proxyId);
+}
+
+bool AABBTree::MoveProxy(unsigned int proxyId, const BoundingBox& bounds)
+{
+	Node& node = nodes[proxyId];
+
+	Vec3f min = bounds.center - bounds.extents;
+	Vec3f max = bounds.center + bounds.extents;
+
+	bool contained =
+		node.min.x <= min.x && node.min.y <= min.y && node.min.z <= min.z &&
+		max.x <= node.max.x && max.y <= node.max.y && max.z <= node.max.z;
+
+	if (contained)
+		return false;
+
+	RemoveLeaf(proxyId);
+	SetFatBounds(nodes[proxyId], bounds);
+	InsertLeaf(proxyId);
+
+	return true;
+}
+
+void AABBTree::InsertLeaf(unsigned int leaf)
+{
+	if (root == Null)
+	{
+		root = leaf;
+		nodes[root].parent = Null;
+		return;
+	}
+
+	const Vec3f leafMin = nodes[leaf].min;
+	const Vec3f leafMax = nodes[leaf].max;
+
+	// Find the best sibling by descending towards the cheapest child,
+	// using surface area as the cost
+	unsigned int index = root;
+
+	while (nodes[index].IsLeaf() == false)
+	{
+		const Node& node = nodes[index];
+		unsigned int child0 = node.child[0];
+		unsigned int child1 = node.child[1];
+
+		float area = SurfaceArea(node.min, node.max);
+		float combinedArea = SurfaceArea(Min(node.min, leafMin), Max(node.max, leafMax));
+
+		// Cost of creating a new parent for this node and the new leaf
+		float cost = 2.0f * combinedArea;
+
+		// Minimum cost of pushing the leaf further down the tree
+		float inheritanceCost = 2.0f * (combinedArea - area);
+
+		float childCost[2];
+		unsigned int children[2] = { child0, child1 };
+
+		for (unsigned int i = 0; i < 2; ++i)
+		{
+			const Node& child = nodes[children[i]];
+			float newArea = SurfaceArea(Min(child.min, leafMin), Max(child.max, leafMax));
+
+			if (child.IsLeaf())
+				childCost[i] = newArea + inheritanceCost;
+			else
+				childCost[i] = newArea - SurfaceArea(child.min, child.max) + inheritanceCost;
+		}
+
+		if (cost < childCost[0] && cost < childCost[1])
+			break;
+
+		index = childCost[0] < childCost[1] ? child0 : child1;
+	}
+
+	unsigned int sibling = index;
+
+	// Create a new parent for the sibling and the leaf
+	unsigned int oldParent = nodes[sibling].parent;
+	unsigned int newParent = AllocateNode();
+
+	Node& parent = nodes[newParent];
+	parent.parent = oldParent;
+	parent.min = Min(leafMin, nodes[sibling].min);
+	parent.max = Max(leafMax, nodes[sibling].max);
+	parent.height = nodes[sibling].height + 1;
+	parent.child[0] = sibling;
+	parent.child[1] = leaf;
+
+	nodes[sibling].parent = newParent;
+	nodes[leaf].parent = newParent;
+
+	if (oldParent != Null)
+	{
+		if (nodes[oldParent].child[0] == sibling)
+			nodes[oldParent].child[0] = newParent;
+		else
+			nodes[oldParent].child[1] = newParent;
+	}
+	else
+		root = newParent;
+
+	Refit(nodes[leaf].parent);
+}
+
+void AABBTree::RemoveLeaf(unsigned int leaf)
+{
+	if (leaf == root)
+	{
+		root = Null;
+		return;
+	}
+
+	unsigned int parent = nodes[leaf].parent;
+	unsigned int grandParent = nodes[parent].parent;
+	unsigned int sibling = nodes[parent].child[0] == leaf ? nodes[parent].child[1] : nodes[parent].child[0];
+
+	if (grandParent != Null)
+	{
+		// Replace the parent with the sibling
+		if (nodes[grandParent].child[0] == parent)
+			nodes[grandParent].child[0] = sibling;
+		else
+			nodes[grandParent].child[1] = sibling;
+
+		nodes[sibling].parent = grandParent;
+		FreeNode(parent);
+
+		Refit(grandParent);
+	}
+	else
+	{
+		root = sibling;
+		nodes[sibling].parent = Null;
+		FreeNode(parent);
+	}
+}
+
+void AABBTree::Refit(unsigned int nodeId)
+{
+	// Walk back up the tree fixing heights and bounds
+	while (nodeId != Null)
+	{
+		nodeId = Balance(nodeId);
+
+		Node& node = nodes[nodeId];
+		const Node& child0 = nodes[node.child[0]];
+		const Node& child1 = nodes[node.child[1]];
+
+		node.height = 1 + std::max(child0.height, child1.height);
+		node.min = Min(child0.min, child1.min);
+		node.max = Max(child0.max, child1.max);
+
+		nodeId = node.parent;
+	}
+}
+
+unsigned int AABBTree::Balance(unsigned int iA)
+{
+	// Perform a left or right rotation if node A is imbalanced.
+	// Returns the new root index of the subtree.
+
+	Node* A = nodes + iA;
+
+	if (A->IsLeaf() || A->height < 2)
+		return iA;
+
+	unsigned int iB = A->child[0];
+	unsigned int iC = A->child[1];
+	Node* B = nodes + iB;
+	Node* C = nodes + iC;
+
+	int balance = C->height - B->height;
+
+	if (balance > 1 || balance < -1)
+	{
+		// Rotate the taller child up
+		bool rotateC = balance > 1;
+
+		unsigned int iUp = rotateC ? iC : iB;
+		unsigned int iOther = rotateC ? iB : iC;
+		Node* up = nodes + iUp;
+
+		unsigned int iF = up->child[0];
+		unsigned int iG = up->child[1];
+		Node* F = nodes + iF;
+		Node* G = nodes + iG;
+
+		// Swap A and the rotated child
+		up->child[0] = iA;
+		up->parent = A->parent;
+		A->parent = iUp;
+
+		// A's old parent should point to the rotated child
+		if (up->parent != Null)
+		{
+			if (nodes[up->parent].child[0] == iA)
+				nodes[up->parent].child[0] = iUp;
+			else
+				nodes[up->parent].child[1] = iUp;
+		}
+		else
+			root = iUp;
+
+		// Keep the taller grandchild under the rotated child
+		unsigned int iKeep = F->height > G->height ? iF : iG;
+		unsigned int iMove = F->height > G->height ? iG : iF;
+		Node* keep = nodes + iKeep;
+		Node* move = nodes + iMove;
+		Node* other = nodes + iOther;
+
+		up->child[1] = iKeep;
+
+		if (rotateC)
+			A->child[1] = iMove;
+		else
+			A->child[0] = iMove;
+
+		move->parent = iA;
+
+		A->min = Min(other->min, move->min);
+		A->max = Max(other->max, move->max);
+		A->height = 1 + std::max(other->height, move->height);
+
+		up->min = Min(A->min, keep->min);
+		up->max = Max(A->max, keep->max);
+		up->height = 1 + std::max(A->height, keep->height);
+
+		return iUp;
+	}
+
+	return iA;
+}
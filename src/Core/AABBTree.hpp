@@ -0,0 +1,192 @@
+#pragma once
+
+#include <cassert>
+#include <cmath>
+
+#include "Core/Array.hpp"
+
+#include "Math/Frustum.hpp"
+#include "Math/Vec3.hpp"
+
+class Allocator;
+
+struct BoundingBox;
+
+/**
+ * Incremental dynamic bounding volume hierarchy of axis-aligned bounding
+ * boxes. Leaves store fattened bounds so that small movements don't require
+ * changes to the tree. Inserting a leaf refits its ancestors and applies
+ * rotations to keep the tree balanced.
+ */
+class AABBTree
+{
+public:
+	static const unsigned int Null = ~0u;
+
+	// Bit mask of all six frustum planes, see QueryFrustum
+	static const unsigned int AllPlanes = 0x3f;
+
+private:
+	struct Node
+	{
+		Vec3f min;
+		Vec3f max;
+
+		// Parent node, or next free node when the node is in the free list
+		unsigned int parent;
+		unsigned int child[2];
+
+		// Leaf nodes have height 0, free nodes -1
+		int height;
+
+		unsigned int userData;
+
+		bool IsLeaf() const { return child[0] == Null; }
+	};
+
+	Allocator* allocator;
+
+	Node* nodes;
+	unsigned int nodeCount;
+	unsigned int nodeCapacity;
+
+	unsigned int root;
+	unsigned int freeList;
+
+	float fatMarginRatio;
+	float fatMarginMinimum;
+
+	unsigned int AllocateNode();
+	void FreeNode(unsigned int nodeId);
+
+	void InsertLeaf(unsigned int leaf);
+	void RemoveLeaf(unsigned int leaf);
+	unsigned int Balance(unsigned int nodeId);
+	void Refit(unsigned int nodeId);
+
+	void SetFatBounds(Node& node, const BoundingBox& bounds) const;
+
+public:
+	/**
+	 * Leaf bounds are grown by <fatMarginRatio> times the box extents plus
+	 * <fatMarginMinimum> on each side.
+	 */
+	AABBTree(Allocator* allocator, float fatMarginRatio = 0.1f, float fatMarginMinimum = 0.1f);
+	~AABBTree();
+
+	AABBTree(const AABBTree&) = delete;
+	AABBTree& operator=(const AABBTree&) = delete;
+
+	/**
+	 * Insert a box and return the proxy ID that refers to it.
+	 */
+	unsigned int CreateProxy(const BoundingBox& bounds, unsigned int userData);
+	void DestroyProxy(unsigned int proxyId);
+
+	/**
+	 * Update the bounds of a proxy. The leaf is only reinserted if the new
+	 * bounds are not contained in its fattened bounds.
+	 * Returns true if the tree was modified.
+	 */
+	bool MoveProxy(unsigned int proxyId, const BoundingBox& bounds);
+
+	unsigned int GetUserData(unsigned int proxyId) const { return nodes[proxyId].userData; }
+
+	int GetHeight() const { return root != Null ? nodes[root].height : 0; }
+
+	/**
+	 * Test <center> and <extents> against the planes in <planeMask> and clear
+	 * the bits of the planes the box is fully inside of.
+	 * Returns false if the box is outside any of the planes.
+	 */
+	static bool TestPlanes(const FrustumPlanes& frustum,
+		const Vec3f& center, const Vec3f& extents, unsigned int& planeMask)
+	{
+		for (unsigned int i = 0; i < 6; ++i)
+		{
+			const unsigned int bit = 1u << i;
+
+			if (planeMask & bit)
+			{
+				const Plane& plane = frustum.planes[i];
+
+				const float d = Vec3f::Dot(center, plane.normal);
+				const float r = extents.x * std::abs(plane.normal.x) +
+					extents.y * std::abs(plane.normal.y) +
+					extents.z * std::abs(plane.normal.z);
+
+				if (d + r < -plane.distance)
+					return false;
+
+				if (d - r >= -plane.distance)
+					planeMask &= ~bit;
+			}
+		}
+
+		return true;
+	}
+
+	/**
+	 * Call fn(userData, planeMask) for each leaf whose fattened bounds
+	 * intersect <frustum>. <planeMask> has the bits of the planes that the
+	 * leaf wasn't found to be fully inside of. If it's zero, the object is
+	 * known to be inside the frustum. Subtrees that are fully inside are
+	 * accepted without testing their nodes.
+	 */
+	template <typename Fn>
+	void QueryFrustum(const FrustumPlanes& frustum, Fn fn) const
+	{
+		if (root == Null)
+			return;
+
+		struct StackItem
+		{
+			unsigned int node;
+			unsigned int planeMask;
+		};
+
+		// The depth-first traversal leaves at most one sibling per level on the
+		// stack. Balancing keeps the tree height logarithmic, so the fixed size
+		// stack is enough unless the tree is very large.
+		const unsigned int FixedStackSize = 256;
+		StackItem fixedStack[FixedStackSize];
+		StackItem* stack = fixedStack;
+		unsigned int stackSize = 0;
+
+		const unsigned int requiredStackSize = static_cast<unsigned int>(nodes[root].height) + 2;
+		Array<StackItem> scratchStack(allocator);
+
+		if (requiredStackSize > FixedStackSize)
+		{
+			scratchStack.Resize(requiredStackSize);
+			stack = scratchStack.GetData();
+		}
+
+		stack[stackSize++] = StackItem{ root, AllPlanes };
+
+		while (stackSize > 0)
+		{
+			StackItem item = stack[--stackSize];
+			const Node& node = nodes[item.node];
+
+			if (item.planeMask != 0)
+			{
+				Vec3f extents = (node.max - node.min) * 0.5f;
+				Vec3f center = node.min + extents;
+
+				if (TestPlanes(frustum, center, extents, item.planeMask) == false)
+					continue;
+			}
+
+			if (node.IsLeaf())
+				fn(node.userData, item.planeMask);
+			else
+			{
+				assert(stackSize + 2 <= requiredStackSize);
+
+				stack[stackSize++] = StackItem{ node.child[1], item.planeMask };
+				stack[stackSize++] = StackItem{ node.child[0], item.planeMask };
+			}
+		}
+	}
+};
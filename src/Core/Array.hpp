@@ -271,4 +271,25 @@ public:
 		data = nullptr;
 		allocated = 0;
 	}
+
+	/**
+	 * Exchange the items, memory and allocators of the two arrays
+	 */
+	void Swap(Array& other)
+	{
+		Allocator* otherAllocator = other.allocator;
+		ValueType* otherData = other.data;
+		SizeType otherCount = other.count;
+		SizeType otherAllocated = other.allocated;
+
+		other.allocator = allocator;
+		other.data = data;
+		other.count = count;
+		other.allocated = allocated;
+
+		allocator = otherAllocator;
+		data = otherData;
+		count = otherCount;
+		allocated = otherAllocated;
+	}
 };
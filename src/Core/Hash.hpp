@@ -44,6 +44,20 @@ namespace Hash
 	{
 		return (FNV1a_32Basis * FNV_32MagicPrime) ^ static_cast<uint32_t>(v);
 	}
+
+	// Hashes the bytes of <v> from the least significant to the most significant
+	constexpr uint32_t FNV1a_32(uint64_t v)
+	{
+		uint32_t hash = FNV1a_32Basis;
+
+		for (unsigned int shift = 0; shift < 64; shift += 8)
+		{
+			hash ^= static_cast<uint32_t>((v >> shift) & 0xff);
+			hash *= FNV_32MagicPrime;
+		}
+
+		return hash;
+	}
 }
 
 constexpr uint32_t operator ""_hash(const char* string, size_t size)
@@ -284,4 +284,31 @@ public:
 
 		this->ReserveInternal(desiredSize);
 	}
+
+	/**
+	 * Exchange the items, memory and allocators of the two maps
+	 */
+	void Swap(HashMap& other)
+	{
+		Allocator* otherAllocator = other.allocator;
+		KeyValuePair* otherData = other.data;
+		unsigned int otherPopulation = other.population;
+		unsigned int otherAllocated = other.allocated;
+		bool otherZeroUsed = other.zeroUsed;
+		KeyValuePair otherZeroPair = other.zeroPair;
+
+		other.allocator = allocator;
+		other.data = data;
+		other.population = population;
+		other.allocated = allocated;
+		other.zeroUsed = zeroUsed;
+		other.zeroPair = zeroPair;
+
+		allocator = otherAllocator;
+		data = otherData;
+		population = otherPopulation;
+		allocated = otherAllocated;
+		zeroUsed = otherZeroUsed;
+		zeroPair = otherZeroPair;
+	}
 };
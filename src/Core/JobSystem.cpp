@@ -0,0 +1,203 @@
+#include "Core/JobSystem.hpp"
+
+#include <new>
+
+#include "Memory/Allocator.hpp"
+
+// Index of the worker queue that belongs to the current thread
+static thread_local unsigned int currentWorkerIndex = 0;
+
+JobSystem::JobSystem(Allocator* allocator, unsigned int workerThreadCount) :
+	allocator(allocator),
+	queues(nullptr),
+	threads(nullptr),
+	workerCount(workerThreadCount + 1),
+	queuedJobCount(0),
+	exitRequested(false)
+{
+	void* queueBuffer = allocator->Allocate(sizeof(WorkerQueue) * workerCount);
+	queues = static_cast<WorkerQueue*>(queueBuffer);
+
+	for (unsigned int i = 0; i < workerCount; ++i)
+	{
+		WorkerQueue* queue = new (queues + i) WorkerQueue;
+		queue->jobs = static_cast<Job*>(allocator->Allocate(sizeof(Job) * QueueCapacity));
+		queue->start = 0;
+		queue->count = 0;
+	}
+
+	if (workerThreadCount > 0)
+	{
+		void* threadBuffer = allocator->Allocate(sizeof(std::thread) * workerThreadCount);
+		threads = static_cast<std::thread*>(threadBuffer);
+
+		for (unsigned int i = 0; i < workerThreadCount; ++i)
+			new (threads + i) std::thread(&JobSystem::WorkerMain, this, i + 1);
+	}
+}
+
+JobSystem::~JobSystem()
+{
+	{
+		std::lock_guard<std::mutex> lock(sleepMutex);
+		exitRequested.store(true);
+	}
+
+	sleepCondition.notify_all();
+
+	if (threads != nullptr)
+	{
+		for (unsigned int i = 0, count = workerCount - 1; i < count; ++i)
+		{
+			threads[i].join();
+			threads[i].~thread();
+		}
+
+		allocator->Deallocate(threads);
+	}
+
+	for (unsigned int i = 0; i < workerCount; ++i)
+	{
+		allocator->Deallocate(queues[i].jobs);
+		queues[i].~WorkerQueue();
+	}
+
+	allocator->Deallocate(queues);
+}
+
+void JobSystem::WorkerMain(unsigned int workerIndex)
+{
+	currentWorkerIndex = workerIndex;
+
+	while (exitRequested.load() == false)
+	{
+		if (TryRunJob(workerIndex) == false)
+		{
+			std::unique_lock<std::mutex> lock(sleepMutex);
+			sleepCondition.wait(lock, [this]()
+			{
+				return queuedJobCount.load() > 0 || exitRequested.load();
+			});
+		}
+	}
+}
+
+bool JobSystem::PushJob(unsigned int workerIndex, const Job& job)
+{
+	WorkerQueue& queue = queues[workerIndex];
+	std::lock_guard<std::mutex> lock(queue.mutex);
+
+	if (queue.count == QueueCapacity)
+		return false;
+
+	queue.jobs[(queue.start + queue.count) % QueueCapacity] = job;
+	queue.count += 1;
+
+	queuedJobCount.fetch_add(1);
+
+	return true;
+}
+
+bool JobSystem::PopJob(unsigned int workerIndex, Job& jobOut)
+{
+	WorkerQueue& queue = queues[workerIndex];
+	std::lock_guard<std::mutex> lock(queue.mutex);
+
+	if (queue.count == 0)
+		return false;
+
+	queue.count -= 1;
+	jobOut = queue.jobs[(queue.start + queue.count) % QueueCapacity];
+
+	queuedJobCount.fetch_sub(1);
+
+	return true;
+}
+
+bool JobSystem::StealJob(unsigned int workerIndex, Job& jobOut)
+{
+	for (unsigned int offset = 1; offset < workerCount; ++offset)
+	{
+		WorkerQueue& queue = queues[(workerIndex + offset) % workerCount];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+
+		if (queue.count > 0)
+		{
+			jobOut = queue.jobs[queue.start];
+			queue.start = (queue.start + 1) % QueueCapacity;
+			queue.count -= 1;
+
+			queuedJobCount.fetch_sub(1);
+
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool JobSystem::TryRunJob(unsigned int workerIndex)
+{
+	Job job;
+
+	if (PopJob(workerIndex, job) || StealJob(workerIndex, job))
+	{
+		RunJob(job);
+		return true;
+	}
+
+	return false;
+}
+
+void JobSystem::RunJob(const Job& job)
+{
+	job.function(job.userData, job.begin, job.end);
+
+	if (job.counter != nullptr)
+		job.counter->pending.fetch_sub(1, std::memory_order_release);
+}
+
+void JobSystem::Submit(unsigned int count, const Job* jobs, JobCounter* counter)
+{
+	if (counter != nullptr)
+		counter->pending.fetch_add(count);
+
+	unsigned int workerIndex = currentWorkerIndex;
+	unsigned int pushed = 0;
+
+	for (unsigned int i = 0; i < count; ++i)
+	{
+		Job job = jobs[i];
+		job.counter = counter;
+
+		if (PushJob(workerIndex, job))
+			pushed += 1;
+		else // Queue is full, run the job right away
+			RunJob(job);
+	}
+
+	if (pushed > 0)
+	{
+		// Taking the lock makes sure a worker can't miss the wake-up between
+		// checking the queued job count and going to sleep
+		{
+			std::lock_guard<std::mutex> lock(sleepMutex);
+		}
+
+		if (pushed == 1)
+			sleepCondition.notify_one();
+		else
+			sleepCondition.notify_all();
+	}
+}
+
+void JobSystem::Wait(JobCounter* counter)
+{
+	unsigned int workerIndex = currentWorkerIndex;
+
+	while (counter->IsComplete() == false)
+	{
+		if (TryRunJob(workerIndex) == false)
+			std::this_thread::yield();
+	}
+}
@@ -0,0 +1,154 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+class Allocator;
+
+/**
+ * Counts the jobs that have been submitted but not yet completed.
+ * Wait on a counter before submitting jobs that depend on its results.
+ */
+struct JobCounter
+{
+	std::atomic<unsigned int> pending;
+
+	JobCounter() : pending(0) {}
+
+	bool IsComplete() const { return pending.load(std::memory_order_acquire) == 0; }
+};
+
+class JobSystem
+{
+public:
+	using JobFunction = void(*)(void* userData, unsigned int begin, unsigned int end);
+
+	struct Job
+	{
+		JobFunction function;
+		void* userData;
+		unsigned int begin;
+		unsigned int end;
+		JobCounter* counter;
+	};
+
+private:
+	static const unsigned int QueueCapacity = 4096;
+
+	// Double-ended queue of jobs owned by one worker.
+	// The owner pushes and pops at the back, other workers steal from the front.
+	struct WorkerQueue
+	{
+		std::mutex mutex;
+		Job* jobs;
+		unsigned int start;
+		unsigned int count;
+	};
+
+	Allocator* allocator;
+
+	WorkerQueue* queues;
+	std::thread* threads;
+
+	// Worker 0 is the thread that created the job system
+	unsigned int workerCount;
+
+	std::atomic<unsigned int> queuedJobCount;
+	std::atomic<bool> exitRequested;
+
+	std::mutex sleepMutex;
+	std::condition_variable sleepCondition;
+
+	void WorkerMain(unsigned int workerIndex);
+
+	bool PushJob(unsigned int workerIndex, const Job& job);
+	bool PopJob(unsigned int workerIndex, Job& jobOut);
+	bool StealJob(unsigned int workerIndex, Job& jobOut);
+
+	bool TryRunJob(unsigned int workerIndex);
+	void RunJob(const Job& job);
+
+	template <typename Fn>
+	static void InvokeRange(void* userData, unsigned int begin, unsigned int end)
+	{
+		(*static_cast<Fn*>(userData))(begin, end);
+	}
+
+public:
+	/**
+	 * Create a job system that runs jobs on <workerThreadCount> threads in
+	 * addition to the calling thread. Queue storage is taken from <allocator>.
+	 */
+	JobSystem(Allocator* allocator, unsigned int workerThreadCount);
+	~JobSystem();
+
+	JobSystem(const JobSystem&) = delete;
+	JobSystem& operator=(const JobSystem&) = delete;
+
+	/**
+	 * Number of threads that execute jobs, including the thread that waits.
+	 */
+	unsigned int GetWorkerCount() const { return workerCount; }
+
+	/**
+	 * Submit jobs to the calling thread's queue. Each job's counter is
+	 * set to <counter> and the counter is incremented by <count>.
+	 */
+	void Submit(unsigned int count, const Job* jobs, JobCounter* counter);
+
+	/**
+	 * Run queued jobs on the calling thread until <counter> reaches zero.
+	 */
+	void Wait(JobCounter* counter);
+
+	/**
+	 * Call fn(begin, end) for consecutive ranges of at most <grain> items
+	 * covering [0, count) and return once all ranges have been processed.
+	 * If there is only one range or no worker threads, fn(0, count) is
+	 * called once on the calling thread instead.
+	 */
+	template <typename Fn>
+	void ParallelFor(unsigned int count, unsigned int grain, Fn fn)
+	{
+		if (grain == 0)
+			grain = 1;
+
+		unsigned int jobCount = (count + grain - 1) / grain;
+
+		if (jobCount <= 1 || workerCount <= 1)
+		{
+			if (count > 0)
+				fn(0u, count);
+
+			return;
+		}
+
+		const unsigned int BatchSize = 64;
+		Job batch[BatchSize];
+		unsigned int batchCount = 0;
+
+		JobCounter counter;
+
+		for (unsigned int begin = 0; begin < count; begin += grain)
+		{
+			Job& job = batch[batchCount++];
+			job.function = &InvokeRange<Fn>;
+			job.userData = &fn;
+			job.begin = begin;
+			job.end = count - begin > grain ? begin + grain : count;
+
+			if (batchCount == BatchSize)
+			{
+				Submit(batchCount, batch, &counter);
+				batchCount = 0;
+			}
+		}
+
+		if (batchCount > 0)
+			Submit(batchCount, batch, &counter);
+
+		Wait(&counter);
+	}
+};
@@ -1,6 +1,8 @@
 #pragma once
 
+#include <cstdint>
 #include <cstdlib>
+#include <cstring>
 
 template <typename T>
 void InsertionSortAsc(T* array, size_t count)
@@ -139,3 +141,66 @@ void ShellSortDesc(T* array, size_t count)
 		}
 	}
 }
+
+/**
+ * Sort an array of 64-bit keys in ascending order using a least significant
+ * digit radix sort. The scratch buffer must have space for <count> keys.
+ * Passes where every key has the same digit value are skipped.
+ */
+inline void RadixSortAsc(uint64_t* array, uint64_t* scratch, size_t count)
+{
+	const unsigned int DigitBits = 8;
+	const unsigned int DigitCount = sizeof(uint64_t) * 8 / DigitBits;
+	const unsigned int BucketCount = 1 << DigitBits;
+	const uint64_t DigitMask = BucketCount - 1;
+
+	if (count < 2)
+		return;
+
+	// Gather histograms for all digits in a single pass over the keys
+	size_t histograms[DigitCount][BucketCount] = {};
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		uint64_t key = array[i];
+
+		for (unsigned int digit = 0; digit < DigitCount; ++digit)
+			histograms[digit][(key >> (digit * DigitBits)) & DigitMask] += 1;
+	}
+
+	uint64_t* src = array;
+	uint64_t* dst = scratch;
+
+	for (unsigned int digit = 0; digit < DigitCount; ++digit)
+	{
+		const unsigned int shift = digit * DigitBits;
+		size_t* offsets = histograms[digit];
+
+		// All keys share this digit, so this pass wouldn't change the order
+		if (offsets[(src[0] >> shift) & DigitMask] == count)
+			continue;
+
+		// Convert bucket counts to starting offsets
+		size_t offset = 0;
+		for (unsigned int bucket = 0; bucket < BucketCount; ++bucket)
+		{
+			size_t bucketCount = offsets[bucket];
+			offsets[bucket] = offset;
+			offset += bucketCount;
+		}
+
+		for (size_t i = 0; i < count; ++i)
+		{
+			uint64_t key = src[i];
+			dst[offsets[(key >> shift) & DigitMask]++] = key;
+		}
+
+		uint64_t* temporary = src;
+		src = dst;
+		dst = temporary;
+	}
+
+	// Result ended up in the scratch buffer after an odd number of passes
+	if (src != array)
+		std::memcpy(array, src, count * sizeof(uint64_t));
+}
@@ -16,6 +16,7 @@
 
 #include "Rendering/Renderer.hpp"
 #include "Rendering/RenderDevice.hpp"
+#include "Rendering/RenderThread.hpp"
 
 #include "Resources/BitmapFont.hpp"
 #include "Resources/ShaderManager.hpp"
@@ -42,6 +43,7 @@ Debug::Debug(
 	allocator(allocator),
 	renderDevice(renderDevice),
 	window(nullptr),
+	renderThread(nullptr),
 	currentFrameRate(0.0),
 	nextFrameRateUpdate(-1.0),
 	mode(DebugMode::None)
@@ -117,6 +119,7 @@ void Debug::Initialize(Window* window, Renderer* renderer,
 	graph->SetDrawArea(graphArea);
 
 	culling->SetRenderer(renderer);
+	memoryStats->SetRenderer(renderer);
 	culling->SetGuideTextPosition(Vec2f(0.0f, scaledLineHeight));
 }
 
@@ -125,6 +128,23 @@ void Debug::Deinitialize()
 	vectorRenderer->Deinitialize();
 }
 
+void Debug::DrawRenderThreadStats(float lineHeight)
+{
+	RenderThread::Stats stats = renderThread->GetStats();
+
+	Vec2f position(0.0f, lineHeight);
+
+	char buffer[128];
+	std::snprintf(buffer, sizeof(buffer), "Render thread latency: %.2f ms, queued: %.2f ms, replay: %.2f ms, swap: %.2f ms",
+		stats.latencyMilliseconds, stats.queueMilliseconds, stats.replayMilliseconds, stats.swapMilliseconds);
+	textRenderer->AddText(StringRef(buffer), position);
+	position.y += lineHeight;
+
+	std::snprintf(buffer, sizeof(buffer), "Submit wait: %.2f ms, packet size: %llu bytes, packets in flight: %u",
+		stats.submitWaitMilliseconds, static_cast<unsigned long long>(stats.packetSize), stats.packetsInFlight);
+	textRenderer->AddText(StringRef(buffer), position);
+}
+
 void Debug::Render(Scene* scene)
 {
 	bool vsync = false;
@@ -157,6 +177,17 @@ void Debug::Render(Scene* scene)
 			this->mode = DebugMode::MemoryStats;
 		}
 
+		// Check culling view switches
+
+		if (this->mode == DebugMode::Culling)
+		{
+			if (keyboard->GetKeyDown(Key::F5))
+				culling->ToggleOcclusionCulling();
+
+			if (keyboard->GetKeyDown(Key::F6))
+				culling->ToggleOpaqueSortOrder();
+		}
+
 		// Check vsync switching
 
 		vsync = window->GetSwapInterval() != 0;
@@ -246,8 +277,13 @@ void Debug::Render(Scene* scene)
 		console->UpdateAndDraw();
 
 	if (mode == DebugMode::FrameTime)
+	{
 		graph->DrawToVectorRenderer();
 
+		if (renderThread != nullptr)
+			DrawRenderThreadStats(static_cast<float>(lineHeight));
+	}
+
 	if (mode == DebugMode::Culling)
 		culling->UpdateAndDraw(scene);
 
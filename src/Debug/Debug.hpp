@@ -8,6 +8,7 @@ class ShaderManager;
 class Scene;
 class Window;
 class Renderer;
+class RenderThread;
 class SceneManager;
 
 class DebugVectorRenderer;
@@ -34,6 +35,9 @@ private:
 
 	Window* window;
 
+	// Null unless frames are submitted on a render thread
+	RenderThread* renderThread;
+
 	double currentFrameRate;
 	double nextFrameRateUpdate;
 
@@ -47,6 +51,8 @@ private:
 	}
 	mode;
 
+	void DrawRenderThreadStats(float lineHeight);
+
 public:
 	Debug(Allocator* allocator, AllocatorManager* allocManager,
 		Window* window, RenderDevice* renderDevice);
@@ -55,7 +61,10 @@ public:
 	void Initialize(Window* window, Renderer* renderer, MeshManager* meshManager,
 		ShaderManager* shaderManager, SceneManager* sceneManager);
 	void Deinitialize();
-	
+
+	// Frame latency of the render thread is shown in the frame time view
+	void SetRenderThread(RenderThread* thread) { renderThread = thread; }
+
 	void Render(Scene* scene);
 
 	DebugLog* GetLog() { return log; }
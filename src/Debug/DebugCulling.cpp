@@ -1,9 +1,13 @@
 #include "Debug/DebugCulling.hpp"
 
+#include <cstdio>
+
 #include "Application/App.hpp"
 #include "Engine/Engine.hpp"
 #include "Entity/EntityManager.hpp"
 #include "System/Window.hpp"
+#include "Resources/BitmapFont.hpp"
+#include "Rendering/OcclusionCuller.hpp"
 #include "Rendering/Renderer.hpp"
 #include "Scene/Scene.hpp"
 #include "Math/Frustum.hpp"
@@ -28,11 +32,76 @@ void DebugCulling::SetLockCullingCamera(bool lockCullingCamera)
 	renderer->SetLockCullingCamera(lockCullingCamera);
 }
 
+void DebugCulling::ToggleOpaqueSortOrder()
+{
+	RenderOrderSort sort = renderer->GetSortOrder(RenderPass::OpaqueGeometry);
+
+	renderer->SetSortOrder(RenderPass::OpaqueGeometry, sort == RenderOrderSort::DepthMajor ?
+		RenderOrderSort::MaterialMajor : RenderOrderSort::DepthMajor);
+}
+
+void DebugCulling::ToggleOcclusionCulling()
+{
+	OcclusionCuller* occlusionCuller = renderer->GetOcclusionCuller();
+	occlusionCuller->SetEnabled(occlusionCuller->IsEnabled() == false);
+}
+
 void DebugCulling::UpdateAndDraw(Scene* scene)
 {
+	Vec2f textPosition = guideTextPosition;
+
+	const BitmapFont* font = textRenderer->GetFont();
+	float lineHeight = font != nullptr ? static_cast<float>(font->GetLineHeight()) : 0.0f;
+
+	{
+		// Changes between object draws, to compare sort orders
+		const Renderer::StateChangeStats& changes = renderer->GetStateChangeStats();
+
+		char buffer[128];
+		std::snprintf(buffer, sizeof(buffer), "Draw calls: %u, program changes: %u, materials: %u, vertex arrays: %u, textures: %u",
+			changes.drawCalls, changes.shaderProgramChanges, changes.materialChanges,
+			changes.vertexArrayChanges, changes.textureChanges);
+
+		textRenderer->AddText(StringRef(buffer), textPosition);
+		textPosition.y += lineHeight;
+
+		bool materialMajor = renderer->GetSortOrder(RenderPass::OpaqueGeometry) == RenderOrderSort::MaterialMajor;
+		std::snprintf(buffer, sizeof(buffer), "[F6] Opaque sort order: %s", materialMajor ? "material-major" : "depth-major");
+
+		textRenderer->AddText(StringRef(buffer), textPosition);
+		textPosition.y += lineHeight;
+	}
+
+	OcclusionCuller* occlusionCuller = renderer->GetOcclusionCuller();
+
+	char buffer[128];
+	std::snprintf(buffer, sizeof(buffer), "[F5] Occlusion culling: %s", occlusionCuller->IsEnabled() ? "on" : "off");
+
+	textRenderer->AddText(StringRef(buffer), textPosition);
+	textPosition.y += lineHeight;
+
+	if (occlusionCuller->IsEnabled())
+	{
+		const OcclusionCuller::Stats& stats = occlusionCuller->GetStats();
+
+		std::snprintf(buffer, sizeof(buffer), "Occluders: %u / %u, occluded objects: %u / %u",
+			stats.occludersRasterized, stats.occluderCandidates, stats.objectsOccluded, stats.objectsTested);
+
+		textRenderer->AddText(StringRef(buffer), textPosition);
+		textPosition.y += lineHeight;
+
+		// Draw the occluders that were rasterized on the last frame
+		Color occluderColor(1.0f, 0.5f, 0.0f);
+
+		const Mat4x4f* occluders = occlusionCuller->GetOccluderTransforms();
+
+		for (unsigned int i = 0, count = occlusionCuller->GetOccluderCount(); i < count; ++i)
+			vectorRenderer->DrawWireCube(occluders[i], occluderColor);
+	}
+
 	if (cullingCameraIsLocked)
 	{
-		textRenderer->AddText(StringRef("Culling camera is locked"), guideTextPosition);
+		textRenderer->AddText(StringRef("Culling camera is locked"), textPosition);
 
 		const Mat4x4f& transform = renderer->GetCullingCameraTransform();
 
@@ -27,5 +27,11 @@ public:
 	void UpdateAndDraw(Scene* scene);
 
 	void SetLockCullingCamera(bool lockCullingCamera);
+
+	// Switch the opaque geometry pass between depth-major and material-major sorting
+	void ToggleOpaqueSortOrder();
+
+	// Switch CPU occlusion culling of the main viewport on or off
+	void ToggleOcclusionCulling();
 	void SetGuideTextPosition(const Vec2f& pos) { guideTextPosition = pos; }
 };
@@ -5,11 +5,16 @@
 
 #include "Memory/AllocatorManager.hpp"
 
+#include "Rendering/PersistentRingBuffer.hpp"
+#include "Rendering/Renderer.hpp"
+#include "Rendering/RenderTargetContainer.hpp"
+
 #include "Debug/DebugTextRenderer.hpp"
 
 DebugMemoryStats::DebugMemoryStats(AllocatorManager* allocatorManager, DebugTextRenderer* textRenderer) :
 	allocatorManager(allocatorManager),
-	textRenderer(textRenderer)
+	textRenderer(textRenderer),
+	renderer(nullptr)
 {
 }
 
@@ -106,4 +111,59 @@ void DebugMemoryStats::UpdateAndDraw()
 			textRenderer->AddText(StringRef(buffer), area);
 		}
 	}
+	if (renderer != nullptr)
+	{
+		const RenderTargetContainer::Stats& stats = renderer->GetRenderTargetContainer()->GetStats();
+
+		char countBuffer[32];
+
+		std::sprintf(countBuffer, "%u", stats.targetCount);
+		std::sprintf(buffer, "%llu", static_cast<unsigned long long>(stats.currentBytes));
+		DrawRow(scopeCount + 2, "Render targets", countBuffer, buffer);
+
+		std::sprintf(buffer, "%llu", static_cast<unsigned long long>(stats.peakBytes));
+		DrawRow(scopeCount + 3, "Render targets peak", "", buffer);
+
+		// Bytes written this frame and the total number of frames that waited for the GPU
+		const PersistentRingBuffer::Stats& transforms = renderer->GetTransformBufferStats();
+
+		std::sprintf(countBuffer, "%u stalls", transforms.stallCount);
+		std::sprintf(buffer, "%llu", static_cast<unsigned long long>(transforms.bytesWritten));
+		DrawRow(scopeCount + 5, "Transform ring buffer", countBuffer, buffer);
+
+		const PersistentRingBuffer::Stats& indirect = renderer->GetIndirectBufferStats();
+
+		std::sprintf(countBuffer, "%u stalls", indirect.stallCount);
+		std::sprintf(buffer, "%llu", static_cast<unsigned long long>(indirect.bytesWritten));
+		DrawRow(scopeCount + 6, "Indirect ring buffer", countBuffer, buffer);
+	}
+}
+
+void DebugMemoryStats::DrawRow(unsigned int row, const char* name, const char* count, const char* size)
+{
+	const unsigned int columnWidth0 = 24;
+	const unsigned int columnWidth1 = 12;
+	const unsigned int columnWidth2 = 12;
+
+	const BitmapFont* font = textRenderer->GetFont();
+	int lineHeight = font->GetLineHeight();
+	int glyphWidth = font->GetGlyphWidth();
+	Vec2f areaPos = this->drawArea.position;
+
+	const char* columns[] = { name, count, size };
+	const unsigned int columnWidths[] = { columnWidth0, columnWidth1, columnWidth2 };
+	unsigned int columnStart = 0;
+
+	for (unsigned int i = 0; i < 3; ++i)
+	{
+		Rectanglef area;
+		area.position.x = areaPos.x + glyphWidth * columnStart;
+		area.position.y = areaPos.y + (lineHeight * row);
+		area.size.x = static_cast<float>(glyphWidth * columnWidths[i]);
+		area.size.y = static_cast<float>(lineHeight);
+
+		textRenderer->AddText(StringRef(columns[i]), area);
+
+		columnStart += columnWidths[i];
+	}
 }
@@ -4,20 +4,28 @@
 
 class AllocatorManager;
 class DebugTextRenderer;
+class Renderer;
 
 class DebugMemoryStats
 {
 private:
 	AllocatorManager* allocatorManager;
 	DebugTextRenderer* textRenderer;
+	Renderer* renderer;
 
 	Rectanglef drawArea;
 
+	void DrawRow(unsigned int row, const char* name, const char* count, const char* size);
+
 public:
 	DebugMemoryStats(AllocatorManager* allocatorManager, DebugTextRenderer* textRenderer);
 	~DebugMemoryStats();
 
 	void SetDrawArea(const Rectanglef& area);
 
+	// Video memory of the render targets and the per-frame writes to the
+	// renderer's ring buffers are shown below the allocator scopes
+	void SetRenderer(Renderer* renderer) { this->renderer = renderer; }
+
 	void UpdateAndDraw();
 };
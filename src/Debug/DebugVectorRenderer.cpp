@@ -458,7 +458,7 @@ void DebugVectorRenderer::Render(Camera* camera)
 
 		Scene* scene = sceneManager->GetScene(sceneManager->GetPrimarySceneId());
 		SceneObjectId cameraSceneObject = scene->Lookup(camera->GetEntity());
-		const Mat4x4f& cameraTransform = scene->GetWorldTransform(cameraSceneObject);
+		const Mat3x4f& cameraTransform = scene->GetWorldTransform(cameraSceneObject);
 
 		bool reverseDepth = false;
 		Mat4x4f proj = camera->parameters.GetProjectionMatrix(reverseDepth);
@@ -1,7 +1,9 @@
 #include "Engine/Engine.hpp"
 
 #include <cstdio>
+#include <thread>
 
+#include "Core/JobSystem.hpp"
 #include "Core/String.hpp"
 
 #include "Debug/Debug.hpp"
@@ -18,7 +20,11 @@
 #include "Memory/ProxyAllocator.hpp"
 
 #include "Rendering/LightManager.hpp"
+#include "Rendering/RenderCaptureFile.hpp"
 #include "Rendering/RenderDeviceOpenGL.hpp"
+#include "Rendering/RenderDeviceRecorder.hpp"
+#include "Rendering/RenderDeviceStateFilter.hpp"
+#include "Rendering/RenderThread.hpp"
 #include "Rendering/Renderer.hpp"
 #include "Rendering/TerrainManager.hpp"
 
@@ -39,7 +45,8 @@ void Engine::InstanceAllocatorPair<Type>::CreateScope(AllocatorManager* manager,
 	allocator = manager->CreateAllocatorScope(name, alloc);
 }
 
-Engine::Engine()
+Engine::Engine(const Settings& settings) :
+	settings(settings)
 {
 	Memory::InitializeMemorySystem();
 	Allocator* alloc = Memory::GetDefaultAllocator();
@@ -47,29 +54,79 @@ Engine::Engine()
 	allocatorManager = alloc->MakeNew<AllocatorManager>(alloc);
 
 	mainWindow.CreateScope(allocatorManager, "Window", alloc);
-	mainWindow.New(mainWindow.allocator);
-
 	systemAllocator = allocatorManager->CreateAllocatorScope("System", alloc);
 	time = systemAllocator->MakeNew<Time>();
-	renderDevice = systemAllocator->MakeNew<RenderDeviceOpenGL>();
+
+	// Without a window there's no context for a render thread to own
+	if (settings.headless)
+		this->settings.renderThread = false;
+
+	// The render thread takes the recorded commands every frame, so a capture
+	// wouldn't have the objects the captured frame uses
+	if (this->settings.renderThread)
+		this->settings.captureFrame = 0;
+
+	renderThread.CreateScope(allocatorManager, "RenderThread", alloc);
+	renderThread.instance = nullptr;
+
+	if (settings.headless)
+	{
+		mainWindow.instance = nullptr;
+		renderDevice = nullptr;
+	}
+	else
+	{
+		mainWindow.New(mainWindow.allocator);
+		renderDevice = systemAllocator->MakeNew<RenderDeviceOpenGL>();
+	}
+
+	// Without a window the recorder acts as the device. With a render thread
+	// it acts as the device too and records the commands for the thread.
+	// Otherwise it's only needed to capture frames.
+	if (this->settings.headless || this->settings.renderThread)
+	{
+		renderDeviceRecorder = systemAllocator->MakeNew<RenderDeviceRecorder>(systemAllocator, nullptr);
+		renderDeviceRecorder->SetRecording(this->settings.renderThread || this->settings.captureFrame != 0);
+	}
+	else if (this->settings.captureFrame != 0)
+	{
+		renderDeviceRecorder = systemAllocator->MakeNew<RenderDeviceRecorder>(systemAllocator, renderDevice);
+
+		// Record from the start, so that the objects the captured frame uses are in the capture
+		renderDeviceRecorder->SetRecording(true);
+	}
+	else
+		renderDeviceRecorder = nullptr;
+
+	// All systems use the device through the filter, so that state changes
+	// are tracked in one place
+	RenderDevice* filteredDevice = renderDeviceRecorder != nullptr ? renderDeviceRecorder : renderDevice;
+	renderDeviceStateFilter = systemAllocator->MakeNew<RenderDeviceStateFilter>(filteredDevice);
+
+	// The main thread also runs jobs while it waits for them
+	unsigned int threadCount = std::thread::hardware_concurrency();
+	unsigned int workerThreadCount = threadCount > 1 ? threadCount - 1 : 0;
+
+	jobSystem.CreateScope(allocatorManager, "JobSystem", alloc);
+	jobSystem.New(jobSystem.allocator, workerThreadCount);
 
 	debug.CreateScope(allocatorManager, "Debug", alloc);
-	debug.New(debug.allocator, allocatorManager, mainWindow.instance, renderDevice);
+	debug.New(debug.allocator, allocatorManager, mainWindow.instance, renderDeviceStateFilter);
 
 	entityManager.CreateScope(allocatorManager, "EntityManager", alloc);
 	entityManager.New(entityManager.allocator);
 
 	meshManager.CreateScope(allocatorManager, "MeshManager", alloc);
-	meshManager.New(meshManager.allocator, renderDevice);
+	meshManager.New(meshManager.allocator, renderDeviceStateFilter);
 
 	textureManager.CreateScope(allocatorManager, "TextureManager", alloc);
-	textureManager.New(textureManager.allocator, renderDevice);
+	textureManager.New(textureManager.allocator, renderDeviceStateFilter);
 
 	shaderManager.CreateScope(allocatorManager, "ShaderManager", alloc);
-	shaderManager.New(shaderManager.allocator, renderDevice);
+	shaderManager.New(shaderManager.allocator, renderDeviceStateFilter);
 
 	materialManager.CreateScope(allocatorManager, "MaterialManager", alloc);
-	materialManager.New(materialManager.allocator, renderDevice, shaderManager.instance, textureManager.instance);
+	materialManager.New(materialManager.allocator, renderDeviceStateFilter, shaderManager.instance, textureManager.instance);
 
 	lightManager.CreateScope(allocatorManager, "LightManager", alloc);
 	lightManager.New(lightManager.allocator);
@@ -78,20 +135,22 @@ Engine::Engine()
 	sceneManager.New(this, sceneManager.allocator);
 
 	terrainManager.CreateScope(allocatorManager, "TerrainManager", alloc);
-	terrainManager.New(terrainManager.allocator, renderDevice, meshManager.instance, materialManager.instance);
+	terrainManager.New(terrainManager.allocator, renderDeviceStateFilter, meshManager.instance, materialManager.instance);
 
 	particleSystem.CreateScope(allocatorManager, "ParticleManager", alloc);
-	particleSystem.New(renderDevice, shaderManager.instance, meshManager.instance);
+	particleSystem.New(renderDeviceStateFilter, shaderManager.instance, meshManager.instance);
 
 	renderer.CreateScope(allocatorManager, "Renderer", alloc);
-	renderer.New(renderer.allocator, renderDevice, lightManager.instance,
+	renderer.New(renderer.allocator, jobSystem.instance, renderDeviceStateFilter, lightManager.instance,
 		shaderManager.instance, meshManager.instance, materialManager.instance);
 }
 
 Engine::~Engine()
 {
 	renderer.instance->Deinitialize();
-	debug.instance->Deinitialize();
+
+	if (settings.headless == false)
+		debug.instance->Deinitialize();
 
 	renderer.Delete();
 	particleSystem.Delete();
@@ -104,9 +163,22 @@ Engine::~Engine()
 	meshManager.Delete();
 	entityManager.Delete();
 	debug.Delete();
+	jobSystem.Delete();
+
+	// Execute the commands that destroy the device objects before stopping the thread
+	if (renderThread.instance != nullptr)
+	{
+		renderThread.instance->Submit(renderDeviceRecorder, false);
+		renderThread.Delete();
+	}
+
 	systemAllocator->MakeDelete(this->time);
+	systemAllocator->MakeDelete(this->renderDeviceStateFilter);
+	systemAllocator->MakeDelete(this->renderDeviceRecorder);
 	systemAllocator->MakeDelete(this->renderDevice);
-	mainWindow.Delete();
+
+	if (mainWindow.instance != nullptr)
+		mainWindow.Delete();
 
 	Allocator* defaultAllocator = Memory::GetDefaultAllocator();
 	defaultAllocator->MakeDelete(this->allocatorManager);
@@ -116,16 +188,25 @@ Engine::~Engine()
 
 bool Engine::Initialize()
 {
-	Vec2i windowSize(1920, 1080);
+	Vec2i frameSize(settings.frameWidth, settings.frameHeight);
 
-	if (mainWindow.instance->Initialize(windowSize.x, windowSize.y, "Kokko"))
+	if (settings.headless == false)
 	{
-		const char* const logFilename = "log.txt";
-		const char* const debugFontFilename = "res/fonts/gohufont-uni-14.bdf";
+		if (mainWindow.instance->Initialize(frameSize.x, frameSize.y, "Kokko") == false)
+			return false;
 
-		DebugLog* debugLog = debug.instance->GetLog();
-		debugLog->OpenLogFile(logFilename, false);
+		frameSize = mainWindow.instance->GetFrameBufferSize();
+	}
+
+	const char* const logFilename = "log.txt";
+	const char* const debugFontFilename = "res/fonts/gohufont-uni-14.bdf";
 
+	DebugLog* debugLog = debug.instance->GetLog();
+	debugLog->OpenLogFile(logFilename, false);
+
+	// Debug overlays draw to the window and read its input
+	if (settings.headless == false)
+	{
 		DebugTextRenderer* debugTextRenderer = debug.instance->GetTextRenderer();
 		bool fontLoaded = debugTextRenderer->LoadBitmapFont(textureManager.instance, debugFontFilename);
 		if (fontLoaded == false)
@@ -137,36 +218,81 @@ bool Engine::Initialize()
 
 		debug.instance->Initialize(mainWindow.instance, renderer.instance,
 			meshManager.instance, shaderManager.instance, sceneManager.instance);
+	}
 
-		textureManager.instance->Initialize();
-		renderer.instance->Initialize(mainWindow.instance, entityManager.instance);
-		terrainManager.instance->Initialize(renderer.instance, shaderManager.instance);
-		particleSystem.instance->Initialize(renderer.instance);
+	textureManager.instance->Initialize();
+	renderer.instance->Initialize(frameSize, entityManager.instance);
+	terrainManager.instance->Initialize(renderer.instance, shaderManager.instance);
+	particleSystem.instance->Initialize(renderer.instance);
 
-		return true;
-	}
-	else
+	if (settings.renderThread)
 	{
-		return false;
+		// The context moves to the render thread for the rest of its life
+		Window::ReleaseCurrentContext();
+
+		renderThread.New(systemAllocator, renderThread.allocator, mainWindow.instance,
+			renderDevice, settings.renderQueueDepth);
+
+		debug.instance->SetRenderThread(renderThread.instance);
+
+		// Create the objects that initialization recorded
+		renderThread.instance->Submit(renderDeviceRecorder, false);
 	}
+
+	return true;
 }
 
 void Engine::Update()
 {
 	this->time->Update();
 
+	bool capturingFrame = settings.captureFrame != 0 && Time::GetFrameNumber() == settings.captureFrame;
+	size_t captureFrameStart = capturingFrame ? renderDeviceRecorder->GetCommandStream().GetCount() : 0;
+
 	unsigned int primarySceneId = sceneManager.instance->GetPrimarySceneId();
 	Scene* primaryScene = sceneManager.instance->GetScene(primarySceneId);
 
-	// Propagate transform updates from Scene to other systems that require it
-	ITransformUpdateReceiver* transformUpdateReceivers[] = { lightManager.instance, renderer.instance };
-	unsigned int receiverCount = sizeof(transformUpdateReceivers) / sizeof(transformUpdateReceivers[0]);
-	primaryScene->NotifyUpdatedTransforms(receiverCount, transformUpdateReceivers);
+	primaryScene->UpdateWorldTransforms(jobSystem.instance);
+
+	// Propagate transform updates from Scene to the systems that attached components to it
+	primaryScene->NotifyUpdatedTransforms();
+
+	if (settings.headless == false)
+		renderer.instance->SetFrameSize(mainWindow.instance->GetFrameBufferSize());
 
 	renderer.instance->Render(primaryScene);
 
-	debug.instance->Render(primaryScene);
+	if (capturingFrame)
+		WriteFrameCapture(captureFrameStart);
+
+	if (settings.headless == false)
+	{
+		debug.instance->Render(primaryScene);
+
+		mainWindow.instance->UpdateInput();
+
+		if (renderThread.instance != nullptr)
+		{
+			// The render thread swaps buffers after submitting the frame
+			renderThread.instance->Submit(renderDeviceRecorder, true);
+			mainWindow.instance->PollEvents();
+		}
+		else
+			mainWindow.instance->Swap();
+	}
+}
+
+void Engine::WriteFrameCapture(size_t frameStart)
+{
+	const char* filename = settings.captureFilename;
+	bool written = RenderCaptureFile::Write(filename, renderDeviceRecorder->GetCommandStream(), frameStart);
+
+	Allocator* defaultAllocator = Memory::GetDefaultAllocator();
+	String logText(defaultAllocator, written ? "Wrote frame capture to " : "Writing frame capture failed: ");
+	logText.Append(filename);
+	debug.instance->GetLog()->Log(logText);
 
-	mainWindow.instance->UpdateInput();
-	mainWindow.instance->Swap();
+	// Only one frame is captured, so the recorded commands aren't needed anymore
+	renderDeviceRecorder->SetRecording(false);
+	renderDeviceRecorder->ClearCommandStream();
 }
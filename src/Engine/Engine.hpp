@@ -1,10 +1,16 @@
 #pragma once
 
+#include <cstddef>
+
 class Allocator;
 class AllocatorManager;
 class Window;
 class Time;
+class JobSystem;
 class RenderDevice;
+class RenderDeviceRecorder;
+class RenderDeviceStateFilter;
+class RenderThread;
 class EntityManager;
 class Renderer;
 class MeshManager;
@@ -20,6 +26,42 @@ class Debug;
 
 class Engine
 {
+public:
+	struct Settings
+	{
+		// Run without a window and render with a RenderDeviceRecorder, so
+		// that frames can be benchmarked without a GPU
+		bool headless;
+
+		// Size of the window, or of the render targets when headless
+		int frameWidth;
+		int frameHeight;
+
+		// Write the device commands of this frame to captureFilename, zero
+		// disables capturing. All commands before the frame are recorded too.
+		unsigned int captureFrame;
+		const char* captureFilename;
+
+		// Submit device commands to OpenGL on a separate render thread, so
+		// that the next frame can be updated while the previous one is
+		// submitted. Ignored when headless, and frames can't be captured.
+		bool renderThread;
+
+		// Number of frames the render thread can lag behind, see RenderThread
+		unsigned int renderQueueDepth;
+
+		Settings() :
+			headless(false),
+			frameWidth(1920),
+			frameHeight(1080),
+			captureFrame(0),
+			captureFilename("frame.kcap"),
+			renderThread(false),
+			renderQueueDepth(1)
+		{
+		}
+	};
+
 private:
 	template <typename Type>
 	struct InstanceAllocatorPair
@@ -39,13 +81,19 @@ private:
 		Allocator* allocator;
 	};
 
+	Settings settings;
+
 	AllocatorManager* allocatorManager;
 
 	Allocator* systemAllocator;
 
 	InstanceAllocatorPair<Window> mainWindow;
+	InstanceAllocatorPair<RenderThread> renderThread;
 	Time* time;
 	RenderDevice* renderDevice;
+	RenderDeviceRecorder* renderDeviceRecorder;
+	RenderDeviceStateFilter* renderDeviceStateFilter;
+	InstanceAllocatorPair<JobSystem> jobSystem;
 	InstanceAllocatorPair<Debug> debug;
 	InstanceAllocatorPair<EntityManager> entityManager;
 	InstanceAllocatorPair<MeshManager> meshManager;
@@ -58,16 +106,28 @@ private:
 	InstanceAllocatorPair<ParticleSystem> particleSystem;
 	InstanceAllocatorPair<Renderer> renderer;
 
+	void WriteFrameCapture(size_t frameStart);
 
 public:
-	Engine();
+	explicit Engine(const Settings& settings = Settings());
 	~Engine();
 
 	bool Initialize();
 	void Update();
 
+	const Settings& GetSettings() const { return settings; }
+
 	AllocatorManager* GetAllocatorManager() { return allocatorManager; }
+	// Null when running headless
 	Window* GetMainWindow() { return mainWindow.instance; }
+
+	// Null unless running headless, on a render thread or capturing a frame
+	RenderDeviceRecorder* GetRenderDeviceRecorder() { return renderDeviceRecorder; }
+	RenderDeviceStateFilter* GetRenderDeviceStateFilter() { return renderDeviceStateFilter; }
+
+	// Null unless Settings::renderThread is enabled
+	RenderThread* GetRenderThread() { return renderThread.instance; }
+	JobSystem* GetJobSystem() { return jobSystem.instance; }
 	EntityManager* GetEntityManager() { return entityManager.instance; }
 	LightManager* GetLightManager() { return lightManager.instance; }
 	Renderer* GetRenderer() { return renderer.instance; }
@@ -51,3 +51,33 @@ struct BoundingBox
 		center = minimum + extents;
 	}
 };
+
+/**
+ * Structure-of-arrays view of bounding boxes, used by the SIMD culling kernels.
+ */
+struct BoundingBoxSoA
+{
+	float* centerX;
+	float* centerY;
+	float* centerZ;
+	float* extentX;
+	float* extentY;
+	float* extentZ;
+
+	void Set(unsigned int index, const BoundingBox& box)
+	{
+		centerX[index] = box.center.x;
+		centerY[index] = box.center.y;
+		centerZ[index] = box.center.z;
+		extentX[index] = box.extents.x;
+		extentY[index] = box.extents.y;
+		extentZ[index] = box.extents.z;
+	}
+
+	// Get a view that starts from <index>
+	BoundingBoxSoA Offset(unsigned int index) const
+	{
+		return BoundingBoxSoA{ centerX + index, centerY + index, centerZ + index,
+			extentX + index, extentY + index, extentZ + index };
+	}
+};
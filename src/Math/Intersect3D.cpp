@@ -1,6 +1,7 @@
 #include "Intersect3D.hpp"
 
 #include <cmath>
+#include <immintrin.h>
 
 #include "Core/BitPack.hpp"
 
@@ -47,18 +48,131 @@ void Intersect::FrustumAABB(
 	}
 }
 
+// Project all corners of a box and test the area of their bounding rectangle
+static bool BoxCornersLargeEnough(
+	const Mat4x4f& viewProjection,
+	const Vec3f& center,
+	const Vec3f& extents,
+	const Vec2f& viewportSizePx,
+	float minimumArea)
+{
+	const Vec3f half3(0.5f, 0.5f, 0.0f);
+
+	Vec2f min(1e9f, 1e9f);
+	Vec2f max(-1e9f, -1e9f);
+
+	for (int cornerIdx = 0; cornerIdx < 8; ++cornerIdx)
+	{
+		Vec3f multiplier(
+			static_cast<float>((cornerIdx % 2) * 2 - 1),
+			static_cast<float>(((cornerIdx / 2) % 2) * 2 - 1),
+			static_cast<float>(((cornerIdx / 4) % 2) * 2 - 1));
+
+		Vec3f corner = Vec3f::Hadamard(extents, multiplier);
+
+		Vec4f proj = viewProjection * Vec4f(center + corner, 1.0f);
+		Vec3f scr = proj.xyz() * (1.0f / proj.w) * 0.5f + half3;
+
+		min.x = std::min(scr.x, min.x);
+		min.y = std::min(scr.y, min.y);
+		max.x = std::max(scr.x, max.x);
+		max.y = std::max(scr.y, max.y);
+	}
+
+	float width = (max.x - min.x) * viewportSizePx.x;
+	float height = (max.y - min.y) * viewportSizePx.y;
+
+	return (width * height < minimumArea) == false;
+}
+
+// Size of the range of x / z covered by a sphere, when looking down the z axis.
+// The tangent points are solved exactly, so the sphere must satisfy z > radius.
+static float ProjectedSphereExtent(float x, float z, float radius)
+{
+	float t = std::sqrt(x * x + z * z - radius * radius);
+	float min = (x * t - radius * z) / (z * t + radius * x);
+	float max = (x * t + radius * z) / (z * t - radius * x);
+
+	return max - min;
+}
+
+struct SphereSizeParams
+{
+	const Mat4x4f* view;
+	bool perspective;
+
+	// Multipliers from normalized device coordinate size to pixels
+	float pixelsX;
+	float pixelsY;
+
+	float minimumArea;
+
+	SphereSizeParams(const Mat4x4f& view, const Mat4x4f& projection,
+		const Vec2f& viewportSizePx, float minimumSizePx) :
+		view(&view),
+		perspective(projection[11] != 0.0f),
+		pixelsX(projection[0] * 0.5f * viewportSizePx.x),
+		pixelsY(projection[5] * 0.5f * viewportSizePx.y),
+		minimumArea(minimumSizePx * minimumSizePx)
+	{
+	}
+};
+
+// Test the area of the screen space bounding rectangle of a box's bounding sphere
+static bool BoundingSphereLargeEnough(const SphereSizeParams& p, const Vec3f& center, const Vec3f& extents)
+{
+	const Mat4x4f& view = *p.view;
+	const float radius = std::sqrt(Vec3f::Dot(extents, extents));
+	float width, height;
+
+	if (p.perspective)
+	{
+		const float x = view[0] * center.x + view[4] * center.y + view[8] * center.z + view[12];
+		const float y = view[1] * center.x + view[5] * center.y + view[9] * center.z + view[13];
+		const float z = -(view[2] * center.x + view[6] * center.y + view[10] * center.z + view[14]);
+
+		if (z <= radius) // Sphere is not entirely in front of the camera
+			return true;
+
+		width = ProjectedSphereExtent(x, z, radius) * p.pixelsX;
+		height = ProjectedSphereExtent(y, z, radius) * p.pixelsY;
+	}
+	else
+	{
+		width = 2.0f * radius * p.pixelsX;
+		height = 2.0f * radius * p.pixelsY;
+	}
+
+	return (width * height < p.minimumArea) == false;
+}
+
+static bool AABBOutsideFrustum(const Plane* planes, const Vec3f* planeNormalAbs,
+	const Vec3f& center, const Vec3f& extents)
+{
+	// For each plane in view frustum
+	for (unsigned int planeIdx = 0; planeIdx < 6; ++planeIdx)
+	{
+		const float d = Vec3f::Dot(center, planes[planeIdx].normal);
+		const float r = Vec3f::Dot(extents, planeNormalAbs[planeIdx]);
+
+		if (d + r < -planes[planeIdx].distance)
+			return true;
+	}
+
+	return false;
+}
+
 void Intersect::FrustumAABBMinSize(
 	const FrustumPlanes& frustum,
 	const Mat4x4f& viewProjection,
-	float minimumSize,
+	const Vec2f& viewportSizePx,
+	float minimumSizePx,
 	unsigned int count,
 	const BoundingBox* bounds,
 	BitPack* intersectedOut)
 {
 	const Plane* planes = frustum.planes;
 	Vec3f planeNormalAbs[6];
-	Vec3f boxCornerMultipliers[8];
-	Vec3f half3(0.5f, 0.5f, 0.0f);
 
 	for (int i = 0; i < 6; ++i)
 	{
@@ -67,62 +181,109 @@ void Intersect::FrustumAABBMinSize(
 		planeNormalAbs[i].z = std::abs(planes[i].normal.z);
 	}
 
-	for (int i = 0; i < 8; ++i)
+	const float minimumArea = minimumSizePx * minimumSizePx;
+
+	// For each axis aligned bounding box
+	for (unsigned int boxIdx = 0; boxIdx < count; ++boxIdx)
+	{
+		const Vec3f& center = bounds[boxIdx].center;
+		const Vec3f& extents = bounds[boxIdx].extents;
+
+		bool visible = AABBOutsideFrustum(planes, planeNormalAbs, center, extents) == false &&
+			BoxCornersLargeEnough(viewProjection, center, extents, viewportSizePx, minimumArea);
+
+		BitPack::Set(intersectedOut, boxIdx, visible);
+	}
+}
+
+void Intersect::FrustumAABBMinSphereSize(
+	const FrustumPlanes& frustum,
+	const Mat4x4f& view,
+	const Mat4x4f& projection,
+	const Vec2f& viewportSizePx,
+	float minimumSizePx,
+	unsigned int count,
+	const BoundingBox* bounds,
+	BitPack* intersectedOut)
+{
+	const Plane* planes = frustum.planes;
+	Vec3f planeNormalAbs[6];
+
+	for (int i = 0; i < 6; ++i)
 	{
-		boxCornerMultipliers[i].x = ((i % 2) * 2 - 1);
-		boxCornerMultipliers[i].y = (((i / 2) % 2) * 2 - 1);
-		boxCornerMultipliers[i].z = (((i / 4) % 2) * 2 - 1);
+		planeNormalAbs[i].x = std::abs(planes[i].normal.x);
+		planeNormalAbs[i].y = std::abs(planes[i].normal.y);
+		planeNormalAbs[i].z = std::abs(planes[i].normal.z);
 	}
 
+	const SphereSizeParams sizeParams(view, projection, viewportSizePx, minimumSizePx);
+
 	// For each axis aligned bounding box
 	for (unsigned int boxIdx = 0; boxIdx < count; ++boxIdx)
 	{
-		bool visible = true;
+		const Vec3f& center = bounds[boxIdx].center;
+		const Vec3f& extents = bounds[boxIdx].extents;
 
-		Vec3f center = bounds[boxIdx].center;
-		Vec3f extents = bounds[boxIdx].extents;
+		bool visible = AABBOutsideFrustum(planes, planeNormalAbs, center, extents) == false &&
+			BoundingSphereLargeEnough(sizeParams, center, extents);
 
-		// For each plane in view frustum
-		for (unsigned int planeIdx = 0; planeIdx < 6; ++planeIdx)
-		{
-			const float d = Vec3f::Dot(center, planes[planeIdx].normal);
-			const float r = Vec3f::Dot(extents, planeNormalAbs[planeIdx]);
+		BitPack::Set(intersectedOut, boxIdx, visible);
+	}
+}
 
-			if (d + r < -planes[planeIdx].distance)
-			{
-				visible = false;
-				break;
-			}
-		}
+void Intersect::RejectSmallAABB(
+	const Mat4x4f& viewProjection,
+	const Vec2f& viewportSizePx,
+	float minimumSizePx,
+	unsigned int count,
+	const BoundingBox* bounds,
+	BitPack* visibility)
+{
+	const float minimumArea = minimumSizePx * minimumSizePx;
+
+	for (unsigned int packIdx = 0, packCount = BitPack::CalculateRequired(count); packIdx < packCount; ++packIdx)
+	{
+		if (visibility[packIdx].data == 0)
+			continue;
+
+		unsigned int first = packIdx * BitPack::BitsPerPack;
+		unsigned int end = std::min(first + BitPack::BitsPerPack, count);
 
-		if (visible == true)
+		for (unsigned int boxIdx = first; boxIdx < end; ++boxIdx)
 		{
-			Vec2f min(1e9f, 1e9f);
-			Vec2f max(-1e9f, -1e9f);
+			if (visibility[packIdx].Get(boxIdx - first) &&
+				BoxCornersLargeEnough(viewProjection, bounds[boxIdx].center,
+					bounds[boxIdx].extents, viewportSizePx, minimumArea) == false)
+				visibility[packIdx].Set(boxIdx - first, false);
+		}
+	}
+}
 
-			for (unsigned cornerIdx = 0; cornerIdx < 8; ++cornerIdx)
-			{
-				Vec3f corner = Vec3f::Hadamard(extents, boxCornerMultipliers[cornerIdx]);
-				
-				Vec4f proj = viewProjection * Vec4f(center + corner, 1.0f);
-				Vec3f scr = proj.xyz() * (1.0f / proj.w) * 0.5f + half3;
-
-				min.x = std::min(scr.x, min.x);
-				min.y = std::min(scr.y, min.y);
-				max.x = std::max(scr.x, max.x);
-				max.y = std::max(scr.y, max.y);
-			}
+void Intersect::RejectSmallAABBSphere(
+	const Mat4x4f& view,
+	const Mat4x4f& projection,
+	const Vec2f& viewportSizePx,
+	float minimumSizePx,
+	unsigned int count,
+	const BoundingBox* bounds,
+	BitPack* visibility)
+{
+	const SphereSizeParams sizeParams(view, projection, viewportSizePx, minimumSizePx);
 
-			float width = max.x - min.x;
-			float height = max.y - min.y;
+	for (unsigned int packIdx = 0, packCount = BitPack::CalculateRequired(count); packIdx < packCount; ++packIdx)
+	{
+		if (visibility[packIdx].data == 0)
+			continue;
 
-			if (width * height < minimumSize)
-			{
-				visible = false;
-			}
-		}
+		unsigned int first = packIdx * BitPack::BitsPerPack;
+		unsigned int end = std::min(first + BitPack::BitsPerPack, count);
 
-		BitPack::Set(intersectedOut, boxIdx, visible);
+		for (unsigned int boxIdx = first; boxIdx < end; ++boxIdx)
+		{
+			if (visibility[packIdx].Get(boxIdx - first) &&
+				BoundingSphereLargeEnough(sizeParams, bounds[boxIdx].center, bounds[boxIdx].extents) == false)
+				visibility[packIdx].Set(boxIdx - first, false);
+		}
 	}
 }
 
@@ -160,3 +321,393 @@ void Intersect::FrustumSphere(
 		BitPack::Set(intersectedOut, sphereIdx, inside);
 	}
 }
+
+namespace
+{
+	struct SimdSSE
+	{
+		using Float = __m128;
+		static const unsigned int Width = 4;
+
+		static Float Load(const float* p) { return _mm_loadu_ps(p); }
+		static Float Set(float v) { return _mm_set1_ps(v); }
+		static Float Add(Float a, Float b) { return _mm_add_ps(a, b); }
+		static Float Sub(Float a, Float b) { return _mm_sub_ps(a, b); }
+		static Float Mul(Float a, Float b) { return _mm_mul_ps(a, b); }
+		static Float Div(Float a, Float b) { return _mm_div_ps(a, b); }
+		static Float Sqrt(Float a) { return _mm_sqrt_ps(a); }
+		static Float Min(Float a, Float b) { return _mm_min_ps(a, b); }
+		static Float Max(Float a, Float b) { return _mm_max_ps(a, b); }
+		static Float Or(Float a, Float b) { return _mm_or_ps(a, b); }
+		static Float Less(Float a, Float b) { return _mm_cmplt_ps(a, b); }
+		static Float Zero() { return _mm_setzero_ps(); }
+		static unsigned int Mask(Float a) { return static_cast<unsigned int>(_mm_movemask_ps(a)); }
+	};
+
+#ifdef __AVX2__
+	struct SimdAVX
+	{
+		using Float = __m256;
+		static const unsigned int Width = 8;
+
+		static Float Load(const float* p) { return _mm256_loadu_ps(p); }
+		static Float Set(float v) { return _mm256_set1_ps(v); }
+		static Float Add(Float a, Float b) { return _mm256_add_ps(a, b); }
+		static Float Sub(Float a, Float b) { return _mm256_sub_ps(a, b); }
+		static Float Mul(Float a, Float b) { return _mm256_mul_ps(a, b); }
+		static Float Div(Float a, Float b) { return _mm256_div_ps(a, b); }
+		static Float Sqrt(Float a) { return _mm256_sqrt_ps(a); }
+		static Float Min(Float a, Float b) { return _mm256_min_ps(a, b); }
+		static Float Max(Float a, Float b) { return _mm256_max_ps(a, b); }
+		static Float Or(Float a, Float b) { return _mm256_or_ps(a, b); }
+		static Float Less(Float a, Float b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+		static Float Zero() { return _mm256_setzero_ps(); }
+		static unsigned int Mask(Float a) { return static_cast<unsigned int>(_mm256_movemask_ps(a)); }
+	};
+
+	using Simd = SimdAVX;
+#else
+	using Simd = SimdSSE;
+#endif
+
+	using SimdFloat = Simd::Float;
+
+	const unsigned int MaxStreamCount = 6;
+
+	struct SimdPlanes
+	{
+		SimdFloat normalX[6];
+		SimdFloat normalY[6];
+		SimdFloat normalZ[6];
+		SimdFloat normalAbsX[6];
+		SimdFloat normalAbsY[6];
+		SimdFloat normalAbsZ[6];
+		SimdFloat negDistance[6];
+
+		explicit SimdPlanes(const FrustumPlanes& frustum)
+		{
+			for (unsigned int i = 0; i < 6; ++i)
+			{
+				const Plane& plane = frustum.planes[i];
+
+				normalX[i] = Simd::Set(plane.normal.x);
+				normalY[i] = Simd::Set(plane.normal.y);
+				normalZ[i] = Simd::Set(plane.normal.z);
+				normalAbsX[i] = Simd::Set(std::abs(plane.normal.x));
+				normalAbsY[i] = Simd::Set(std::abs(plane.normal.y));
+				normalAbsZ[i] = Simd::Set(std::abs(plane.normal.z));
+				negDistance[i] = Simd::Set(-plane.distance);
+			}
+		}
+	};
+
+	// Returns a lane mask of the boxes that are outside at least one plane
+	SimdFloat BoxesOutside(const SimdPlanes& p, const float* const* streams, unsigned int index)
+	{
+		const SimdFloat cx = Simd::Load(streams[0] + index);
+		const SimdFloat cy = Simd::Load(streams[1] + index);
+		const SimdFloat cz = Simd::Load(streams[2] + index);
+		const SimdFloat ex = Simd::Load(streams[3] + index);
+		const SimdFloat ey = Simd::Load(streams[4] + index);
+		const SimdFloat ez = Simd::Load(streams[5] + index);
+
+		SimdFloat outside = Simd::Zero();
+
+		for (unsigned int i = 0; i < 6; ++i)
+		{
+			SimdFloat d = Simd::Add(Simd::Add(Simd::Mul(cx, p.normalX[i]),
+				Simd::Mul(cy, p.normalY[i])), Simd::Mul(cz, p.normalZ[i]));
+			SimdFloat r = Simd::Add(Simd::Add(Simd::Mul(ex, p.normalAbsX[i]),
+				Simd::Mul(ey, p.normalAbsY[i])), Simd::Mul(ez, p.normalAbsZ[i]));
+
+			outside = Simd::Or(outside, Simd::Less(Simd::Add(d, r), p.negDistance[i]));
+		}
+
+		return outside;
+	}
+
+	/*
+	* Run <kernel> over [0, count) in groups of Simd::Width and write the
+	* returned lane masks to whole BitPack words. The tail group is run on
+	* zero-padded copies of the input streams.
+	*/
+	template <typename Kernel>
+	void RunSoAKernel(unsigned int count, unsigned int streamCount, const float* const* streams,
+		const Kernel& kernel, BitPack* intersectedOut)
+	{
+		const unsigned int fullCount = count - count % Simd::Width;
+		BitPack::DataType bits = 0;
+
+		for (unsigned int index = 0; index < fullCount; index += Simd::Width)
+		{
+			bits |= kernel(streams, index) << BitPack::CellIndex(index);
+
+			if (BitPack::CellIndex(index + Simd::Width) == 0)
+			{
+				intersectedOut[BitPack::PackIndex(index)].data = bits;
+				bits = 0;
+			}
+		}
+
+		if (fullCount < count)
+		{
+			const unsigned int tailCount = count - fullCount;
+
+			float tail[MaxStreamCount][Simd::Width] = {};
+			const float* tailStreams[MaxStreamCount];
+
+			for (unsigned int s = 0; s < streamCount; ++s)
+			{
+				for (unsigned int i = 0; i < tailCount; ++i)
+					tail[s][i] = streams[s][fullCount + i];
+
+				tailStreams[s] = tail[s];
+			}
+
+			unsigned int laneMask = (1u << tailCount) - 1;
+			bits |= (kernel(tailStreams, 0) & laneMask) << BitPack::CellIndex(fullCount);
+		}
+
+		if (BitPack::CellIndex(count) != 0)
+			intersectedOut[BitPack::PackIndex(count)].data = bits;
+	}
+}
+
+const unsigned int Intersect::SoAWidth = Simd::Width;
+
+void Intersect::FrustumAABBSoA(
+	const FrustumPlanes& frustum,
+	unsigned int count,
+	const BoundingBoxSoA& bounds,
+	BitPack* intersectedOut)
+{
+	const SimdPlanes planes(frustum);
+	const unsigned int allLanes = (1u << Simd::Width) - 1;
+
+	const float* streams[] = {
+		bounds.centerX, bounds.centerY, bounds.centerZ,
+		bounds.extentX, bounds.extentY, bounds.extentZ
+	};
+
+	auto kernel = [&planes, allLanes](const float* const* s, unsigned int index)
+	{
+		return ~Simd::Mask(BoxesOutside(planes, s, index)) & allLanes;
+	};
+
+	RunSoAKernel(count, 6, streams, kernel, intersectedOut);
+}
+
+void Intersect::FrustumAABBMinSizeSoA(
+	const FrustumPlanes& frustum,
+	const Mat4x4f& viewProjection,
+	const Vec2f& viewportSizePx,
+	float minimumSizePx,
+	unsigned int count,
+	const BoundingBoxSoA& bounds,
+	BitPack* intersectedOut)
+{
+	const SimdPlanes planes(frustum);
+	const unsigned int allLanes = (1u << Simd::Width) - 1;
+
+	SimdFloat m[16];
+	for (unsigned int i = 0; i < 16; ++i)
+		m[i] = Simd::Set(viewProjection[i]);
+
+	const SimdFloat one = Simd::Set(1.0f);
+	const SimdFloat half = Simd::Set(0.5f);
+	const SimdFloat viewportWidth = Simd::Set(viewportSizePx.x);
+	const SimdFloat viewportHeight = Simd::Set(viewportSizePx.y);
+	const SimdFloat minimumArea = Simd::Set(minimumSizePx * minimumSizePx);
+
+	const float* streams[] = {
+		bounds.centerX, bounds.centerY, bounds.centerZ,
+		bounds.extentX, bounds.extentY, bounds.extentZ
+	};
+
+	auto kernel = [&](const float* const* s, unsigned int index)
+	{
+		unsigned int visible = ~Simd::Mask(BoxesOutside(planes, s, index)) & allLanes;
+
+		if (visible == 0)
+			return visible;
+
+		const SimdFloat cx = Simd::Load(s[0] + index);
+		const SimdFloat cy = Simd::Load(s[1] + index);
+		const SimdFloat cz = Simd::Load(s[2] + index);
+		const SimdFloat ex = Simd::Load(s[3] + index);
+		const SimdFloat ey = Simd::Load(s[4] + index);
+		const SimdFloat ez = Simd::Load(s[5] + index);
+
+		SimdFloat minX = Simd::Set(1e9f);
+		SimdFloat minY = Simd::Set(1e9f);
+		SimdFloat maxX = Simd::Set(-1e9f);
+		SimdFloat maxY = Simd::Set(-1e9f);
+
+		// Project the box corners in the same order and precision as FrustumAABBMinSize
+		for (int cornerIdx = 0; cornerIdx < 8; ++cornerIdx)
+		{
+			const SimdFloat sx = Simd::Set(static_cast<float>((cornerIdx % 2) * 2 - 1));
+			const SimdFloat sy = Simd::Set(static_cast<float>(((cornerIdx / 2) % 2) * 2 - 1));
+			const SimdFloat sz = Simd::Set(static_cast<float>(((cornerIdx / 4) % 2) * 2 - 1));
+
+			const SimdFloat px = Simd::Add(cx, Simd::Mul(ex, sx));
+			const SimdFloat py = Simd::Add(cy, Simd::Mul(ey, sy));
+			const SimdFloat pz = Simd::Add(cz, Simd::Mul(ez, sz));
+
+			SimdFloat projX = Simd::Add(Simd::Add(Simd::Add(Simd::Mul(m[0], px),
+				Simd::Mul(m[4], py)), Simd::Mul(m[8], pz)), m[12]);
+			SimdFloat projY = Simd::Add(Simd::Add(Simd::Add(Simd::Mul(m[1], px),
+				Simd::Mul(m[5], py)), Simd::Mul(m[9], pz)), m[13]);
+			SimdFloat projW = Simd::Add(Simd::Add(Simd::Add(Simd::Mul(m[3], px),
+				Simd::Mul(m[7], py)), Simd::Mul(m[11], pz)), m[15]);
+
+			SimdFloat invW = Simd::Div(one, projW);
+			SimdFloat scrX = Simd::Add(Simd::Mul(Simd::Mul(projX, invW), half), half);
+			SimdFloat scrY = Simd::Add(Simd::Mul(Simd::Mul(projY, invW), half), half);
+
+			minX = Simd::Min(scrX, minX);
+			minY = Simd::Min(scrY, minY);
+			maxX = Simd::Max(scrX, maxX);
+			maxY = Simd::Max(scrY, maxY);
+		}
+
+		SimdFloat width = Simd::Mul(Simd::Sub(maxX, minX), viewportWidth);
+		SimdFloat height = Simd::Mul(Simd::Sub(maxY, minY), viewportHeight);
+		SimdFloat tooSmall = Simd::Less(Simd::Mul(width, height), minimumArea);
+
+		return visible & ~Simd::Mask(tooSmall);
+	};
+
+	RunSoAKernel(count, 6, streams, kernel, intersectedOut);
+}
+
+void Intersect::FrustumAABBMinSphereSizeSoA(
+	const FrustumPlanes& frustum,
+	const Mat4x4f& view,
+	const Mat4x4f& projection,
+	const Vec2f& viewportSizePx,
+	float minimumSizePx,
+	unsigned int count,
+	const BoundingBoxSoA& bounds,
+	BitPack* intersectedOut)
+{
+	const SimdPlanes planes(frustum);
+	const unsigned int allLanes = (1u << Simd::Width) - 1;
+
+	const bool perspective = projection[11] != 0.0f;
+
+	SimdFloat v[16];
+	for (unsigned int i = 0; i < 16; ++i)
+		v[i] = Simd::Set(view[i]);
+
+	const SimdFloat two = Simd::Set(2.0f);
+	const SimdFloat pixelsX = Simd::Set(projection[0] * 0.5f * viewportSizePx.x);
+	const SimdFloat pixelsY = Simd::Set(projection[5] * 0.5f * viewportSizePx.y);
+	const SimdFloat minimumArea = Simd::Set(minimumSizePx * minimumSizePx);
+
+	const float* streams[] = {
+		bounds.centerX, bounds.centerY, bounds.centerZ,
+		bounds.extentX, bounds.extentY, bounds.extentZ
+	};
+
+	// Same operations as ProjectedSphereExtent
+	auto sphereExtent = [](SimdFloat x, SimdFloat z, SimdFloat radius)
+	{
+		SimdFloat t = Simd::Sqrt(Simd::Sub(Simd::Add(Simd::Mul(x, x), Simd::Mul(z, z)), Simd::Mul(radius, radius)));
+		SimdFloat xt = Simd::Mul(x, t);
+		SimdFloat zt = Simd::Mul(z, t);
+		SimdFloat rz = Simd::Mul(radius, z);
+		SimdFloat rx = Simd::Mul(radius, x);
+		SimdFloat min = Simd::Div(Simd::Sub(xt, rz), Simd::Add(zt, rx));
+		SimdFloat max = Simd::Div(Simd::Add(xt, rz), Simd::Sub(zt, rx));
+
+		return Simd::Sub(max, min);
+	};
+
+	auto kernel = [&](const float* const* s, unsigned int index)
+	{
+		unsigned int visible = ~Simd::Mask(BoxesOutside(planes, s, index)) & allLanes;
+
+		if (visible == 0)
+			return visible;
+
+		const SimdFloat cx = Simd::Load(s[0] + index);
+		const SimdFloat cy = Simd::Load(s[1] + index);
+		const SimdFloat cz = Simd::Load(s[2] + index);
+		const SimdFloat ex = Simd::Load(s[3] + index);
+		const SimdFloat ey = Simd::Load(s[4] + index);
+		const SimdFloat ez = Simd::Load(s[5] + index);
+
+		const SimdFloat radius = Simd::Sqrt(Simd::Add(Simd::Add(Simd::Mul(ex, ex), Simd::Mul(ey, ey)), Simd::Mul(ez, ez)));
+
+		SimdFloat width, height;
+		unsigned int inFront = allLanes;
+
+		if (perspective)
+		{
+			SimdFloat x = Simd::Add(Simd::Add(Simd::Add(Simd::Mul(v[0], cx),
+				Simd::Mul(v[4], cy)), Simd::Mul(v[8], cz)), v[12]);
+			SimdFloat y = Simd::Add(Simd::Add(Simd::Add(Simd::Mul(v[1], cx),
+				Simd::Mul(v[5], cy)), Simd::Mul(v[9], cz)), v[13]);
+			SimdFloat z = Simd::Sub(Simd::Zero(), Simd::Add(Simd::Add(Simd::Add(Simd::Mul(v[2], cx),
+				Simd::Mul(v[6], cy)), Simd::Mul(v[10], cz)), v[14]));
+
+			inFront = Simd::Mask(Simd::Less(radius, z));
+
+			width = Simd::Mul(sphereExtent(x, z, radius), pixelsX);
+			height = Simd::Mul(sphereExtent(y, z, radius), pixelsY);
+		}
+		else
+		{
+			width = Simd::Mul(Simd::Mul(two, radius), pixelsX);
+			height = Simd::Mul(Simd::Mul(two, radius), pixelsY);
+		}
+
+		unsigned int tooSmall = Simd::Mask(Simd::Less(Simd::Mul(width, height), minimumArea));
+
+		return visible & ~(tooSmall & inFront);
+	};
+
+	RunSoAKernel(count, 6, streams, kernel, intersectedOut);
+}
+
+void Intersect::FrustumSphereSoA(
+	const FrustumPlanes& frustum,
+	unsigned int count,
+	const float* positionX,
+	const float* positionY,
+	const float* positionZ,
+	const float* radii,
+	BitPack* intersectedOut)
+{
+	const SimdPlanes planes(frustum);
+	const unsigned int allLanes = (1u << Simd::Width) - 1;
+
+	SimdFloat distance[6];
+	for (unsigned int i = 0; i < 6; ++i)
+		distance[i] = Simd::Set(frustum.planes[i].distance);
+
+	const float* streams[] = { positionX, positionY, positionZ, radii };
+
+	auto kernel = [&](const float* const* s, unsigned int index)
+	{
+		const SimdFloat x = Simd::Load(s[0] + index);
+		const SimdFloat y = Simd::Load(s[1] + index);
+		const SimdFloat z = Simd::Load(s[2] + index);
+		const SimdFloat negRadius = Simd::Sub(Simd::Zero(), Simd::Load(s[3] + index));
+
+		SimdFloat outside = Simd::Zero();
+
+		for (unsigned int i = 0; i < 6; ++i)
+		{
+			SimdFloat side = Simd::Add(Simd::Add(Simd::Add(Simd::Mul(x, planes.normalX[i]),
+				Simd::Mul(y, planes.normalY[i])), Simd::Mul(z, planes.normalZ[i])), distance[i]);
+
+			outside = Simd::Or(outside, Simd::Less(side, negRadius));
+		}
+
+		return ~Simd::Mask(outside) & allLanes;
+	};
+
+	RunSoAKernel(count, 4, streams, kernel, intersectedOut);
+}
@@ -1,8 +1,10 @@
 #pragma once
 
+#include "Math/Vec2.hpp"
 #include "Math/Vec3.hpp"
 
 struct BoundingBox;
+struct BoundingBoxSoA;
 struct Mat4x4f;
 struct FrustumPlanes;
 struct BitPack;
@@ -19,16 +21,61 @@ namespace Intersect
 		BitPack* intersectedOut);
 
 	/*
-	* Calculate visibility for bounding boxes with a minimum size
+	* Calculate visibility for bounding boxes with a minimum size. All 8 box
+	* corners are projected and the screen space bounding rectangle of the box
+	* must have an area of at least <minimumSizePx> squared pixels.
 	*/
 	void FrustumAABBMinSize(
 		const FrustumPlanes& frustum,
 		const Mat4x4f& viewProjection,
-		float minimumSize,
+		const Vec2f& viewportSizePx,
+		float minimumSizePx,
 		unsigned int count,
 		const BoundingBox* bounds,
 		BitPack* intersectedOut);
 
+	/*
+	* Calculate visibility for bounding boxes with a minimum size, estimated
+	* from the exact screen space bounds of each box's bounding sphere. This
+	* never rejects a box that FrustumAABBMinSize would keep. Spheres that are
+	* not entirely in front of the camera are always kept.
+	* Orthographic projection is detected from <projection>.
+	*/
+	void FrustumAABBMinSphereSize(
+		const FrustumPlanes& frustum,
+		const Mat4x4f& view,
+		const Mat4x4f& projection,
+		const Vec2f& viewportSizePx,
+		float minimumSizePx,
+		unsigned int count,
+		const BoundingBox* bounds,
+		BitPack* intersectedOut);
+
+	/*
+	* Clear the visibility of bounding boxes that are too small, estimated like
+	* FrustumAABBMinSize. Only boxes whose bit is set in <visibility> are tested.
+	*/
+	void RejectSmallAABB(
+		const Mat4x4f& viewProjection,
+		const Vec2f& viewportSizePx,
+		float minimumSizePx,
+		unsigned int count,
+		const BoundingBox* bounds,
+		BitPack* visibility);
+
+	/*
+	* Clear the visibility of bounding boxes that are too small, estimated like
+	* FrustumAABBMinSphereSize. Only boxes whose bit is set in <visibility> are tested.
+	*/
+	void RejectSmallAABBSphere(
+		const Mat4x4f& view,
+		const Mat4x4f& projection,
+		const Vec2f& viewportSizePx,
+		float minimumSizePx,
+		unsigned int count,
+		const BoundingBox* bounds,
+		BitPack* visibility);
+
 	/*
 	* Calculate visibility for spheres
 	*/
@@ -38,4 +85,61 @@ namespace Intersect
 		const Vec3f* positions,
 		const float* radii,
 		BitPack* intersectedOut);
+
+	/*
+	* Number of volumes the SoA functions test per iteration: 8 when compiled
+	* with AVX2, otherwise 4 using SSE2.
+	*/
+	extern const unsigned int SoAWidth;
+
+	/*
+	* Calculate visibility for bounding boxes stored as structure-of-arrays.
+	* Whole BitPack words are written; bits past <count> in the last word are cleared.
+	* Results match FrustumAABB.
+	*/
+	void FrustumAABBSoA(
+		const FrustumPlanes& frustum,
+		unsigned int count,
+		const BoundingBoxSoA& bounds,
+		BitPack* intersectedOut);
+
+	/*
+	* Calculate visibility for bounding boxes stored as structure-of-arrays,
+	* with a minimum size. Results match FrustumAABBMinSize.
+	*/
+	void FrustumAABBMinSizeSoA(
+		const FrustumPlanes& frustum,
+		const Mat4x4f& viewProjection,
+		const Vec2f& viewportSizePx,
+		float minimumSizePx,
+		unsigned int count,
+		const BoundingBoxSoA& bounds,
+		BitPack* intersectedOut);
+
+	/*
+	* Calculate visibility for bounding boxes stored as structure-of-arrays,
+	* with a minimum size. Results match FrustumAABBMinSphereSize.
+	*/
+	void FrustumAABBMinSphereSizeSoA(
+		const FrustumPlanes& frustum,
+		const Mat4x4f& view,
+		const Mat4x4f& projection,
+		const Vec2f& viewportSizePx,
+		float minimumSizePx,
+		unsigned int count,
+		const BoundingBoxSoA& bounds,
+		BitPack* intersectedOut);
+
+	/*
+	* Calculate visibility for spheres stored as structure-of-arrays.
+	* Results match FrustumSphere.
+	*/
+	void FrustumSphereSoA(
+		const FrustumPlanes& frustum,
+		unsigned int count,
+		const float* positionX,
+		const float* positionY,
+		const float* positionZ,
+		const float* radii,
+		BitPack* intersectedOut);
 }
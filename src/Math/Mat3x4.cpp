@@ -0,0 +1,131 @@
+#include "Math/Mat3x4.hpp"
+
+#include <immintrin.h>
+
+#define KOKKO_USE_SSE
+
+Mat3x4f operator*(const Mat3x4f& a, const Mat3x4f& b)
+{
+	Mat3x4f result;
+
+#ifdef KOKKO_USE_SSE
+	const __m128 bx = _mm_load_ps(b.m + 0);
+	const __m128 by = _mm_load_ps(b.m + 4);
+	const __m128 bz = _mm_load_ps(b.m + 8);
+
+	// Implicit bottom row of b, only adds the translation of a
+	const __m128 bw = _mm_set_ps(1.0f, 0.0f, 0.0f, 0.0f);
+
+	for (unsigned int row = 0; row < 3; ++row)
+	{
+		const float* aRowPtr = a.m + row * 4;
+
+		__m128 x = _mm_mul_ps(_mm_set_ps1(aRowPtr[0]), bx);
+		__m128 y = _mm_mul_ps(_mm_set_ps1(aRowPtr[1]), by);
+		__m128 z = _mm_mul_ps(_mm_set_ps1(aRowPtr[2]), bz);
+		__m128 w = _mm_mul_ps(_mm_set_ps1(aRowPtr[3]), bw);
+
+		__m128 rxy = _mm_add_ps(x, y);
+		__m128 rzw = _mm_add_ps(z, w);
+		__m128 r = _mm_add_ps(rxy, rzw);
+
+		_mm_store_ps(result.m + row * 4, r);
+	}
+#else
+	for (unsigned int row = 0; row < 3; ++row)
+	{
+		const float* aRow = a.m + row * 4;
+		float* resultRow = result.m + row * 4;
+
+		for (unsigned int col = 0; col < 4; ++col)
+			resultRow[col] = aRow[0] * b.m[col] + aRow[1] * b.m[4 + col] + aRow[2] * b.m[8 + col];
+
+		resultRow[3] += aRow[3];
+	}
+#endif
+
+	return result;
+}
+
+Mat3x4f Mat3x4f::GetAffineInverse() const
+{
+	Mat3x4f result;
+
+#ifdef KOKKO_USE_SSE
+	// Columns of the 3x3 part and the translation, with zero in the w lane
+	__m128 c0 = _mm_load_ps(m + 0);
+	__m128 c1 = _mm_load_ps(m + 4);
+	__m128 c2 = _mm_load_ps(m + 8);
+	__m128 t = _mm_setzero_ps();
+	_MM_TRANSPOSE4_PS(c0, c1, c2, t);
+
+	// Rows of the inverse are the cross products of the columns divided by the determinant
+	const __m128 c0yzx = _mm_shuffle_ps(c0, c0, _MM_SHUFFLE(3, 0, 2, 1));
+	const __m128 c1yzx = _mm_shuffle_ps(c1, c1, _MM_SHUFFLE(3, 0, 2, 1));
+	const __m128 c2yzx = _mm_shuffle_ps(c2, c2, _MM_SHUFFLE(3, 0, 2, 1));
+
+	// Cross product computed in yzx order is shuffled back to xyz
+	__m128 r0 = _mm_sub_ps(_mm_mul_ps(c1, c2yzx), _mm_mul_ps(c1yzx, c2));
+	__m128 r1 = _mm_sub_ps(_mm_mul_ps(c2, c0yzx), _mm_mul_ps(c2yzx, c0));
+	__m128 r2 = _mm_sub_ps(_mm_mul_ps(c0, c1yzx), _mm_mul_ps(c0yzx, c1));
+	r0 = _mm_shuffle_ps(r0, r0, _MM_SHUFFLE(3, 0, 2, 1));
+	r1 = _mm_shuffle_ps(r1, r1, _MM_SHUFFLE(3, 0, 2, 1));
+	r2 = _mm_shuffle_ps(r2, r2, _MM_SHUFFLE(3, 0, 2, 1));
+
+	__m128 det = _mm_mul_ps(c0, r0);
+	det = _mm_add_ps(det, _mm_shuffle_ps(det, det, _MM_SHUFFLE(2, 3, 0, 1)));
+	det = _mm_add_ps(det, _mm_shuffle_ps(det, det, _MM_SHUFFLE(1, 0, 3, 2)));
+	const __m128 inverseDet = _mm_div_ps(_mm_set_ps1(1.0f), det);
+
+	r0 = _mm_mul_ps(r0, inverseDet);
+	r1 = _mm_mul_ps(r1, inverseDet);
+	r2 = _mm_mul_ps(r2, inverseDet);
+
+	// Translation of the inverse is the inverse 3x3 part applied to the negated translation
+	__m128 r3 = _mm_setzero_ps();
+	_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+
+	__m128 x = _mm_mul_ps(r0, _mm_shuffle_ps(t, t, _MM_SHUFFLE(0, 0, 0, 0)));
+	__m128 y = _mm_mul_ps(r1, _mm_shuffle_ps(t, t, _MM_SHUFFLE(1, 1, 1, 1)));
+	__m128 z = _mm_mul_ps(r2, _mm_shuffle_ps(t, t, _MM_SHUFFLE(2, 2, 2, 2)));
+	r3 = _mm_sub_ps(_mm_setzero_ps(), _mm_add_ps(_mm_add_ps(x, y), z));
+
+	_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+
+	_mm_store_ps(result.m + 0, r0);
+	_mm_store_ps(result.m + 4, r1);
+	_mm_store_ps(result.m + 8, r2);
+#else
+	Vec3f c0(m[0], m[4], m[8]);
+	Vec3f c1(m[1], m[5], m[9]);
+	Vec3f c2(m[2], m[6], m[10]);
+	Vec3f t(m[3], m[7], m[11]);
+
+	Vec3f r0 = Vec3f::Cross(c1, c2);
+	Vec3f r1 = Vec3f::Cross(c2, c0);
+	Vec3f r2 = Vec3f::Cross(c0, c1);
+
+	float inverseDet = 1.0f / Vec3f::Dot(c0, r0);
+
+	r0 = r0 * inverseDet;
+	r1 = r1 * inverseDet;
+	r2 = r2 * inverseDet;
+
+	result.m[0] = r0.x;
+	result.m[1] = r0.y;
+	result.m[2] = r0.z;
+	result.m[3] = -Vec3f::Dot(r0, t);
+
+	result.m[4] = r1.x;
+	result.m[5] = r1.y;
+	result.m[6] = r1.z;
+	result.m[7] = -Vec3f::Dot(r1, t);
+
+	result.m[8] = r2.x;
+	result.m[9] = r2.y;
+	result.m[10] = r2.z;
+	result.m[11] = -Vec3f::Dot(r2, t);
+#endif
+
+	return result;
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+#include "Math/Mat3x3.hpp"
+#include "Math/Mat4x4.hpp"
+#include "Math/Vec3.hpp"
+
+/*
+Affine transform stored as the top three rows of a 4x4 matrix, the bottom
+row is implicitly (0, 0, 0, 1). Unlike Mat4x4f, values are stored by rows,
+so element (row, column) is m[row * 4 + column] and each row fits in one
+SIMD register. The translation is the last column.
+*/
+struct alignas(16) Mat3x4f
+{
+	float m[12];
+
+	Mat3x4f():
+	m { 1, 0, 0, 0,
+		0, 1, 0, 0,
+		0, 0, 1, 0 }
+	{
+	}
+
+	explicit Mat3x4f(const Mat4x4f& m4):
+	m { m4[0], m4[4], m4[8], m4[12],
+		m4[1], m4[5], m4[9], m4[13],
+		m4[2], m4[6], m4[10], m4[14] }
+	{
+	}
+
+	Mat3x4f(const Mat3x3f& m3, const Vec3f& translation):
+	m { m3[0], m3[3], m3[6], translation.x,
+		m3[1], m3[4], m3[7], translation.y,
+		m3[2], m3[5], m3[8], translation.z }
+	{
+	}
+
+	float& operator[](std::size_t index) { return m[index]; }
+	const float& operator[](std::size_t index) const { return m[index]; }
+
+	float* ValuePointer() { return m; }
+	const float* ValuePointer() const { return m; }
+
+	Vec3f GetTranslation() const { return Vec3f(m[3], m[7], m[11]); }
+
+	Mat3x3f Get3x3() const
+	{
+		Mat3x3f result;
+
+		result[0] = m[0];
+		result[1] = m[4];
+		result[2] = m[8];
+
+		result[3] = m[1];
+		result[4] = m[5];
+		result[5] = m[9];
+
+		result[6] = m[2];
+		result[7] = m[6];
+		result[8] = m[10];
+
+		return result;
+	}
+
+	Mat4x4f ToMat4x4() const
+	{
+		Mat4x4f result;
+
+		result[0] = m[0];
+		result[1] = m[4];
+		result[2] = m[8];
+		result[3] = 0.0f;
+
+		result[4] = m[1];
+		result[5] = m[5];
+		result[6] = m[9];
+		result[7] = 0.0f;
+
+		result[8] = m[2];
+		result[9] = m[6];
+		result[10] = m[10];
+		result[11] = 0.0f;
+
+		result[12] = m[3];
+		result[13] = m[7];
+		result[14] = m[11];
+		result[15] = 1.0f;
+
+		return result;
+	}
+
+	Vec3f TransformPoint(const Vec3f& p) const
+	{
+		return Vec3f(m[0] * p.x + m[1] * p.y + m[2] * p.z + m[3],
+					 m[4] * p.x + m[5] * p.y + m[6] * p.z + m[7],
+					 m[8] * p.x + m[9] * p.y + m[10] * p.z + m[11]);
+	}
+
+	Vec3f TransformDirection(const Vec3f& d) const
+	{
+		return Vec3f(m[0] * d.x + m[1] * d.y + m[2] * d.z,
+					 m[4] * d.x + m[5] * d.y + m[6] * d.z,
+					 m[8] * d.x + m[9] * d.y + m[10] * d.z);
+	}
+
+	/*
+	Get the inverse of an affine transform, which can have scale and shear.
+	Much cheaper than inverting a general 4x4 matrix.
+	*/
+	Mat3x4f GetAffineInverse() const;
+};
+
+Mat3x4f operator*(const Mat3x4f& a, const Mat3x4f& b);
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <cmath>
+
+#include "Math/Mat3x3.hpp"
+#include "Math/Vec3.hpp"
+
+/*
+Unit quaternion representing a rotation. Rotations compose like matrices:
+(a * b) applies rotation b first, then rotation a.
+*/
+struct Quatf
+{
+	float x, y, z, w;
+
+	Quatf(): x(0.0f), y(0.0f), z(0.0f), w(1.0f) {}
+	Quatf(float x, float y, float z, float w): x(x), y(y), z(z), w(w) {}
+
+	float* ValuePointer() { return &x; }
+	const float* ValuePointer() const { return &x; }
+
+	void Normalize()
+	{
+		float inverseMagnitude = 1.0f / std::sqrt(x * x + y * y + z * z + w * w);
+		x *= inverseMagnitude;
+		y *= inverseMagnitude;
+		z *= inverseMagnitude;
+		w *= inverseMagnitude;
+	}
+
+	Quatf GetNormalized() const
+	{
+		Quatf normalized = *this;
+		normalized.Normalize();
+		return normalized;
+	}
+
+	// Inverse rotation of a unit quaternion
+	Quatf GetConjugate() const
+	{
+		return Quatf(-x, -y, -z, w);
+	}
+
+	Mat3x3f ToMat3x3() const
+	{
+		const float xx = x * x;
+		const float yy = y * y;
+		const float zz = z * z;
+
+		const float xy = x * y;
+		const float xz = x * z;
+		const float yz = y * z;
+
+		const float wx = w * x;
+		const float wy = w * y;
+		const float wz = w * z;
+
+		Mat3x3f result;
+
+		result[0] = 1.0f - 2.0f * (yy + zz);
+		result[1] = 2.0f * (xy + wz);
+		result[2] = 2.0f * (xz - wy);
+
+		result[3] = 2.0f * (xy - wz);
+		result[4] = 1.0f - 2.0f * (xx + zz);
+		result[5] = 2.0f * (yz + wx);
+
+		result[6] = 2.0f * (xz + wy);
+		result[7] = 2.0f * (yz - wx);
+		result[8] = 1.0f - 2.0f * (xx + yy);
+
+		return result;
+	}
+
+	static Quatf RotateAroundAxis(Vec3f axis, float angle)
+	{
+		axis.Normalize();
+
+		const float halfAngle = angle * 0.5f;
+		const float s = std::sin(halfAngle);
+
+		return Quatf(axis.x * s, axis.y * s, axis.z * s, std::cos(halfAngle));
+	}
+
+	// Rotation of an orthonormal matrix without scale
+	static Quatf FromMat3x3(const Mat3x3f& m)
+	{
+		const float trace = m[0] + m[4] + m[8];
+
+		Quatf result;
+
+		if (trace > 0.0f)
+		{
+			float s = 0.5f / std::sqrt(trace + 1.0f);
+			result.w = 0.25f / s;
+			result.x = (m[5] - m[7]) * s;
+			result.y = (m[6] - m[2]) * s;
+			result.z = (m[1] - m[3]) * s;
+		}
+		else if (m[0] > m[4] && m[0] > m[8])
+		{
+			float s = 2.0f * std::sqrt(1.0f + m[0] - m[4] - m[8]);
+			result.w = (m[5] - m[7]) / s;
+			result.x = 0.25f * s;
+			result.y = (m[3] + m[1]) / s;
+			result.z = (m[6] + m[2]) / s;
+		}
+		else if (m[4] > m[8])
+		{
+			float s = 2.0f * std::sqrt(1.0f + m[4] - m[0] - m[8]);
+			result.w = (m[6] - m[2]) / s;
+			result.x = (m[3] + m[1]) / s;
+			result.y = 0.25f * s;
+			result.z = (m[7] + m[5]) / s;
+		}
+		else
+		{
+			float s = 2.0f * std::sqrt(1.0f + m[8] - m[0] - m[4]);
+			result.w = (m[1] - m[3]) / s;
+			result.x = (m[6] + m[2]) / s;
+			result.y = (m[7] + m[5]) / s;
+			result.z = 0.25f * s;
+		}
+
+		return result;
+	}
+
+	// Same rotation as Mat3x3f::RotateEuler
+	static Quatf RotateEuler(const Vec3f& angles)
+	{
+		return FromMat3x3(Mat3x3f::RotateEuler(angles));
+	}
+};
+
+inline Quatf operator*(const Quatf& a, const Quatf& b)
+{
+	return Quatf(a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y,
+				 a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x,
+				 a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w,
+				 a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z);
+}
+
+inline Vec3f operator*(const Quatf& q, const Vec3f& v)
+{
+	// v + 2w(u x v) + 2u x (u x v), where u is the vector part
+	Vec3f u(q.x, q.y, q.z);
+	Vec3f t = 2.0f * Vec3f::Cross(u, v);
+	return v + q.w * t + Vec3f::Cross(u, t);
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "Math/Mat3x4.hpp"
+#include "Math/Quat.hpp"
+#include "Math/Vec3.hpp"
+
+/*
+Transform made of scale, rotation and translation, applied in that order.
+*/
+struct Transformf
+{
+	Vec3f translation;
+	Quatf rotation;
+	Vec3f scale;
+
+	Transformf(): translation(), rotation(), scale(1.0f, 1.0f, 1.0f) {}
+
+	Transformf(const Vec3f& translation, const Quatf& rotation, const Vec3f& scale):
+		translation(translation), rotation(rotation), scale(scale)
+	{
+	}
+
+	static Transformf Translate(const Vec3f& translation)
+	{
+		return Transformf(translation, Quatf(), Vec3f(1.0f, 1.0f, 1.0f));
+	}
+
+	Mat3x4f GetMatrix() const
+	{
+		Mat3x3f r = rotation.ToMat3x3();
+
+		Mat3x4f result;
+
+		result[0] = r[0] * scale.x;
+		result[1] = r[3] * scale.y;
+		result[2] = r[6] * scale.z;
+		result[3] = translation.x;
+
+		result[4] = r[1] * scale.x;
+		result[5] = r[4] * scale.y;
+		result[6] = r[7] * scale.z;
+		result[7] = translation.y;
+
+		result[8] = r[2] * scale.x;
+		result[9] = r[5] * scale.y;
+		result[10] = r[8] * scale.z;
+		result[11] = translation.z;
+
+		return result;
+	}
+};
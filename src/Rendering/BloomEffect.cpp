@@ -5,7 +5,6 @@
 #include "Rendering/PostProcessRenderer.hpp"
 #include "Rendering/PostProcessRenderPass.hpp"
 #include "Rendering/RenderDevice.hpp"
-#include "Rendering/RenderTargetContainer.hpp"
 #include "Rendering/StaticUniformBuffer.hpp"
 
 #include "Resources/ShaderManager.hpp"
@@ -52,7 +51,9 @@ BloomEffect::BloomEffect(
 	postProcessRenderer(postProcessRenderer),
 	shaderManager(shaderManager),
 	blurKernel(allocator),
-	uniformStagingBuffer(nullptr)
+	uniformStagingBuffer(nullptr),
+	renderGraph(nullptr),
+	graphPassCount(0)
 {
 	extractShaderId = ShaderId{ 0 };
 	downsampleShaderId = ShaderId{ 0 };
@@ -136,58 +137,62 @@ void BloomEffect::SetParams(const Params& params)
 	bloomParams = params;
 }
 
-void BloomEffect::Render(unsigned int sourceTexture, unsigned int destinationFramebuffer, const Vec2i& framebufferSize)
+void* BloomEffect::AddGraphPass(RenderGraph* graph, const char* name, ShaderId shaderId, size_t uniformSize,
+	RenderGraphResourceId source, RenderGraphResourceId destination, bool enableBlending)
 {
-	unsigned int passCount = 0;
+	unsigned int passIndex = graphPassCount;
+	graphPassCount += 1;
 
-	RenderTarget renderTargets[8];
-	PostProcessRenderPass renderPasses[16];
+	GraphPass& pass = graphPasses[passIndex];
+	pass.source = source;
+	pass.destination = destination;
+	pass.shaderId = shaderId;
+	pass.uniformSize = static_cast<unsigned int>(uniformSize);
+	pass.enableBlending = enableBlending;
 
-	RenderTarget* currentSource = nullptr;
-	RenderTarget* currentDestination = nullptr;
+	RenderGraphAccess destinationAccess = enableBlending ?
+		RenderGraphAccess::RenderTargetBlend : RenderGraphAccess::RenderTargetWrite;
 
-	unsigned int extractPassSampler = linearSamplerId;
-	unsigned int downsamplePassSampler = linearSamplerId;
-	unsigned int upsamplePassSampler = linearSamplerId;
-	unsigned int applyPassSampler = linearSamplerId;
+	RenderGraphPassId graphPass = graph->AddPass(name, ExecutePass, this, passIndex);
+	graph->AddAccess(graphPass, source, RenderGraphAccess::ShaderRead);
+	graph->AddAccess(graphPass, destination, destinationAccess);
 
-	PostProcessRenderPass pass;
-	pass.textureNameHashes[0] = "source_map"_hash;
-	pass.textureCount = 1;
-	pass.uniformBufferId = uniformBufferId;
-	pass.uniformBindingPoint = UniformBlockBinding::Object;
-	pass.enableBlending = false;
+	return &uniformStagingBuffer[uniformBlockStride * passIndex];
+}
+
+void BloomEffect::AddPasses(RenderGraph* graph, RenderGraphResourceId source, RenderGraphResourceId destination)
+{
+	renderGraph = graph;
+	graphPassCount = 0;
+
+	RenderGraphResourceId targets[MaxIterationCount];
+	Vec2i targetSizes[MaxIterationCount];
+
+	unsigned int iterationCount = bloomParams.iterationCount;
+	if (iterationCount > MaxIterationCount)
+		iterationCount = MaxIterationCount;
+
+	const Vec2i& framebufferSize = graph->GetTextureDesc(source).size;
 
 	// EXTRACT PASS
 
 	Vec2i size(framebufferSize.x / 2, framebufferSize.y / 2);
 
-	RenderTargetContainer* renderTargetContainer = postProcessRenderer->GetRenderTargetContainer();
-	renderTargets[0] = renderTargetContainer->AcquireRenderTarget(size, RenderTextureSizedFormat::RGB16F);
-	currentDestination = &renderTargets[0];
+	targets[0] = graph->CreateTexture("Bloom", RenderGraph::TextureDesc{ size, RenderTextureSizedFormat::RGB16F });
+	targetSizes[0] = size;
 
-	ExtractUniforms* extractBlock = reinterpret_cast<ExtractUniforms*>(&uniformStagingBuffer[uniformBlockStride * passCount]);
+	void* extractUniforms = AddGraphPass(graph, "Bloom extract", extractShaderId,
+		sizeof(ExtractUniforms), source, targets[0], false);
+
+	ExtractUniforms* extractBlock = static_cast<ExtractUniforms*>(extractUniforms);
 	extractBlock->textureScale = Vec2f(1.0f / framebufferSize.x, 1.0f / framebufferSize.y);
 	extractBlock->threshold = bloomParams.bloomThreshold;
 	extractBlock->softThreshold = bloomParams.bloomSoftThreshold;
 
-	pass.textureIds[0] = sourceTexture;
-	pass.samplerIds[0] = extractPassSampler;
-	pass.uniformBufferRangeStart = uniformBlockStride * passCount;
-	pass.uniformBufferRangeSize = sizeof(ExtractUniforms);
-	pass.framebufferId = currentDestination->framebuffer;
-	pass.viewportSize = currentDestination->size;
-	pass.shaderId = extractShaderId;
-
-	renderPasses[passCount] = pass;
-	passCount += 1;
-
-	currentSource = currentDestination;
-
 	// DOWNSAMPLE PASSES
 
-	int rtIdx = 1;
-	for (; rtIdx < bloomParams.iterationCount; ++rtIdx)
+	unsigned int rtIdx = 1;
+	for (; rtIdx < iterationCount; ++rtIdx)
 	{
 		size.x /= 2;
 		size.y /= 2;
@@ -195,94 +200,86 @@ void BloomEffect::Render(unsigned int sourceTexture, unsigned int destinationFra
 		if (size.x < 2 || size.y < 2)
 			break;
 
-		renderTargets[rtIdx] = renderTargetContainer->AcquireRenderTarget(size, RenderTextureSizedFormat::RGB16F);
-		currentDestination = &renderTargets[rtIdx];
-
-		DownsampleUniforms* block = reinterpret_cast<DownsampleUniforms*>(&uniformStagingBuffer[uniformBlockStride * passCount]);
-		block->textureScale = Vec2f(1.0f / currentSource->size.x, 1.0f / currentSource->size.y);
+		targets[rtIdx] = graph->CreateTexture("Bloom", RenderGraph::TextureDesc{ size, RenderTextureSizedFormat::RGB16F });
+		targetSizes[rtIdx] = size;
 
-		pass.textureIds[0] = currentSource->colorTexture;
-		pass.samplerIds[0] = downsamplePassSampler;
-		pass.uniformBufferRangeStart = uniformBlockStride * passCount;
-		pass.uniformBufferRangeSize = sizeof(DownsampleUniforms);
-		pass.framebufferId = currentDestination->framebuffer;
-		pass.viewportSize = currentDestination->size;
-		pass.shaderId = downsampleShaderId;
+		void* uniforms = AddGraphPass(graph, "Bloom downsample", downsampleShaderId,
+			sizeof(DownsampleUniforms), targets[rtIdx - 1], targets[rtIdx], false);
 
-		renderPasses[passCount] = pass;
-		passCount += 1;
-
-		currentSource = currentDestination;
+		const Vec2i& sourceSize = targetSizes[rtIdx - 1];
+		DownsampleUniforms* block = static_cast<DownsampleUniforms*>(uniforms);
+		block->textureScale = Vec2f(1.0f / sourceSize.x, 1.0f / sourceSize.y);
 	}
 
 	// UPSAMPLE PASSES
 
-	pass.enableBlending = true;
-	pass.sourceBlendFactor = RenderBlendFactor::One;
-	pass.destinationBlendFactor = RenderBlendFactor::One;
+	unsigned int sourceIdx = rtIdx - 1;
 
-	for (rtIdx -= 2; rtIdx >= 0; rtIdx--)
+	for (; sourceIdx > 0; --sourceIdx)
 	{
-		UpsampleUniforms* block = reinterpret_cast<UpsampleUniforms*>(&uniformStagingBuffer[uniformBlockStride * passCount]);
+		void* uniforms = AddGraphPass(graph, "Bloom upsample", upsampleShaderId,
+			sizeof(UpsampleUniforms), targets[sourceIdx], targets[sourceIdx - 1], true);
+
+		UpsampleUniforms* block = static_cast<UpsampleUniforms*>(uniforms);
 
 		for (size_t i = 0; i < MaxKernelSize; ++i)
 			block->kernel[i] = blurKernel[i];
 
-		block->textureScale = Vec2f(1.0f / currentSource->size.x, 1.0f / currentSource->size.y);
+		const Vec2i& sourceSize = targetSizes[sourceIdx];
+		block->textureScale = Vec2f(1.0f / sourceSize.x, 1.0f / sourceSize.y);
 		block->kernelExtent = KernelExtent;
-
-		currentDestination = &renderTargets[rtIdx];
-
-		pass.textureIds[0] = currentSource->colorTexture;
-		pass.samplerIds[0] = upsamplePassSampler;
-		pass.uniformBufferRangeStart = uniformBlockStride * passCount;
-		pass.uniformBufferRangeSize = sizeof(UpsampleUniforms);
-		pass.framebufferId = currentDestination->framebuffer;
-		pass.viewportSize = currentDestination->size;
-		pass.shaderId = upsampleShaderId;
-
-		renderPasses[passCount] = pass;
-		passCount += 1;
-
-		currentSource = currentDestination;
 	}
 
 	// APPLY PASS
 
-	ApplyUniforms* applyBlock = reinterpret_cast<ApplyUniforms*>(&uniformStagingBuffer[uniformBlockStride * passCount]);
+	void* applyUniforms = AddGraphPass(graph, "Bloom apply", applyShaderId,
+		sizeof(ApplyUniforms), targets[0], destination, true);
+
+	ApplyUniforms* applyBlock = static_cast<ApplyUniforms*>(applyUniforms);
 	for (size_t i = 0; i < MaxKernelSize; ++i)
 		applyBlock->kernel[i] = blurKernel[i];
 
-	applyBlock->textureScale = Vec2f(1.0f / currentSource->size.x, 1.0f / currentSource->size.y);
+	applyBlock->textureScale = Vec2f(1.0f / targetSizes[0].x, 1.0f / targetSizes[0].y);
 	applyBlock->kernelExtent = KernelExtent;
 	applyBlock->intensity = bloomParams.bloomIntensity;
-	
-	pass.textureIds[0] = currentSource->colorTexture;
-	pass.samplerIds[0] = applyPassSampler;
-	pass.uniformBufferRangeStart = uniformBlockStride * passCount;
-	pass.uniformBufferRangeSize = sizeof(ApplyUniforms);
-	pass.framebufferId = destinationFramebuffer;
-	pass.viewportSize = framebufferSize;
-	pass.shaderId = applyShaderId;
+}
 
-	renderPasses[passCount] = pass;
-	passCount += 1;
+void BloomEffect::ExecutePass(void* userData, unsigned int passIndex)
+{
+	static_cast<BloomEffect*>(userData)->RenderPass(passIndex);
+}
 
-	// Update uniform buffer
+void BloomEffect::RenderPass(unsigned int passIndex)
+{
+	// Every other pass depends on the extract pass, so it's executed first
+	if (passIndex == 0)
+	{
+		renderDevice->BindBuffer(RenderBufferTarget::UniformBuffer, uniformBufferId);
+		renderDevice->SetBufferSubData(RenderBufferTarget::UniformBuffer, 0,
+			uniformBlockStride * graphPassCount, uniformStagingBuffer);
+	}
 
-	renderDevice->BindBuffer(RenderBufferTarget::UniformBuffer, uniformBufferId);
-	renderDevice->SetBufferSubData(RenderBufferTarget::UniformBuffer, 0, uniformBlockStride * passCount, uniformStagingBuffer);
+	const GraphPass& graphPass = graphPasses[passIndex];
 
-	// Render passes
+	PostProcessRenderPass pass;
+	pass.textureNameHashes[0] = "source_map"_hash;
+	pass.textureIds[0] = renderGraph->GetTexture(graphPass.source);
+	pass.samplerIds[0] = linearSamplerId;
+	pass.textureCount = 1;
+	pass.uniformBufferId = uniformBufferId;
+	pass.uniformBindingPoint = UniformBlockBinding::Object;
+	pass.uniformBufferRangeStart = uniformBlockStride * passIndex;
+	pass.uniformBufferRangeSize = graphPass.uniformSize;
+	pass.framebufferId = renderGraph->GetFramebuffer(graphPass.destination);
+	pass.viewportSize = renderGraph->GetTextureDesc(graphPass.destination).size;
+	pass.shaderId = graphPass.shaderId;
+	pass.enableBlending = graphPass.enableBlending;
+	pass.sourceBlendFactor = RenderBlendFactor::One;
+	pass.destinationBlendFactor = RenderBlendFactor::One;
 
 	renderDevice->DepthTestDisable();
 
-	postProcessRenderer->RenderPasses(passCount, renderPasses);
-
-	// Release render targets
-
-	for (unsigned int i = 0; i < bloomParams.iterationCount; ++i)
-		renderTargetContainer->ReleaseRenderTarget(renderTargets[i].id);
+	postProcessRenderer->RenderPass(pass);
 }
 
 void BloomEffect::CreateKernel(int kernelExtent)
@@ -4,12 +4,13 @@
 
 #include "Math/Vec2.hpp"
 
+#include "Rendering/RenderGraph.hpp"
+
 #include "Resources/ShaderId.hpp"
 
 class Allocator;
 class RenderDevice;
 class PostProcessRenderer;
-class RenderTargetContainer;
 class ShaderManager;
 
 class BloomEffect
@@ -24,6 +25,18 @@ public:
 	};
 
 private:
+	static const unsigned int MaxIterationCount = 8;
+	static const unsigned int MaxPassCount = 2 * MaxIterationCount;
+
+	struct GraphPass
+	{
+		RenderGraphResourceId source;
+		RenderGraphResourceId destination;
+		ShaderId shaderId;
+		unsigned int uniformSize;
+		bool enableBlending;
+	};
+
 	Allocator* allocator;
 	RenderDevice* renderDevice;
 	ShaderManager* shaderManager;
@@ -45,8 +58,20 @@ private:
 
 	Params bloomParams;
 
+	// Graph the passes were last added to, and the passes
+	const RenderGraph* renderGraph;
+	GraphPass graphPasses[MaxPassCount];
+	unsigned int graphPassCount;
+
 	void CreateKernel(int kernelExtent);
 
+	// Returns a pointer to the uniform block of the pass in the staging buffer
+	void* AddGraphPass(RenderGraph* graph, const char* name, ShaderId shaderId, size_t uniformSize,
+		RenderGraphResourceId source, RenderGraphResourceId destination, bool enableBlending);
+
+	static void ExecutePass(void* userData, unsigned int passIndex);
+	void RenderPass(unsigned int passIndex);
+
 public:
 	BloomEffect(
 		Allocator* allocator,
@@ -60,8 +85,11 @@ public:
 	void Deinitialize();
 
 	void SetParams(const Params& params);
-	void Render(
-		unsigned int sourceTexture,
-		unsigned int destinationFramebuffer,
-		const Vec2i& framebufferSize);
+
+	/**
+	 * Add the bloom passes to <graph>. The bloom of <source> is blended into
+	 * <destination>, which can be the same texture. The passes are executed
+	 * with the graph, which has to stay alive until then.
+	 */
+	void AddPasses(RenderGraph* graph, RenderGraphResourceId source, RenderGraphResourceId destination);
 };
@@ -0,0 +1,104 @@
+#include "Rendering/DrawBatchBuilder.hpp"
+
+#include "Rendering/RenderDevice.hpp"
+
+static bool CanInstance(const DrawBatchBuilder::Draw& a, const DrawBatchBuilder::Draw& b)
+{
+	return a.type == b.type && a.viewport == b.viewport && a.pass == b.pass &&
+		a.material == b.material && a.mesh == b.mesh;
+}
+
+static bool CanDrawIndirect(const DrawBatchBuilder::Draw& a, const DrawBatchBuilder::Draw& b)
+{
+	return a.type == b.type && a.viewport == b.viewport && a.pass == b.pass &&
+		a.material == b.material && a.vertexArray == b.vertexArray &&
+		a.primitiveMode == b.primitiveMode && a.indexType == b.indexType;
+}
+
+DrawBatchBuilder::DrawBatchBuilder(Allocator* allocator) :
+	batches(allocator),
+	indirectCommands(allocator)
+{
+}
+
+void DrawBatchBuilder::AddBatch(DrawBatchType type, unsigned int firstDraw, unsigned int drawCount)
+{
+	Batch batch;
+	batch.type = type;
+	batch.firstDraw = firstDraw;
+	batch.drawCount = drawCount;
+	batch.firstIndirectCommand = indirectCommands.GetCount();
+	batches.PushBack(batch);
+}
+
+void DrawBatchBuilder::Build(const Params& params, unsigned int drawCount, const Draw* draws)
+{
+	batches.Clear();
+	indirectCommands.Clear();
+
+	unsigned int drawIdx = 0;
+	while (drawIdx < drawCount)
+	{
+		const Draw& first = draws[drawIdx];
+		unsigned int runLength = 1;
+
+		if (first.type == DrawBatchType::Instanced)
+		{
+			while (drawIdx + runLength < drawCount && CanInstance(first, draws[drawIdx + runLength]))
+				runLength += 1;
+
+			if (runLength >= params.instancingThreshold)
+			{
+				AddBatch(DrawBatchType::Instanced, drawIdx, runLength);
+			}
+			else
+			{
+				for (unsigned int i = 0; i < runLength; ++i)
+					AddBatch(DrawBatchType::Single, drawIdx + i, 1);
+			}
+		}
+		else if (first.type == DrawBatchType::Indirect)
+		{
+			while (drawIdx + runLength < drawCount && CanDrawIndirect(first, draws[drawIdx + runLength]))
+				runLength += 1;
+
+			AddBatch(DrawBatchType::Indirect, drawIdx, runLength);
+
+			// One command per object, the base instance locates the object's draw
+			for (unsigned int i = 0; i < runLength; ++i)
+			{
+				RenderCommandData::DrawIndexedIndirectCommand command;
+				command.count = static_cast<unsigned int>(draws[drawIdx + i].indexCount);
+				command.instanceCount = 1;
+				command.firstIndex = 0;
+				command.baseVertex = 0;
+				command.baseInstance = drawIdx + i;
+				indirectCommands.PushBack(command);
+			}
+		}
+		else
+		{
+			AddBatch(DrawBatchType::Single, drawIdx, 1);
+		}
+
+		drawIdx += runLength;
+	}
+}
+
+void DrawBatchBuilder::DrawBatch(RenderDevice* device, const Batch& batch, const Draw& firstDraw, intptr_t indirectOffset)
+{
+	if (batch.type == DrawBatchType::Indirect)
+	{
+		using IndirectCommand = RenderCommandData::DrawIndexedIndirectCommand;
+		intptr_t offset = indirectOffset + batch.firstIndirectCommand * sizeof(IndirectCommand);
+
+		device->MultiDrawIndexedIndirect(firstDraw.primitiveMode, firstDraw.indexType,
+			offset, batch.drawCount, sizeof(IndirectCommand));
+	}
+	else
+	{
+		// Base instance is the index of the first object draw of the batch
+		device->DrawIndexedInstancedBaseInstance(firstDraw.primitiveMode, firstDraw.indexCount,
+			firstDraw.indexType, batch.drawCount, batch.firstDraw);
+	}
+}
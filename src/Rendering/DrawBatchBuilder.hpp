@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstdint>
+
+#include "Core/Array.hpp"
+
+#include "Rendering/RenderCommandData.hpp"
+#include "Rendering/RenderDeviceEnums.hpp"
+
+class Allocator;
+class RenderDevice;
+
+enum class DrawBatchType
+{
+	// One object per draw call
+	Single,
+
+	// Objects with the same mesh in one instanced draw call
+	Instanced,
+
+	// Objects with the same vertex array in one multi-draw indirect call
+	Indirect
+};
+
+/**
+ * Groups the object draws of a sorted command list into draw calls.
+ *
+ * Only consecutive draws are combined, so the sort order of the command list
+ * is preserved. Every batch covers a range of the draws, which shaders find
+ * from the base instance of the draw call. Building the batches has no
+ * dependency on the render device.
+ */
+class DrawBatchBuilder
+{
+public:
+	struct Draw
+	{
+		unsigned int viewport;
+		unsigned int pass;
+		unsigned int material;
+		unsigned int mesh;
+
+		unsigned int vertexArray;
+		int indexCount;
+		RenderPrimitiveMode primitiveMode;
+		RenderIndexType indexType;
+
+		// How the draw's material allows it to be batched
+		DrawBatchType type;
+	};
+
+	struct Batch
+	{
+		DrawBatchType type;
+
+		// Range of consecutive draws in the batch
+		unsigned int firstDraw;
+		unsigned int drawCount;
+
+		// Index of the first indirect command, if type is Indirect
+		unsigned int firstIndirectCommand;
+	};
+
+	struct Params
+	{
+		// Runs of instanced draws shorter than this are drawn one at a time
+		unsigned int instancingThreshold;
+	};
+
+private:
+	Array<Batch> batches;
+	Array<RenderCommandData::DrawIndexedIndirectCommand> indirectCommands;
+
+	void AddBatch(DrawBatchType type, unsigned int firstDraw, unsigned int drawCount);
+
+public:
+	explicit DrawBatchBuilder(Allocator* allocator);
+
+	void Build(const Params& params, unsigned int drawCount, const Draw* draws);
+
+	const Array<Batch>& GetBatches() const { return batches; }
+
+	const Array<RenderCommandData::DrawIndexedIndirectCommand>& GetIndirectCommands() const
+	{
+		return indirectCommands;
+	}
+
+	/**
+	 * Issue the draw call of <batch>. <firstDraw> is the batch's first draw and
+	 * <indirectOffset> is the offset of the first indirect command in the bound
+	 * indirect buffer. The vertex array of the draw must already be bound.
+	 */
+	static void DrawBatch(RenderDevice* device, const Batch& batch, const Draw& firstDraw, intptr_t indirectOffset);
+};
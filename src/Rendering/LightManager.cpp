@@ -73,20 +73,18 @@ float LightManager::CalculateDefaultRadius(Vec3f color)
 	return std::sqrt(lightMax * thresholdInv);
 }
 
-void LightManager::NotifyUpdatedTransforms(unsigned int count, const Entity* entities, const Mat4x4f* transforms)
+void LightManager::NotifyUpdatedTransforms(unsigned int count, const unsigned int* componentIndices,
+	const Mat4x4f* transforms)
 {
 	Vec4f origin(0.0f, 0.0f, 0.0f, 1.0f);
 	
-	for (unsigned int entityIdx = 0; entityIdx < count; ++entityIdx)
+	for (unsigned int updateIdx = 0; updateIdx < count; ++updateIdx)
 	{
-		LightId id = this->Lookup(entities[entityIdx]);
-
-		if (id.IsNull() == false)
-		{
-			const Mat4x4f& t = transforms[entityIdx];
-			data.position[id.i] = (t * origin).xyz();
-			data.orientation[id.i] = t.Get3x3();
-		}
+		unsigned int id = componentIndices[updateIdx];
+
+		const Mat4x4f& t = transforms[updateIdx];
+		data.position[id] = (t * origin).xyz();
+		data.orientation[id] = t.Get3x3();
 	}
 }
 
@@ -49,7 +49,8 @@ public:
 	LightManager(Allocator* allocator);
 	~LightManager();
 
-	virtual void NotifyUpdatedTransforms(unsigned int count, const Entity* entities, const Mat4x4f* transforms);
+	virtual void NotifyUpdatedTransforms(unsigned int count, const unsigned int* componentIndices,
+		const Mat4x4f* transforms);
 
 	LightId Lookup(Entity e)
 	{
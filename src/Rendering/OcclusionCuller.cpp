@@ -0,0 +1,306 @@
+#include "Rendering/OcclusionCuller.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <immintrin.h>
+
+#include "Math/BoundingBox.hpp"
+#include "Memory/Allocator.hpp"
+
+// Vertices closer to the camera plane than this are not projected
+static const float MinimumW = 1e-3f;
+
+// Relative depth margin required for an object to be occluded, so that
+// objects touching an occluder's surface stay visible
+static const float OccludedDepthBias = 1e-3f;
+
+// Faces are rasterized as quads, because the shared edge of two triangles
+// would leave a crack where neither covers a whole pixel
+static const unsigned int CubeFaceIndices[24] = {
+	0, 1, 3, 2, // -X
+	4, 6, 7, 5, // +X
+	0, 4, 5, 1, // -Y
+	2, 3, 7, 6, // +Y
+	0, 2, 6, 4, // -Z
+	1, 5, 7, 3  // +Z
+};
+
+OcclusionCuller::OcclusionCuller(Allocator* allocator, unsigned int width, unsigned int height) :
+	allocator(allocator),
+	width(width),
+	height(height),
+	tilesX((width + TileSize - 1) / TileSize),
+	tilesY((height + TileSize - 1) / TileSize),
+	enabled(false),
+	occluderBudget(32),
+	stats(Stats{}),
+	occluderTransforms(allocator)
+{
+	depthBuffer = static_cast<float*>(allocator->Allocate(sizeof(float) * width * height));
+	tileMinDepth = static_cast<float*>(allocator->Allocate(sizeof(float) * tilesX * tilesY));
+}
+
+OcclusionCuller::~OcclusionCuller()
+{
+	allocator->Deallocate(tileMinDepth);
+	allocator->Deallocate(depthBuffer);
+}
+
+void OcclusionCuller::BeginFrame(const Mat4x4f& viewProjection)
+{
+	this->viewProjection = viewProjection;
+
+	std::memset(depthBuffer, 0, sizeof(float) * width * height);
+
+	stats = Stats{};
+	occluderTransforms.Clear();
+}
+
+void OcclusionCuller::RasterizeOccluder(const Mat4x4f& boxToWorld)
+{
+	const Mat4x4f boxToClip = viewProjection * boxToWorld;
+
+	// Screen space x, y and 1 / w of each corner
+	float vertices[8][3];
+
+	for (unsigned int i = 0; i < 8; ++i)
+	{
+		Vec4f corner((i & 4) ? 0.5f : -0.5f, (i & 2) ? 0.5f : -0.5f, (i & 1) ? 0.5f : -0.5f, 1.0f);
+		Vec4f clip = boxToClip * corner;
+
+		if (clip.w < MinimumW)
+			return;
+
+		float invW = 1.0f / clip.w;
+		vertices[i][0] = (clip.x * invW * 0.5f + 0.5f) * width;
+		vertices[i][1] = (clip.y * invW * 0.5f + 0.5f) * height;
+		vertices[i][2] = invW;
+	}
+
+	for (unsigned int i = 0; i < 24; i += 4)
+	{
+		RasterizeQuad(
+			vertices[CubeFaceIndices[i + 0]],
+			vertices[CubeFaceIndices[i + 1]],
+			vertices[CubeFaceIndices[i + 2]],
+			vertices[CubeFaceIndices[i + 3]]);
+	}
+
+	occluderTransforms.PushBack(boxToWorld);
+	stats.occludersRasterized += 1;
+}
+
+static float SignedArea(const float* v0, const float* v1, const float* v2)
+{
+	return (v1[0] - v0[0]) * (v2[1] - v0[1]) - (v1[1] - v0[1]) * (v2[0] - v0[0]);
+}
+
+void OcclusionCuller::RasterizeQuad(const float* v0, const float* v1, const float* v2, const float* v3)
+{
+	// The quad is a projected box face, so it's convex and planar
+	float area = SignedArea(v0, v1, v2) + SignedArea(v0, v2, v3);
+
+	if (std::abs(area) < 1e-6f)
+		return;
+
+	// Both windings are rasterized, make the vertex order counter-clockwise
+	if (area < 0.0f)
+		std::swap(v1, v3);
+
+	const float* verts[4] = { v0, v1, v2, v3 };
+
+	float minX = std::min(std::min(v0[0], v1[0]), std::min(v2[0], v3[0]));
+	float maxX = std::max(std::max(v0[0], v1[0]), std::max(v2[0], v3[0]));
+	float minY = std::min(std::min(v0[1], v1[1]), std::min(v2[1], v3[1]));
+	float maxY = std::max(std::max(v0[1], v1[1]), std::max(v2[1], v3[1]));
+
+	// Clamp before converting to integers to avoid overflow
+	const float lastX = static_cast<float>(width - 1);
+	const float lastY = static_cast<float>(height - 1);
+
+	int x0 = static_cast<int>(std::floor(std::max(minX, 0.0f))) & ~3;
+	int x1 = static_cast<int>(std::ceil(std::min(maxX, lastX)));
+	int y0 = static_cast<int>(std::floor(std::max(minY, 0.0f)));
+	int y1 = static_cast<int>(std::ceil(std::min(maxY, lastY)));
+
+	if (x0 > x1 || y0 > y1)
+		return;
+
+	// Edge functions E(x, y) = A * x + B * y + C, positive inside the quad.
+	// C is moved inwards so that E at a pixel center is only positive when the
+	// whole pixel is inside the edge.
+	__m128 edgeA[4];
+	float edgeB[4];
+	float edgeC[4];
+
+	for (unsigned int i = 0; i < 4; ++i)
+	{
+		const float* a = verts[i];
+		const float* b = verts[(i + 1) % 4];
+
+		float A = a[1] - b[1];
+		float B = b[0] - a[0];
+		float C = -A * a[0] - B * a[1];
+
+		edgeA[i] = _mm_set1_ps(A);
+		edgeB[i] = B;
+		edgeC[i] = C - 0.5f * (std::abs(A) + std::abs(B));
+	}
+
+	// Any three corners define the depth plane, use the larger half of the
+	// quad so that a short edge doesn't make the plane unstable. Both halves
+	// are counter-clockwise now.
+	const float* p0 = v0;
+	const float* p1 = v1;
+	const float* p2 = v2;
+	float planeArea = SignedArea(v0, v1, v2);
+
+	if (SignedArea(v0, v2, v3) > planeArea)
+	{
+		p1 = v2;
+		p2 = v3;
+		planeArea = SignedArea(v0, v2, v3);
+	}
+
+	// Depth plane d(x, y) = a * x + b * y + c, moved back to the farthest
+	// value within the pixel
+	float d10 = p1[2] - p0[2];
+	float d20 = p2[2] - p0[2];
+	float planeA = (d10 * (p2[1] - p0[1]) - d20 * (p1[1] - p0[1])) / planeArea;
+	float planeB = (d20 * (p1[0] - p0[0]) - d10 * (p2[0] - p0[0])) / planeArea;
+	float planeC = p0[2] - planeA * p0[0] - planeB * p0[1] - 0.5f * (std::abs(planeA) + std::abs(planeB));
+
+	const __m128 depthA = _mm_set1_ps(planeA);
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 laneOffsets = _mm_set_ps(3.5f, 2.5f, 1.5f, 0.5f);
+
+	for (int y = y0; y <= y1; ++y)
+	{
+		float py = y + 0.5f;
+
+		__m128 rowE0 = _mm_set1_ps(edgeB[0] * py + edgeC[0]);
+		__m128 rowE1 = _mm_set1_ps(edgeB[1] * py + edgeC[1]);
+		__m128 rowE2 = _mm_set1_ps(edgeB[2] * py + edgeC[2]);
+		__m128 rowE3 = _mm_set1_ps(edgeB[3] * py + edgeC[3]);
+		__m128 rowDepth = _mm_set1_ps(planeB * py + planeC);
+
+		float* row = depthBuffer + y * width;
+
+		for (int x = x0; x <= x1; x += 4)
+		{
+			__m128 px = _mm_add_ps(_mm_set1_ps(static_cast<float>(x)), laneOffsets);
+
+			__m128 e0 = _mm_add_ps(_mm_mul_ps(edgeA[0], px), rowE0);
+			__m128 e1 = _mm_add_ps(_mm_mul_ps(edgeA[1], px), rowE1);
+			__m128 e2 = _mm_add_ps(_mm_mul_ps(edgeA[2], px), rowE2);
+			__m128 e3 = _mm_add_ps(_mm_mul_ps(edgeA[3], px), rowE3);
+
+			__m128 inside = _mm_and_ps(
+				_mm_and_ps(_mm_cmpge_ps(e0, zero), _mm_cmpge_ps(e1, zero)),
+				_mm_and_ps(_mm_cmpge_ps(e2, zero), _mm_cmpge_ps(e3, zero)));
+
+			if (_mm_movemask_ps(inside) == 0)
+				continue;
+
+			__m128 depth = _mm_add_ps(_mm_mul_ps(depthA, px), rowDepth);
+
+			// Pixels outside the quad get 0, which never replaces a stored depth
+			__m128 stored = _mm_loadu_ps(row + x);
+			_mm_storeu_ps(row + x, _mm_max_ps(stored, _mm_and_ps(inside, depth)));
+		}
+	}
+
+	stats.facesRasterized += 1;
+}
+
+void OcclusionCuller::EndOccluders()
+{
+	for (unsigned int ty = 0; ty < tilesY; ++ty)
+	{
+		for (unsigned int tx = 0; tx < tilesX; ++tx)
+		{
+			unsigned int xEnd = std::min((tx + 1) * TileSize, width);
+			unsigned int yEnd = std::min((ty + 1) * TileSize, height);
+
+			float minDepth = depthBuffer[ty * TileSize * width + tx * TileSize];
+
+			for (unsigned int y = ty * TileSize; y < yEnd; ++y)
+				for (unsigned int x = tx * TileSize; x < xEnd; ++x)
+					minDepth = std::min(minDepth, depthBuffer[y * width + x]);
+
+			tileMinDepth[ty * tilesX + tx] = minDepth;
+		}
+	}
+}
+
+bool OcclusionCuller::IsOccluded(const BoundingBox& bounds)
+{
+	stats.objectsTested += 1;
+
+	if (occluderTransforms.GetCount() == 0)
+		return false;
+
+	float minX = 1e9f, minY = 1e9f;
+	float maxX = -1e9f, maxY = -1e9f;
+	float nearestDepth = 0.0f;
+
+	for (unsigned int i = 0; i < 8; ++i)
+	{
+		Vec3f corner(
+			bounds.center.x + ((i & 4) ? bounds.extents.x : -bounds.extents.x),
+			bounds.center.y + ((i & 2) ? bounds.extents.y : -bounds.extents.y),
+			bounds.center.z + ((i & 1) ? bounds.extents.z : -bounds.extents.z));
+
+		Vec4f clip = viewProjection * Vec4f(corner, 1.0f);
+
+		// The box reaches the camera, it can't be occluded
+		if (clip.w < MinimumW)
+			return false;
+
+		float invW = 1.0f / clip.w;
+		float x = (clip.x * invW * 0.5f + 0.5f) * width;
+		float y = (clip.y * invW * 0.5f + 0.5f) * height;
+
+		minX = std::min(minX, x);
+		maxX = std::max(maxX, x);
+		minY = std::min(minY, y);
+		maxY = std::max(maxY, y);
+		nearestDepth = std::max(nearestDepth, invW);
+	}
+
+	// Pixels that the screen space rectangle touches
+	int x0 = static_cast<int>(std::floor(std::max(minX, 0.0f)));
+	int x1 = static_cast<int>(std::ceil(std::min(maxX, static_cast<float>(width)))) - 1;
+	int y0 = static_cast<int>(std::floor(std::max(minY, 0.0f)));
+	int y1 = static_cast<int>(std::ceil(std::min(maxY, static_cast<float>(height)))) - 1;
+
+	if (x0 > x1 || y0 > y1)
+		return false;
+
+	nearestDepth *= 1.0f + OccludedDepthBias;
+
+	for (int ty = y0 / TileSize, tyEnd = y1 / TileSize; ty <= tyEnd; ++ty)
+	{
+		for (int tx = x0 / TileSize, txEnd = x1 / TileSize; tx <= txEnd; ++tx)
+		{
+			// The whole tile is in front of the box
+			if (tileMinDepth[ty * tilesX + tx] > nearestDepth)
+				continue;
+
+			int pyStart = std::max(y0, ty * static_cast<int>(TileSize));
+			int pyEnd = std::min(y1, (ty + 1) * static_cast<int>(TileSize) - 1);
+			int pxStart = std::max(x0, tx * static_cast<int>(TileSize));
+			int pxEnd = std::min(x1, (tx + 1) * static_cast<int>(TileSize) - 1);
+
+			for (int py = pyStart; py <= pyEnd; ++py)
+				for (int px = pxStart; px <= pxEnd; ++px)
+					if (depthBuffer[py * width + px] <= nearestDepth)
+						return false;
+		}
+	}
+
+	stats.objectsOccluded += 1;
+
+	return true;
+}
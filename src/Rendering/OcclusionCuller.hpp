@@ -0,0 +1,118 @@
+#pragma once
+
+#include "Core/Array.hpp"
+
+#include "Math/Mat4x4.hpp"
+
+class Allocator;
+
+struct BoundingBox;
+
+/**
+ * CPU occlusion culling against a low resolution depth buffer.
+ *
+ * Occluders are boxes that are known to be solid, such as walls and
+ * buildings. They must be opted in explicitly, since a box that isn't
+ * actually solid would hide objects that are visible. Their faces are
+ * rasterized conservatively: a pixel is only covered if the face covers all
+ * of it, and it gets the farthest depth the face has in the pixel. Objects
+ * are then tested using the nearest depth of their bounding box, so an object
+ * is only occluded when every pixel it touches is behind an occluder.
+ *
+ * Depth is stored as 1 / w, so larger values are closer and 0 is empty.
+ * The buffer is stored row by row and rasterized 4 pixels at a time with SSE.
+ * Each 8x8 pixel tile also stores its farthest depth, so that tests can
+ * accept whole tiles without looking at the pixels.
+ */
+class OcclusionCuller
+{
+public:
+	struct Stats
+	{
+		unsigned int occluderCandidates;
+		unsigned int occludersRasterized;
+		unsigned int facesRasterized;
+		unsigned int objectsTested;
+		unsigned int objectsOccluded;
+	};
+
+	static const unsigned int TileSize = 8;
+
+private:
+	Allocator* allocator;
+
+	unsigned int width;
+	unsigned int height;
+	unsigned int tilesX;
+	unsigned int tilesY;
+
+	float* depthBuffer;
+	float* tileMinDepth;
+
+	Mat4x4f viewProjection;
+	bool enabled;
+	unsigned int occluderBudget;
+
+	Stats stats;
+
+	// Unit cube to world transforms of the occluders rasterized this frame
+	Array<Mat4x4f> occluderTransforms;
+
+	void RasterizeQuad(const float* v0, const float* v1, const float* v2, const float* v3);
+
+public:
+	/**
+	 * <width> must be a multiple of 4 and <height> a multiple of TileSize.
+	 */
+	OcclusionCuller(Allocator* allocator, unsigned int width = 256, unsigned int height = 128);
+	~OcclusionCuller();
+
+	OcclusionCuller(const OcclusionCuller&) = delete;
+	OcclusionCuller& operator=(const OcclusionCuller&) = delete;
+
+	/**
+	 * Occlusion culling is disabled by default.
+	 */
+	void SetEnabled(bool enabled) { this->enabled = enabled; }
+	bool IsEnabled() const { return enabled; }
+
+	/**
+	 * Maximum number of occluders rasterized per frame.
+	 */
+	void SetOccluderBudget(unsigned int budget) { occluderBudget = budget; }
+	unsigned int GetOccluderBudget() const { return occluderBudget; }
+
+	/**
+	 * Clear the depth buffer and statistics for a new frame.
+	 */
+	void BeginFrame(const Mat4x4f& viewProjection);
+
+	/**
+	 * Rasterize a box occluder. <boxToWorld> transforms the unit cube
+	 * centered at the origin to world space. Occluders that cross the near
+	 * plane are skipped.
+	 */
+	void RasterizeOccluder(const Mat4x4f& boxToWorld);
+
+	/**
+	 * Must be called after all occluders have been rasterized and before
+	 * testing objects.
+	 */
+	void EndOccluders();
+
+	/**
+	 * Returns true if the box is fully hidden behind rasterized occluders.
+	 */
+	bool IsOccluded(const BoundingBox& bounds);
+
+	void AddOccluderCandidates(unsigned int count) { stats.occluderCandidates += count; }
+
+	const Stats& GetStats() const { return stats; }
+
+	unsigned int GetOccluderCount() const { return occluderTransforms.GetCount(); }
+	const Mat4x4f* GetOccluderTransforms() const { return occluderTransforms.GetData(); }
+
+	unsigned int GetWidth() const { return width; }
+	unsigned int GetHeight() const { return height; }
+	const float* GetDepthBuffer() const { return depthBuffer; }
+};
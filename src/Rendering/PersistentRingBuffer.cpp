@@ -0,0 +1,144 @@
+#include "Rendering/PersistentRingBuffer.hpp"
+
+#include <cassert>
+
+PersistentRingBuffer::PersistentRingBuffer(
+	RenderDevice* device, RenderBufferTarget target, unsigned int framesInFlight) :
+	device(device),
+	target(target),
+	bufferId(0),
+	mappedData(nullptr),
+	frameSize(0),
+	alignment(1),
+	frameCount(framesInFlight),
+	currentFrame(0),
+	stats(Stats{})
+{
+	assert(framesInFlight > 0 && framesInFlight <= MaxFramesInFlight);
+
+	for (unsigned int i = 0; i < MaxFramesInFlight; ++i)
+		fences[i] = nullptr;
+}
+
+PersistentRingBuffer::~PersistentRingBuffer()
+{
+	Deinitialize();
+}
+
+void PersistentRingBuffer::Initialize(size_t initialFrameSize, size_t alignment)
+{
+	this->alignment = alignment > 0 ? alignment : 1;
+
+	CreateBuffer(initialFrameSize);
+
+	// First BeginFrame moves to the first region
+	currentFrame = frameCount - 1;
+}
+
+void PersistentRingBuffer::Deinitialize()
+{
+	if (bufferId != 0)
+	{
+		for (unsigned int i = 0; i < frameCount; ++i)
+			WaitForFence(i);
+
+		DestroyBuffer();
+	}
+}
+
+void PersistentRingBuffer::CreateBuffer(size_t requiredFrameSize)
+{
+	frameSize = (requiredFrameSize + alignment - 1) / alignment * alignment;
+
+	device->CreateBuffers(1, &bufferId);
+	device->BindBuffer(target, bufferId);
+
+	RenderCommandData::SetBufferStorage storage{};
+	storage.target = target;
+	storage.size = frameSize * frameCount;
+	storage.mapWriteAccess = true;
+	storage.mapPersistent = true;
+	storage.mapCoherent = true;
+
+	device->SetBufferStorage(&storage);
+
+	RenderCommandData::MapBufferRange map{};
+	map.target = target;
+	map.offset = 0;
+	map.length = frameSize * frameCount;
+	map.writeAccess = true;
+	map.persistent = true;
+	map.coherent = true;
+
+	mappedData = static_cast<char*>(device->MapBufferRange(&map));
+}
+
+void PersistentRingBuffer::DestroyBuffer()
+{
+	device->BindBuffer(target, bufferId);
+	device->UnmapBuffer(target);
+	device->DestroyBuffers(1, &bufferId);
+
+	bufferId = 0;
+	mappedData = nullptr;
+}
+
+bool PersistentRingBuffer::WaitForFence(unsigned int frame)
+{
+	RenderSyncObject fence = fences[frame];
+
+	if (fence == nullptr)
+		return false;
+
+	bool stalled = false;
+
+	// Poll first, and only flush and block if the fence hasn't been signaled yet
+	RenderSyncWaitResult result = device->ClientWaitSync(fence, false, 0);
+
+	while (result == RenderSyncWaitResult::TimeoutExpired)
+	{
+		stalled = true;
+
+		const uint64_t timeout = 100 * 1000 * 1000; // 100 ms
+		result = device->ClientWaitSync(fence, true, timeout);
+	}
+
+	device->DeleteSync(fence);
+	fences[frame] = nullptr;
+
+	return stalled;
+}
+
+void PersistentRingBuffer::BeginFrame(size_t requiredSize)
+{
+	bool stalled = false;
+
+	if (requiredSize > frameSize)
+	{
+		// Buffer storage is immutable, so wait for all frames and recreate it
+		for (unsigned int i = 0; i < frameCount; ++i)
+			stalled |= WaitForFence(i);
+
+		DestroyBuffer();
+
+		// Leave headroom so that slowly growing frames don't recreate every time
+		size_t grownSize = frameSize + frameSize / 2;
+		CreateBuffer(requiredSize > grownSize ? requiredSize : grownSize);
+	}
+
+	currentFrame = (currentFrame + 1) % frameCount;
+
+	stalled |= WaitForFence(currentFrame);
+
+	if (stalled)
+		stats.stallCount += 1;
+
+	stats.bytesWritten = 0;
+}
+
+void PersistentRingBuffer::EndFrame()
+{
+	assert(fences[currentFrame] == nullptr);
+
+	fences[currentFrame] = device->FenceSync();
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstddef>
+
+#include "Rendering/RenderDevice.hpp"
+
+/**
+ * Buffer that stays persistently and coherently mapped, split into one
+ * region per frame in flight. Each frame writes to its own region and a
+ * fence placed after the frame's commands tells when the region can be
+ * written again, so the driver never has to orphan or synchronize the buffer.
+ */
+class PersistentRingBuffer
+{
+public:
+	static const unsigned int MaxFramesInFlight = 4;
+
+	struct Stats
+	{
+		// Number of times the CPU had to wait for the GPU to release a region
+		unsigned int stallCount;
+
+		// Bytes written to the region of the last frame
+		size_t bytesWritten;
+	};
+
+private:
+	RenderDevice* device;
+	RenderBufferTarget target;
+
+	unsigned int bufferId;
+	char* mappedData;
+
+	size_t frameSize;
+	size_t alignment;
+	unsigned int frameCount;
+	unsigned int currentFrame;
+
+	RenderSyncObject fences[MaxFramesInFlight];
+
+	Stats stats;
+
+	void CreateBuffer(size_t requiredFrameSize);
+	void DestroyBuffer();
+
+	// Returns true if the CPU had to wait for the fence
+	bool WaitForFence(unsigned int frame);
+
+public:
+	PersistentRingBuffer(RenderDevice* device, RenderBufferTarget target, unsigned int framesInFlight);
+	~PersistentRingBuffer();
+
+	// Offsets of the frame regions are multiples of alignment
+	void Initialize(size_t initialFrameSize, size_t alignment);
+	void Deinitialize();
+
+	/**
+	 * Wait until the GPU has finished reading the next frame's region and
+	 * make it the current region. If the frame needs more than the current
+	 * region size, the buffer is recreated after all frames have completed.
+	 */
+	void BeginFrame(size_t requiredSize);
+
+	// Place the fence that guards the current region, after its last use
+	void EndFrame();
+
+	void AddBytesWritten(size_t bytes) { stats.bytesWritten += bytes; }
+
+	unsigned int GetBufferId() const { return bufferId; }
+
+	// Offset of the current region from the start of the buffer
+	size_t GetFrameOffset() const { return currentFrame * frameSize; }
+	char* GetFrameData() const { return mappedData + GetFrameOffset(); }
+
+	const Stats& GetStats() const { return stats; }
+};
@@ -96,6 +96,9 @@ void PostProcessRenderer::RenderPasses(unsigned int count, const PostProcessRend
 			BindTextures(shader, pass.textureCount, pass.textureNameHashes, pass.textureIds, pass.samplerIds);
 
 		renderDevice->DrawIndexed(draw->primitiveMode, draw->count, draw->indexType);
+
+		if (pass.textureCount > 0)
+			UnbindSamplers(pass.textureCount, pass.samplerIds);
 	}
 }
 
@@ -116,3 +119,13 @@ void PostProcessRenderer::BindTextures(const ShaderData& shader, unsigned int co
 		}
 	}
 }
+
+void PostProcessRenderer::UnbindSamplers(unsigned int count, const unsigned int* samplers)
+{
+	// Texture units are shared with the mesh renderer, which relies on texture
+	// sampler parameters, so don't leave sampler objects bound after a pass
+
+	for (unsigned int i = 0; i < count; ++i)
+		if (samplers[i] != 0)
+			renderDevice->BindSampler(i, 0);
+}
@@ -24,6 +24,7 @@ private:
 
 	void BindTextures(const ShaderData& shader, unsigned int count,
 		const uint32_t* nameHashes, const unsigned int* textures, const unsigned int* samplers);
+	void UnbindSamplers(unsigned int count, const unsigned int* samplers);
 
 public:
 	PostProcessRenderer(RenderDevice* renderDevice, MeshManager* meshManager,
@@ -0,0 +1,38 @@
+#include "Rendering/RenderCaptureFile.hpp"
+
+#include <cstring>
+
+#include "Core/Buffer.hpp"
+
+#include "System/File.hpp"
+
+bool RenderCaptureFile::Write(const char* path, const Array<uint8_t>& stream, size_t frameStart)
+{
+	Header header;
+	header.magic = Magic;
+	header.version = Version;
+	header.frameStart = frameStart;
+	header.streamSize = stream.GetCount();
+
+	BufferRef<char> headerContent(reinterpret_cast<char*>(&header), sizeof(Header));
+	BufferRef<char> streamContent(reinterpret_cast<char*>(const_cast<uint8_t*>(stream.GetData())), stream.GetCount());
+
+	return File::Write(path, headerContent, false) && File::Write(path, streamContent, true);
+}
+
+bool RenderCaptureFile::Read(const char* path, Buffer<unsigned char>& fileOut, size_t& streamOffsetOut, Header& headerOut)
+{
+	if (File::ReadBinary(path, fileOut) == false || fileOut.Count() < sizeof(Header))
+		return false;
+
+	std::memcpy(&headerOut, fileOut.Data(), sizeof(Header));
+
+	if (headerOut.magic != Magic || headerOut.version != Version ||
+		headerOut.streamSize > fileOut.Count() - sizeof(Header) ||
+		headerOut.frameStart > headerOut.streamSize)
+		return false;
+
+	streamOffsetOut = sizeof(Header);
+
+	return true;
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "Core/Array.hpp"
+
+template <typename T>
+class Buffer;
+
+/**
+ * A capture file holds a command stream recorded by RenderDeviceRecorder.
+ * The stream has every command since the recording started, so that the
+ * objects used by the captured frame are created and filled before it. The
+ * captured frame starts at frameStart and continues to the end of the stream.
+ */
+namespace RenderCaptureFile
+{
+	struct Header
+	{
+		uint32_t magic;
+		uint32_t version;
+		uint64_t frameStart;
+		uint64_t streamSize;
+	};
+
+	const uint32_t Magic = 0x50434b4b; // "KKCP"
+	const uint32_t Version = 1;
+
+	bool Write(const char* path, const Array<uint8_t>& stream, size_t frameStart);
+
+	// On success, the stream starts at streamOffsetOut in fileOut
+	bool Read(const char* path, Buffer<unsigned char>& fileOut, size_t& streamOffsetOut, Header& headerOut);
+}
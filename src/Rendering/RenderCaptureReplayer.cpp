@@ -0,0 +1,1542 @@
+#include "Rendering/RenderCaptureReplayer.hpp"
+
+#include <cstdint>
+
+RenderCaptureReplayer::RenderCaptureReplayer(Allocator* allocator, RenderDevice* device) :
+	device(device),
+	framebuffers(allocator),
+	textures(allocator),
+	samplers(allocator),
+	shaderPrograms(allocator),
+	shaderStages(allocator),
+	vertexArrays(allocator),
+	buffers(allocator),
+	uniformLocations(allocator),
+	currentProgram(0),
+	mappedBuffers(allocator),
+	syncs(allocator),
+	objectScratch(allocator),
+	createdObjectScratch(allocator),
+	floatScratch(allocator),
+	drawBufferScratch(allocator),
+	readPosition(nullptr),
+	readEnd(nullptr),
+	malformed(false),
+	timingEnabled(true)
+{
+	for (unsigned int i = 0; i < BufferTargetCount; ++i)
+		boundBuffers[i] = 0;
+
+	ResetCategoryStats();
+}
+
+void RenderCaptureReplayer::ResetCategoryStats()
+{
+	for (size_t i = 0; i < static_cast<size_t>(Category::Count); ++i)
+		categoryStats[i] = CategoryStats{ 0, 0 };
+}
+
+RenderCaptureReplayer::Category RenderCaptureReplayer::GetCallCategory(Call call)
+{
+	switch (call)
+	{
+	case Call::SetDebugMessageCallback:
+	case Call::SetObjectLabel:
+	case Call::SetObjectPtrLabel:
+	case Call::PushDebugGroup:
+	case Call::PopDebugGroup:
+		return Category::Debug;
+
+	case Call::BindFramebuffer:
+	case Call::BindTexture:
+	case Call::SetActiveTextureUnit:
+	case Call::BindSampler:
+	case Call::UseShaderProgram:
+	case Call::BindVertexArray:
+	case Call::BindBuffer:
+	case Call::BindBufferBase:
+	case Call::BindBufferRange:
+		return Category::Bind;
+
+	case Call::CreateFramebuffers:
+	case Call::DestroyFramebuffers:
+	case Call::AttachFramebufferTexture2D:
+	case Call::SetFramebufferDrawBuffers:
+	case Call::CreateTextures:
+	case Call::DestroyTextures:
+	case Call::SetTextureStorage2D:
+	case Call::GenerateTextureMipmaps:
+	case Call::SetTextureParameterInt:
+	case Call::SetTextureMinFilter:
+	case Call::SetTextureMagFilter:
+	case Call::SetTextureWrapModeU:
+	case Call::SetTextureWrapModeV:
+	case Call::SetTextureWrapModeW:
+	case Call::SetTextureCompareMode:
+	case Call::SetTextureCompareFunc:
+	case Call::CreateSamplers:
+	case Call::DestroySamplers:
+	case Call::SetSamplerParameters:
+	case Call::CreateVertexArrays:
+	case Call::DestroyVertexArrays:
+	case Call::EnableVertexAttribute:
+	case Call::SetVertexAttributePointer:
+	case Call::CreateBuffers:
+	case Call::DestroyBuffers:
+	case Call::MapBuffer:
+	case Call::MapBufferRange:
+	case Call::UnmapBuffer:
+		return Category::Resource;
+
+	case Call::SetTextureImage2D:
+	case Call::SetTextureSubImage2D:
+	case Call::SetTextureImageCompressed2D:
+	case Call::SetBufferStorage:
+	case Call::SetBufferData:
+	case Call::SetBufferSubData:
+	case Call::WriteMappedBuffer:
+		return Category::Upload;
+
+	case Call::CreateShaderProgram:
+	case Call::DestroyShaderProgram:
+	case Call::AttachShaderStageToProgram:
+	case Call::LinkShaderProgram:
+	case Call::CreateShaderStage:
+	case Call::DestroyShaderStage:
+	case Call::SetShaderStageSource:
+	case Call::CompileShaderStage:
+		return Category::Shader;
+
+	case Call::GetIntegerValue:
+	case Call::GetShaderProgramParameterInt:
+	case Call::GetShaderProgramLinkStatus:
+	case Call::GetShaderProgramInfoLogLength:
+	case Call::GetShaderProgramInfoLog:
+	case Call::GetShaderStageParameterInt:
+	case Call::GetShaderStageCompileStatus:
+	case Call::GetShaderStageInfoLogLength:
+	case Call::GetShaderStageInfoLog:
+	case Call::GetUniformLocation:
+		return Category::Query;
+
+	case Call::SetUniformMat4x4f:
+	case Call::SetUniformVec4f:
+	case Call::SetUniformVec3f:
+	case Call::SetUniformVec2f:
+	case Call::SetUniformFloat:
+	case Call::SetUniformInt:
+		return Category::Uniform;
+
+	case Call::Draw:
+	case Call::DrawIndexed:
+	case Call::DrawInstanced:
+	case Call::DrawIndexedInstanced:
+	case Call::DrawIndexedInstancedBaseInstance:
+	case Call::MultiDrawIndexedIndirect:
+	case Call::DispatchCompute:
+	case Call::MemoryBarrier:
+		return Category::Draw;
+
+	case Call::FenceSync:
+	case Call::ClientWaitSync:
+	case Call::DeleteSync:
+		return Category::Sync;
+
+	default:
+		return Category::State;
+	}
+}
+
+const char* RenderCaptureReplayer::GetCategoryName(Category category)
+{
+	switch (category)
+	{
+	case Category::Debug: return "Debug";
+	case Category::State: return "State";
+	case Category::Bind: return "Bind";
+	case Category::Resource: return "Resource";
+	case Category::Upload: return "Upload";
+	case Category::Shader: return "Shader";
+	case Category::Query: return "Query";
+	case Category::Uniform: return "Uniform";
+	case Category::Draw: return "Draw";
+	case Category::Sync: return "Sync";
+	default: return "";
+	}
+}
+
+bool RenderCaptureReplayer::Replay(const uint8_t* commands, size_t size)
+{
+	const uint8_t* position = commands;
+	const uint8_t* end = commands + size;
+
+	while (position < end)
+	{
+		using CommandHeader = RenderDeviceRecorder::CommandHeader;
+
+		if (static_cast<size_t>(end - position) < sizeof(CommandHeader))
+			return false;
+
+		CommandHeader header;
+		std::memcpy(&header, position, sizeof(CommandHeader));
+		position += sizeof(CommandHeader);
+
+		if (header.call >= static_cast<uint32_t>(Call::Count) || header.size > static_cast<size_t>(end - position))
+			return false;
+
+		readPosition = position;
+		readEnd = position + header.size;
+		malformed = false;
+
+		Execute(static_cast<Call>(header.call));
+
+		if (malformed)
+			return false;
+
+		position += header.size;
+	}
+
+	return true;
+}
+
+void RenderCaptureReplayer::EndTiming(Call call)
+{
+	if (timingEnabled == false)
+		return;
+
+	uint64_t elapsed = static_cast<uint64_t>(timer.ElapsedNanoseconds());
+
+	CategoryStats& stats = categoryStats[static_cast<size_t>(GetCallCategory(call))];
+	stats.callCount += 1;
+	stats.nanoseconds += elapsed;
+}
+
+const uint8_t* RenderCaptureReplayer::Take(size_t size)
+{
+	if (size > static_cast<size_t>(readEnd - readPosition))
+	{
+		malformed = true;
+		return nullptr;
+	}
+
+	const uint8_t* data = readPosition;
+	readPosition += size;
+
+	return data;
+}
+
+const char* RenderCaptureReplayer::ReadString(size_t length)
+{
+	return reinterpret_cast<const char*>(Take(length));
+}
+
+const void* RenderCaptureReplayer::ReadPayload(size_t& sizeOut)
+{
+	uint64_t size = Read<uint64_t>();
+	const uint8_t* data = size > 0 ? Take(static_cast<size_t>(size)) : nullptr;
+
+	sizeOut = data != nullptr ? static_cast<size_t>(size) : 0;
+
+	return data;
+}
+
+RenderCaptureReplayer::ObjectMap* RenderCaptureReplayer::GetObjectMap(RenderObjectType type)
+{
+	switch (type)
+	{
+	case RenderObjectType::Buffer: return &buffers;
+	case RenderObjectType::Shader: return &shaderStages;
+	case RenderObjectType::Program: return &shaderPrograms;
+	case RenderObjectType::VertexArray: return &vertexArrays;
+	case RenderObjectType::Sampler: return &samplers;
+	case RenderObjectType::Texture: return &textures;
+	case RenderObjectType::Framebuffer: return &framebuffers;
+	default: return nullptr;
+	}
+}
+
+unsigned int RenderCaptureReplayer::MapObject(ObjectMap& map, unsigned int recorded)
+{
+	// Zero is the default object of every type
+	if (recorded == 0)
+		return 0;
+
+	ObjectMap::KeyValuePair* pair = map.Lookup(recorded);
+	return pair != nullptr ? pair->second : 0;
+}
+
+void RenderCaptureReplayer::AddObjects(ObjectMap& map, unsigned int count,
+	const unsigned int* recorded, const unsigned int* created)
+{
+	for (unsigned int i = 0; i < count; ++i)
+		map.Insert(recorded[i])->second = created[i];
+}
+
+void RenderCaptureReplayer::RemoveObjects(ObjectMap& map, unsigned int count, const unsigned int* recorded)
+{
+	for (unsigned int i = 0; i < count; ++i)
+	{
+		ObjectMap::KeyValuePair* pair = map.Lookup(recorded[i]);
+		if (pair != nullptr)
+			map.Remove(pair);
+	}
+}
+
+uint32_t RenderCaptureReplayer::GetUniformKey(unsigned int program, int recordedLocation)
+{
+	return (static_cast<uint32_t>(program) << 16) | (static_cast<uint32_t>(recordedLocation) & 0xffff);
+}
+
+int RenderCaptureReplayer::MapUniform(int recordedLocation)
+{
+	// Uniforms that don't exist in the program can be set, but are ignored
+	if (recordedLocation < 0)
+		return recordedLocation;
+
+	HashMap<uint32_t, int>::KeyValuePair* pair = uniformLocations.Lookup(GetUniformKey(currentProgram, recordedLocation));
+	return pair != nullptr ? pair->second : -1;
+}
+
+void RenderCaptureReplayer::SetMapping(RenderBufferTarget target, void* mapped, size_t offset, size_t length)
+{
+	unsigned int buffer = boundBuffers[static_cast<size_t>(target)];
+
+	if (mapped != nullptr)
+		mappedBuffers.Insert(buffer)->second = MappedBuffer{ static_cast<uint8_t*>(mapped), offset, length };
+	else if (HashMap<unsigned int, MappedBuffer>::KeyValuePair* pair = mappedBuffers.Lookup(buffer))
+		mappedBuffers.Remove(pair);
+}
+
+void RenderCaptureReplayer::AddSync(uint64_t recorded, RenderSyncObject sync)
+{
+	// When a frame is replayed again, its fences are placed again before the old ones are deleted
+	for (unsigned int i = 0, count = syncs.GetCount(); i < count; ++i)
+	{
+		if (syncs[i].recorded == recorded)
+		{
+			device->DeleteSync(syncs[i].sync);
+			syncs[i].sync = sync;
+			return;
+		}
+	}
+
+	syncs.PushBack(SyncPair{ recorded, sync });
+}
+
+RenderSyncObject RenderCaptureReplayer::FindSync(uint64_t recorded)
+{
+	for (unsigned int i = 0, count = syncs.GetCount(); i < count; ++i)
+		if (syncs[i].recorded == recorded)
+			return syncs[i].sync;
+
+	return nullptr;
+}
+
+void RenderCaptureReplayer::RemoveSync(uint64_t recorded)
+{
+	for (unsigned int i = 0, count = syncs.GetCount(); i < count; ++i)
+	{
+		if (syncs[i].recorded == recorded)
+		{
+			syncs.Remove(i);
+			return;
+		}
+	}
+}
+
+void RenderCaptureReplayer::Execute(Call call)
+{
+	switch (call)
+	{
+	case Call::GetIntegerValue:
+	{
+		RenderDeviceParameter parameter = Read<RenderDeviceParameter>();
+		int value = 0;
+
+		StartTiming();
+		device->GetIntegerValue(parameter, &value);
+		EndTiming(call);
+		break;
+	}
+
+	case Call::SetDebugMessageCallback:
+	{
+		// The callback can't be captured
+		break;
+	}
+
+	case Call::SetObjectLabel:
+	{
+		RenderObjectType type = Read<RenderObjectType>();
+		unsigned int object = Read<unsigned int>();
+		unsigned int labelLength = Read<unsigned int>();
+		StringRef label(ReadString(labelLength), labelLength);
+
+		HashMap<unsigned int, unsigned int>* objects = GetObjectMap(type);
+		if (objects != nullptr)
+			object = MapObject(*objects, object);
+
+		StartTiming();
+		device->SetObjectLabel(type, object, label);
+		EndTiming(call);
+		break;
+	}
+
+	case Call::SetObjectPtrLabel:
+	{
+		// Sync objects aren't labeled in the capture, so there's nothing to label
+		break;
+	}
+
+	case Call::PushDebugGroup:
+	{
+		unsigned int id = Read<unsigned int>();
+		unsigned int messageLength = Read<unsigned int>();
+		StringRef message(ReadString(messageLength), messageLength);
+
+		StartTiming();
+		device->PushDebugGroup(id, message);
+		EndTiming(call);
+		break;
+	}
+
+	case Call::PopDebugGroup:
+	{
+		StartTiming();
+		device->PopDebugGroup();
+		EndTiming(call);
+		break;
+	}
+
+	case Call::Clear:
+	{
+		RenderCommandData::ClearMask data = Read<RenderCommandData::ClearMask>();
+
+		StartTiming();
+		device->Clear(&data);
+		EndTiming(call);
+		break;
+	}
+
+	case Call::ClearColor:
+	{
+		RenderCommandData::ClearColorData data = Read<RenderCommandData::ClearColorData>();
+
+		StartTiming();
+		device->ClearColor(&data);
+		EndTiming(call);
+		break;
+	}
+
+	case Call::ClearDepth:
+	{
+		float depth = Read<float>();
+
+		StartTiming();
+		device->ClearDepth(depth);
+		EndTiming(call);
+		break;
+	}
+
+	case Call::BlendingEnable:
+	{
+		StartTiming();
+		device->BlendingEnable();
+		EndTiming(call);
+		break;
+	}
+
+	case Call::BlendingDisable:
+	{
+		StartTiming();
+		device->BlendingDisable();
+		EndTiming(call);
+		break;
+	}
+
+	case Call::BlendFunction:
+	{
+		RenderCommandData::BlendFunctionData data = Read<RenderCommandData::BlendFunctionData>();
+
+		StartTiming();
+		device->BlendFunction(&data);
+		EndTiming(call);
+		break;
+	}
+
+	case Call::SetClipBehavior:
+	{
+		RenderClipOriginMode origin = Read<RenderClipOriginMode>();
+		RenderClipDepthMode depth = Read<RenderClipDepthMode>();
+
+		StartTiming();
+		device->SetClipBehavior(origin, depth);
+		EndTiming(call);
+		break;
+	}
+
+	case Call::DepthRange:
+	{
+		RenderCommandData::DepthRangeData data = Read<RenderCommandData::DepthRangeData>();
+
+		StartTiming();
+		device->DepthRange(&data);
+		EndTiming(call);
+		break;
+	}
+
+	case Call::Viewport:
+	{
+		RenderCommandData::ViewportData data = Read<RenderCommandData::ViewportData>();
+
+		StartTiming();
+		device->Viewport(&data);
+		EndTiming(call);
+		break;
+	}
+
+	case Call::DepthTestEnable:
+	{
+		StartTiming();
+		device->DepthTestEnable();
+		EndTiming(call);
+		break;
+	}
+
+	case Call::DepthTestDisable:
+	{
+		StartTiming();
+		device->DepthTestDisable();
+		EndTiming(call);
+		break;
+	}
+
+	case Call::DepthTestFunction:
+	{
+		RenderDepthCompareFunc function = Read<RenderDepthCompareFunc>();
+
+		StartTiming();
+		device->DepthTestFunction(function);
+		EndTiming(call);
+		break;
+	}
+
+	case Call::DepthWriteEnable:
+	{
+		StartTiming();
+		device->DepthWriteEnable();
+		EndTiming(call);
+		break;
+	}
+
+	case Call::DepthWriteDisable:
+	{
+		StartTiming();
+		device->DepthWriteDisable();
+		EndTiming(call);
+		break;
+	}
+
+	case Call::CullFaceEnable:
+	{
+		StartTiming();
+		device->CullFaceEnable();
+		EndTiming(call);
+		break;
+	}
+
+	case Call::CullFaceDisable:
+	{
+		StartTiming();
+		device->CullFaceDisable();
+		EndTiming(call);
+		break;
+	}
+
+	case Call::CullFaceFront:
+	{
+		StartTiming();
+		device->CullFaceFront();
+		EndTiming(call);
+		break;
+	}
+
+	case Call::CullFaceBack:
+	{
+		StartTiming();
+		device->CullFaceBack();
+		EndTiming(call);
+		break;
+	}
+
+	case Call::FramebufferSrgbEnable:
+	{
+		StartTiming();
+		device->FramebufferSrgbEnable();
+		EndTiming(call);
+		break;
+	}
+
+	case Call::FramebufferSrgbDisable:
+	{
+		StartTiming();
+		device->FramebufferSrgbDisable();
+		EndTiming(call);
+		break;
+	}
+
+	case Call::CreateFramebuffers:
+	{
+		unsigned int count = Read<unsigned int>();
+		ReadArray(count, objectScratch);
+		count = objectScratch.GetCount();
+		createdObjectScratch.Resize(count);
+
+		StartTiming();
+		device->CreateFramebuffers(count, createdObjectScratch.GetData());
+		EndTiming(call);
+
+		AddObjects(framebuffers, count, objectScratch.GetData(), createdObjectScratch.GetData());
+		break;
+	}
+
+	case Call::DestroyFramebuffers:
+	{
+		unsigned int count = Read<unsigned int>();
+		ReadArray(count, objectScratch);
+		count = objectScratch.GetCount();
+		RemoveObjects(framebuffers, count, objectScratch.GetData());
+
+		StartTiming();
+		device->DestroyFramebuffers(count, objectScratch.GetData());
+		EndTiming(call);
+		break;
+	}
+
+	case Call::BindFramebuffer:
+	{
+		RenderCommandData::BindFramebufferData data = Read<RenderCommandData::BindFramebufferData>();
+		data.framebuffer = MapObject(framebuffers, data.framebuffer);
+
+		StartTiming();
+		device->BindFramebuffer(&data);
+		EndTiming(call);
+		break;
+	}
+
+	case Call::AttachFramebufferTexture2D:
+	{
+		RenderCommandData::AttachFramebufferTexture2D data = Read<RenderCommandData::AttachFramebufferTexture2D>();
+		data.texture = MapObject(textures, data.texture);
+
+		StartTiming();
+		device->AttachFramebufferTexture2D(&data);
+		EndTiming(call);
+		break;
+	}
+
+	case Call::SetFramebufferDrawBuffers:
+	{
+		unsigned int count = Read<unsigned int>();
+		ReadArray(count, drawBufferScratch);
+
+		StartTiming();
+		device->SetFramebufferDrawBuffers(drawBufferScratch.GetCount(), drawBufferScratch.GetData());
+		EndTiming(call);
+		break;
+	}
+
+	case Call::CreateTextures:
+	{
+		unsigned int count = Read<unsigned int>();
+		ReadArray(count, objectScratch);
+		count = objectScratch.GetCount();
+		createdObjectScratch.Resize(count);
+
+		StartTiming();
+		device->CreateTextures(count, createdObjectScratch.GetData());
+		EndTiming(call);
+
+		AddObjects(textures, count, objectScratch.GetData(), createdObjectScratch.GetData());
+		break;
+	}
+
+	case Call::DestroyTextures:
+	{
+		unsigned int count = Read<unsigned int>();
+		ReadArray(count, objectScratch);
+		count = objectScratch.GetCount();
+		RemoveObjects(textures, count, objectScratch.GetData());
+
+		StartTiming();
+		device->DestroyTextures(count, objectScratch.GetData());
+		EndTiming(call);
+		break;
+	}
+
+	case Call::BindTexture:
+	{
+		RenderTextureTarget target = Read<RenderTextureTarget>();
+		unsigned int texture = MapObject(textures, Read<unsigned int>());
+
+		StartTiming();
+		device->BindTexture(target, texture);
+		EndTiming(call);
+		break;
+	}
+
+	case Call::SetTextureStorage2D:
+	{
+		RenderCommandData::SetTextureStorage2D data = Read<RenderCommandData::SetTextureStorage2D>();
+
+		StartTiming();
+		device->SetTextureStorage2D(&data);
+		EndTiming(call);
+		break;
+	}
+
+	case Call::SetTextureImage2D:
+	{
+		RenderCommandData::SetTextureImage2D data = Read<RenderCommandData::SetTextureImage2D>();
+		size_t size = 0;
+		data.data = ReadPayload(size);
+
+		StartTiming();
+		device->SetTextureImage2D(&data);
+		EndTiming(call);
+		break;
+	}
+
+	case Call::SetTextureSubImage2D:
+	{
+		RenderCommandData::SetTextureSubImage2D data = Read<RenderCommandData::SetTextureSubImage2D>();
+		size_t size = 0;
+		data.data = ReadPayload(size);
+
+		StartTiming();
+		device->SetTextureSubImage2D(&data);
+		EndTiming(call);
+		break;
+	}
+
+	case Call::SetTextureImageCompressed2D:
+	{
+		RenderCommandData::SetTextureImageCompressed2D data = Read<RenderCommandData::SetTextureImageCompressed2D>();
+		size_t size = 0;
+		data.data = ReadPayload(size);
+
+		StartTiming();
+		device->SetTextureImageCompressed2D(&data);
+		EndTiming(call);
+		break;
+	}
+
+	case Call::GenerateTextureMipmaps:
+	{
+		RenderTextureTarget target = Read<RenderTextureTarget>();
+
+		StartTiming();
+		device->GenerateTextureMipmaps(target);
+		EndTiming(call);
+		break;
+	}
+
+	case Call::SetActiveTextureUnit:
+	{
+		unsigned int textureUnit = Read<unsigned int>();
+
+		StartTiming();
+		device->SetActiveTextureUnit(textureUnit);
+		EndTiming(call);
+		break;
+	}
+
+	case Call::SetTextureParameterInt:
+	{
+		RenderTextureTarget target = Read<RenderTextureTarget>();
+		RenderTextureParameter parameter = Read<RenderTextureParameter>();
+		unsigned int value = Read<unsigned int>();
+
+		StartTiming();
+		device->SetTextureParameterInt(target, parameter, value);
+		EndTiming(call);
+		break;
+	}
+
+	case Call::SetTextureMinFilter:
+	{
+		RenderTextureTarget target = Read<RenderTextureTarget>();
+		RenderTextureFilterMode mode = Read<RenderTextureFilterMode>();
+
+		StartTiming();
+		device->SetTextureMinFilter(target, mode);
+		EndTiming(call);
+		break;
+	}
+
+	case Call::SetTextureMagFilter:
+	{
+		RenderTextureTarget target = Read<RenderTextureTarget>();
+		RenderTextureFilterMode mode = Read<RenderTextureFilterMode>();
+
+		StartTiming();
+		device->SetTextureMagFilter(target, mode);
+		EndTiming(call);
+		break;
+	}
+
+	case Call::SetTextureWrapModeU:
+	{
+		RenderTextureTarget target = Read<RenderTextureTarget>();
+		RenderTextureWrapMode mode = Read<RenderTextureWrapMode>();
+
+		StartTiming();
+		device->SetTextureWrapModeU(target, mode);
+		EndTiming(call);
+		break;
+	}
+
+	case Call::SetTextureWrapModeV:
+	{
+		RenderTextureTarget target = Read<RenderTextureTarget>();
+		RenderTextureWrapMode mode = Read<RenderTextureWrapMode>();
+
+		StartTiming();
+		device->SetTextureWrapModeV(target, mode);
+		EndTiming(call);
+		break;
+	}
+
+	case Call::SetTextureWrapModeW:
+	{
+		RenderTextureTarget target = Read<RenderTextureTarget>();
+		RenderTextureWrapMode mode = Read<RenderTextureWrapMode>();
+
+		StartTiming();
+		device->SetTextureWrapModeW(target, mode);
+		EndTiming(call);
+		break;
+	}
+
+	case Call::SetTextureCompareMode:
+	{
+		RenderTextureTarget target = Read<RenderTextureTarget>();
+		RenderTextureCompareMode mode = Read<RenderTextureCompareMode>();
+
+		StartTiming();
+		device->SetTextureCompareMode(target, mode);
+		EndTiming(call);
+		break;
+	}
+
+	case Call::SetTextureCompareFunc:
+	{
+		RenderTextureTarget target = Read<RenderTextureTarget>();
+		RenderDepthCompareFunc func = Read<RenderDepthCompareFunc>();
+
+		StartTiming();
+		device->SetTextureCompareFunc(target, func);
+		EndTiming(call);
+		break;
+	}
+
+	case Call::CreateSamplers:
+	{
+		unsigned int count = Read<unsigned int>();
+		ReadArray(count, objectScratch);
+		count = objectScratch.GetCount();
+		createdObjectScratch.Resize(count);
+
+		StartTiming();
+		device->CreateSamplers(count, createdObjectScratch.GetData());
+		EndTiming(call);
+
+		AddObjects(samplers, count, objectScratch.GetData(), createdObjectScratch.GetData());
+		break;
+	}
+
+	case Call::DestroySamplers:
+	{
+		unsigned int count = Read<unsigned int>();
+		ReadArray(count, objectScratch);
+		count = objectScratch.GetCount();
+		RemoveObjects(samplers, count, objectScratch.GetData());
+
+		StartTiming();
+		device->DestroySamplers(count, objectScratch.GetData());
+		EndTiming(call);
+		break;
+	}
+
+	case Call::BindSampler:
+	{
+		unsigned int textureUnit = Read<unsigned int>();
+		unsigned int sampler = MapObject(samplers, Read<unsigned int>());
+
+		StartTiming();
+		device->BindSampler(textureUnit, sampler);
+		EndTiming(call);
+		break;
+	}
+
+	case Call::SetSamplerParameters:
+	{
+		RenderCommandData::SetSamplerParameters data = Read<RenderCommandData::SetSamplerParameters>();
+		data.sampler = MapObject(samplers, data.sampler);
+
+		StartTiming();
+		device->SetSamplerParameters(&data);
+		EndTiming(call);
+		break;
+	}
+
+	case Call::CreateShaderProgram:
+	{
+		unsigned int recordedProgram = Read<unsigned int>();
+
+		StartTiming();
+		unsigned int shaderProgram = device->CreateShaderProgram();
+		EndTiming(call);
+
+		AddObjects(shaderPrograms, 1, &recordedProgram, &shaderProgram);
+		break;
+	}
+
+	case Call::DestroyShaderProgram:
+	{
+		unsigned int recorded = Read<unsigned int>();
+		unsigned int shaderProgram = MapObject(shaderPrograms, recorded);
+		RemoveObjects(shaderPrograms, 1, &recorded);
+
+		StartTiming();
+		device->DestroyShaderProgram(shaderProgram);
+		EndTiming(call);
+		break;
+	}
+
+	case Call::AttachShaderStageToProgram:
+	{
+		unsigned int shaderProgram = MapObject(shaderPrograms, Read<unsigned int>());
+		unsigned int shaderStage = MapObject(shaderStages, Read<unsigned int>());
+
+		StartTiming();
+		device->AttachShaderStageToProgram(shaderProgram, shaderStage);
+		EndTiming(call);
+		break;
+	}
+
+	case Call::LinkShaderProgram:
+	{
+		unsigned int shaderProgram = MapObject(shaderPrograms, Read<unsigned int>());
+
+		StartTiming();
+		device->LinkShaderProgram(shaderProgram);
+		EndTiming(call);
+		break;
+	}
+
+	case Call::UseShaderProgram:
+	{
+		currentProgram = MapObject(shaderPrograms, Read<unsigned int>());
+
+		StartTiming();
+		device->UseShaderProgram(currentProgram);
+		EndTiming(call);
+		break;
+	}
+
+	case Call::GetShaderProgramParameterInt:
+	{
+		unsigned int shaderProgram = MapObject(shaderPrograms, Read<unsigned int>());
+		unsigned int parameter = Read<unsigned int>();
+
+		StartTiming();
+		device->GetShaderProgramParameterInt(shaderProgram, parameter);
+		EndTiming(call);
+		break;
+	}
+
+	case Call::GetShaderProgramLinkStatus:
+	{
+		unsigned int shaderProgram = MapObject(shaderPrograms, Read<unsigned int>());
+
+		StartTiming();
+		device->GetShaderProgramLinkStatus(shaderProgram);
+		EndTiming(call);
+		break;
+	}
+
+	case Call::GetShaderProgramInfoLogLength:
+	{
+		unsigned int shaderProgram = MapObject(shaderPrograms, Read<unsigned int>());
+
+		StartTiming();
+		device->GetShaderProgramInfoLogLength(shaderProgram);
+		EndTiming(call);
+		break;
+	}
+
+	case Call::GetShaderProgramInfoLog:
+	{
+		// Logs are only read after failed builds, which can't be reproduced
+		break;
+	}
+
+	case Call::CreateShaderStage:
+	{
+		RenderShaderStage stage = Read<RenderShaderStage>();
+		unsigned int recordedStage = Read<unsigned int>();
+
+		StartTiming();
+		unsigned int shaderStage = device->CreateShaderStage(stage);
+		EndTiming(call);
+
+		AddObjects(shaderStages, 1, &recordedStage, &shaderStage);
+		break;
+	}
+
+	case Call::DestroyShaderStage:
+	{
+		unsigned int recorded = Read<unsigned int>();
+		unsigned int shaderStage = MapObject(shaderStages, recorded);
+		RemoveObjects(shaderStages, 1, &recorded);
+
+		StartTiming();
+		device->DestroyShaderStage(shaderStage);
+		EndTiming(call);
+		break;
+	}
+
+	case Call::SetShaderStageSource:
+	{
+		unsigned int shaderStage = MapObject(shaderStages, Read<unsigned int>());
+		int length = Read<int>();
+		const char* source = ReadString(length);
+
+		StartTiming();
+		device->SetShaderStageSource(shaderStage, source, length);
+		EndTiming(call);
+		break;
+	}
+
+	case Call::CompileShaderStage:
+	{
+		unsigned int shaderStage = MapObject(shaderStages, Read<unsigned int>());
+
+		StartTiming();
+		device->CompileShaderStage(shaderStage);
+		EndTiming(call);
+		break;
+	}
+
+	case Call::GetShaderStageParameterInt:
+	{
+		unsigned int shaderStage = MapObject(shaderStages, Read<unsigned int>());
+		unsigned int parameter = Read<unsigned int>();
+
+		StartTiming();
+		device->GetShaderStageParameterInt(shaderStage, parameter);
+		EndTiming(call);
+		break;
+	}
+
+	case Call::GetShaderStageCompileStatus:
+	{
+		unsigned int shaderStage = MapObject(shaderStages, Read<unsigned int>());
+
+		StartTiming();
+		device->GetShaderStageCompileStatus(shaderStage);
+		EndTiming(call);
+		break;
+	}
+
+	case Call::GetShaderStageInfoLogLength:
+	{
+		unsigned int shaderStage = MapObject(shaderStages, Read<unsigned int>());
+
+		StartTiming();
+		device->GetShaderStageInfoLogLength(shaderStage);
+		EndTiming(call);
+		break;
+	}
+
+	case Call::GetShaderStageInfoLog:
+	{
+		// Logs are only read after failed builds, which can't be reproduced
+		break;
+	}
+
+	case Call::GetUniformLocation:
+	{
+		unsigned int shaderProgram = MapObject(shaderPrograms, Read<unsigned int>());
+		int recordedLocation = Read<int>();
+		unsigned int nameLength = Read<unsigned int>();
+		const char* name = ReadString(nameLength + 1);
+
+		StartTiming();
+		int location = device->GetUniformLocation(shaderProgram, name);
+		EndTiming(call);
+
+		uniformLocations.Insert(GetUniformKey(shaderProgram, recordedLocation))->second = location;
+		break;
+	}
+
+	case Call::SetUniformMat4x4f:
+	{
+		int uniform = MapUniform(Read<int>());
+		unsigned int count = Read<unsigned int>();
+		ReadArray(count * 16, floatScratch);
+		count = floatScratch.GetCount() / 16;
+
+		StartTiming();
+		device->SetUniformMat4x4f(uniform, count, floatScratch.GetData());
+		EndTiming(call);
+		break;
+	}
+
+	case Call::SetUniformVec4f:
+	{
+		int uniform = MapUniform(Read<int>());
+		unsigned int count = Read<unsigned int>();
+		ReadArray(count * 4, floatScratch);
+		count = floatScratch.GetCount() / 4;
+
+		StartTiming();
+		device->SetUniformVec4f(uniform, count, floatScratch.GetData());
+		EndTiming(call);
+		break;
+	}
+
+	case Call::SetUniformVec3f:
+	{
+		int uniform = MapUniform(Read<int>());
+		unsigned int count = Read<unsigned int>();
+		ReadArray(count * 3, floatScratch);
+		count = floatScratch.GetCount() / 3;
+
+		StartTiming();
+		device->SetUniformVec3f(uniform, count, floatScratch.GetData());
+		EndTiming(call);
+		break;
+	}
+
+	case Call::SetUniformVec2f:
+	{
+		int uniform = MapUniform(Read<int>());
+		unsigned int count = Read<unsigned int>();
+		ReadArray(count * 2, floatScratch);
+		count = floatScratch.GetCount() / 2;
+
+		StartTiming();
+		device->SetUniformVec2f(uniform, count, floatScratch.GetData());
+		EndTiming(call);
+		break;
+	}
+
+	case Call::SetUniformFloat:
+	{
+		int uniform = MapUniform(Read<int>());
+		float value = Read<float>();
+
+		StartTiming();
+		device->SetUniformFloat(uniform, value);
+		EndTiming(call);
+		break;
+	}
+
+	case Call::SetUniformInt:
+	{
+		int uniform = MapUniform(Read<int>());
+		int value = Read<int>();
+
+		StartTiming();
+		device->SetUniformInt(uniform, value);
+		EndTiming(call);
+		break;
+	}
+
+	case Call::CreateVertexArrays:
+	{
+		unsigned int count = Read<unsigned int>();
+		ReadArray(count, objectScratch);
+		count = objectScratch.GetCount();
+		createdObjectScratch.Resize(count);
+
+		StartTiming();
+		device->CreateVertexArrays(count, createdObjectScratch.GetData());
+		EndTiming(call);
+
+		AddObjects(vertexArrays, count, objectScratch.GetData(), createdObjectScratch.GetData());
+		break;
+	}
+
+	case Call::DestroyVertexArrays:
+	{
+		unsigned int count = Read<unsigned int>();
+		ReadArray(count, objectScratch);
+		count = objectScratch.GetCount();
+		RemoveObjects(vertexArrays, count, objectScratch.GetData());
+
+		StartTiming();
+		device->DestroyVertexArrays(count, objectScratch.GetData());
+		EndTiming(call);
+		break;
+	}
+
+	case Call::BindVertexArray:
+	{
+		unsigned int vertexArrayId = MapObject(vertexArrays, Read<unsigned int>());
+
+		StartTiming();
+		device->BindVertexArray(vertexArrayId);
+		EndTiming(call);
+		break;
+	}
+
+	case Call::EnableVertexAttribute:
+	{
+		unsigned int index = Read<unsigned int>();
+
+		StartTiming();
+		device->EnableVertexAttribute(index);
+		EndTiming(call);
+		break;
+	}
+
+	case Call::SetVertexAttributePointer:
+	{
+		RenderCommandData::SetVertexAttributePointer data = Read<RenderCommandData::SetVertexAttributePointer>();
+
+		StartTiming();
+		device->SetVertexAttributePointer(&data);
+		EndTiming(call);
+		break;
+	}
+
+	case Call::Draw:
+	{
+		RenderPrimitiveMode mode = Read<RenderPrimitiveMode>();
+		int offset = Read<int>();
+		int vertexCount = Read<int>();
+
+		StartTiming();
+		device->Draw(mode, offset, vertexCount);
+		EndTiming(call);
+		break;
+	}
+
+	case Call::DrawIndexed:
+	{
+		RenderPrimitiveMode mode = Read<RenderPrimitiveMode>();
+		int indexCount = Read<int>();
+		RenderIndexType indexType = Read<RenderIndexType>();
+
+		StartTiming();
+		device->DrawIndexed(mode, indexCount, indexType);
+		EndTiming(call);
+		break;
+	}
+
+	case Call::DrawInstanced:
+	{
+		RenderPrimitiveMode mode = Read<RenderPrimitiveMode>();
+		int offset = Read<int>();
+		int vertexCount = Read<int>();
+		int instanceCount = Read<int>();
+
+		StartTiming();
+		device->DrawInstanced(mode, offset, vertexCount, instanceCount);
+		EndTiming(call);
+		break;
+	}
+
+	case Call::DrawIndexedInstanced:
+	{
+		RenderPrimitiveMode mode = Read<RenderPrimitiveMode>();
+		int indexCount = Read<int>();
+		RenderIndexType indexType = Read<RenderIndexType>();
+		int instanceCount = Read<int>();
+
+		StartTiming();
+		device->DrawIndexedInstanced(mode, indexCount, indexType, instanceCount);
+		EndTiming(call);
+		break;
+	}
+
+	case Call::DrawIndexedInstancedBaseInstance:
+	{
+		RenderPrimitiveMode mode = Read<RenderPrimitiveMode>();
+		int indexCount = Read<int>();
+		RenderIndexType indexType = Read<RenderIndexType>();
+		int instanceCount = Read<int>();
+		unsigned int baseInstance = Read<unsigned int>();
+
+		StartTiming();
+		device->DrawIndexedInstancedBaseInstance(mode, indexCount, indexType, instanceCount, baseInstance);
+		EndTiming(call);
+		break;
+	}
+
+	case Call::MultiDrawIndexedIndirect:
+	{
+		RenderPrimitiveMode mode = Read<RenderPrimitiveMode>();
+		RenderIndexType indexType = Read<RenderIndexType>();
+		intptr_t offset = Read<intptr_t>();
+		int drawCount = Read<int>();
+		int stride = Read<int>();
+
+		StartTiming();
+		device->MultiDrawIndexedIndirect(mode, indexType, offset, drawCount, stride);
+		EndTiming(call);
+		break;
+	}
+
+	case Call::CreateBuffers:
+	{
+		unsigned int count = Read<unsigned int>();
+		ReadArray(count, objectScratch);
+		count = objectScratch.GetCount();
+		createdObjectScratch.Resize(count);
+
+		StartTiming();
+		device->CreateBuffers(count, createdObjectScratch.GetData());
+		EndTiming(call);
+
+		AddObjects(buffers, count, objectScratch.GetData(), createdObjectScratch.GetData());
+		break;
+	}
+
+	case Call::DestroyBuffers:
+	{
+		unsigned int count = Read<unsigned int>();
+		ReadArray(count, objectScratch);
+		count = objectScratch.GetCount();
+		RemoveObjects(buffers, count, objectScratch.GetData());
+
+		StartTiming();
+		device->DestroyBuffers(count, objectScratch.GetData());
+		EndTiming(call);
+		break;
+	}
+
+	case Call::BindBuffer:
+	{
+		RenderBufferTarget target = Read<RenderBufferTarget>();
+		unsigned int recordedBuffer = Read<unsigned int>();
+		unsigned int buffer = MapObject(buffers, recordedBuffer);
+		boundBuffers[static_cast<size_t>(target)] = recordedBuffer;
+
+		StartTiming();
+		device->BindBuffer(target, buffer);
+		EndTiming(call);
+		break;
+	}
+
+	case Call::BindBufferBase:
+	{
+		RenderBufferTarget target = Read<RenderBufferTarget>();
+		unsigned int bindingPoint = Read<unsigned int>();
+		unsigned int recordedBuffer = Read<unsigned int>();
+		unsigned int buffer = MapObject(buffers, recordedBuffer);
+		boundBuffers[static_cast<size_t>(target)] = recordedBuffer;
+
+		StartTiming();
+		device->BindBufferBase(target, bindingPoint, buffer);
+		EndTiming(call);
+		break;
+	}
+
+	case Call::BindBufferRange:
+	{
+		RenderCommandData::BindBufferRange data = Read<RenderCommandData::BindBufferRange>();
+		boundBuffers[static_cast<size_t>(data.target)] = data.buffer;
+		data.buffer = MapObject(buffers, data.buffer);
+
+		StartTiming();
+		device->BindBufferRange(&data);
+		EndTiming(call);
+		break;
+	}
+
+	case Call::SetBufferStorage:
+	{
+		RenderCommandData::SetBufferStorage data = Read<RenderCommandData::SetBufferStorage>();
+		size_t size = 0;
+		data.data = ReadPayload(size);
+
+		StartTiming();
+		device->SetBufferStorage(&data);
+		EndTiming(call);
+		break;
+	}
+
+	case Call::SetBufferData:
+	{
+		RenderBufferTarget target = Read<RenderBufferTarget>();
+		unsigned int size = Read<unsigned int>();
+		RenderBufferUsage usage = Read<RenderBufferUsage>();
+		size_t dataSize = 0;
+		const void* data = ReadPayload(dataSize);
+
+		StartTiming();
+		device->SetBufferData(target, size, data, usage);
+		EndTiming(call);
+		break;
+	}
+
+	case Call::SetBufferSubData:
+	{
+		RenderBufferTarget target = Read<RenderBufferTarget>();
+		unsigned int offset = Read<unsigned int>();
+		unsigned int size = Read<unsigned int>();
+		size_t dataSize = 0;
+		const void* data = ReadPayload(dataSize);
+
+		if (data == nullptr || dataSize < size)
+			break;
+
+		StartTiming();
+		device->SetBufferSubData(target, offset, size, data);
+		EndTiming(call);
+		break;
+	}
+
+	case Call::MapBuffer:
+	{
+		RenderBufferTarget target = Read<RenderBufferTarget>();
+		RenderBufferAccess access = Read<RenderBufferAccess>();
+
+		StartTiming();
+		void* mapped = device->MapBuffer(target, access);
+		EndTiming(call);
+
+		SetMapping(target, mapped, 0, SIZE_MAX);
+		break;
+	}
+
+	case Call::MapBufferRange:
+	{
+		RenderCommandData::MapBufferRange data = Read<RenderCommandData::MapBufferRange>();
+
+		StartTiming();
+		void* mapped = device->MapBufferRange(&data);
+		EndTiming(call);
+
+		SetMapping(data.target, mapped, data.offset, data.length);
+		break;
+	}
+
+	case Call::UnmapBuffer:
+	{
+		RenderBufferTarget target = Read<RenderBufferTarget>();
+
+		StartTiming();
+		device->UnmapBuffer(target);
+		EndTiming(call);
+
+		SetMapping(target, nullptr, 0, 0);
+		break;
+	}
+
+	case Call::DispatchCompute:
+	{
+		unsigned int numGroupsX = Read<unsigned int>();
+		unsigned int numGroupsY = Read<unsigned int>();
+		unsigned int numGroupsZ = Read<unsigned int>();
+
+		StartTiming();
+		device->DispatchCompute(numGroupsX, numGroupsY, numGroupsZ);
+		EndTiming(call);
+		break;
+	}
+
+	case Call::MemoryBarrier:
+	{
+		RenderCommandData::MemoryBarrier barrier = Read<RenderCommandData::MemoryBarrier>();
+
+		StartTiming();
+		device->MemoryBarrier(barrier);
+		EndTiming(call);
+		break;
+	}
+
+	case Call::FenceSync:
+	{
+		uint64_t recordedSync = Read<uint64_t>();
+
+		StartTiming();
+		RenderSyncObject sync = device->FenceSync();
+		EndTiming(call);
+
+		AddSync(recordedSync, sync);
+		break;
+	}
+
+	case Call::ClientWaitSync:
+	{
+		RenderSyncObject sync = FindSync(Read<uint64_t>());
+		bool flushCommands = Read<bool>();
+		uint64_t timeoutNanoseconds = Read<uint64_t>();
+
+		if (sync == nullptr)
+			break;
+
+		// The recording device may have reported the fence as signaled right
+		// away, so the recorded wait can be a poll that the commands after it
+		// rely on. Block until the fence is actually signaled, like
+		// PersistentRingBuffer does.
+		StartTiming();
+		RenderSyncWaitResult result = device->ClientWaitSync(sync, flushCommands, timeoutNanoseconds);
+
+		while (result == RenderSyncWaitResult::TimeoutExpired)
+		{
+			const uint64_t timeout = 100 * 1000 * 1000; // 100 ms
+			result = device->ClientWaitSync(sync, true, timeout);
+		}
+
+		EndTiming(call);
+		break;
+	}
+
+	case Call::DeleteSync:
+	{
+		uint64_t recordedSync = Read<uint64_t>();
+		RenderSyncObject sync = FindSync(recordedSync);
+
+		if (sync == nullptr)
+			break;
+
+		StartTiming();
+		device->DeleteSync(sync);
+		EndTiming(call);
+
+		RemoveSync(recordedSync);
+		break;
+	}
+
+	case Call::WriteMappedBuffer:
+	{
+		unsigned int buffer = Read<unsigned int>();
+		uint64_t offset = Read<uint64_t>();
+		size_t size = 0;
+		const void* data = ReadPayload(size);
+
+		HashMap<unsigned int, MappedBuffer>::KeyValuePair* pair = mappedBuffers.Lookup(buffer);
+		if (pair == nullptr || data == nullptr)
+			break;
+
+		const MappedBuffer& mapping = pair->second;
+		if (offset < mapping.offset || offset + size > mapping.offset + mapping.length)
+			break;
+
+		StartTiming();
+		std::memcpy(mapping.data + (offset - mapping.offset), data, size);
+		EndTiming(call);
+		break;
+	}
+
+	default:
+		malformed = true;
+		break;
+	}
+}
@@ -0,0 +1,172 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "Core/Array.hpp"
+#include "Core/HashMap.hpp"
+
+#include "Debug/PerformanceTimer.hpp"
+
+#include "Rendering/RenderDeviceRecorder.hpp"
+
+class Allocator;
+
+/**
+ * Executes a command stream recorded by RenderDeviceRecorder on another
+ * RenderDevice. Objects created by the stream are mapped to the objects the
+ * device creates, so the same stream can be replayed any number of times.
+ * Fence waits block until the fence is signaled, whatever the recording
+ * device reported.
+ *
+ * The CPU time of each device call is measured and summed by call category.
+ */
+class RenderCaptureReplayer
+{
+public:
+	using Call = RenderDeviceRecorder::Call;
+
+	enum class Category
+	{
+		Debug,
+		State,
+		Bind,
+		Resource,
+		Upload,
+		Shader,
+		Query,
+		Uniform,
+		Draw,
+		Sync,
+
+		Count
+	};
+
+	struct CategoryStats
+	{
+		unsigned int callCount;
+		uint64_t nanoseconds;
+	};
+
+private:
+	using ObjectMap = HashMap<unsigned int, unsigned int>;
+
+	static const unsigned int BufferTargetCount = 5;
+
+	struct MappedBuffer
+	{
+		uint8_t* data;
+		size_t offset;
+		size_t length;
+	};
+
+	struct SyncPair
+	{
+		uint64_t recorded;
+		RenderSyncObject sync;
+	};
+
+	RenderDevice* device;
+
+	// Maps from the object IDs in the stream to the object IDs of the device
+	ObjectMap framebuffers;
+	ObjectMap textures;
+	ObjectMap samplers;
+	ObjectMap shaderPrograms;
+	ObjectMap shaderStages;
+	ObjectMap vertexArrays;
+	ObjectMap buffers;
+
+	// Uniform locations by program and recorded location
+	HashMap<uint32_t, int> uniformLocations;
+	unsigned int currentProgram;
+
+	// Mapped buffers by recorded buffer ID
+	HashMap<unsigned int, MappedBuffer> mappedBuffers;
+	unsigned int boundBuffers[BufferTargetCount];
+
+	Array<SyncPair> syncs;
+
+	Array<unsigned int> objectScratch;
+	Array<unsigned int> createdObjectScratch;
+	Array<float> floatScratch;
+	Array<RenderFramebufferAttachment> drawBufferScratch;
+
+	const uint8_t* readPosition;
+	const uint8_t* readEnd;
+	bool malformed;
+
+	bool timingEnabled;
+	PerformanceTimer timer;
+	CategoryStats categoryStats[static_cast<size_t>(Category::Count)];
+
+	void Execute(Call call);
+
+	void StartTiming()
+	{
+		if (timingEnabled)
+			timer.Restart();
+	}
+
+	void EndTiming(Call call);
+
+	// Returns null if the command doesn't have enough data left
+	const uint8_t* Take(size_t size);
+
+	template <typename T>
+	T Read()
+	{
+		T value{};
+		if (const uint8_t* data = Take(sizeof(T)))
+			std::memcpy(&value, data, sizeof(T));
+		return value;
+	}
+
+	const char* ReadString(size_t length);
+	const void* ReadPayload(size_t& sizeOut);
+
+	// Copies the array to aligned memory, or leaves it empty if the data is missing
+	template <typename T>
+	void ReadArray(unsigned int count, Array<T>& arrayOut)
+	{
+		const uint8_t* data = Take(sizeof(T) * count);
+		arrayOut.Resize(data != nullptr ? count : 0);
+		if (data != nullptr)
+			std::memcpy(arrayOut.GetData(), data, sizeof(T) * count);
+	}
+
+	ObjectMap* GetObjectMap(RenderObjectType type);
+	unsigned int MapObject(ObjectMap& map, unsigned int recorded);
+	void AddObjects(ObjectMap& map, unsigned int count, const unsigned int* recorded, const unsigned int* created);
+	void RemoveObjects(ObjectMap& map, unsigned int count, const unsigned int* recorded);
+
+	static uint32_t GetUniformKey(unsigned int program, int recordedLocation);
+	int MapUniform(int recordedLocation);
+
+	void SetMapping(RenderBufferTarget target, void* mapped, size_t offset, size_t length);
+
+	void AddSync(uint64_t recorded, RenderSyncObject sync);
+	RenderSyncObject FindSync(uint64_t recorded);
+	void RemoveSync(uint64_t recorded);
+
+public:
+	RenderCaptureReplayer(Allocator* allocator, RenderDevice* device);
+
+	// Returns false if the stream ends in the middle of a command or has unknown commands
+	bool Replay(const uint8_t* commands, size_t size);
+
+	const CategoryStats& GetCategoryStats(Category category) const
+	{
+		return categoryStats[static_cast<size_t>(category)];
+	}
+
+	void ResetCategoryStats();
+
+	// Measuring every call has a cost, so it can be turned off when only the
+	// commands are needed
+	void SetTimingEnabled(bool enable) { timingEnabled = enable; }
+
+	static Category GetCallCategory(Call call);
+	static const char* GetCategoryName(Category category);
+};
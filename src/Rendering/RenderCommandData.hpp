@@ -122,6 +122,16 @@ namespace RenderCommandData
 		std::uintptr_t offset;
 	};
 
+	// Layout of a command in a RenderBufferTarget::DrawIndirectBuffer
+	struct DrawIndexedIndirectCommand
+	{
+		unsigned int count;
+		unsigned int instanceCount;
+		unsigned int firstIndex;
+		int baseVertex;
+		unsigned int baseInstance;
+	};
+
 	struct BindBufferRange
 	{
 		RenderBufferTarget target;
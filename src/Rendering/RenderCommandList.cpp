@@ -59,8 +59,18 @@ void RenderCommandList::AddDraw(
 	RenderPass pass,
 	float depth,
 	MaterialId material,
+	MeshId mesh,
 	unsigned int renderObjectId)
 {
+	// The largest material ID would be mistaken for a callback draw, and
+	// larger IDs would be truncated into another material. Rejected draws
+	// are counted, so that the renderer can report them.
+	if (material.i >= RenderOrderConfiguration::CallbackMaterialId)
+	{
+		rejectedDrawCount += 1;
+		return;
+	}
+
 	depth = (depth > 1.0f ? 1.0f : (depth < 0.0f ? 0.0f : depth));
 
 	uint64_t intpass = static_cast<uint64_t>(pass);
@@ -70,19 +80,7 @@ void RenderCommandList::AddDraw(
 	renderOrder.viewportIndex.AssignValue(c, viewport);
 	renderOrder.viewportPass.AssignValue(c, intpass);
 	renderOrder.command.AssignValue(c, static_cast<uint64_t>(RenderCommandType::Draw));
-
-	if ((0xfc & intpass) != 0) // Is greater than 0x03; must be transparent
-	{
-		uint64_t intDepth(renderOrder.maxTransparentDepth * (1.0f - depth));
-		renderOrder.transparentDepth.AssignValue(c, intDepth);
-	}
-	else
-	{
-		uint64_t intDepth(renderOrder.maxOpaqueDepth * depth);
-		renderOrder.opaqueDepth.AssignValue(c, intDepth);
-	}
-
-	renderOrder.materialId.AssignValue(c, material.i);
+	renderOrder.AssignDraw(c, intpass, depth, material.i, mesh.i);
 	renderOrder.renderObject.AssignValue(c, renderObjectId);
 
 	commands.PushBack(c);
@@ -99,19 +97,7 @@ void RenderCommandList::AddDrawWithCallback(unsigned int viewport, RenderPass pa
 	renderOrder.viewportIndex.AssignValue(c, viewport);
 	renderOrder.viewportPass.AssignValue(c, intpass);
 	renderOrder.command.AssignValue(c, static_cast<uint64_t>(RenderCommandType::Draw));
-
-	if ((0xfc & intpass) != 0) // Is greater than 0x03; must be transparent
-	{
-		uint64_t intDepth(renderOrder.maxTransparentDepth * (1.0f - depth));
-		renderOrder.transparentDepth.AssignValue(c, intDepth);
-	}
-	else
-	{
-		uint64_t intDepth(renderOrder.maxOpaqueDepth * depth);
-		renderOrder.opaqueDepth.AssignValue(c, intDepth);
-	}
-
-	renderOrder.materialId.AssignValue(c, RenderOrderConfiguration::CallbackMaterialId);
+	renderOrder.AssignDraw(c, intpass, depth, RenderOrderConfiguration::CallbackMaterialId, 0);
 	renderOrder.renderObject.AssignValue(c, callbackIndex);
 
 	commands.PushBack(c);
@@ -119,11 +105,15 @@ void RenderCommandList::AddDrawWithCallback(unsigned int viewport, RenderPass pa
 
 void RenderCommandList::Sort()
 {
-	ShellSortAsc(commands.GetData(), commands.GetCount());
+	unsigned int count = commands.GetCount();
+	sortScratch.Resize(count);
+
+	RadixSortAsc(commands.GetData(), sortScratch.GetData(), count);
 }
 
 void RenderCommandList::Clear()
 {
 	commands.Clear();
 	commandData.Clear();
+	rejectedDrawCount = 0;
 }
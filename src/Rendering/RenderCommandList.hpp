@@ -3,6 +3,7 @@
 #include "Core/Array.hpp"
 
 #include "Resources/MaterialData.hpp"
+#include "Resources/MeshData.hpp"
 
 #include "Rendering/RenderOrder.hpp"
 #include "Rendering/RenderCommandType.hpp"
@@ -13,7 +14,9 @@ struct RenderCommandList
 {
 	RenderCommandList(Allocator* allocator) :
 		commands(allocator),
-		commandData(allocator)
+		commandData(allocator),
+		sortScratch(allocator),
+		rejectedDrawCount(0)
 	{
 	}
 
@@ -22,6 +25,13 @@ struct RenderCommandList
 	Array<uint64_t> commands;
 	Array<uint8_t> commandData;
 
+	// Reused between frames as the radix sort scratch buffer
+	Array<uint64_t> sortScratch;
+
+	// Draws that AddDraw skipped since the last Clear, because their
+	// material ID doesn't fit in the sort key
+	unsigned int rejectedDrawCount;
+
 	void AddControl(
 		unsigned int viewport,
 		RenderPass pass,
@@ -42,6 +52,7 @@ struct RenderCommandList
 		RenderPass pass,
 		float depth,
 		MaterialId material,
+		MeshId mesh,
 		unsigned int objIndex);
 
 	void AddDrawWithCallback(
@@ -5,6 +5,9 @@
 #include "Rendering/RenderCommandData.hpp"
 #include "Rendering/RenderDeviceEnums.hpp"
 
+// Opaque handle to a fence sync object created by RenderDevice::FenceSync
+using RenderSyncObject = void*;
+
 class RenderDevice
 {
 public:
@@ -126,6 +129,13 @@ public:
 	virtual void DrawIndexed(RenderPrimitiveMode mode, int indexCount, RenderIndexType indexType) = 0;
 	virtual void DrawInstanced(RenderPrimitiveMode mode, int offset, int vertexCount, int instanceCount) = 0;
 	virtual void DrawIndexedInstanced(RenderPrimitiveMode mode, int indexCount, RenderIndexType indexType, int instanceCount) = 0;
+	virtual void DrawIndexedInstancedBaseInstance(RenderPrimitiveMode mode, int indexCount, RenderIndexType indexType,
+		int instanceCount, unsigned int baseInstance) = 0;
+
+	// Draw commands read from the buffer bound to RenderBufferTarget::DrawIndirectBuffer,
+	// stored as RenderCommandData::DrawIndexedIndirectCommand starting at byte <offset>
+	virtual void MultiDrawIndexedIndirect(RenderPrimitiveMode mode, RenderIndexType indexType,
+		intptr_t offset, int drawCount, int stride) = 0;
 
 	virtual void CreateBuffers(unsigned int count, unsigned int* buffersOut) = 0;
 	virtual void DestroyBuffers(unsigned int count, unsigned int* buffers) = 0;
@@ -142,4 +152,9 @@ public:
 	virtual void DispatchCompute(unsigned int numGroupsX, unsigned int numGroupsY, unsigned int numGroupsZ) = 0;
 
 	virtual void MemoryBarrier(const RenderCommandData::MemoryBarrier& barrier) = 0;
+
+	// Fence that is signaled once all previously issued commands have completed
+	virtual RenderSyncObject FenceSync() = 0;
+	virtual RenderSyncWaitResult ClientWaitSync(RenderSyncObject sync, bool flushCommands, uint64_t timeoutNanoseconds) = 0;
+	virtual void DeleteSync(RenderSyncObject sync) = 0;
 };
@@ -3,7 +3,8 @@
 enum class RenderDeviceParameter
 {
 	MaxUniformBlockSize,
-	UniformBufferOffsetAlignment
+	UniformBufferOffsetAlignment,
+	ShaderStorageBufferOffsetAlignment
 };
 
 enum class RenderDebugSource
@@ -83,6 +84,15 @@ enum class RenderBufferTarget
 	IndexBuffer,
 	UniformBuffer,
 	ShaderStorageBuffer,
+	DrawIndirectBuffer,
+};
+
+enum class RenderSyncWaitResult
+{
+	AlreadySignaled,
+	ConditionSatisfied,
+	TimeoutExpired,
+	WaitFailed
 };
 
 enum class RenderBufferAccess
@@ -8,6 +8,7 @@ static unsigned int ConvertDeviceParameter(RenderDeviceParameter parameter)
 	{
 	case RenderDeviceParameter::MaxUniformBlockSize: return GL_MAX_UNIFORM_BLOCK_SIZE;
 	case RenderDeviceParameter::UniformBufferOffsetAlignment: return GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT;
+	case RenderDeviceParameter::ShaderStorageBufferOffsetAlignment: return GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT;
 	default: return 0;
 	}
 }
@@ -57,6 +58,7 @@ static unsigned int ConvertBufferTarget(RenderBufferTarget target)
 	case RenderBufferTarget::IndexBuffer: return GL_ELEMENT_ARRAY_BUFFER;
 	case RenderBufferTarget::UniformBuffer: return GL_UNIFORM_BUFFER;
 	case RenderBufferTarget::ShaderStorageBuffer: return GL_SHADER_STORAGE_BUFFER;
+	case RenderBufferTarget::DrawIndirectBuffer: return GL_DRAW_INDIRECT_BUFFER;
 	default: return 0;
 	}
 }
@@ -357,6 +359,17 @@ static RenderDebugSeverity ConvertDebugSeverity(GLenum severity)
 	}
 }
 
+static RenderSyncWaitResult ConvertSyncWaitResult(GLenum result)
+{
+	switch (result)
+	{
+	case GL_ALREADY_SIGNALED: return RenderSyncWaitResult::AlreadySignaled;
+	case GL_CONDITION_SATISFIED: return RenderSyncWaitResult::ConditionSatisfied;
+	case GL_TIMEOUT_EXPIRED: return RenderSyncWaitResult::TimeoutExpired;
+	default: return RenderSyncWaitResult::WaitFailed;
+	}
+}
+
 static unsigned int ConvertObjectType(RenderObjectType type)
 {
 	switch (type)
@@ -879,6 +892,20 @@ void RenderDeviceOpenGL::DrawIndexedInstanced(RenderPrimitiveMode mode, int inde
 	glDrawElementsInstanced(ConvertPrimitiveMode(mode), indexCount, ConvertIndexType(indexType), nullptr, instanceCount);
 }
 
+void RenderDeviceOpenGL::DrawIndexedInstancedBaseInstance(RenderPrimitiveMode mode, int indexCount, RenderIndexType indexType,
+	int instanceCount, unsigned int baseInstance)
+{
+	glDrawElementsInstancedBaseInstance(ConvertPrimitiveMode(mode), indexCount, ConvertIndexType(indexType),
+		nullptr, instanceCount, baseInstance);
+}
+
+void RenderDeviceOpenGL::MultiDrawIndexedIndirect(RenderPrimitiveMode mode, RenderIndexType indexType,
+	intptr_t offset, int drawCount, int stride)
+{
+	glMultiDrawElementsIndirect(ConvertPrimitiveMode(mode), ConvertIndexType(indexType),
+		reinterpret_cast<const void*>(offset), drawCount, stride);
+}
+
 void RenderDeviceOpenGL::CreateBuffers(unsigned int count, unsigned int* buffersOut)
 {
 	glGenBuffers(count, buffersOut);
@@ -977,3 +1004,21 @@ void RenderDeviceOpenGL::MemoryBarrier(const RenderCommandData::MemoryBarrier& b
 
 	glMemoryBarrier(bits);
 }
+
+RenderSyncObject RenderDeviceOpenGL::FenceSync()
+{
+	return glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+RenderSyncWaitResult RenderDeviceOpenGL::ClientWaitSync(RenderSyncObject sync, bool flushCommands, uint64_t timeoutNanoseconds)
+{
+	GLbitfield flags = flushCommands ? GL_SYNC_FLUSH_COMMANDS_BIT : 0;
+	GLenum result = glClientWaitSync(static_cast<GLsync>(sync), flags, timeoutNanoseconds);
+
+	return ConvertSyncWaitResult(result);
+}
+
+void RenderDeviceOpenGL::DeleteSync(RenderSyncObject sync)
+{
+	glDeleteSync(static_cast<GLsync>(sync));
+}
@@ -121,6 +121,10 @@ public:
 	virtual void DrawIndexed(RenderPrimitiveMode mode, int indexCount, RenderIndexType indexType) override;
 	virtual void DrawInstanced(RenderPrimitiveMode mode, int offset, int vertexCount, int instanceCount) override;
 	virtual void DrawIndexedInstanced(RenderPrimitiveMode mode, int indexCount, RenderIndexType indexType, int instanceCount) override;
+	virtual void DrawIndexedInstancedBaseInstance(RenderPrimitiveMode mode, int indexCount, RenderIndexType indexType,
+		int instanceCount, unsigned int baseInstance) override;
+	virtual void MultiDrawIndexedIndirect(RenderPrimitiveMode mode, RenderIndexType indexType,
+		intptr_t offset, int drawCount, int stride) override;
 
 	virtual void CreateBuffers(unsigned int count, unsigned int* buffersOut) override;
 	virtual void DestroyBuffers(unsigned int count, unsigned int* buffers) override;
@@ -137,4 +141,8 @@ public:
 	virtual void DispatchCompute(unsigned int numGroupsX, unsigned int numGroupsY, unsigned int numGroupsZ) override;
 
 	virtual void MemoryBarrier(const RenderCommandData::MemoryBarrier& barrier) override;
+
+	virtual RenderSyncObject FenceSync() override;
+	virtual RenderSyncWaitResult ClientWaitSync(RenderSyncObject sync, bool flushCommands, uint64_t timeoutNanoseconds) override;
+	virtual void DeleteSync(RenderSyncObject sync) override;
 };
@@ -0,0 +1,1681 @@
+#include "Rendering/RenderDeviceRecorder.hpp"
+
+#include <cassert>
+#include <cstring>
+
+#include "Memory/Allocator.hpp"
+
+#include "System/IncludeOpenGL.hpp"
+
+static const char* const CallNames[] = {
+	"GetIntegerValue",
+	"SetDebugMessageCallback",
+	"SetObjectLabel",
+	"SetObjectPtrLabel",
+	"PushDebugGroup",
+	"PopDebugGroup",
+	"Clear",
+	"ClearColor",
+	"ClearDepth",
+	"BlendingEnable",
+	"BlendingDisable",
+	"BlendFunction",
+	"SetClipBehavior",
+	"DepthRange",
+	"Viewport",
+	"DepthTestEnable",
+	"DepthTestDisable",
+	"DepthTestFunction",
+	"DepthWriteEnable",
+	"DepthWriteDisable",
+	"CullFaceEnable",
+	"CullFaceDisable",
+	"CullFaceFront",
+	"CullFaceBack",
+	"FramebufferSrgbEnable",
+	"FramebufferSrgbDisable",
+	"CreateFramebuffers",
+	"DestroyFramebuffers",
+	"BindFramebuffer",
+	"AttachFramebufferTexture2D",
+	"SetFramebufferDrawBuffers",
+	"CreateTextures",
+	"DestroyTextures",
+	"BindTexture",
+	"SetTextureStorage2D",
+	"SetTextureImage2D",
+	"SetTextureSubImage2D",
+	"SetTextureImageCompressed2D",
+	"GenerateTextureMipmaps",
+	"SetActiveTextureUnit",
+	"SetTextureParameterInt",
+	"SetTextureMinFilter",
+	"SetTextureMagFilter",
+	"SetTextureWrapModeU",
+	"SetTextureWrapModeV",
+	"SetTextureWrapModeW",
+	"SetTextureCompareMode",
+	"SetTextureCompareFunc",
+	"CreateSamplers",
+	"DestroySamplers",
+	"BindSampler",
+	"SetSamplerParameters",
+	"CreateShaderProgram",
+	"DestroyShaderProgram",
+	"AttachShaderStageToProgram",
+	"LinkShaderProgram",
+	"UseShaderProgram",
+	"GetShaderProgramParameterInt",
+	"GetShaderProgramLinkStatus",
+	"GetShaderProgramInfoLogLength",
+	"GetShaderProgramInfoLog",
+	"CreateShaderStage",
+	"DestroyShaderStage",
+	"SetShaderStageSource",
+	"CompileShaderStage",
+	"GetShaderStageParameterInt",
+	"GetShaderStageCompileStatus",
+	"GetShaderStageInfoLogLength",
+	"GetShaderStageInfoLog",
+	"GetUniformLocation",
+	"SetUniformMat4x4f",
+	"SetUniformVec4f",
+	"SetUniformVec3f",
+	"SetUniformVec2f",
+	"SetUniformFloat",
+	"SetUniformInt",
+	"CreateVertexArrays",
+	"DestroyVertexArrays",
+	"BindVertexArray",
+	"EnableVertexAttribute",
+	"SetVertexAttributePointer",
+	"Draw",
+	"DrawIndexed",
+	"DrawInstanced",
+	"DrawIndexedInstanced",
+	"DrawIndexedInstancedBaseInstance",
+	"MultiDrawIndexedIndirect",
+	"CreateBuffers",
+	"DestroyBuffers",
+	"BindBuffer",
+	"BindBufferBase",
+	"BindBufferRange",
+	"SetBufferStorage",
+	"SetBufferData",
+	"SetBufferSubData",
+	"MapBuffer",
+	"MapBufferRange",
+	"UnmapBuffer",
+	"DispatchCompute",
+	"MemoryBarrier",
+	"FenceSync",
+	"ClientWaitSync",
+	"DeleteSync",
+	"WriteMappedBuffer"
+};
+
+static_assert(sizeof(CallNames) / sizeof(CallNames[0]) == static_cast<size_t>(RenderDeviceRecorder::Call::Count),
+	"Every call must have a name");
+
+// Size of the pixel data OpenGL reads, with rows aligned to the default
+// GL_UNPACK_ALIGNMENT of 4 bytes
+static size_t GetAlignedImageSize(int width, int height, size_t pixelSize)
+{
+	if (width <= 0 || height <= 0)
+		return 0;
+
+	const size_t alignment = 4;
+	size_t rowSize = pixelSize * width;
+	size_t rowStride = (rowSize + alignment - 1) / alignment * alignment;
+
+	return rowStride * (height - 1) + rowSize;
+}
+
+// SetTextureImage2D takes OpenGL pixel formats and data types. Returns zero
+// for unknown formats, so that no pixel data is read.
+static size_t GetImageDataSize(int width, int height, unsigned int format, unsigned int type)
+{
+	size_t components;
+	switch (format)
+	{
+	case GL_RED: case GL_GREEN: case GL_BLUE: case GL_ALPHA:
+	case GL_RED_INTEGER: case GL_GREEN_INTEGER: case GL_BLUE_INTEGER:
+	case GL_DEPTH_COMPONENT: case GL_STENCIL_INDEX:
+		components = 1;
+		break;
+
+	// Only valid with packed data types, which set the size of the whole pixel
+	case GL_DEPTH_STENCIL:
+		components = 1;
+		break;
+
+	case GL_RG: case GL_RG_INTEGER:
+		components = 2;
+		break;
+
+	case GL_RGB: case GL_BGR: case GL_RGB_INTEGER: case GL_BGR_INTEGER:
+		components = 3;
+		break;
+
+	case GL_RGBA: case GL_BGRA: case GL_RGBA_INTEGER: case GL_BGRA_INTEGER:
+		components = 4;
+		break;
+
+	default:
+		assert(false && "Unknown pixel format");
+		return 0;
+	}
+
+	size_t pixelSize;
+	switch (type)
+	{
+	case GL_UNSIGNED_BYTE: case GL_BYTE:
+		pixelSize = components * 1;
+		break;
+
+	case GL_UNSIGNED_SHORT: case GL_SHORT: case GL_HALF_FLOAT:
+		pixelSize = components * 2;
+		break;
+
+	case GL_UNSIGNED_INT: case GL_INT: case GL_FLOAT:
+		pixelSize = components * 4;
+		break;
+
+	// Packed types store the whole pixel in one value
+	case GL_UNSIGNED_BYTE_3_3_2: case GL_UNSIGNED_BYTE_2_3_3_REV:
+		pixelSize = 1;
+		break;
+
+	case GL_UNSIGNED_SHORT_5_6_5: case GL_UNSIGNED_SHORT_5_6_5_REV:
+	case GL_UNSIGNED_SHORT_4_4_4_4: case GL_UNSIGNED_SHORT_4_4_4_4_REV:
+	case GL_UNSIGNED_SHORT_5_5_5_1: case GL_UNSIGNED_SHORT_1_5_5_5_REV:
+		pixelSize = 2;
+		break;
+
+	case GL_UNSIGNED_INT_8_8_8_8: case GL_UNSIGNED_INT_8_8_8_8_REV:
+	case GL_UNSIGNED_INT_10_10_10_2: case GL_UNSIGNED_INT_2_10_10_10_REV:
+	case GL_UNSIGNED_INT_24_8: case GL_UNSIGNED_INT_10F_11F_11F_REV:
+	case GL_UNSIGNED_INT_5_9_9_9_REV:
+		pixelSize = 4;
+		break;
+
+	case GL_FLOAT_32_UNSIGNED_INT_24_8_REV:
+		pixelSize = 8;
+		break;
+
+	default:
+		assert(false && "Unknown pixel data type");
+		return 0;
+	}
+
+	return GetAlignedImageSize(width, height, pixelSize);
+}
+
+static size_t GetImageDataSize(int width, int height, RenderTextureBaseFormat format, RenderTextureDataType type)
+{
+	size_t components = 0;
+	switch (format)
+	{
+	case RenderTextureBaseFormat::R: components = 1; break;
+	case RenderTextureBaseFormat::RG: components = 2; break;
+	case RenderTextureBaseFormat::RGB: components = 3; break;
+	case RenderTextureBaseFormat::RGBA: components = 4; break;
+	case RenderTextureBaseFormat::Depth: components = 1; break;
+
+	// Depth and stencil are packed into one 32-bit value
+	case RenderTextureBaseFormat::DepthStencil: components = 1; break;
+	}
+
+	size_t componentSize = 0;
+	switch (type)
+	{
+	case RenderTextureDataType::UnsignedByte: case RenderTextureDataType::SignedByte: componentSize = 1; break;
+	case RenderTextureDataType::UnsignedShort: case RenderTextureDataType::SignedShort: componentSize = 2; break;
+	case RenderTextureDataType::UnsignedInt: case RenderTextureDataType::SignedInt: componentSize = 4; break;
+	case RenderTextureDataType::Float: componentSize = 4; break;
+	}
+
+	assert(components != 0 && componentSize != 0);
+
+	return GetAlignedImageSize(width, height, components * componentSize);
+}
+
+RenderDeviceRecorder::RenderDeviceRecorder(Allocator* allocator, RenderDevice* target) :
+	allocator(allocator),
+	target(target),
+	commandStream(allocator),
+	commandStart(0),
+	recording(false),
+	nextObjectId(1),
+	nextUniformLocation(0),
+	buffers(allocator)
+{
+	ResetStats();
+
+	for (unsigned int i = 0; i < BufferTargetCount; ++i)
+		boundBuffers[i] = 0;
+}
+
+RenderDeviceRecorder::~RenderDeviceRecorder()
+{
+	for (unsigned int i = 0, count = buffers.GetCount(); i < count; ++i)
+		allocator->Deallocate(buffers[i].storage);
+}
+
+void RenderDeviceRecorder::ResetStats()
+{
+	stats.bytesUploaded = 0;
+	stats.drawCalls = 0;
+	stats.drawnInstances = 0;
+
+	for (size_t i = 0; i < static_cast<size_t>(Call::Count); ++i)
+		stats.callCounts[i] = 0;
+}
+
+const char* RenderDeviceRecorder::GetCallName(Call call)
+{
+	size_t index = static_cast<size_t>(call);
+	return index < static_cast<size_t>(Call::Count) ? CallNames[index] : "";
+}
+
+void RenderDeviceRecorder::BeginCommand(Call call)
+{
+	stats.callCounts[static_cast<size_t>(call)] += 1;
+
+	if (recording)
+	{
+		commandStart = commandStream.GetCount();
+
+		CommandHeader header{ static_cast<uint32_t>(call), 0 };
+		Write(header);
+	}
+}
+
+void RenderDeviceRecorder::EndCommand()
+{
+	if (recording)
+	{
+		// Patch the argument size into the header now that it's known, the header may be unaligned
+		uint32_t size = static_cast<uint32_t>(commandStream.GetCount() - commandStart - sizeof(CommandHeader));
+		std::memcpy(commandStream.GetData() + commandStart + offsetof(CommandHeader, size), &size, sizeof(size));
+	}
+}
+
+void RenderDeviceRecorder::Write(const void* data, size_t size)
+{
+	if (recording && size > 0)
+	{
+		size_t offset = commandStream.GetCount();
+		commandStream.Resize(static_cast<unsigned int>(offset + size));
+		std::memcpy(commandStream.GetData() + offset, data, size);
+	}
+}
+
+void RenderDeviceRecorder::WritePayload(const void* data, size_t size)
+{
+	Write(static_cast<uint64_t>(size));
+	Write(data, size);
+}
+
+void RenderDeviceRecorder::CreateObjectIds(unsigned int count, unsigned int* objectsOut)
+{
+	for (unsigned int i = 0; i < count; ++i)
+		objectsOut[i] = nextObjectId++;
+}
+
+void RenderDeviceRecorder::RecordObjects(Call call, unsigned int count, const unsigned int* objects)
+{
+	BeginCommand(call);
+	Write(count);
+	Write(objects, sizeof(unsigned int) * count);
+	EndCommand();
+}
+
+void RenderDeviceRecorder::SetBoundBuffer(RenderBufferTarget target, unsigned int buffer)
+{
+	boundBuffers[static_cast<size_t>(target)] = buffer;
+}
+
+unsigned int RenderDeviceRecorder::GetBoundBuffer(RenderBufferTarget target) const
+{
+	return boundBuffers[static_cast<size_t>(target)];
+}
+
+RenderDeviceRecorder::BufferData* RenderDeviceRecorder::GetBufferData(unsigned int buffer)
+{
+	if (buffer == 0 || buffer >= buffers.GetCount())
+		return nullptr;
+
+	return &buffers[buffer];
+}
+
+void RenderDeviceRecorder::SetBufferSize(RenderBufferTarget target, size_t size)
+{
+	BufferData* buffer = GetBufferData(GetBoundBuffer(target));
+
+	if (buffer != nullptr)
+	{
+		buffer->size = size;
+
+		if (this->target == nullptr)
+		{
+			allocator->Deallocate(buffer->storage);
+			buffer->storage = static_cast<uint8_t*>(allocator->Allocate(size));
+		}
+	}
+}
+
+void RenderDeviceRecorder::SetBufferMapping(RenderBufferTarget target, void* mapped, size_t offset, size_t length,
+	bool write, bool persistent)
+{
+	BufferData* buffer = GetBufferData(GetBoundBuffer(target));
+
+	if (buffer != nullptr)
+	{
+		buffer->mapped = static_cast<uint8_t*>(mapped);
+		buffer->mappedOffset = offset;
+		buffer->mappedLength = mapped != nullptr ? length : 0;
+		buffer->mappedForWrite = write;
+		buffer->mappedPersistent = persistent;
+	}
+}
+
+const uint8_t* RenderDeviceRecorder::GetBufferContents(unsigned int buffer, size_t offset, size_t size)
+{
+	BufferData* data = GetBufferData(buffer);
+
+	if (data == nullptr || data->storage == nullptr || offset + size > data->size)
+		return nullptr;
+
+	return data->storage + offset;
+}
+
+void RenderDeviceRecorder::RecordMappedWrite(unsigned int buffer, size_t offset, size_t size, bool persistentOnly)
+{
+	BufferData* data = GetBufferData(buffer);
+
+	if (recording == false || data == nullptr || data->mapped == nullptr || data->mappedForWrite == false)
+		return;
+
+	if (persistentOnly && data->mappedPersistent == false)
+		return;
+
+	// Only the part of the range that is mapped can have been written
+	size_t mappedEnd = data->mappedOffset + data->mappedLength;
+	size_t begin = offset > data->mappedOffset ? offset : data->mappedOffset;
+	size_t end = offset + size < mappedEnd ? offset + size : mappedEnd;
+
+	if (begin >= end)
+		return;
+
+	// Reading write-mapped memory can be slow, but this only happens when recording
+	BeginCommand(Call::WriteMappedBuffer);
+	Write(buffer);
+	Write(static_cast<uint64_t>(begin));
+	WritePayload(data->mapped + (begin - data->mappedOffset), end - begin);
+	EndCommand();
+}
+
+void RenderDeviceRecorder::GetIntegerValue(RenderDeviceParameter parameter, int* valueOut)
+{
+	BeginCommand(Call::GetIntegerValue);
+	Write(parameter);
+	EndCommand();
+
+	if (target != nullptr)
+	{
+		target->GetIntegerValue(parameter, valueOut);
+		return;
+	}
+
+	// Report the minimum limits that the OpenGL specification guarantees
+	switch (parameter)
+	{
+	case RenderDeviceParameter::MaxUniformBlockSize:
+		*valueOut = 16384;
+		break;
+
+	case RenderDeviceParameter::UniformBufferOffsetAlignment:
+	case RenderDeviceParameter::ShaderStorageBufferOffsetAlignment:
+		*valueOut = 256;
+		break;
+
+	default:
+		*valueOut = 0;
+		break;
+	}
+}
+
+void RenderDeviceRecorder::SetDebugMessageCallback(DebugCallbackFn callback)
+{
+	BeginCommand(Call::SetDebugMessageCallback);
+	EndCommand();
+
+	if (target != nullptr)
+		target->SetDebugMessageCallback(callback);
+}
+
+void RenderDeviceRecorder::SetObjectLabel(RenderObjectType type, unsigned int object, StringRef label)
+{
+	BeginCommand(Call::SetObjectLabel);
+	Write(type);
+	Write(object);
+	Write(label.len);
+	Write(label.str, label.len);
+	EndCommand();
+
+	if (target != nullptr)
+		target->SetObjectLabel(type, object, label);
+}
+
+void RenderDeviceRecorder::SetObjectPtrLabel(void* ptr, StringRef label)
+{
+	BeginCommand(Call::SetObjectPtrLabel);
+	Write(label.len);
+	Write(label.str, label.len);
+	EndCommand();
+
+	if (target != nullptr)
+		target->SetObjectPtrLabel(ptr, label);
+}
+
+void RenderDeviceRecorder::PushDebugGroup(unsigned int id, StringRef message)
+{
+	BeginCommand(Call::PushDebugGroup);
+	Write(id);
+	Write(message.len);
+	Write(message.str, message.len);
+	EndCommand();
+
+	if (target != nullptr)
+		target->PushDebugGroup(id, message);
+}
+
+void RenderDeviceRecorder::PopDebugGroup()
+{
+	BeginCommand(Call::PopDebugGroup);
+	EndCommand();
+
+	if (target != nullptr)
+		target->PopDebugGroup();
+}
+
+void RenderDeviceRecorder::Clear(const RenderCommandData::ClearMask* data)
+{
+	BeginCommand(Call::Clear);
+	Write(*data);
+	EndCommand();
+
+	if (target != nullptr)
+		target->Clear(data);
+}
+
+void RenderDeviceRecorder::ClearColor(const RenderCommandData::ClearColorData* data)
+{
+	BeginCommand(Call::ClearColor);
+	Write(*data);
+	EndCommand();
+
+	if (target != nullptr)
+		target->ClearColor(data);
+}
+
+void RenderDeviceRecorder::ClearDepth(float depth)
+{
+	BeginCommand(Call::ClearDepth);
+	Write(depth);
+	EndCommand();
+
+	if (target != nullptr)
+		target->ClearDepth(depth);
+}
+
+void RenderDeviceRecorder::BlendingEnable()
+{
+	BeginCommand(Call::BlendingEnable);
+	EndCommand();
+
+	if (target != nullptr)
+		target->BlendingEnable();
+}
+
+void RenderDeviceRecorder::BlendingDisable()
+{
+	BeginCommand(Call::BlendingDisable);
+	EndCommand();
+
+	if (target != nullptr)
+		target->BlendingDisable();
+}
+
+void RenderDeviceRecorder::BlendFunction(const RenderCommandData::BlendFunctionData* data)
+{
+	BeginCommand(Call::BlendFunction);
+	Write(*data);
+	EndCommand();
+
+	if (target != nullptr)
+		target->BlendFunction(data);
+}
+
+void RenderDeviceRecorder::BlendFunction(RenderBlendFactor srcFactor, RenderBlendFactor dstFactor)
+{
+	RenderCommandData::BlendFunctionData data{ srcFactor, dstFactor };
+	BlendFunction(&data);
+}
+
+void RenderDeviceRecorder::SetClipBehavior(RenderClipOriginMode origin, RenderClipDepthMode depth)
+{
+	BeginCommand(Call::SetClipBehavior);
+	Write(origin);
+	Write(depth);
+	EndCommand();
+
+	if (target != nullptr)
+		target->SetClipBehavior(origin, depth);
+}
+
+void RenderDeviceRecorder::DepthRange(const RenderCommandData::DepthRangeData* data)
+{
+	BeginCommand(Call::DepthRange);
+	Write(*data);
+	EndCommand();
+
+	if (target != nullptr)
+		target->DepthRange(data);
+}
+
+void RenderDeviceRecorder::Viewport(const RenderCommandData::ViewportData* data)
+{
+	BeginCommand(Call::Viewport);
+	Write(*data);
+	EndCommand();
+
+	if (target != nullptr)
+		target->Viewport(data);
+}
+
+void RenderDeviceRecorder::DepthTestEnable()
+{
+	BeginCommand(Call::DepthTestEnable);
+	EndCommand();
+
+	if (target != nullptr)
+		target->DepthTestEnable();
+}
+
+void RenderDeviceRecorder::DepthTestDisable()
+{
+	BeginCommand(Call::DepthTestDisable);
+	EndCommand();
+
+	if (target != nullptr)
+		target->DepthTestDisable();
+}
+
+void RenderDeviceRecorder::DepthTestFunction(RenderDepthCompareFunc function)
+{
+	BeginCommand(Call::DepthTestFunction);
+	Write(function);
+	EndCommand();
+
+	if (target != nullptr)
+		target->DepthTestFunction(function);
+}
+
+void RenderDeviceRecorder::DepthWriteEnable()
+{
+	BeginCommand(Call::DepthWriteEnable);
+	EndCommand();
+
+	if (target != nullptr)
+		target->DepthWriteEnable();
+}
+
+void RenderDeviceRecorder::DepthWriteDisable()
+{
+	BeginCommand(Call::DepthWriteDisable);
+	EndCommand();
+
+	if (target != nullptr)
+		target->DepthWriteDisable();
+}
+
+void RenderDeviceRecorder::CullFaceEnable()
+{
+	BeginCommand(Call::CullFaceEnable);
+	EndCommand();
+
+	if (target != nullptr)
+		target->CullFaceEnable();
+}
+
+void RenderDeviceRecorder::CullFaceDisable()
+{
+	BeginCommand(Call::CullFaceDisable);
+	EndCommand();
+
+	if (target != nullptr)
+		target->CullFaceDisable();
+}
+
+void RenderDeviceRecorder::CullFaceFront()
+{
+	BeginCommand(Call::CullFaceFront);
+	EndCommand();
+
+	if (target != nullptr)
+		target->CullFaceFront();
+}
+
+void RenderDeviceRecorder::CullFaceBack()
+{
+	BeginCommand(Call::CullFaceBack);
+	EndCommand();
+
+	if (target != nullptr)
+		target->CullFaceBack();
+}
+
+void RenderDeviceRecorder::FramebufferSrgbEnable()
+{
+	BeginCommand(Call::FramebufferSrgbEnable);
+	EndCommand();
+
+	if (target != nullptr)
+		target->FramebufferSrgbEnable();
+}
+
+void RenderDeviceRecorder::FramebufferSrgbDisable()
+{
+	BeginCommand(Call::FramebufferSrgbDisable);
+	EndCommand();
+
+	if (target != nullptr)
+		target->FramebufferSrgbDisable();
+}
+
+void RenderDeviceRecorder::CreateFramebuffers(unsigned int count, unsigned int* framebuffersOut)
+{
+	if (target != nullptr)
+		target->CreateFramebuffers(count, framebuffersOut);
+	else
+		CreateObjectIds(count, framebuffersOut);
+
+	RecordObjects(Call::CreateFramebuffers, count, framebuffersOut);
+}
+
+void RenderDeviceRecorder::DestroyFramebuffers(unsigned int count, unsigned int* framebuffers)
+{
+	RecordObjects(Call::DestroyFramebuffers, count, framebuffers);
+
+	if (target != nullptr)
+		target->DestroyFramebuffers(count, framebuffers);
+}
+
+void RenderDeviceRecorder::BindFramebuffer(const RenderCommandData::BindFramebufferData* data)
+{
+	BeginCommand(Call::BindFramebuffer);
+	Write(*data);
+	EndCommand();
+
+	if (target != nullptr)
+		target->BindFramebuffer(data);
+}
+
+void RenderDeviceRecorder::BindFramebuffer(RenderFramebufferTarget target, unsigned int framebuffer)
+{
+	RenderCommandData::BindFramebufferData data{ target, framebuffer };
+	BindFramebuffer(&data);
+}
+
+void RenderDeviceRecorder::AttachFramebufferTexture2D(const RenderCommandData::AttachFramebufferTexture2D* data)
+{
+	BeginCommand(Call::AttachFramebufferTexture2D);
+	Write(*data);
+	EndCommand();
+
+	if (target != nullptr)
+		target->AttachFramebufferTexture2D(data);
+}
+
+void RenderDeviceRecorder::SetFramebufferDrawBuffers(unsigned int count, RenderFramebufferAttachment* buffers)
+{
+	BeginCommand(Call::SetFramebufferDrawBuffers);
+	Write(count);
+	Write(buffers, sizeof(RenderFramebufferAttachment) * count);
+	EndCommand();
+
+	if (target != nullptr)
+		target->SetFramebufferDrawBuffers(count, buffers);
+}
+
+void RenderDeviceRecorder::CreateTextures(unsigned int count, unsigned int* texturesOut)
+{
+	if (target != nullptr)
+		target->CreateTextures(count, texturesOut);
+	else
+		CreateObjectIds(count, texturesOut);
+
+	RecordObjects(Call::CreateTextures, count, texturesOut);
+}
+
+void RenderDeviceRecorder::DestroyTextures(unsigned int count, unsigned int* textures)
+{
+	RecordObjects(Call::DestroyTextures, count, textures);
+
+	if (target != nullptr)
+		target->DestroyTextures(count, textures);
+}
+
+void RenderDeviceRecorder::BindTexture(RenderTextureTarget target, unsigned int texture)
+{
+	BeginCommand(Call::BindTexture);
+	Write(target);
+	Write(texture);
+	EndCommand();
+
+	if (this->target != nullptr)
+		this->target->BindTexture(target, texture);
+}
+
+void RenderDeviceRecorder::SetTextureStorage2D(const RenderCommandData::SetTextureStorage2D* data)
+{
+	BeginCommand(Call::SetTextureStorage2D);
+	Write(*data);
+	EndCommand();
+
+	if (target != nullptr)
+		target->SetTextureStorage2D(data);
+}
+
+void RenderDeviceRecorder::SetTextureImage2D(const RenderCommandData::SetTextureImage2D* data)
+{
+	size_t size = data->data != nullptr ? GetImageDataSize(data->width, data->height, data->format, data->type) : 0;
+
+	BeginCommand(Call::SetTextureImage2D);
+	Write(*data);
+	WritePayload(data->data, size);
+	EndCommand();
+
+	stats.bytesUploaded += size;
+
+	if (target != nullptr)
+		target->SetTextureImage2D(data);
+}
+
+void RenderDeviceRecorder::SetTextureSubImage2D(const RenderCommandData::SetTextureSubImage2D* data)
+{
+	size_t size = data->data != nullptr ? GetImageDataSize(data->width, data->height, data->format, data->type) : 0;
+
+	BeginCommand(Call::SetTextureSubImage2D);
+	Write(*data);
+	WritePayload(data->data, size);
+	EndCommand();
+
+	stats.bytesUploaded += size;
+
+	if (target != nullptr)
+		target->SetTextureSubImage2D(data);
+}
+
+void RenderDeviceRecorder::SetTextureImageCompressed2D(const RenderCommandData::SetTextureImageCompressed2D* data)
+{
+	size_t size = data->data != nullptr ? data->dataSize : 0;
+
+	BeginCommand(Call::SetTextureImageCompressed2D);
+	Write(*data);
+	WritePayload(data->data, size);
+	EndCommand();
+
+	stats.bytesUploaded += size;
+
+	if (target != nullptr)
+		target->SetTextureImageCompressed2D(data);
+}
+
+void RenderDeviceRecorder::GenerateTextureMipmaps(RenderTextureTarget target)
+{
+	BeginCommand(Call::GenerateTextureMipmaps);
+	Write(target);
+	EndCommand();
+
+	if (this->target != nullptr)
+		this->target->GenerateTextureMipmaps(target);
+}
+
+void RenderDeviceRecorder::SetActiveTextureUnit(unsigned int textureUnit)
+{
+	BeginCommand(Call::SetActiveTextureUnit);
+	Write(textureUnit);
+	EndCommand();
+
+	if (target != nullptr)
+		target->SetActiveTextureUnit(textureUnit);
+}
+
+void RenderDeviceRecorder::SetTextureParameterInt(RenderTextureTarget target, RenderTextureParameter parameter, unsigned int value)
+{
+	BeginCommand(Call::SetTextureParameterInt);
+	Write(target);
+	Write(parameter);
+	Write(value);
+	EndCommand();
+
+	if (this->target != nullptr)
+		this->target->SetTextureParameterInt(target, parameter, value);
+}
+
+void RenderDeviceRecorder::SetTextureMinFilter(RenderTextureTarget target, RenderTextureFilterMode mode)
+{
+	BeginCommand(Call::SetTextureMinFilter);
+	Write(target);
+	Write(mode);
+	EndCommand();
+
+	if (this->target != nullptr)
+		this->target->SetTextureMinFilter(target, mode);
+}
+
+void RenderDeviceRecorder::SetTextureMagFilter(RenderTextureTarget target, RenderTextureFilterMode mode)
+{
+	BeginCommand(Call::SetTextureMagFilter);
+	Write(target);
+	Write(mode);
+	EndCommand();
+
+	if (this->target != nullptr)
+		this->target->SetTextureMagFilter(target, mode);
+}
+
+void RenderDeviceRecorder::SetTextureWrapModeU(RenderTextureTarget target, RenderTextureWrapMode mode)
+{
+	BeginCommand(Call::SetTextureWrapModeU);
+	Write(target);
+	Write(mode);
+	EndCommand();
+
+	if (this->target != nullptr)
+		this->target->SetTextureWrapModeU(target, mode);
+}
+
+void RenderDeviceRecorder::SetTextureWrapModeV(RenderTextureTarget target, RenderTextureWrapMode mode)
+{
+	BeginCommand(Call::SetTextureWrapModeV);
+	Write(target);
+	Write(mode);
+	EndCommand();
+
+	if (this->target != nullptr)
+		this->target->SetTextureWrapModeV(target, mode);
+}
+
+void RenderDeviceRecorder::SetTextureWrapModeW(RenderTextureTarget target, RenderTextureWrapMode mode)
+{
+	BeginCommand(Call::SetTextureWrapModeW);
+	Write(target);
+	Write(mode);
+	EndCommand();
+
+	if (this->target != nullptr)
+		this->target->SetTextureWrapModeW(target, mode);
+}
+
+void RenderDeviceRecorder::SetTextureCompareMode(RenderTextureTarget target, RenderTextureCompareMode mode)
+{
+	BeginCommand(Call::SetTextureCompareMode);
+	Write(target);
+	Write(mode);
+	EndCommand();
+
+	if (this->target != nullptr)
+		this->target->SetTextureCompareMode(target, mode);
+}
+
+void RenderDeviceRecorder::SetTextureCompareFunc(RenderTextureTarget target, RenderDepthCompareFunc func)
+{
+	BeginCommand(Call::SetTextureCompareFunc);
+	Write(target);
+	Write(func);
+	EndCommand();
+
+	if (this->target != nullptr)
+		this->target->SetTextureCompareFunc(target, func);
+}
+
+void RenderDeviceRecorder::CreateSamplers(unsigned int count, unsigned int* samplersOut)
+{
+	if (target != nullptr)
+		target->CreateSamplers(count, samplersOut);
+	else
+		CreateObjectIds(count, samplersOut);
+
+	RecordObjects(Call::CreateSamplers, count, samplersOut);
+}
+
+void RenderDeviceRecorder::DestroySamplers(unsigned int count, unsigned int* samplers)
+{
+	RecordObjects(Call::DestroySamplers, count, samplers);
+
+	if (target != nullptr)
+		target->DestroySamplers(count, samplers);
+}
+
+void RenderDeviceRecorder::BindSampler(unsigned int textureUnit, unsigned int sampler)
+{
+	BeginCommand(Call::BindSampler);
+	Write(textureUnit);
+	Write(sampler);
+	EndCommand();
+
+	if (target != nullptr)
+		target->BindSampler(textureUnit, sampler);
+}
+
+void RenderDeviceRecorder::SetSamplerParameters(const RenderCommandData::SetSamplerParameters* data)
+{
+	BeginCommand(Call::SetSamplerParameters);
+	Write(*data);
+	EndCommand();
+
+	if (target != nullptr)
+		target->SetSamplerParameters(data);
+}
+
+unsigned int RenderDeviceRecorder::CreateShaderProgram()
+{
+	unsigned int shaderProgram = target != nullptr ? target->CreateShaderProgram() : nextObjectId++;
+
+	BeginCommand(Call::CreateShaderProgram);
+	Write(shaderProgram);
+	EndCommand();
+
+	return shaderProgram;
+}
+
+void RenderDeviceRecorder::DestroyShaderProgram(unsigned int shaderProgram)
+{
+	BeginCommand(Call::DestroyShaderProgram);
+	Write(shaderProgram);
+	EndCommand();
+
+	if (target != nullptr)
+		target->DestroyShaderProgram(shaderProgram);
+}
+
+void RenderDeviceRecorder::AttachShaderStageToProgram(unsigned int shaderProgram, unsigned int shaderStage)
+{
+	BeginCommand(Call::AttachShaderStageToProgram);
+	Write(shaderProgram);
+	Write(shaderStage);
+	EndCommand();
+
+	if (target != nullptr)
+		target->AttachShaderStageToProgram(shaderProgram, shaderStage);
+}
+
+void RenderDeviceRecorder::LinkShaderProgram(unsigned int shaderProgram)
+{
+	BeginCommand(Call::LinkShaderProgram);
+	Write(shaderProgram);
+	EndCommand();
+
+	if (target != nullptr)
+		target->LinkShaderProgram(shaderProgram);
+}
+
+void RenderDeviceRecorder::UseShaderProgram(unsigned int shaderProgram)
+{
+	BeginCommand(Call::UseShaderProgram);
+	Write(shaderProgram);
+	EndCommand();
+
+	if (target != nullptr)
+		target->UseShaderProgram(shaderProgram);
+}
+
+int RenderDeviceRecorder::GetShaderProgramParameterInt(unsigned int shaderProgram, unsigned int parameter)
+{
+	BeginCommand(Call::GetShaderProgramParameterInt);
+	Write(shaderProgram);
+	Write(parameter);
+	EndCommand();
+
+	return target != nullptr ? target->GetShaderProgramParameterInt(shaderProgram, parameter) : 0;
+}
+
+bool RenderDeviceRecorder::GetShaderProgramLinkStatus(unsigned int shaderProgram)
+{
+	BeginCommand(Call::GetShaderProgramLinkStatus);
+	Write(shaderProgram);
+	EndCommand();
+
+	return target != nullptr ? target->GetShaderProgramLinkStatus(shaderProgram) : true;
+}
+
+int RenderDeviceRecorder::GetShaderProgramInfoLogLength(unsigned int shaderProgram)
+{
+	BeginCommand(Call::GetShaderProgramInfoLogLength);
+	Write(shaderProgram);
+	EndCommand();
+
+	return target != nullptr ? target->GetShaderProgramInfoLogLength(shaderProgram) : 0;
+}
+
+void RenderDeviceRecorder::GetShaderProgramInfoLog(unsigned int shaderProgram, unsigned int maxLength, char* logOut)
+{
+	BeginCommand(Call::GetShaderProgramInfoLog);
+	Write(shaderProgram);
+	Write(maxLength);
+	EndCommand();
+
+	if (target != nullptr)
+		target->GetShaderProgramInfoLog(shaderProgram, maxLength, logOut);
+	else if (maxLength > 0)
+		logOut[0] = '\0';
+}
+
+unsigned int RenderDeviceRecorder::CreateShaderStage(RenderShaderStage stage)
+{
+	unsigned int shaderStage = target != nullptr ? target->CreateShaderStage(stage) : nextObjectId++;
+
+	BeginCommand(Call::CreateShaderStage);
+	Write(stage);
+	Write(shaderStage);
+	EndCommand();
+
+	return shaderStage;
+}
+
+void RenderDeviceRecorder::DestroyShaderStage(unsigned int shaderStage)
+{
+	BeginCommand(Call::DestroyShaderStage);
+	Write(shaderStage);
+	EndCommand();
+
+	if (target != nullptr)
+		target->DestroyShaderStage(shaderStage);
+}
+
+void RenderDeviceRecorder::SetShaderStageSource(unsigned int shaderStage, const char* source, int length)
+{
+	// Negative length means that the source is null-terminated
+	int sourceLength = length >= 0 ? length : static_cast<int>(std::strlen(source));
+
+	BeginCommand(Call::SetShaderStageSource);
+	Write(shaderStage);
+	Write(sourceLength);
+	Write(source, sourceLength);
+	EndCommand();
+
+	if (target != nullptr)
+		target->SetShaderStageSource(shaderStage, source, length);
+}
+
+void RenderDeviceRecorder::CompileShaderStage(unsigned int shaderStage)
+{
+	BeginCommand(Call::CompileShaderStage);
+	Write(shaderStage);
+	EndCommand();
+
+	if (target != nullptr)
+		target->CompileShaderStage(shaderStage);
+}
+
+int RenderDeviceRecorder::GetShaderStageParameterInt(unsigned int shaderStage, unsigned int parameter)
+{
+	BeginCommand(Call::GetShaderStageParameterInt);
+	Write(shaderStage);
+	Write(parameter);
+	EndCommand();
+
+	return target != nullptr ? target->GetShaderStageParameterInt(shaderStage, parameter) : 0;
+}
+
+bool RenderDeviceRecorder::GetShaderStageCompileStatus(unsigned int shaderStage)
+{
+	BeginCommand(Call::GetShaderStageCompileStatus);
+	Write(shaderStage);
+	EndCommand();
+
+	return target != nullptr ? target->GetShaderStageCompileStatus(shaderStage) : true;
+}
+
+int RenderDeviceRecorder::GetShaderStageInfoLogLength(unsigned int shaderStage)
+{
+	BeginCommand(Call::GetShaderStageInfoLogLength);
+	Write(shaderStage);
+	EndCommand();
+
+	return target != nullptr ? target->GetShaderStageInfoLogLength(shaderStage) : 0;
+}
+
+void RenderDeviceRecorder::GetShaderStageInfoLog(unsigned int shaderStage, unsigned int maxLength, char* logOut)
+{
+	BeginCommand(Call::GetShaderStageInfoLog);
+	Write(shaderStage);
+	Write(maxLength);
+	EndCommand();
+
+	if (target != nullptr)
+		target->GetShaderStageInfoLog(shaderStage, maxLength, logOut);
+	else if (maxLength > 0)
+		logOut[0] = '\0';
+}
+
+int RenderDeviceRecorder::GetUniformLocation(unsigned int shaderProgram, const char* uniformName)
+{
+	// Locations must be unique so that a replay can map them to its own locations
+	int location = target != nullptr ? target->GetUniformLocation(shaderProgram, uniformName) : nextUniformLocation++;
+
+	unsigned int nameLength = static_cast<unsigned int>(std::strlen(uniformName));
+
+	BeginCommand(Call::GetUniformLocation);
+	Write(shaderProgram);
+	Write(location);
+	Write(nameLength);
+	Write(uniformName, nameLength + 1);
+	EndCommand();
+
+	return location;
+}
+
+void RenderDeviceRecorder::SetUniformMat4x4f(int uniform, unsigned int count, const float* values)
+{
+	BeginCommand(Call::SetUniformMat4x4f);
+	Write(uniform);
+	Write(count);
+	Write(values, sizeof(float) * 16 * count);
+	EndCommand();
+
+	if (target != nullptr)
+		target->SetUniformMat4x4f(uniform, count, values);
+}
+
+void RenderDeviceRecorder::SetUniformVec4f(int uniform, unsigned int count, const float* values)
+{
+	BeginCommand(Call::SetUniformVec4f);
+	Write(uniform);
+	Write(count);
+	Write(values, sizeof(float) * 4 * count);
+	EndCommand();
+
+	if (target != nullptr)
+		target->SetUniformVec4f(uniform, count, values);
+}
+
+void RenderDeviceRecorder::SetUniformVec3f(int uniform, unsigned int count, const float* values)
+{
+	BeginCommand(Call::SetUniformVec3f);
+	Write(uniform);
+	Write(count);
+	Write(values, sizeof(float) * 3 * count);
+	EndCommand();
+
+	if (target != nullptr)
+		target->SetUniformVec3f(uniform, count, values);
+}
+
+void RenderDeviceRecorder::SetUniformVec2f(int uniform, unsigned int count, const float* values)
+{
+	BeginCommand(Call::SetUniformVec2f);
+	Write(uniform);
+	Write(count);
+	Write(values, sizeof(float) * 2 * count);
+	EndCommand();
+
+	if (target != nullptr)
+		target->SetUniformVec2f(uniform, count, values);
+}
+
+void RenderDeviceRecorder::SetUniformFloat(int uniform, float value)
+{
+	BeginCommand(Call::SetUniformFloat);
+	Write(uniform);
+	Write(value);
+	EndCommand();
+
+	if (target != nullptr)
+		target->SetUniformFloat(uniform, value);
+}
+
+void RenderDeviceRecorder::SetUniformInt(int uniform, int value)
+{
+	BeginCommand(Call::SetUniformInt);
+	Write(uniform);
+	Write(value);
+	EndCommand();
+
+	if (target != nullptr)
+		target->SetUniformInt(uniform, value);
+}
+
+void RenderDeviceRecorder::CreateVertexArrays(unsigned int count, unsigned int* vertexArraysOut)
+{
+	if (target != nullptr)
+		target->CreateVertexArrays(count, vertexArraysOut);
+	else
+		CreateObjectIds(count, vertexArraysOut);
+
+	RecordObjects(Call::CreateVertexArrays, count, vertexArraysOut);
+}
+
+void RenderDeviceRecorder::DestroyVertexArrays(unsigned int count, unsigned int* vertexArrays)
+{
+	RecordObjects(Call::DestroyVertexArrays, count, vertexArrays);
+
+	if (target != nullptr)
+		target->DestroyVertexArrays(count, vertexArrays);
+}
+
+void RenderDeviceRecorder::BindVertexArray(unsigned int vertexArrayId)
+{
+	BeginCommand(Call::BindVertexArray);
+	Write(vertexArrayId);
+	EndCommand();
+
+	if (target != nullptr)
+		target->BindVertexArray(vertexArrayId);
+}
+
+void RenderDeviceRecorder::EnableVertexAttribute(unsigned int index)
+{
+	BeginCommand(Call::EnableVertexAttribute);
+	Write(index);
+	EndCommand();
+
+	if (target != nullptr)
+		target->EnableVertexAttribute(index);
+}
+
+void RenderDeviceRecorder::SetVertexAttributePointer(const RenderCommandData::SetVertexAttributePointer* data)
+{
+	BeginCommand(Call::SetVertexAttributePointer);
+	Write(*data);
+	EndCommand();
+
+	if (target != nullptr)
+		target->SetVertexAttributePointer(data);
+}
+
+void RenderDeviceRecorder::Draw(RenderPrimitiveMode mode, int offset, int vertexCount)
+{
+	BeginCommand(Call::Draw);
+	Write(mode);
+	Write(offset);
+	Write(vertexCount);
+	EndCommand();
+
+	stats.drawCalls += 1;
+	stats.drawnInstances += 1;
+
+	if (target != nullptr)
+		target->Draw(mode, offset, vertexCount);
+}
+
+void RenderDeviceRecorder::DrawIndexed(RenderPrimitiveMode mode, int indexCount, RenderIndexType indexType)
+{
+	BeginCommand(Call::DrawIndexed);
+	Write(mode);
+	Write(indexCount);
+	Write(indexType);
+	EndCommand();
+
+	stats.drawCalls += 1;
+	stats.drawnInstances += 1;
+
+	if (target != nullptr)
+		target->DrawIndexed(mode, indexCount, indexType);
+}
+
+void RenderDeviceRecorder::DrawInstanced(RenderPrimitiveMode mode, int offset, int vertexCount, int instanceCount)
+{
+	BeginCommand(Call::DrawInstanced);
+	Write(mode);
+	Write(offset);
+	Write(vertexCount);
+	Write(instanceCount);
+	EndCommand();
+
+	stats.drawCalls += 1;
+	stats.drawnInstances += instanceCount;
+
+	if (target != nullptr)
+		target->DrawInstanced(mode, offset, vertexCount, instanceCount);
+}
+
+void RenderDeviceRecorder::DrawIndexedInstanced(RenderPrimitiveMode mode, int indexCount, RenderIndexType indexType, int instanceCount)
+{
+	BeginCommand(Call::DrawIndexedInstanced);
+	Write(mode);
+	Write(indexCount);
+	Write(indexType);
+	Write(instanceCount);
+	EndCommand();
+
+	stats.drawCalls += 1;
+	stats.drawnInstances += instanceCount;
+
+	if (target != nullptr)
+		target->DrawIndexedInstanced(mode, indexCount, indexType, instanceCount);
+}
+
+void RenderDeviceRecorder::DrawIndexedInstancedBaseInstance(RenderPrimitiveMode mode, int indexCount, RenderIndexType indexType, int instanceCount, unsigned int baseInstance)
+{
+	BeginCommand(Call::DrawIndexedInstancedBaseInstance);
+	Write(mode);
+	Write(indexCount);
+	Write(indexType);
+	Write(instanceCount);
+	Write(baseInstance);
+	EndCommand();
+
+	stats.drawCalls += 1;
+	stats.drawnInstances += instanceCount;
+
+	if (target != nullptr)
+		target->DrawIndexedInstancedBaseInstance(mode, indexCount, indexType, instanceCount, baseInstance);
+}
+
+void RenderDeviceRecorder::MultiDrawIndexedIndirect(RenderPrimitiveMode mode, RenderIndexType indexType, intptr_t offset, int drawCount, int stride)
+{
+	using IndirectCommand = RenderCommandData::DrawIndexedIndirectCommand;
+
+	unsigned int commandBuffer = GetBoundBuffer(RenderBufferTarget::DrawIndirectBuffer);
+	size_t commandStride = stride != 0 ? stride : sizeof(IndirectCommand);
+	size_t commandsSize = commandStride * drawCount;
+
+	RecordMappedWrite(commandBuffer, offset, commandsSize, true);
+
+	BeginCommand(Call::MultiDrawIndexedIndirect);
+	Write(mode);
+	Write(indexType);
+	Write(offset);
+	Write(drawCount);
+	Write(stride);
+	EndCommand();
+
+	stats.drawCalls += 1;
+
+	const uint8_t* commands = GetBufferContents(commandBuffer, offset, commandsSize);
+	if (commands != nullptr)
+	{
+		for (int i = 0; i < drawCount; ++i)
+			stats.drawnInstances += reinterpret_cast<const IndirectCommand*>(commands + commandStride * i)->instanceCount;
+	}
+	else
+		stats.drawnInstances += drawCount;
+
+	if (target != nullptr)
+		target->MultiDrawIndexedIndirect(mode, indexType, offset, drawCount, stride);
+}
+
+void RenderDeviceRecorder::CreateBuffers(unsigned int count, unsigned int* buffersOut)
+{
+	if (target != nullptr)
+		target->CreateBuffers(count, buffersOut);
+	else
+		CreateObjectIds(count, buffersOut);
+
+	RecordObjects(Call::CreateBuffers, count, buffersOut);
+
+	for (unsigned int i = 0; i < count; ++i)
+	{
+		unsigned int oldCount = buffers.GetCount();
+		if (buffersOut[i] >= oldCount)
+		{
+			buffers.Resize(buffersOut[i] + 1);
+
+			for (unsigned int j = oldCount, newCount = buffers.GetCount(); j < newCount; ++j)
+				buffers[j] = BufferData{};
+		}
+	}
+}
+
+void RenderDeviceRecorder::DestroyBuffers(unsigned int count, unsigned int* buffers)
+{
+	RecordObjects(Call::DestroyBuffers, count, buffers);
+
+	for (unsigned int i = 0; i < count; ++i)
+	{
+		if (BufferData* buffer = GetBufferData(buffers[i]))
+		{
+			allocator->Deallocate(buffer->storage);
+			*buffer = BufferData{};
+		}
+
+		for (unsigned int target = 0; target < BufferTargetCount; ++target)
+			if (boundBuffers[target] == buffers[i])
+				boundBuffers[target] = 0;
+	}
+
+	if (target != nullptr)
+		target->DestroyBuffers(count, buffers);
+}
+
+void RenderDeviceRecorder::BindBuffer(RenderBufferTarget target, unsigned int buffer)
+{
+	BeginCommand(Call::BindBuffer);
+	Write(target);
+	Write(buffer);
+	EndCommand();
+
+	SetBoundBuffer(target, buffer);
+
+	if (this->target != nullptr)
+		this->target->BindBuffer(target, buffer);
+}
+
+void RenderDeviceRecorder::BindBufferBase(RenderBufferTarget target, unsigned int bindingPoint, unsigned int buffer)
+{
+	if (BufferData* data = GetBufferData(buffer))
+		RecordMappedWrite(buffer, data->mappedOffset, data->mappedLength, true);
+
+	BeginCommand(Call::BindBufferBase);
+	Write(target);
+	Write(bindingPoint);
+	Write(buffer);
+	EndCommand();
+
+	// Binding to an indexed binding point also binds to the generic binding point
+	SetBoundBuffer(target, buffer);
+
+	if (this->target != nullptr)
+		this->target->BindBufferBase(target, bindingPoint, buffer);
+}
+
+void RenderDeviceRecorder::BindBufferRange(const RenderCommandData::BindBufferRange* data)
+{
+	RecordMappedWrite(data->buffer, data->offset, data->length, true);
+
+	BeginCommand(Call::BindBufferRange);
+	Write(*data);
+	EndCommand();
+
+	SetBoundBuffer(data->target, data->buffer);
+
+	if (target != nullptr)
+		target->BindBufferRange(data);
+}
+
+void RenderDeviceRecorder::SetBufferStorage(const RenderCommandData::SetBufferStorage* data)
+{
+	size_t size = data->data != nullptr ? data->size : 0;
+
+	BeginCommand(Call::SetBufferStorage);
+	Write(*data);
+	WritePayload(data->data, size);
+	EndCommand();
+
+	SetBufferSize(data->target, data->size);
+	stats.bytesUploaded += size;
+
+	if (target != nullptr)
+		target->SetBufferStorage(data);
+	else if (size > 0)
+		std::memcpy(GetBufferData(GetBoundBuffer(data->target))->storage, data->data, size);
+}
+
+void RenderDeviceRecorder::SetBufferData(RenderBufferTarget target, unsigned int size, const void* data, RenderBufferUsage usage)
+{
+	size_t dataSize = data != nullptr ? size : 0;
+
+	BeginCommand(Call::SetBufferData);
+	Write(target);
+	Write(size);
+	Write(usage);
+	WritePayload(data, dataSize);
+	EndCommand();
+
+	SetBufferSize(target, size);
+	stats.bytesUploaded += dataSize;
+
+	if (this->target != nullptr)
+		this->target->SetBufferData(target, size, data, usage);
+	else if (dataSize > 0)
+		std::memcpy(GetBufferData(GetBoundBuffer(target))->storage, data, dataSize);
+}
+
+void RenderDeviceRecorder::SetBufferSubData(RenderBufferTarget target, unsigned int offset, unsigned int size, const void* data)
+{
+	BeginCommand(Call::SetBufferSubData);
+	Write(target);
+	Write(offset);
+	Write(size);
+	WritePayload(data, size);
+	EndCommand();
+
+	stats.bytesUploaded += size;
+
+	if (this->target != nullptr)
+		this->target->SetBufferSubData(target, offset, size, data);
+	else if (uint8_t* storage = const_cast<uint8_t*>(GetBufferContents(GetBoundBuffer(target), offset, size)))
+		std::memcpy(storage, data, size);
+}
+
+void* RenderDeviceRecorder::MapBuffer(RenderBufferTarget target, RenderBufferAccess access)
+{
+	BeginCommand(Call::MapBuffer);
+	Write(target);
+	Write(access);
+	EndCommand();
+
+	BufferData* buffer = GetBufferData(GetBoundBuffer(target));
+	size_t size = buffer != nullptr ? buffer->size : 0;
+	void* mapped = nullptr;
+
+	if (this->target != nullptr)
+		mapped = this->target->MapBuffer(target, access);
+	else if (buffer != nullptr)
+		mapped = buffer->storage;
+
+	SetBufferMapping(target, mapped, 0, size, access != RenderBufferAccess::ReadOnly, false);
+
+	return mapped;
+}
+
+void* RenderDeviceRecorder::MapBufferRange(const RenderCommandData::MapBufferRange* data)
+{
+	BeginCommand(Call::MapBufferRange);
+	Write(*data);
+	EndCommand();
+
+	void* mapped = nullptr;
+
+	if (target != nullptr)
+		mapped = target->MapBufferRange(data);
+	else
+		mapped = const_cast<uint8_t*>(GetBufferContents(GetBoundBuffer(data->target), data->offset, data->length));
+
+	SetBufferMapping(data->target, mapped, data->offset, data->length, data->writeAccess, data->persistent);
+
+	return mapped;
+}
+
+void RenderDeviceRecorder::UnmapBuffer(RenderBufferTarget target)
+{
+	unsigned int bufferId = GetBoundBuffer(target);
+	BufferData* buffer = GetBufferData(bufferId);
+
+	if (buffer != nullptr && buffer->mapped != nullptr)
+	{
+		// Writes to a temporary mapping are complete when it's unmapped
+		if (buffer->mappedForWrite)
+			RecordMappedWrite(bufferId, buffer->mappedOffset, buffer->mappedLength, false);
+
+		if (buffer->mappedPersistent == false)
+			stats.bytesUploaded += buffer->mappedLength;
+	}
+
+	BeginCommand(Call::UnmapBuffer);
+	Write(target);
+	EndCommand();
+
+	SetBufferMapping(target, nullptr, 0, 0, false, false);
+
+	if (this->target != nullptr)
+		this->target->UnmapBuffer(target);
+}
+
+void RenderDeviceRecorder::DispatchCompute(unsigned int numGroupsX, unsigned int numGroupsY, unsigned int numGroupsZ)
+{
+	BeginCommand(Call::DispatchCompute);
+	Write(numGroupsX);
+	Write(numGroupsY);
+	Write(numGroupsZ);
+	EndCommand();
+
+	if (target != nullptr)
+		target->DispatchCompute(numGroupsX, numGroupsY, numGroupsZ);
+}
+
+void RenderDeviceRecorder::MemoryBarrier(const RenderCommandData::MemoryBarrier& barrier)
+{
+	BeginCommand(Call::MemoryBarrier);
+	Write(barrier);
+	EndCommand();
+
+	if (target != nullptr)
+		target->MemoryBarrier(barrier);
+}
+
+RenderSyncObject RenderDeviceRecorder::FenceSync()
+{
+	RenderSyncObject sync;
+
+	if (target != nullptr)
+		sync = target->FenceSync();
+	else
+		sync = reinterpret_cast<RenderSyncObject>(static_cast<uintptr_t>(nextObjectId++));
+
+	BeginCommand(Call::FenceSync);
+	Write(static_cast<uint64_t>(reinterpret_cast<uintptr_t>(sync)));
+	EndCommand();
+
+	return sync;
+}
+
+RenderSyncWaitResult RenderDeviceRecorder::ClientWaitSync(RenderSyncObject sync, bool flushCommands, uint64_t timeoutNanoseconds)
+{
+	BeginCommand(Call::ClientWaitSync);
+	Write(static_cast<uint64_t>(reinterpret_cast<uintptr_t>(sync)));
+	Write(flushCommands);
+	Write(timeoutNanoseconds);
+	EndCommand();
+
+	if (target != nullptr)
+		return target->ClientWaitSync(sync, flushCommands, timeoutNanoseconds);
+
+	// Nothing is executed, so every fence is signaled as soon as it's placed
+	return RenderSyncWaitResult::AlreadySignaled;
+}
+
+void RenderDeviceRecorder::DeleteSync(RenderSyncObject sync)
+{
+	BeginCommand(Call::DeleteSync);
+	Write(static_cast<uint64_t>(reinterpret_cast<uintptr_t>(sync)));
+	EndCommand();
+
+	if (target != nullptr)
+		target->DeleteSync(sync);
+}
@@ -0,0 +1,370 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "Core/Array.hpp"
+
+#include "Rendering/RenderDevice.hpp"
+
+class Allocator;
+
+/**
+ * RenderDevice that counts calls and optionally records them into a binary
+ * command stream, along with their upload payloads.
+ *
+ * Without a target device nothing is rendered and objects get fake IDs, so
+ * that the renderer can run without a GPU or a window. Buffers then get CPU
+ * memory for their storage, so that mapping works. With a target device all
+ * calls are forwarded to it, which allows capturing frames from a normal run.
+ *
+ * Writes to persistently mapped memory can't be seen by the device. They are
+ * recorded as WriteMappedBuffer commands where the GPU would start reading
+ * the memory: when the range is bound and when indirect commands are drawn.
+ * They are not counted in bytesUploaded.
+ */
+class RenderDeviceRecorder : public RenderDevice
+{
+public:
+	enum class Call : uint32_t
+	{
+		GetIntegerValue,
+		SetDebugMessageCallback,
+		SetObjectLabel,
+		SetObjectPtrLabel,
+		PushDebugGroup,
+		PopDebugGroup,
+		Clear,
+		ClearColor,
+		ClearDepth,
+		BlendingEnable,
+		BlendingDisable,
+		BlendFunction,
+		SetClipBehavior,
+		DepthRange,
+		Viewport,
+		DepthTestEnable,
+		DepthTestDisable,
+		DepthTestFunction,
+		DepthWriteEnable,
+		DepthWriteDisable,
+		CullFaceEnable,
+		CullFaceDisable,
+		CullFaceFront,
+		CullFaceBack,
+		FramebufferSrgbEnable,
+		FramebufferSrgbDisable,
+		CreateFramebuffers,
+		DestroyFramebuffers,
+		BindFramebuffer,
+		AttachFramebufferTexture2D,
+		SetFramebufferDrawBuffers,
+		CreateTextures,
+		DestroyTextures,
+		BindTexture,
+		SetTextureStorage2D,
+		SetTextureImage2D,
+		SetTextureSubImage2D,
+		SetTextureImageCompressed2D,
+		GenerateTextureMipmaps,
+		SetActiveTextureUnit,
+		SetTextureParameterInt,
+		SetTextureMinFilter,
+		SetTextureMagFilter,
+		SetTextureWrapModeU,
+		SetTextureWrapModeV,
+		SetTextureWrapModeW,
+		SetTextureCompareMode,
+		SetTextureCompareFunc,
+		CreateSamplers,
+		DestroySamplers,
+		BindSampler,
+		SetSamplerParameters,
+		CreateShaderProgram,
+		DestroyShaderProgram,
+		AttachShaderStageToProgram,
+		LinkShaderProgram,
+		UseShaderProgram,
+		GetShaderProgramParameterInt,
+		GetShaderProgramLinkStatus,
+		GetShaderProgramInfoLogLength,
+		GetShaderProgramInfoLog,
+		CreateShaderStage,
+		DestroyShaderStage,
+		SetShaderStageSource,
+		CompileShaderStage,
+		GetShaderStageParameterInt,
+		GetShaderStageCompileStatus,
+		GetShaderStageInfoLogLength,
+		GetShaderStageInfoLog,
+		GetUniformLocation,
+		SetUniformMat4x4f,
+		SetUniformVec4f,
+		SetUniformVec3f,
+		SetUniformVec2f,
+		SetUniformFloat,
+		SetUniformInt,
+		CreateVertexArrays,
+		DestroyVertexArrays,
+		BindVertexArray,
+		EnableVertexAttribute,
+		SetVertexAttributePointer,
+		Draw,
+		DrawIndexed,
+		DrawInstanced,
+		DrawIndexedInstanced,
+		DrawIndexedInstancedBaseInstance,
+		MultiDrawIndexedIndirect,
+		CreateBuffers,
+		DestroyBuffers,
+		BindBuffer,
+		BindBufferBase,
+		BindBufferRange,
+		SetBufferStorage,
+		SetBufferData,
+		SetBufferSubData,
+		MapBuffer,
+		MapBufferRange,
+		UnmapBuffer,
+		DispatchCompute,
+		MemoryBarrier,
+		FenceSync,
+		ClientWaitSync,
+		DeleteSync,
+
+		// Contents of mapped memory, written before the command that reads it
+		WriteMappedBuffer,
+
+		Count
+	};
+
+	// Each recorded command starts with a header and is followed by
+	// size bytes of arguments in the order of the function parameters.
+	// Uploaded data and strings follow their arguments, prefixed by their size.
+	struct CommandHeader
+	{
+		uint32_t call;
+		uint32_t size;
+	};
+
+	struct Stats
+	{
+		uint64_t bytesUploaded;
+		unsigned int drawCalls;
+		uint64_t drawnInstances;
+		unsigned int callCounts[static_cast<size_t>(Call::Count)];
+	};
+
+private:
+	static const unsigned int BufferTargetCount = 5;
+
+	struct BufferData
+	{
+		// CPU storage of the buffer, only used without a target device
+		uint8_t* storage;
+		size_t size;
+
+		// Current mapping of the buffer, if any
+		uint8_t* mapped;
+		size_t mappedOffset;
+		size_t mappedLength;
+		bool mappedForWrite;
+		bool mappedPersistent;
+	};
+
+	Allocator* allocator;
+	RenderDevice* target;
+
+	Array<uint8_t> commandStream;
+	size_t commandStart;
+	bool recording;
+
+	Stats stats;
+
+	unsigned int nextObjectId;
+	int nextUniformLocation;
+
+	// Indexed by buffer ID
+	Array<BufferData> buffers;
+	unsigned int boundBuffers[BufferTargetCount];
+
+	void BeginCommand(Call call);
+	void EndCommand();
+
+	void Write(const void* data, size_t size);
+
+	template <typename T>
+	void Write(const T& value) { Write(&value, sizeof(T)); }
+
+	void WritePayload(const void* data, size_t size);
+
+	void CreateObjectIds(unsigned int count, unsigned int* objectsOut);
+	void RecordObjects(Call call, unsigned int count, const unsigned int* objects);
+
+	void SetBoundBuffer(RenderBufferTarget target, unsigned int buffer);
+	unsigned int GetBoundBuffer(RenderBufferTarget target) const;
+	BufferData* GetBufferData(unsigned int buffer);
+
+	void SetBufferSize(RenderBufferTarget target, size_t size);
+	void SetBufferMapping(RenderBufferTarget target, void* mapped, size_t offset, size_t length,
+		bool write, bool persistent);
+
+	// Memory that holds the contents of a buffer range, or null if it isn't in CPU memory
+	const uint8_t* GetBufferContents(unsigned int buffer, size_t offset, size_t size);
+
+	// Record the contents of a mapped buffer range, unless the device already knows them
+	void RecordMappedWrite(unsigned int buffer, size_t offset, size_t size, bool persistentOnly);
+
+public:
+	// If target is null, the recorder acts as a null device
+	RenderDeviceRecorder(Allocator* allocator, RenderDevice* target);
+	~RenderDeviceRecorder();
+
+	// Start or stop recording calls into the command stream. Calls are
+	// counted in the stats either way.
+	void SetRecording(bool enable) { recording = enable; }
+
+	bool IsRecording() const { return recording; }
+
+	const Array<uint8_t>& GetCommandStream() const { return commandStream; }
+	void ClearCommandStream() { commandStream.Clear(); }
+
+	// Hand the recorded commands over and continue recording into <stream>
+	void SwapCommandStream(Array<uint8_t>& stream) { commandStream.Swap(stream); }
+
+	const Stats& GetStats() const { return stats; }
+	void ResetStats();
+
+	static const char* GetCallName(Call call);
+
+
+	virtual void GetIntegerValue(RenderDeviceParameter parameter, int* valueOut) override;
+
+	virtual void SetDebugMessageCallback(DebugCallbackFn callback) override;
+	virtual void SetObjectLabel(RenderObjectType type, unsigned int object, StringRef label) override;
+	virtual void SetObjectPtrLabel(void* ptr, StringRef label) override;
+	virtual void PushDebugGroup(unsigned int id, StringRef message) override;
+	virtual void PopDebugGroup() override;
+
+	virtual void Clear(const RenderCommandData::ClearMask* data) override;
+	virtual void ClearColor(const RenderCommandData::ClearColorData* data) override;
+	virtual void ClearDepth(float depth) override;
+
+	virtual void BlendingEnable() override;
+	virtual void BlendingDisable() override;
+	virtual void BlendFunction(const RenderCommandData::BlendFunctionData* data) override;
+	virtual void BlendFunction(RenderBlendFactor srcFactor, RenderBlendFactor dstFactor) override;
+
+	virtual void SetClipBehavior(RenderClipOriginMode origin, RenderClipDepthMode depth) override;
+	virtual void DepthRange(const RenderCommandData::DepthRangeData* data) override;
+	virtual void Viewport(const RenderCommandData::ViewportData* data) override;
+
+	virtual void DepthTestEnable() override;
+	virtual void DepthTestDisable() override;
+
+	virtual void DepthTestFunction(RenderDepthCompareFunc function) override;
+
+	virtual void DepthWriteEnable() override;
+	virtual void DepthWriteDisable() override;
+
+	virtual void CullFaceEnable() override;
+	virtual void CullFaceDisable() override;
+	virtual void CullFaceFront() override;
+	virtual void CullFaceBack() override;
+
+	virtual void FramebufferSrgbEnable() override;
+	virtual void FramebufferSrgbDisable() override;
+
+	virtual void CreateFramebuffers(unsigned int count, unsigned int* framebuffersOut) override;
+	virtual void DestroyFramebuffers(unsigned int count, unsigned int* framebuffers) override;
+	virtual void BindFramebuffer(const RenderCommandData::BindFramebufferData* data) override;
+	virtual void BindFramebuffer(RenderFramebufferTarget target, unsigned int framebuffer) override;
+	virtual void AttachFramebufferTexture2D(const RenderCommandData::AttachFramebufferTexture2D* data) override;
+	virtual void SetFramebufferDrawBuffers(unsigned int count, RenderFramebufferAttachment* buffers) override;
+
+	virtual void CreateTextures(unsigned int count, unsigned int* texturesOut) override;
+	virtual void DestroyTextures(unsigned int count, unsigned int* textures) override;
+	virtual void BindTexture(RenderTextureTarget target, unsigned int texture) override;
+	virtual void SetTextureStorage2D(const RenderCommandData::SetTextureStorage2D* data) override;
+	virtual void SetTextureImage2D(const RenderCommandData::SetTextureImage2D* data) override;
+	virtual void SetTextureSubImage2D(const RenderCommandData::SetTextureSubImage2D* data) override;
+	virtual void SetTextureImageCompressed2D(const RenderCommandData::SetTextureImageCompressed2D* data) override;
+	virtual void GenerateTextureMipmaps(RenderTextureTarget target) override;
+	virtual void SetActiveTextureUnit(unsigned int textureUnit) override;
+
+	virtual void SetTextureParameterInt(RenderTextureTarget target, RenderTextureParameter parameter, unsigned int value) override;
+	virtual void SetTextureMinFilter(RenderTextureTarget target, RenderTextureFilterMode mode) override;
+	virtual void SetTextureMagFilter(RenderTextureTarget target, RenderTextureFilterMode mode) override;
+	virtual void SetTextureWrapModeU(RenderTextureTarget target, RenderTextureWrapMode mode) override;
+	virtual void SetTextureWrapModeV(RenderTextureTarget target, RenderTextureWrapMode mode) override;
+	virtual void SetTextureWrapModeW(RenderTextureTarget target, RenderTextureWrapMode mode) override;
+	virtual void SetTextureCompareMode(RenderTextureTarget target, RenderTextureCompareMode mode) override;
+	virtual void SetTextureCompareFunc(RenderTextureTarget target, RenderDepthCompareFunc func) override;
+
+	virtual void CreateSamplers(unsigned int count, unsigned int* samplersOut) override;
+	virtual void DestroySamplers(unsigned int count, unsigned int* samplers) override;
+	virtual void BindSampler(unsigned int textureUnit, unsigned int sampler) override;
+	virtual void SetSamplerParameters(const RenderCommandData::SetSamplerParameters* data) override;
+
+	virtual unsigned int CreateShaderProgram() override;
+	virtual void DestroyShaderProgram(unsigned int shaderProgram) override;
+	virtual void AttachShaderStageToProgram(unsigned int shaderProgram, unsigned int shaderStage) override;
+	virtual void LinkShaderProgram(unsigned int shaderProgram) override;
+	virtual void UseShaderProgram(unsigned int shaderProgram) override;
+	virtual bool GetShaderProgramLinkStatus(unsigned int shaderProgram) override;
+	virtual int GetShaderProgramInfoLogLength(unsigned int shaderProgram) override;
+	virtual int GetShaderProgramParameterInt(unsigned int shaderProgram, unsigned int parameter) override;
+	virtual void GetShaderProgramInfoLog(unsigned int shaderProgram, unsigned int maxLength, char* logOut) override;
+
+	virtual unsigned int CreateShaderStage(RenderShaderStage stage) override;
+	virtual void DestroyShaderStage(unsigned int shaderStage) override;
+	virtual void SetShaderStageSource(unsigned int shaderStage, const char* source, int length) override;
+	virtual void CompileShaderStage(unsigned int shaderStage) override;
+	virtual int GetShaderStageParameterInt(unsigned int shaderStage, unsigned int parameter) override;
+	virtual bool GetShaderStageCompileStatus(unsigned int shaderStage) override;
+	virtual int GetShaderStageInfoLogLength(unsigned int shaderStage) override;
+	virtual void GetShaderStageInfoLog(unsigned int shaderStage, unsigned int maxLength, char* logOut) override;
+
+	virtual int GetUniformLocation(unsigned int shaderProgram, const char* uniformName) override;
+	virtual void SetUniformMat4x4f(int uniform, unsigned int count, const float* values) override;
+	virtual void SetUniformVec4f(int uniform, unsigned int count, const float* values) override;
+	virtual void SetUniformVec3f(int uniform, unsigned int count, const float* values) override;
+	virtual void SetUniformVec2f(int uniform, unsigned int count, const float* values) override;
+	virtual void SetUniformFloat(int uniform, float value) override;
+	virtual void SetUniformInt(int uniform, int value) override;
+
+	virtual void CreateVertexArrays(unsigned int count, unsigned int* vertexArraysOut) override;
+	virtual void DestroyVertexArrays(unsigned int count, unsigned int* vertexArrays) override;
+	virtual void BindVertexArray(unsigned int vertexArrayId) override;
+	virtual void EnableVertexAttribute(unsigned int index) override;
+	virtual void SetVertexAttributePointer(const RenderCommandData::SetVertexAttributePointer* data) override;
+
+	virtual void Draw(RenderPrimitiveMode mode, int offset, int vertexCount) override;
+	virtual void DrawIndexed(RenderPrimitiveMode mode, int indexCount, RenderIndexType indexType) override;
+	virtual void DrawInstanced(RenderPrimitiveMode mode, int offset, int vertexCount, int instanceCount) override;
+	virtual void DrawIndexedInstanced(RenderPrimitiveMode mode, int indexCount, RenderIndexType indexType, int instanceCount) override;
+	virtual void DrawIndexedInstancedBaseInstance(RenderPrimitiveMode mode, int indexCount, RenderIndexType indexType,
+		int instanceCount, unsigned int baseInstance) override;
+	virtual void MultiDrawIndexedIndirect(RenderPrimitiveMode mode, RenderIndexType indexType,
+		intptr_t offset, int drawCount, int stride) override;
+
+	virtual void CreateBuffers(unsigned int count, unsigned int* buffersOut) override;
+	virtual void DestroyBuffers(unsigned int count, unsigned int* buffers) override;
+	virtual void BindBuffer(RenderBufferTarget target, unsigned int buffer) override;
+	virtual void BindBufferBase(RenderBufferTarget target, unsigned int bindingPoint, unsigned int buffer) override;
+	virtual void BindBufferRange(const RenderCommandData::BindBufferRange* data) override;
+	virtual void SetBufferStorage(const RenderCommandData::SetBufferStorage* data) override;
+	virtual void SetBufferData(RenderBufferTarget target, unsigned int size, const void* data, RenderBufferUsage usage) override;
+	virtual void SetBufferSubData(RenderBufferTarget target, unsigned int offset, unsigned int size, const void* data) override;
+	virtual void* MapBuffer(RenderBufferTarget target, RenderBufferAccess access) override;
+	virtual void* MapBufferRange(const RenderCommandData::MapBufferRange* data) override;
+	virtual void UnmapBuffer(RenderBufferTarget target) override;
+
+	virtual void DispatchCompute(unsigned int numGroupsX, unsigned int numGroupsY, unsigned int numGroupsZ) override;
+
+	virtual void MemoryBarrier(const RenderCommandData::MemoryBarrier& barrier) override;
+
+	virtual RenderSyncObject FenceSync() override;
+	virtual RenderSyncWaitResult ClientWaitSync(RenderSyncObject sync, bool flushCommands, uint64_t timeoutNanoseconds) override;
+	virtual void DeleteSync(RenderSyncObject sync) override;
+};
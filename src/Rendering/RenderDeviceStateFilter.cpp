@@ -0,0 +1,799 @@
+#include "Rendering/RenderDeviceStateFilter.hpp"
+
+RenderDeviceStateFilter::RenderDeviceStateFilter(RenderDevice* device) :
+	device(device)
+{
+	InvalidateState();
+	ResetCallCounters();
+}
+
+void RenderDeviceStateFilter::InvalidateState()
+{
+	shaderProgram = Unknown;
+	vertexArray = Unknown;
+	framebuffer = Unknown;
+
+	activeTextureUnit = Unknown;
+
+	for (unsigned int unit = 0; unit < MaxTextureUnits; ++unit)
+	{
+		for (unsigned int target = 0; target < TextureTargetCount; ++target)
+			textures[unit][target] = Unknown;
+
+		samplers[unit] = Unknown;
+	}
+
+	for (unsigned int i = 0; i < BufferTargetCount; ++i)
+		buffers[i] = Unknown;
+
+	for (unsigned int i = 0; i < MaxBufferBindingPoints; ++i)
+	{
+		uniformBufferRanges[i] = BufferRange{ Unknown, 0, 0 };
+		storageBufferRanges[i] = BufferRange{ Unknown, 0, 0 };
+	}
+
+	viewportKnown = false;
+	blendFunctionKnown = false;
+	depthFunctionKnown = false;
+
+	blending = Toggle::Unknown;
+	depthTest = Toggle::Unknown;
+	depthWrite = Toggle::Unknown;
+	cullFace = Toggle::Unknown;
+	cullFaceBack = Toggle::Unknown;
+	framebufferSrgb = Toggle::Unknown;
+}
+
+void RenderDeviceStateFilter::ResetCallCounters()
+{
+	for (size_t i = 0; i < static_cast<size_t>(Call::Count); ++i)
+		counters[i] = CallCounter{ 0, 0 };
+}
+
+const char* RenderDeviceStateFilter::GetCallName(Call call)
+{
+	switch (call)
+	{
+	case Call::UseShaderProgram: return "UseShaderProgram";
+	case Call::BindVertexArray: return "BindVertexArray";
+	case Call::BindFramebuffer: return "BindFramebuffer";
+	case Call::SetActiveTextureUnit: return "SetActiveTextureUnit";
+	case Call::BindTexture: return "BindTexture";
+	case Call::BindSampler: return "BindSampler";
+	case Call::BindBuffer: return "BindBuffer";
+	case Call::BindBufferBase: return "BindBufferBase";
+	case Call::BindBufferRange: return "BindBufferRange";
+	case Call::Viewport: return "Viewport";
+	case Call::BlendFunction: return "BlendFunction";
+	case Call::DepthTestFunction: return "DepthTestFunction";
+	case Call::Blending: return "Blending";
+	case Call::DepthTest: return "DepthTest";
+	case Call::DepthWrite: return "DepthWrite";
+	case Call::CullFace: return "CullFace";
+	case Call::CullFaceMode: return "CullFaceMode";
+	case Call::FramebufferSrgb: return "FramebufferSrgb";
+	default: return "";
+	}
+}
+
+bool RenderDeviceStateFilter::Filter(Call call, bool changed)
+{
+	CallCounter& counter = counters[static_cast<size_t>(call)];
+
+	if (changed)
+		counter.forwarded += 1;
+	else
+		counter.elided += 1;
+
+	return changed;
+}
+
+void RenderDeviceStateFilter::SetToggle(Call call, Toggle& current, Toggle value, void (RenderDevice::*fn)())
+{
+	if (Filter(call, current != value))
+	{
+		current = value;
+		(device->*fn)();
+	}
+}
+
+RenderDeviceStateFilter::BufferRange* RenderDeviceStateFilter::GetIndexedBinding(
+	RenderBufferTarget target, unsigned int bindingPoint)
+{
+	if (bindingPoint >= MaxBufferBindingPoints)
+		return nullptr;
+
+	if (target == RenderBufferTarget::UniformBuffer)
+		return &uniformBufferRanges[bindingPoint];
+
+	if (target == RenderBufferTarget::ShaderStorageBuffer)
+		return &storageBufferRanges[bindingPoint];
+
+	return nullptr;
+}
+
+void RenderDeviceStateFilter::GetIntegerValue(RenderDeviceParameter parameter, int* valueOut)
+{
+	device->GetIntegerValue(parameter, valueOut);
+}
+
+void RenderDeviceStateFilter::SetDebugMessageCallback(DebugCallbackFn callback)
+{
+	device->SetDebugMessageCallback(callback);
+}
+
+void RenderDeviceStateFilter::SetObjectLabel(RenderObjectType type, unsigned int object, StringRef label)
+{
+	device->SetObjectLabel(type, object, label);
+}
+
+void RenderDeviceStateFilter::SetObjectPtrLabel(void* ptr, StringRef label)
+{
+	device->SetObjectPtrLabel(ptr, label);
+}
+
+void RenderDeviceStateFilter::PushDebugGroup(unsigned int id, StringRef message)
+{
+	device->PushDebugGroup(id, message);
+}
+
+void RenderDeviceStateFilter::PopDebugGroup()
+{
+	device->PopDebugGroup();
+}
+
+void RenderDeviceStateFilter::Clear(const RenderCommandData::ClearMask* data)
+{
+	device->Clear(data);
+}
+
+void RenderDeviceStateFilter::ClearColor(const RenderCommandData::ClearColorData* data)
+{
+	device->ClearColor(data);
+}
+
+void RenderDeviceStateFilter::ClearDepth(float depth)
+{
+	device->ClearDepth(depth);
+}
+
+void RenderDeviceStateFilter::BlendingEnable()
+{
+	SetToggle(Call::Blending, blending, Toggle::Enabled, &RenderDevice::BlendingEnable);
+}
+
+void RenderDeviceStateFilter::BlendingDisable()
+{
+	SetToggle(Call::Blending, blending, Toggle::Disabled, &RenderDevice::BlendingDisable);
+}
+
+void RenderDeviceStateFilter::BlendFunction(const RenderCommandData::BlendFunctionData* data)
+{
+	BlendFunction(data->srcFactor, data->dstFactor);
+}
+
+void RenderDeviceStateFilter::BlendFunction(RenderBlendFactor srcFactor, RenderBlendFactor dstFactor)
+{
+	bool changed = blendFunctionKnown == false ||
+		blendSrcFactor != srcFactor || blendDstFactor != dstFactor;
+
+	if (Filter(Call::BlendFunction, changed))
+	{
+		blendSrcFactor = srcFactor;
+		blendDstFactor = dstFactor;
+		blendFunctionKnown = true;
+
+		device->BlendFunction(srcFactor, dstFactor);
+	}
+}
+
+void RenderDeviceStateFilter::SetClipBehavior(RenderClipOriginMode origin, RenderClipDepthMode depth)
+{
+	device->SetClipBehavior(origin, depth);
+}
+
+void RenderDeviceStateFilter::DepthRange(const RenderCommandData::DepthRangeData* data)
+{
+	device->DepthRange(data);
+}
+
+void RenderDeviceStateFilter::Viewport(const RenderCommandData::ViewportData* data)
+{
+	bool changed = viewportKnown == false ||
+		viewport.x != data->x || viewport.y != data->y ||
+		viewport.w != data->w || viewport.h != data->h;
+
+	if (Filter(Call::Viewport, changed))
+	{
+		viewport = *data;
+		viewportKnown = true;
+
+		device->Viewport(data);
+	}
+}
+
+void RenderDeviceStateFilter::DepthTestEnable()
+{
+	SetToggle(Call::DepthTest, depthTest, Toggle::Enabled, &RenderDevice::DepthTestEnable);
+}
+
+void RenderDeviceStateFilter::DepthTestDisable()
+{
+	SetToggle(Call::DepthTest, depthTest, Toggle::Disabled, &RenderDevice::DepthTestDisable);
+}
+
+void RenderDeviceStateFilter::DepthTestFunction(RenderDepthCompareFunc function)
+{
+	if (Filter(Call::DepthTestFunction, depthFunctionKnown == false || depthFunction != function))
+	{
+		depthFunction = function;
+		depthFunctionKnown = true;
+
+		device->DepthTestFunction(function);
+	}
+}
+
+void RenderDeviceStateFilter::DepthWriteEnable()
+{
+	SetToggle(Call::DepthWrite, depthWrite, Toggle::Enabled, &RenderDevice::DepthWriteEnable);
+}
+
+void RenderDeviceStateFilter::DepthWriteDisable()
+{
+	SetToggle(Call::DepthWrite, depthWrite, Toggle::Disabled, &RenderDevice::DepthWriteDisable);
+}
+
+void RenderDeviceStateFilter::CullFaceEnable()
+{
+	SetToggle(Call::CullFace, cullFace, Toggle::Enabled, &RenderDevice::CullFaceEnable);
+}
+
+void RenderDeviceStateFilter::CullFaceDisable()
+{
+	SetToggle(Call::CullFace, cullFace, Toggle::Disabled, &RenderDevice::CullFaceDisable);
+}
+
+void RenderDeviceStateFilter::CullFaceFront()
+{
+	SetToggle(Call::CullFaceMode, cullFaceBack, Toggle::Disabled, &RenderDevice::CullFaceFront);
+}
+
+void RenderDeviceStateFilter::CullFaceBack()
+{
+	SetToggle(Call::CullFaceMode, cullFaceBack, Toggle::Enabled, &RenderDevice::CullFaceBack);
+}
+
+void RenderDeviceStateFilter::FramebufferSrgbEnable()
+{
+	SetToggle(Call::FramebufferSrgb, framebufferSrgb, Toggle::Enabled, &RenderDevice::FramebufferSrgbEnable);
+}
+
+void RenderDeviceStateFilter::FramebufferSrgbDisable()
+{
+	SetToggle(Call::FramebufferSrgb, framebufferSrgb, Toggle::Disabled, &RenderDevice::FramebufferSrgbDisable);
+}
+
+void RenderDeviceStateFilter::CreateFramebuffers(unsigned int count, unsigned int* framebuffersOut)
+{
+	device->CreateFramebuffers(count, framebuffersOut);
+}
+
+void RenderDeviceStateFilter::DestroyFramebuffers(unsigned int count, unsigned int* framebuffers)
+{
+	for (unsigned int i = 0; i < count; ++i)
+		if (framebuffers[i] == framebuffer)
+			framebuffer = Unknown;
+
+	device->DestroyFramebuffers(count, framebuffers);
+}
+
+void RenderDeviceStateFilter::BindFramebuffer(const RenderCommandData::BindFramebufferData* data)
+{
+	BindFramebuffer(data->target, data->framebuffer);
+}
+
+void RenderDeviceStateFilter::BindFramebuffer(RenderFramebufferTarget target, unsigned int framebuffer)
+{
+	if (Filter(Call::BindFramebuffer, this->framebuffer != framebuffer))
+	{
+		this->framebuffer = framebuffer;
+		device->BindFramebuffer(target, framebuffer);
+	}
+}
+
+void RenderDeviceStateFilter::AttachFramebufferTexture2D(const RenderCommandData::AttachFramebufferTexture2D* data)
+{
+	device->AttachFramebufferTexture2D(data);
+}
+
+void RenderDeviceStateFilter::SetFramebufferDrawBuffers(unsigned int count, RenderFramebufferAttachment* buffers)
+{
+	device->SetFramebufferDrawBuffers(count, buffers);
+}
+
+void RenderDeviceStateFilter::CreateTextures(unsigned int count, unsigned int* texturesOut)
+{
+	device->CreateTextures(count, texturesOut);
+}
+
+void RenderDeviceStateFilter::DestroyTextures(unsigned int count, unsigned int* textures)
+{
+	for (unsigned int i = 0; i < count; ++i)
+		for (unsigned int unit = 0; unit < MaxTextureUnits; ++unit)
+			for (unsigned int target = 0; target < TextureTargetCount; ++target)
+				if (this->textures[unit][target] == textures[i])
+					this->textures[unit][target] = Unknown;
+
+	device->DestroyTextures(count, textures);
+}
+
+void RenderDeviceStateFilter::BindTexture(RenderTextureTarget target, unsigned int texture)
+{
+	unsigned int targetIndex = static_cast<unsigned int>(target);
+
+	// Bindings of unknown or untracked texture units are always forwarded
+	if (activeTextureUnit >= MaxTextureUnits || targetIndex >= TextureTargetCount)
+	{
+		Filter(Call::BindTexture, true);
+		device->BindTexture(target, texture);
+		return;
+	}
+
+	unsigned int& bound = textures[activeTextureUnit][targetIndex];
+
+	if (Filter(Call::BindTexture, bound != texture))
+	{
+		bound = texture;
+		device->BindTexture(target, texture);
+	}
+}
+
+void RenderDeviceStateFilter::SetTextureStorage2D(const RenderCommandData::SetTextureStorage2D* data)
+{
+	device->SetTextureStorage2D(data);
+}
+
+void RenderDeviceStateFilter::SetTextureImage2D(const RenderCommandData::SetTextureImage2D* data)
+{
+	device->SetTextureImage2D(data);
+}
+
+void RenderDeviceStateFilter::SetTextureSubImage2D(const RenderCommandData::SetTextureSubImage2D* data)
+{
+	device->SetTextureSubImage2D(data);
+}
+
+void RenderDeviceStateFilter::SetTextureImageCompressed2D(const RenderCommandData::SetTextureImageCompressed2D* data)
+{
+	device->SetTextureImageCompressed2D(data);
+}
+
+void RenderDeviceStateFilter::GenerateTextureMipmaps(RenderTextureTarget target)
+{
+	device->GenerateTextureMipmaps(target);
+}
+
+void RenderDeviceStateFilter::SetActiveTextureUnit(unsigned int textureUnit)
+{
+	if (Filter(Call::SetActiveTextureUnit, activeTextureUnit != textureUnit))
+	{
+		activeTextureUnit = textureUnit;
+		device->SetActiveTextureUnit(textureUnit);
+	}
+}
+
+void RenderDeviceStateFilter::SetTextureParameterInt(RenderTextureTarget target, RenderTextureParameter parameter, unsigned int value)
+{
+	device->SetTextureParameterInt(target, parameter, value);
+}
+
+void RenderDeviceStateFilter::SetTextureMinFilter(RenderTextureTarget target, RenderTextureFilterMode mode)
+{
+	device->SetTextureMinFilter(target, mode);
+}
+
+void RenderDeviceStateFilter::SetTextureMagFilter(RenderTextureTarget target, RenderTextureFilterMode mode)
+{
+	device->SetTextureMagFilter(target, mode);
+}
+
+void RenderDeviceStateFilter::SetTextureWrapModeU(RenderTextureTarget target, RenderTextureWrapMode mode)
+{
+	device->SetTextureWrapModeU(target, mode);
+}
+
+void RenderDeviceStateFilter::SetTextureWrapModeV(RenderTextureTarget target, RenderTextureWrapMode mode)
+{
+	device->SetTextureWrapModeV(target, mode);
+}
+
+void RenderDeviceStateFilter::SetTextureWrapModeW(RenderTextureTarget target, RenderTextureWrapMode mode)
+{
+	device->SetTextureWrapModeW(target, mode);
+}
+
+void RenderDeviceStateFilter::SetTextureCompareMode(RenderTextureTarget target, RenderTextureCompareMode mode)
+{
+	device->SetTextureCompareMode(target, mode);
+}
+
+void RenderDeviceStateFilter::SetTextureCompareFunc(RenderTextureTarget target, RenderDepthCompareFunc func)
+{
+	device->SetTextureCompareFunc(target, func);
+}
+
+void RenderDeviceStateFilter::CreateSamplers(unsigned int count, unsigned int* samplersOut)
+{
+	device->CreateSamplers(count, samplersOut);
+}
+
+void RenderDeviceStateFilter::DestroySamplers(unsigned int count, unsigned int* samplers)
+{
+	for (unsigned int i = 0; i < count; ++i)
+		for (unsigned int unit = 0; unit < MaxTextureUnits; ++unit)
+			if (this->samplers[unit] == samplers[i])
+				this->samplers[unit] = Unknown;
+
+	device->DestroySamplers(count, samplers);
+}
+
+void RenderDeviceStateFilter::BindSampler(unsigned int textureUnit, unsigned int sampler)
+{
+	if (textureUnit >= MaxTextureUnits)
+	{
+		Filter(Call::BindSampler, true);
+		device->BindSampler(textureUnit, sampler);
+		return;
+	}
+
+	if (Filter(Call::BindSampler, samplers[textureUnit] != sampler))
+	{
+		samplers[textureUnit] = sampler;
+		device->BindSampler(textureUnit, sampler);
+	}
+}
+
+void RenderDeviceStateFilter::SetSamplerParameters(const RenderCommandData::SetSamplerParameters* data)
+{
+	device->SetSamplerParameters(data);
+}
+
+unsigned int RenderDeviceStateFilter::CreateShaderProgram()
+{
+	return device->CreateShaderProgram();
+}
+
+void RenderDeviceStateFilter::DestroyShaderProgram(unsigned int shaderProgram)
+{
+	if (this->shaderProgram == shaderProgram)
+		this->shaderProgram = Unknown;
+
+	device->DestroyShaderProgram(shaderProgram);
+}
+
+void RenderDeviceStateFilter::AttachShaderStageToProgram(unsigned int shaderProgram, unsigned int shaderStage)
+{
+	device->AttachShaderStageToProgram(shaderProgram, shaderStage);
+}
+
+void RenderDeviceStateFilter::LinkShaderProgram(unsigned int shaderProgram)
+{
+	device->LinkShaderProgram(shaderProgram);
+}
+
+void RenderDeviceStateFilter::UseShaderProgram(unsigned int shaderProgram)
+{
+	if (Filter(Call::UseShaderProgram, this->shaderProgram != shaderProgram))
+	{
+		this->shaderProgram = shaderProgram;
+		device->UseShaderProgram(shaderProgram);
+	}
+}
+
+int RenderDeviceStateFilter::GetShaderProgramParameterInt(unsigned int shaderProgram, unsigned int parameter)
+{
+	return device->GetShaderProgramParameterInt(shaderProgram, parameter);
+}
+
+bool RenderDeviceStateFilter::GetShaderProgramLinkStatus(unsigned int shaderProgram)
+{
+	return device->GetShaderProgramLinkStatus(shaderProgram);
+}
+
+int RenderDeviceStateFilter::GetShaderProgramInfoLogLength(unsigned int shaderProgram)
+{
+	return device->GetShaderProgramInfoLogLength(shaderProgram);
+}
+
+void RenderDeviceStateFilter::GetShaderProgramInfoLog(unsigned int shaderProgram, unsigned int maxLength, char* logOut)
+{
+	device->GetShaderProgramInfoLog(shaderProgram, maxLength, logOut);
+}
+
+unsigned int RenderDeviceStateFilter::CreateShaderStage(RenderShaderStage stage)
+{
+	return device->CreateShaderStage(stage);
+}
+
+void RenderDeviceStateFilter::DestroyShaderStage(unsigned int shaderStage)
+{
+	device->DestroyShaderStage(shaderStage);
+}
+
+void RenderDeviceStateFilter::SetShaderStageSource(unsigned int shaderStage, const char* source, int length)
+{
+	device->SetShaderStageSource(shaderStage, source, length);
+}
+
+void RenderDeviceStateFilter::CompileShaderStage(unsigned int shaderStage)
+{
+	device->CompileShaderStage(shaderStage);
+}
+
+int RenderDeviceStateFilter::GetShaderStageParameterInt(unsigned int shaderStage, unsigned int parameter)
+{
+	return device->GetShaderStageParameterInt(shaderStage, parameter);
+}
+
+bool RenderDeviceStateFilter::GetShaderStageCompileStatus(unsigned int shaderStage)
+{
+	return device->GetShaderStageCompileStatus(shaderStage);
+}
+
+int RenderDeviceStateFilter::GetShaderStageInfoLogLength(unsigned int shaderStage)
+{
+	return device->GetShaderStageInfoLogLength(shaderStage);
+}
+
+void RenderDeviceStateFilter::GetShaderStageInfoLog(unsigned int shaderStage, unsigned int maxLength, char* logOut)
+{
+	device->GetShaderStageInfoLog(shaderStage, maxLength, logOut);
+}
+
+int RenderDeviceStateFilter::GetUniformLocation(unsigned int shaderProgram, const char* uniformName)
+{
+	return device->GetUniformLocation(shaderProgram, uniformName);
+}
+
+void RenderDeviceStateFilter::SetUniformMat4x4f(int uniform, unsigned int count, const float* values)
+{
+	device->SetUniformMat4x4f(uniform, count, values);
+}
+
+void RenderDeviceStateFilter::SetUniformVec4f(int uniform, unsigned int count, const float* values)
+{
+	device->SetUniformVec4f(uniform, count, values);
+}
+
+void RenderDeviceStateFilter::SetUniformVec3f(int uniform, unsigned int count, const float* values)
+{
+	device->SetUniformVec3f(uniform, count, values);
+}
+
+void RenderDeviceStateFilter::SetUniformVec2f(int uniform, unsigned int count, const float* values)
+{
+	device->SetUniformVec2f(uniform, count, values);
+}
+
+void RenderDeviceStateFilter::SetUniformFloat(int uniform, float value)
+{
+	device->SetUniformFloat(uniform, value);
+}
+
+void RenderDeviceStateFilter::SetUniformInt(int uniform, int value)
+{
+	device->SetUniformInt(uniform, value);
+}
+
+void RenderDeviceStateFilter::CreateVertexArrays(unsigned int count, unsigned int* vertexArraysOut)
+{
+	device->CreateVertexArrays(count, vertexArraysOut);
+}
+
+void RenderDeviceStateFilter::DestroyVertexArrays(unsigned int count, unsigned int* vertexArrays)
+{
+	for (unsigned int i = 0; i < count; ++i)
+	{
+		if (vertexArrays[i] == vertexArray)
+		{
+			vertexArray = Unknown;
+			buffers[static_cast<size_t>(RenderBufferTarget::IndexBuffer)] = Unknown;
+		}
+	}
+
+	device->DestroyVertexArrays(count, vertexArrays);
+}
+
+void RenderDeviceStateFilter::BindVertexArray(unsigned int vertexArrayId)
+{
+	if (Filter(Call::BindVertexArray, vertexArray != vertexArrayId))
+	{
+		vertexArray = vertexArrayId;
+
+		// Index buffer binding is part of the vertex array state
+		buffers[static_cast<size_t>(RenderBufferTarget::IndexBuffer)] = Unknown;
+
+		device->BindVertexArray(vertexArrayId);
+	}
+}
+
+void RenderDeviceStateFilter::EnableVertexAttribute(unsigned int index)
+{
+	device->EnableVertexAttribute(index);
+}
+
+void RenderDeviceStateFilter::SetVertexAttributePointer(const RenderCommandData::SetVertexAttributePointer* data)
+{
+	device->SetVertexAttributePointer(data);
+}
+
+void RenderDeviceStateFilter::Draw(RenderPrimitiveMode mode, int offset, int vertexCount)
+{
+	device->Draw(mode, offset, vertexCount);
+}
+
+void RenderDeviceStateFilter::DrawIndexed(RenderPrimitiveMode mode, int indexCount, RenderIndexType indexType)
+{
+	device->DrawIndexed(mode, indexCount, indexType);
+}
+
+void RenderDeviceStateFilter::DrawInstanced(RenderPrimitiveMode mode, int offset, int vertexCount, int instanceCount)
+{
+	device->DrawInstanced(mode, offset, vertexCount, instanceCount);
+}
+
+void RenderDeviceStateFilter::DrawIndexedInstanced(RenderPrimitiveMode mode, int indexCount, RenderIndexType indexType, int instanceCount)
+{
+	device->DrawIndexedInstanced(mode, indexCount, indexType, instanceCount);
+}
+
+void RenderDeviceStateFilter::DrawIndexedInstancedBaseInstance(RenderPrimitiveMode mode, int indexCount, RenderIndexType indexType, int instanceCount, unsigned int baseInstance)
+{
+	device->DrawIndexedInstancedBaseInstance(mode, indexCount, indexType, instanceCount, baseInstance);
+}
+
+void RenderDeviceStateFilter::MultiDrawIndexedIndirect(RenderPrimitiveMode mode, RenderIndexType indexType, intptr_t offset, int drawCount, int stride)
+{
+	device->MultiDrawIndexedIndirect(mode, indexType, offset, drawCount, stride);
+}
+
+void RenderDeviceStateFilter::CreateBuffers(unsigned int count, unsigned int* buffersOut)
+{
+	device->CreateBuffers(count, buffersOut);
+}
+
+void RenderDeviceStateFilter::DestroyBuffers(unsigned int count, unsigned int* buffers)
+{
+	for (unsigned int i = 0; i < count; ++i)
+	{
+		for (unsigned int target = 0; target < BufferTargetCount; ++target)
+			if (this->buffers[target] == buffers[i])
+				this->buffers[target] = Unknown;
+
+		for (unsigned int point = 0; point < MaxBufferBindingPoints; ++point)
+		{
+			if (uniformBufferRanges[point].buffer == buffers[i])
+				uniformBufferRanges[point].buffer = Unknown;
+
+			if (storageBufferRanges[point].buffer == buffers[i])
+				storageBufferRanges[point].buffer = Unknown;
+		}
+	}
+
+	device->DestroyBuffers(count, buffers);
+}
+
+void RenderDeviceStateFilter::BindBuffer(RenderBufferTarget target, unsigned int buffer)
+{
+	unsigned int targetIndex = static_cast<unsigned int>(target);
+
+	if (targetIndex >= BufferTargetCount)
+	{
+		Filter(Call::BindBuffer, true);
+		device->BindBuffer(target, buffer);
+		return;
+	}
+
+	if (Filter(Call::BindBuffer, buffers[targetIndex] != buffer))
+	{
+		buffers[targetIndex] = buffer;
+		device->BindBuffer(target, buffer);
+	}
+}
+
+void RenderDeviceStateFilter::BindBufferBase(RenderBufferTarget target, unsigned int bindingPoint, unsigned int buffer)
+{
+	BufferRange* binding = GetIndexedBinding(target, bindingPoint);
+
+	// Whole buffer bindings are stored as ranges with zero length
+	bool changed = binding == nullptr ||
+		binding->buffer != buffer || binding->offset != 0 || binding->length != 0;
+
+	if (Filter(Call::BindBufferBase, changed))
+	{
+		if (binding != nullptr)
+			*binding = BufferRange{ buffer, 0, 0 };
+
+		// Indexed binding also replaces the generic binding of the target
+		unsigned int targetIndex = static_cast<unsigned int>(target);
+		if (targetIndex < BufferTargetCount)
+			buffers[targetIndex] = buffer;
+
+		device->BindBufferBase(target, bindingPoint, buffer);
+	}
+}
+
+void RenderDeviceStateFilter::BindBufferRange(const RenderCommandData::BindBufferRange* data)
+{
+	BufferRange* binding = GetIndexedBinding(data->target, data->bindingPoint);
+
+	bool changed = binding == nullptr || binding->buffer != data->buffer ||
+		binding->offset != data->offset || binding->length != data->length;
+
+	if (Filter(Call::BindBufferRange, changed))
+	{
+		if (binding != nullptr)
+			*binding = BufferRange{ data->buffer, data->offset, data->length };
+
+		unsigned int targetIndex = static_cast<unsigned int>(data->target);
+		if (targetIndex < BufferTargetCount)
+			buffers[targetIndex] = data->buffer;
+
+		device->BindBufferRange(data);
+	}
+}
+
+void RenderDeviceStateFilter::SetBufferStorage(const RenderCommandData::SetBufferStorage* data)
+{
+	device->SetBufferStorage(data);
+}
+
+void RenderDeviceStateFilter::SetBufferData(RenderBufferTarget target, unsigned int size, const void* data, RenderBufferUsage usage)
+{
+	device->SetBufferData(target, size, data, usage);
+}
+
+void RenderDeviceStateFilter::SetBufferSubData(RenderBufferTarget target, unsigned int offset, unsigned int size, const void* data)
+{
+	device->SetBufferSubData(target, offset, size, data);
+}
+
+void* RenderDeviceStateFilter::MapBuffer(RenderBufferTarget target, RenderBufferAccess access)
+{
+	return device->MapBuffer(target, access);
+}
+
+void* RenderDeviceStateFilter::MapBufferRange(const RenderCommandData::MapBufferRange* data)
+{
+	return device->MapBufferRange(data);
+}
+
+void RenderDeviceStateFilter::UnmapBuffer(RenderBufferTarget target)
+{
+	device->UnmapBuffer(target);
+}
+
+void RenderDeviceStateFilter::DispatchCompute(unsigned int numGroupsX, unsigned int numGroupsY, unsigned int numGroupsZ)
+{
+	device->DispatchCompute(numGroupsX, numGroupsY, numGroupsZ);
+}
+
+void RenderDeviceStateFilter::MemoryBarrier(const RenderCommandData::MemoryBarrier& barrier)
+{
+	device->MemoryBarrier(barrier);
+}
+
+RenderSyncObject RenderDeviceStateFilter::FenceSync()
+{
+	return device->FenceSync();
+}
+
+RenderSyncWaitResult RenderDeviceStateFilter::ClientWaitSync(RenderSyncObject sync, bool flushCommands, uint64_t timeoutNanoseconds)
+{
+	return device->ClientWaitSync(sync, flushCommands, timeoutNanoseconds);
+}
+
+void RenderDeviceStateFilter::DeleteSync(RenderSyncObject sync)
+{
+	device->DeleteSync(sync);
+}
@@ -0,0 +1,402 @@
+#include "Rendering/RenderGraph.hpp"
+
+#include <cassert>
+
+static bool IsReadAccess(RenderGraphAccess access)
+{
+	return access == RenderGraphAccess::ShaderRead ||
+		access == RenderGraphAccess::StorageRead ||
+		access == RenderGraphAccess::RenderTargetRead ||
+		access == RenderGraphAccess::RenderTargetBlend;
+}
+
+static bool IsWriteAccess(RenderGraphAccess access)
+{
+	return access == RenderGraphAccess::RenderTargetWrite ||
+		access == RenderGraphAccess::RenderTargetBlend ||
+		access == RenderGraphAccess::StorageWrite;
+}
+
+static unsigned int AccessBit(RenderGraphAccess access)
+{
+	return 1u << static_cast<unsigned int>(access);
+}
+
+RenderGraph::RenderGraph(Allocator* allocator) :
+	resources(allocator),
+	passes(allocator),
+	accesses(allocator),
+	compiledPasses(allocator),
+	barriers(allocator),
+	physicalTextures(allocator),
+	resourceNeeded(allocator),
+	lastWriteIndex(allocator),
+	lastReadIndex(allocator),
+	syncedReads(allocator)
+{
+}
+
+void RenderGraph::Clear()
+{
+	resources.Clear();
+	passes.Clear();
+	accesses.Clear();
+
+	compiledPasses.Clear();
+	barriers.Clear();
+	physicalTextures.Clear();
+}
+
+RenderGraphResourceId RenderGraph::AddResource(const char* name, ResourceType type)
+{
+	RenderGraphResourceId id{ resources.GetCount() };
+
+	Resource& resource = resources.PushBack();
+	resource.name = name;
+	resource.type = type;
+	resource.desc = TextureDesc{ Vec2i(0, 0), RenderTextureSizedFormat::RGBA8 };
+	resource.imported = false;
+	resource.output = false;
+	resource.object = 0;
+	resource.framebuffer = 0;
+	resource.physicalTexture = Null;
+	resource.firstUse = Null;
+	resource.lastUse = Null;
+
+	return id;
+}
+
+RenderGraphResourceId RenderGraph::ImportTexture(const char* name, const TextureDesc& desc,
+	unsigned int texture, unsigned int framebuffer)
+{
+	RenderGraphResourceId id = AddResource(name, ResourceType::Texture);
+
+	Resource& resource = resources[id.i];
+	resource.desc = desc;
+	resource.imported = true;
+	resource.object = texture;
+	resource.framebuffer = framebuffer;
+
+	return id;
+}
+
+RenderGraphResourceId RenderGraph::ImportBuffer(const char* name, unsigned int buffer)
+{
+	RenderGraphResourceId id = AddResource(name, ResourceType::Buffer);
+
+	Resource& resource = resources[id.i];
+	resource.imported = true;
+	resource.object = buffer;
+
+	return id;
+}
+
+RenderGraphResourceId RenderGraph::CreateTexture(const char* name, const TextureDesc& desc)
+{
+	RenderGraphResourceId id = AddResource(name, ResourceType::Texture);
+	resources[id.i].desc = desc;
+
+	return id;
+}
+
+void RenderGraph::MarkOutput(RenderGraphResourceId resource)
+{
+	resources[resource.i].output = true;
+}
+
+RenderGraphPassId RenderGraph::AddPass(const char* name, ExecuteFunction function, void* userData, unsigned int passData)
+{
+	RenderGraphPassId id{ passes.GetCount() };
+
+	Pass& pass = passes.PushBack();
+	pass.name = name;
+	pass.function = function;
+	pass.userData = userData;
+	pass.passData = passData;
+	pass.firstAccess = accesses.GetCount();
+	pass.accessCount = 0;
+	pass.sideEffect = false;
+	pass.live = false;
+
+	return id;
+}
+
+void RenderGraph::AddAccess(RenderGraphPassId pass, RenderGraphResourceId resource, RenderGraphAccess access)
+{
+	// Accesses of a pass are stored contiguously
+	assert(pass.i + 1 == passes.GetCount());
+	assert(resource.i < resources.GetCount());
+
+	accesses.PushBack(Access{ resource, access });
+	passes[pass.i].accessCount += 1;
+}
+
+void RenderGraph::SetSideEffect(RenderGraphPassId pass)
+{
+	passes[pass.i].sideEffect = true;
+}
+
+void RenderGraph::Compile()
+{
+	compiledPasses.Clear();
+	barriers.Clear();
+	physicalTextures.Clear();
+
+	CullPasses();
+
+	for (unsigned int passIdx = 0, count = passes.GetCount(); passIdx < count; ++passIdx)
+	{
+		if (passes[passIdx].live)
+		{
+			CompiledPass& compiled = compiledPasses.PushBack();
+			compiled.pass = RenderGraphPassId{ passIdx };
+			compiled.firstBarrier = 0;
+			compiled.barrierCount = 0;
+		}
+	}
+
+	FindBarriers();
+	AssignPhysicalTextures();
+}
+
+void RenderGraph::CullPasses()
+{
+	unsigned int resourceCount = resources.GetCount();
+
+	// Whether a later pass, or the graph's output, uses the current contents
+	resourceNeeded.Resize(resourceCount);
+	for (unsigned int i = 0; i < resourceCount; ++i)
+		resourceNeeded[i] = resources[i].output;
+
+	for (unsigned int passIdx = passes.GetCount(); passIdx-- > 0;)
+	{
+		Pass& pass = passes[passIdx];
+		const Access* passAccesses = accesses.GetData() + pass.firstAccess;
+
+		bool live = pass.sideEffect;
+
+		for (unsigned int i = 0; i < pass.accessCount && live == false; ++i)
+			if (IsWriteAccess(passAccesses[i].access) && resourceNeeded[passAccesses[i].resource.i])
+				live = true;
+
+		pass.live = live;
+
+		if (live == false)
+			continue;
+
+		// Contents a pass overwrites aren't needed from earlier passes,
+		// unless the pass also reads them
+		for (unsigned int i = 0; i < pass.accessCount; ++i)
+			if (IsWriteAccess(passAccesses[i].access))
+				resourceNeeded[passAccesses[i].resource.i] = false;
+
+		for (unsigned int i = 0; i < pass.accessCount; ++i)
+			if (IsReadAccess(passAccesses[i].access))
+				resourceNeeded[passAccesses[i].resource.i] = true;
+	}
+}
+
+void RenderGraph::FindBarriers()
+{
+	unsigned int resourceCount = resources.GetCount();
+
+	lastWriteIndex.Resize(resourceCount);
+	lastReadIndex.Resize(resourceCount);
+	syncedReads.Resize(resourceCount);
+
+	for (unsigned int i = 0; i < resourceCount; ++i)
+	{
+		lastWriteIndex[i] = Null;
+		lastReadIndex[i] = Null;
+		syncedReads[i] = 0;
+		resources[i].physicalTexture = Null;
+		resources[i].firstUse = Null;
+		resources[i].lastUse = Null;
+	}
+
+	for (unsigned int compiledIdx = 0, count = compiledPasses.GetCount(); compiledIdx < count; ++compiledIdx)
+	{
+		CompiledPass& compiled = compiledPasses[compiledIdx];
+		const Pass& pass = passes[compiled.pass.i];
+
+		compiled.firstBarrier = barriers.GetCount();
+
+		for (unsigned int accessIdx = pass.firstAccess, end = pass.firstAccess + pass.accessCount;
+			accessIdx < end; ++accessIdx)
+		{
+			const Access& access = accesses[accessIdx];
+			unsigned int resourceIdx = access.resource.i;
+			Resource& resource = resources[resourceIdx];
+
+			if (resource.firstUse == Null)
+				resource.firstUse = compiledIdx;
+
+			resource.lastUse = compiledIdx;
+
+			// Find the earlier access the pass has to wait for
+			unsigned int sourceIdx = Null;
+
+			if (IsWriteAccess(access.access))
+			{
+				// Write after read, or write after write
+				sourceIdx = lastReadIndex[resourceIdx] != Null ?
+					lastReadIndex[resourceIdx] : lastWriteIndex[resourceIdx];
+			}
+			else if ((syncedReads[resourceIdx] & AccessBit(access.access)) == 0)
+			{
+				// Read after write, once for each kind of read
+				sourceIdx = lastWriteIndex[resourceIdx];
+			}
+
+			if (sourceIdx == Null)
+				continue;
+
+			bool found = false;
+
+			// A resource gets one barrier per pass, the one of the write if there is one
+			for (unsigned int i = compiled.firstBarrier, barrierEnd = barriers.GetCount(); i < barrierEnd; ++i)
+			{
+				if (barriers[i].resource == access.resource)
+				{
+					if (IsWriteAccess(access.access))
+					{
+						barriers[i].sourceAccess = accesses[sourceIdx].access;
+						barriers[i].destinationAccess = access.access;
+					}
+
+					found = true;
+				}
+			}
+
+			if (found == false)
+				barriers.PushBack(Barrier{ access.resource, accesses[sourceIdx].access, access.access });
+		}
+
+		compiled.barrierCount = barriers.GetCount() - compiled.firstBarrier;
+
+		// Later passes synchronize with the accesses of this pass
+		for (unsigned int accessIdx = pass.firstAccess, end = pass.firstAccess + pass.accessCount;
+			accessIdx < end; ++accessIdx)
+		{
+			const Access& access = accesses[accessIdx];
+			unsigned int resourceIdx = access.resource.i;
+
+			if (IsWriteAccess(access.access))
+			{
+				lastWriteIndex[resourceIdx] = accessIdx;
+				lastReadIndex[resourceIdx] = Null;
+				syncedReads[resourceIdx] = 0;
+			}
+		}
+
+		for (unsigned int accessIdx = pass.firstAccess, end = pass.firstAccess + pass.accessCount;
+			accessIdx < end; ++accessIdx)
+		{
+			const Access& access = accesses[accessIdx];
+			unsigned int resourceIdx = access.resource.i;
+
+			// Reads of a pass that also writes the resource are ordered by the pass
+			bool writtenByPass = lastWriteIndex[resourceIdx] != Null && lastWriteIndex[resourceIdx] >= pass.firstAccess;
+
+			if (IsWriteAccess(access.access) == false && writtenByPass == false)
+			{
+				lastReadIndex[resourceIdx] = accessIdx;
+				syncedReads[resourceIdx] |= AccessBit(access.access);
+			}
+		}
+	}
+}
+
+void RenderGraph::AssignPhysicalTextures()
+{
+	// Visiting textures in order of their first use and reusing any physical
+	// texture that is free by then uses the fewest physical textures
+	for (unsigned int compiledIdx = 0, count = compiledPasses.GetCount(); compiledIdx < count; ++compiledIdx)
+	{
+		const Pass& pass = passes[compiledPasses[compiledIdx].pass.i];
+
+		for (unsigned int i = 0; i < pass.accessCount; ++i)
+		{
+			Resource& resource = resources[accesses[pass.firstAccess + i].resource.i];
+
+			if (resource.imported || resource.type != ResourceType::Texture ||
+				resource.firstUse != compiledIdx || resource.physicalTexture != Null)
+				continue;
+
+			unsigned int physicalIdx = 0;
+			unsigned int physicalCount = physicalTextures.GetCount();
+
+			for (; physicalIdx < physicalCount; ++physicalIdx)
+			{
+				const PhysicalTexture& physical = physicalTextures[physicalIdx];
+
+				if (physical.lastUse < compiledIdx && physical.desc == resource.desc)
+					break;
+			}
+
+			if (physicalIdx == physicalCount)
+			{
+				PhysicalTexture& physical = physicalTextures.PushBack();
+				physical.desc = resource.desc;
+				physical.texture = 0;
+				physical.framebuffer = 0;
+			}
+
+			physicalTextures[physicalIdx].lastUse = resource.lastUse;
+			resource.physicalTexture = physicalIdx;
+		}
+	}
+}
+
+void RenderGraph::ExecutePass(unsigned int compiledPassIndex) const
+{
+	const Pass& pass = passes[compiledPasses[compiledPassIndex].pass.i];
+
+	if (pass.function != nullptr)
+		pass.function(pass.userData, pass.passData);
+}
+
+void RenderGraph::SetPhysicalTexture(unsigned int index, unsigned int texture, unsigned int framebuffer)
+{
+	physicalTextures[index].texture = texture;
+	physicalTextures[index].framebuffer = framebuffer;
+}
+
+bool RenderGraph::IsTexture(RenderGraphResourceId resource) const
+{
+	return resources[resource.i].type == ResourceType::Texture;
+}
+
+unsigned int RenderGraph::GetPhysicalTextureIndex(RenderGraphResourceId resource) const
+{
+	return resources[resource.i].physicalTexture;
+}
+
+unsigned int RenderGraph::GetTexture(RenderGraphResourceId resource) const
+{
+	const Resource& res = resources[resource.i];
+
+	if (res.imported)
+		return res.object;
+	else if (res.physicalTexture != Null)
+		return physicalTextures[res.physicalTexture].texture;
+	else
+		return 0;
+}
+
+unsigned int RenderGraph::GetFramebuffer(RenderGraphResourceId resource) const
+{
+	const Resource& res = resources[resource.i];
+
+	if (res.imported)
+		return res.framebuffer;
+	else if (res.physicalTexture != Null)
+		return physicalTextures[res.physicalTexture].framebuffer;
+	else
+		return 0;
+}
+
+unsigned int RenderGraph::GetBuffer(RenderGraphResourceId resource) const
+{
+	return resources[resource.i].object;
+}
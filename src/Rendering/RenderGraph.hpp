@@ -0,0 +1,252 @@
+#pragma once
+
+#include "Core/Array.hpp"
+
+#include "Math/Vec2.hpp"
+
+#include "Rendering/RenderDeviceEnums.hpp"
+
+class Allocator;
+
+struct RenderGraphResourceId
+{
+	unsigned int i;
+
+	bool operator==(RenderGraphResourceId other) const { return other.i == i; }
+	bool operator!=(RenderGraphResourceId other) const { return operator==(other) == false; }
+};
+
+struct RenderGraphPassId
+{
+	unsigned int i;
+
+	bool operator==(RenderGraphPassId other) const { return other.i == i; }
+	bool operator!=(RenderGraphPassId other) const { return operator==(other) == false; }
+};
+
+enum class RenderGraphAccess
+{
+	// Sampled as a texture or read as a uniform buffer
+	ShaderRead,
+
+	// Read as a shader storage buffer or image
+	StorageRead,
+
+	// Bound as a framebuffer attachment, e.g. for depth testing, but not written
+	RenderTargetRead,
+
+	// Written as a framebuffer attachment
+	RenderTargetWrite,
+
+	// Blended into as a framebuffer attachment, so both read and written
+	RenderTargetBlend,
+
+	// Written as a shader storage buffer or image
+	StorageWrite
+};
+
+/**
+ * Describes the passes of a frame and the textures and buffers they access.
+ *
+ * Passes are declared in execution order, and the accesses of a pass are
+ * declared right after the pass. Compiling the graph culls the passes whose
+ * results are never used, finds the barriers needed between the remaining
+ * passes, and assigns the transient textures to physical textures. Transient
+ * textures with the same description share a physical texture if their
+ * lifetimes don't overlap. The graph has no dependency on the render device:
+ * the caller creates the physical textures and issues the barriers.
+ */
+class RenderGraph
+{
+public:
+	static const unsigned int Null = ~0u;
+
+	using ExecuteFunction = void(*)(void* userData, unsigned int passData);
+
+	struct TextureDesc
+	{
+		Vec2i size;
+		RenderTextureSizedFormat format;
+
+		bool operator==(const TextureDesc& other) const
+		{
+			return size.x == other.size.x && size.y == other.size.y && format == other.format;
+		}
+	};
+
+	struct Barrier
+	{
+		RenderGraphResourceId resource;
+
+		// Access of the earlier pass that must complete first
+		RenderGraphAccess sourceAccess;
+
+		// Access of the pass that waits for it
+		RenderGraphAccess destinationAccess;
+	};
+
+	struct CompiledPass
+	{
+		RenderGraphPassId pass;
+
+		// Barriers to issue before executing the pass
+		unsigned int firstBarrier;
+		unsigned int barrierCount;
+	};
+
+private:
+	enum class ResourceType
+	{
+		Texture,
+		Buffer
+	};
+
+	struct Resource
+	{
+		const char* name;
+		ResourceType type;
+		TextureDesc desc;
+
+		bool imported;
+		bool output;
+
+		// Device objects of imported resources
+		unsigned int object;
+		unsigned int framebuffer;
+
+		// Physical texture of a transient texture, or Null if it's not used
+		unsigned int physicalTexture;
+
+		// Range of compiled passes that use the resource
+		unsigned int firstUse;
+		unsigned int lastUse;
+	};
+
+	struct Access
+	{
+		RenderGraphResourceId resource;
+		RenderGraphAccess access;
+	};
+
+	struct Pass
+	{
+		const char* name;
+		ExecuteFunction function;
+		void* userData;
+		unsigned int passData;
+
+		unsigned int firstAccess;
+		unsigned int accessCount;
+
+		bool sideEffect;
+		bool live;
+	};
+
+	struct PhysicalTexture
+	{
+		TextureDesc desc;
+
+		// Last compiled pass that uses the texture
+		unsigned int lastUse;
+
+		unsigned int texture;
+		unsigned int framebuffer;
+	};
+
+	Array<Resource> resources;
+	Array<Pass> passes;
+	Array<Access> accesses;
+
+	Array<CompiledPass> compiledPasses;
+	Array<Barrier> barriers;
+	Array<PhysicalTexture> physicalTextures;
+
+	// Scratch data used during compilation
+	Array<bool> resourceNeeded;
+	Array<unsigned int> lastWriteIndex;
+	Array<unsigned int> lastReadIndex;
+
+	// Kinds of reads that have waited for the last write, one bit per access
+	Array<unsigned int> syncedReads;
+
+	RenderGraphResourceId AddResource(const char* name, ResourceType type);
+
+	void CullPasses();
+	void FindBarriers();
+	void AssignPhysicalTextures();
+
+public:
+	explicit RenderGraph(Allocator* allocator);
+
+	/**
+	 * Remove all passes and resources, keeping the allocated memory.
+	 */
+	void Clear();
+
+	/**
+	 * Add a texture that exists outside the graph. Imported textures are never
+	 * aliased. <framebuffer> is the framebuffer passes render to the texture with.
+	 */
+	RenderGraphResourceId ImportTexture(const char* name, const TextureDesc& desc,
+		unsigned int texture, unsigned int framebuffer);
+
+	RenderGraphResourceId ImportBuffer(const char* name, unsigned int buffer);
+
+	/**
+	 * Add a texture that only lives within the frame. The compiled graph
+	 * assigns it to a physical texture.
+	 */
+	RenderGraphResourceId CreateTexture(const char* name, const TextureDesc& desc);
+
+	/**
+	 * Mark the contents of the resource as needed after the graph has executed,
+	 * e.g. the backbuffer. Passes that contribute to no output are culled.
+	 */
+	void MarkOutput(RenderGraphResourceId resource);
+
+	/**
+	 * Add a pass after the passes that have been added. <function> is called
+	 * with <userData> and <passData> when the pass is executed.
+	 */
+	RenderGraphPassId AddPass(const char* name, ExecuteFunction function, void* userData, unsigned int passData);
+
+	/**
+	 * Declare an access of the pass that was added last.
+	 */
+	void AddAccess(RenderGraphPassId pass, RenderGraphResourceId resource, RenderGraphAccess access);
+
+	/**
+	 * Never cull the pass, e.g. because it reads back data to the CPU.
+	 */
+	void SetSideEffect(RenderGraphPassId pass);
+
+	void Compile();
+
+	unsigned int GetCompiledPassCount() const { return compiledPasses.GetCount(); }
+	const CompiledPass& GetCompiledPass(unsigned int index) const { return compiledPasses[index]; }
+
+	const Barrier* GetBarriers() const { return barriers.GetData(); }
+
+	bool IsPassCulled(RenderGraphPassId pass) const { return passes[pass.i].live == false; }
+	const char* GetPassName(RenderGraphPassId pass) const { return passes[pass.i].name; }
+
+	void ExecutePass(unsigned int compiledPassIndex) const;
+
+	// Physical textures of the compiled graph, created by the caller
+
+	unsigned int GetPhysicalTextureCount() const { return physicalTextures.GetCount(); }
+	const TextureDesc& GetPhysicalTextureDesc(unsigned int index) const { return physicalTextures[index].desc; }
+	void SetPhysicalTexture(unsigned int index, unsigned int texture, unsigned int framebuffer);
+
+	// Resource queries, valid once the graph has been compiled
+
+	bool IsTexture(RenderGraphResourceId resource) const;
+	const TextureDesc& GetTextureDesc(RenderGraphResourceId resource) const { return resources[resource.i].desc; }
+
+	// Physical texture of a transient texture, or Null if no live pass uses it
+	unsigned int GetPhysicalTextureIndex(RenderGraphResourceId resource) const;
+
+	unsigned int GetTexture(RenderGraphResourceId resource) const;
+	unsigned int GetFramebuffer(RenderGraphResourceId resource) const;
+	unsigned int GetBuffer(RenderGraphResourceId resource) const;
+};
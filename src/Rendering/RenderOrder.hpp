@@ -2,63 +2,249 @@
 
 #include <cstdint>
 
-#include "Core/BitfieldVariable.hpp"
+#include "Rendering/RenderCommandType.hpp"
+
+/**
+ * A field of the 64-bit render command sort key. The field takes the <Bits>
+ * highest bits of the <UnusedBits> lowest bits of the key, so fields are
+ * defined from the most significant bit down. The position is known at
+ * compile time, so encoding and decoding compile to immediate shifts and masks.
+ * A field can have zero bits, in which case it's always zero.
+ */
+template <unsigned int Bits, unsigned int UnusedBits>
+struct RenderOrderField
+{
+	static_assert(Bits < 64, "Field must be less than 64 bits wide");
+	static_assert(Bits <= UnusedBits, "Field doesn't fit in the sort key");
+
+	static constexpr unsigned int bits = Bits;
+	static constexpr unsigned int shift = UnusedBits - Bits;
+	static constexpr uint64_t mask = (1ULL << Bits) - 1;
+
+	// Bits of the key that the field covers
+	static constexpr uint64_t keyMask = mask << shift;
+
+	static void AssignValue(uint64_t& key, uint64_t value)
+	{
+		key |= (value & mask) << shift;
+	}
 
-struct RenderOrderConfiguration
+	static constexpr uint64_t GetValue(uint64_t key)
+	{
+		return (key >> shift) & mask;
+	}
+};
+
+/**
+ * True if none of the fields cover the same bits
+ */
+template <typename... Fields>
+constexpr bool RenderOrderFieldsDisjoint()
 {
-	static const uint64_t CallbackMaterialId = (1 << 12) - 1;
+	const uint64_t keyMasks[] = { Fields::keyMask... };
 
-	RenderOrderConfiguration()
+	uint64_t covered = 0;
+	for (uint64_t keyMask : keyMasks)
 	{
-		viewportIndex.SetDefinition(3, sizeof(uint64_t) * 8);
-		viewportPass.SetDefinition(3, viewportIndex.shift);
-		command.SetDefinition(1, viewportPass.shift);
+		if ((covered & keyMask) != 0)
+			return false;
+
+		covered |= keyMask;
+	}
+
+	return true;
+}
+
+/**
+ * Widths of the draw command fields of the sort key. The fields share the
+ * bits below the viewport, pass and command fields, and the depth gets the
+ * bits the other fields leave.
+ */
+struct RenderOrderFieldWidths
+{
+	// The largest material ID is reserved for callback draws
+	static const unsigned int MaterialBits = 12;
+
+	// Keeps draws of the same mesh together, zero disables mesh sorting.
+	// Mesh IDs that don't fit only make sorting less effective.
+	static const unsigned int MeshBits = 10;
+
+	static const unsigned int RenderObjectBits = 20;
+
+	// Opaque draws are sorted by depth in coarse steps, so that draws with
+	// the same material and mesh stay together within a step
+	static const unsigned int OpaqueDepthBits = 8;
+};
+
+enum class RenderOrderSort
+{
+	// Depth, material, mesh
+	DepthMajor,
+
+	// Material, mesh, depth
+	MaterialMajor
+};
+
+template <typename Widths>
+struct BasicRenderOrderConfiguration
+{
+	using ViewportIndexField = RenderOrderField<3, 64>;
+	using ViewportPassField = RenderOrderField<3, ViewportIndexField::shift>;
+	using CommandField = RenderOrderField<1, ViewportPassField::shift>;
+
+	// DRAW COMMANDS
+
+	static const unsigned int DepthBits = CommandField::shift -
+		Widths::MaterialBits - Widths::MeshBits - Widths::RenderObjectBits;
+
+	static_assert(Widths::MaterialBits + Widths::MeshBits + Widths::RenderObjectBits < CommandField::shift,
+		"Draw key fields leave no bits for depth");
+	static_assert(Widths::OpaqueDepthBits > 0 && Widths::OpaqueDepthBits <= DepthBits,
+		"Opaque depth doesn't fit in the depth field");
+
+	// Passes sorted depth-major, always used for transparents
+
+	using DepthMajorDepthField = RenderOrderField<DepthBits, CommandField::shift>;
+	using DepthMajorMaterialField = RenderOrderField<Widths::MaterialBits, DepthMajorDepthField::shift>;
+	using DepthMajorMeshField = RenderOrderField<Widths::MeshBits, DepthMajorMaterialField::shift>;
 
-		// DRAW COMMANDS
+	// Passes sorted material-major
 
-		// For transparents
+	using MaterialMajorMaterialField = RenderOrderField<Widths::MaterialBits, CommandField::shift>;
+	using MaterialMajorMeshField = RenderOrderField<Widths::MeshBits, MaterialMajorMaterialField::shift>;
+	using MaterialMajorDepthField = RenderOrderField<DepthBits, MaterialMajorMeshField::shift>;
 
-		transparentDepth.SetDefinition(22, command.shift);
+	// For all draw commands
 
-		// For opaques
+	using RenderObjectField = RenderOrderField<Widths::RenderObjectBits, Widths::RenderObjectBits>;
 
-		opaqueDepth.SetDefinition(8, command.shift);
-		opaquePadding.SetDefinition(14, opaqueDepth.shift);
+	// CONTROL COMMANDS
 
-		// For all draw commands
+	// Ordering for commands for same viewport, layer and transparency
+	using CommandOrderField = RenderOrderField<4, CommandField::shift>;
 
-		materialId.SetDefinition(12, opaquePadding.shift);
-		renderObject.SetDefinition(20, materialId.shift);
+	// Type of command
+	using CommandTypeField = RenderOrderField<8, CommandOrderField::shift>;
 
-		// CONTROL COMMANDS
+	// Command data or offset to buffer, depending on command type
+	using CommandDataField = RenderOrderField<32, CommandTypeField::shift>;
 
-		// Ordering for commands for same viewport, layer and transparency
-		commandOrder.SetDefinition(4, command.shift);
+	static_assert(RenderOrderFieldsDisjoint<ViewportIndexField, ViewportPassField, CommandField,
+		DepthMajorDepthField, DepthMajorMaterialField, DepthMajorMeshField, RenderObjectField>(),
+		"Depth-major draw key fields overlap");
 
-		// Type of command
-		commandType.SetDefinition(8, commandOrder.shift);
+	static_assert(RenderOrderFieldsDisjoint<ViewportIndexField, ViewportPassField, CommandField,
+		MaterialMajorMaterialField, MaterialMajorMeshField, MaterialMajorDepthField, RenderObjectField>(),
+		"Material-major draw key fields overlap");
 
-		// Command data or offset to buffer, depending on command type
-		commandData.SetDefinition(32, commandType.shift);
+	static_assert(RenderOrderFieldsDisjoint<ViewportIndexField, ViewportPassField, CommandField,
+		CommandOrderField, CommandTypeField, CommandDataField>(), "Control key fields overlap");
 
-		// Calculate maximum integer depth values in advance
+	static const uint64_t CallbackMaterialId = DepthMajorMaterialField::mask;
 
-		maxTransparentDepth = (1ULL << transparentDepth.bits) - 1;
-		maxOpaqueDepth = (1ULL << opaqueDepth.bits) - 1;
+	// Maximum integer depth values
+	static const uint64_t maxTransparentDepth = DepthMajorDepthField::mask;
+	static const uint64_t maxOpaqueDepth = (1ULL << Widths::OpaqueDepthBits) - 1;
+
+	// Opaque depth steps are placed in the highest bits of the depth field
+	static const unsigned int opaqueDepthShift = DepthBits - Widths::OpaqueDepthBits;
+
+	// Bit per pass value, set if the pass is sorted material-major
+	uint8_t materialMajorPasses;
+
+	// The fields have no state, they're members so that keys are read
+	// through the configuration of the command list
+	ViewportIndexField viewportIndex;
+	ViewportPassField viewportPass;
+	CommandField command;
+	RenderObjectField renderObject;
+	CommandOrderField commandOrder;
+	CommandTypeField commandType;
+	CommandDataField commandData;
+
+	BasicRenderOrderConfiguration() : materialMajorPasses(0)
+	{
+	}
+
+	static bool IsTransparentPass(uint64_t pass)
+	{
+		return (0xfc & pass) != 0; // Is greater than 0x03; must be transparent
+	}
+
+	/**
+	 * Set how the draws of a pass are sorted. Transparent passes are always
+	 * sorted depth-major, because blending depends on draw order.
+	 */
+	void SetSortOrder(RenderPass pass, RenderOrderSort sort)
+	{
+		uint64_t passInt = static_cast<uint64_t>(pass);
+
+		if (sort == RenderOrderSort::MaterialMajor && IsTransparentPass(passInt) == false)
+			materialMajorPasses |= static_cast<uint8_t>(1 << passInt);
+		else
+			materialMajorPasses &= static_cast<uint8_t>(~(1 << passInt));
+	}
+
+	RenderOrderSort GetSortOrder(RenderPass pass) const
+	{
+		return IsMaterialMajor(static_cast<uint64_t>(pass)) ?
+			RenderOrderSort::MaterialMajor : RenderOrderSort::DepthMajor;
 	}
 
-	BitfieldVariable<uint64_t> viewportIndex;
-	BitfieldVariable<uint64_t> viewportPass;
-	BitfieldVariable<uint64_t> command;
-	BitfieldVariable<uint64_t> transparentDepth;
-	BitfieldVariable<uint64_t> opaqueDepth;
-	BitfieldVariable<uint64_t> opaquePadding;
-	BitfieldVariable<uint64_t> materialId;
-	BitfieldVariable<uint64_t> renderObject;
-	BitfieldVariable<uint64_t> commandOrder;
-	BitfieldVariable<uint64_t> commandType;
-	BitfieldVariable<uint64_t> commandData;
-
-	uint64_t maxTransparentDepth;
-	uint64_t maxOpaqueDepth;
+	bool IsMaterialMajor(uint64_t pass) const
+	{
+		return ((materialMajorPasses >> pass) & 1) != 0;
+	}
+
+	/**
+	 * Encode the fields of a draw command. Depth is in the range [0, 1].
+	 */
+	void AssignDraw(uint64_t& key, uint64_t pass, float depth, uint64_t material, uint64_t mesh) const
+	{
+		uint64_t intDepth;
+
+		if (IsTransparentPass(pass))
+			intDepth = static_cast<uint64_t>(maxTransparentDepth * (1.0f - depth));
+		else
+			intDepth = static_cast<uint64_t>(maxOpaqueDepth * depth) << opaqueDepthShift;
+
+		if (IsMaterialMajor(pass))
+		{
+			MaterialMajorMaterialField::AssignValue(key, material);
+			MaterialMajorMeshField::AssignValue(key, mesh);
+			MaterialMajorDepthField::AssignValue(key, intDepth);
+		}
+		else
+		{
+			DepthMajorDepthField::AssignValue(key, intDepth);
+			DepthMajorMaterialField::AssignValue(key, material);
+			DepthMajorMeshField::AssignValue(key, mesh);
+		}
+	}
+
+	uint64_t GetMaterialId(uint64_t key) const
+	{
+		if (IsMaterialMajor(ViewportPassField::GetValue(key)))
+			return MaterialMajorMaterialField::GetValue(key);
+		else
+			return DepthMajorMaterialField::GetValue(key);
+	}
+
+	uint64_t GetMeshId(uint64_t key) const
+	{
+		if (IsMaterialMajor(ViewportPassField::GetValue(key)))
+			return MaterialMajorMeshField::GetValue(key);
+		else
+			return DepthMajorMeshField::GetValue(key);
+	}
+
+	uint64_t GetDepth(uint64_t key) const
+	{
+		if (IsMaterialMajor(ViewportPassField::GetValue(key)))
+			return MaterialMajorDepthField::GetValue(key);
+		else
+			return DepthMajorDepthField::GetValue(key);
+	}
 };
+
+using RenderOrderConfiguration = BasicRenderOrderConfiguration<RenderOrderFieldWidths>;
@@ -8,85 +8,270 @@
 RenderTargetContainer::RenderTargetContainer(Allocator* allocator, RenderDevice* renderDevice) :
 	allocator(allocator),
 	renderDevice(renderDevice),
-	renderTargetCount(0)
+	renderTargets(allocator),
+	freeLists(allocator),
+	firstUnusedEntry(Null),
+	frameIndex(0),
+	evictionFrameCount(DefaultEvictionFrameCount),
+	stats{}
 {
-	void* buffer = allocator->Allocate(sizeof(TargetInfo) * MaxRenderTargetCount);
-	renderTargets = static_cast<TargetInfo*>(buffer);
 }
 
 RenderTargetContainer::~RenderTargetContainer()
 {
-	allocator->Deallocate(renderTargets);
+	for (unsigned int i = 0, count = renderTargets.GetCount(); i < count; ++i)
+		if (renderTargets[i].allocated)
+			DestroyTarget(i);
 }
 
-const RenderTarget& RenderTargetContainer::AcquireRenderTarget(Vec2i size, RenderTextureSizedFormat format)
+uint64_t RenderTargetContainer::MakeKey(Vec2i size, RenderTextureSizedFormat format)
 {
-	for (size_t i = 0; i < renderTargetCount; ++i)
+	return static_cast<uint64_t>(static_cast<uint32_t>(size.x)) |
+		(static_cast<uint64_t>(static_cast<uint32_t>(size.y) & 0xffffff) << 24) |
+		(static_cast<uint64_t>(format) << 48);
+}
+
+size_t RenderTargetContainer::GetBytesPerPixel(RenderTextureSizedFormat format)
+{
+	switch (format)
 	{
-		TargetInfo& targetInfo = renderTargets[i];
+	case RenderTextureSizedFormat::R8:
+	case RenderTextureSizedFormat::STENCIL_INDEX8:
+		return 1;
 
-		if (targetInfo.inUse == false && targetInfo.target.colorFormat == format &&
-			targetInfo.target.size.x == size.x && targetInfo.target.size.y == size.y)
-		{
-			targetInfo.inUse = true;
-			
-			return targetInfo.target;
-		}
+	case RenderTextureSizedFormat::RG8:
+	case RenderTextureSizedFormat::R16:
+	case RenderTextureSizedFormat::R16F:
+	case RenderTextureSizedFormat::D16:
+		return 2;
+
+	case RenderTextureSizedFormat::RGB8:
+	case RenderTextureSizedFormat::SRGB8:
+		return 3;
+
+	case RenderTextureSizedFormat::RGBA8:
+	case RenderTextureSizedFormat::SRGB8_A8:
+	case RenderTextureSizedFormat::RG16:
+	case RenderTextureSizedFormat::RG16F:
+	case RenderTextureSizedFormat::R32F:
+	case RenderTextureSizedFormat::D32F:
+	case RenderTextureSizedFormat::D24:
+	case RenderTextureSizedFormat::D24_S8:
+		return 4;
+
+	case RenderTextureSizedFormat::RGB16:
+	case RenderTextureSizedFormat::RGB16F:
+		return 6;
+
+	case RenderTextureSizedFormat::RGBA16:
+	case RenderTextureSizedFormat::RGBA16F:
+	case RenderTextureSizedFormat::RG32F:
+	case RenderTextureSizedFormat::D32F_S8:
+		return 8;
+
+	case RenderTextureSizedFormat::RGB32F:
+		return 12;
+
+	case RenderTextureSizedFormat::RGBA32F:
+		return 16;
+	}
+
+	return 4;
+}
+
+void RenderTargetContainer::AddToFreeList(unsigned int index)
+{
+	TargetInfo& info = renderTargets[index];
+
+	HashMap<uint64_t, unsigned int>::KeyValuePair* pair = freeLists.Lookup(info.key);
+
+	if (pair == nullptr)
+	{
+		pair = freeLists.Insert(info.key);
+		pair->second = Null;
 	}
 
-	if (renderTargetCount < MaxRenderTargetCount)
+	info.prevFree = Null;
+	info.nextFree = pair->second;
+
+	if (pair->second != Null)
+		renderTargets[pair->second].prevFree = index;
+
+	pair->second = index;
+}
+
+void RenderTargetContainer::RemoveFromFreeList(unsigned int index)
+{
+	TargetInfo& info = renderTargets[index];
+
+	if (info.nextFree != Null)
+		renderTargets[info.nextFree].prevFree = info.prevFree;
+
+	if (info.prevFree != Null)
+		renderTargets[info.prevFree].nextFree = info.nextFree;
+	else
+	{
+		HashMap<uint64_t, unsigned int>::KeyValuePair* pair = freeLists.Lookup(info.key);
+
+		// Remove empty lists, so that sizes that are no longer used don't remain
+		if (info.nextFree != Null)
+			pair->second = info.nextFree;
+		else
+			freeLists.Remove(pair);
+	}
+
+	info.prevFree = Null;
+	info.nextFree = Null;
+}
+
+void RenderTargetContainer::DestroyTarget(unsigned int index)
+{
+	TargetInfo& info = renderTargets[index];
+
+	renderDevice->DestroyFramebuffers(1, &info.target.framebuffer);
+	renderDevice->DestroyTextures(1, &info.target.colorTexture);
+
+	stats.targetCount -= 1;
+	stats.currentBytes -= info.byteSize;
+
+	info.allocated = false;
+	info.inUse = false;
+	info.target = RenderTarget{};
+
+	// Entry can be reused by the next new target
+	info.prevFree = Null;
+	info.nextFree = firstUnusedEntry;
+	firstUnusedEntry = index;
+}
+
+const RenderTarget& RenderTargetContainer::AcquireRenderTarget(Vec2i size, RenderTextureSizedFormat format)
+{
+	uint64_t key = MakeKey(size, format);
+
+	HashMap<uint64_t, unsigned int>::KeyValuePair* pair = freeLists.Lookup(key);
+
+	if (pair != nullptr)
 	{
-		unsigned int framebuffer = 0;
-		renderDevice->CreateFramebuffers(1, &framebuffer);
-		renderDevice->BindFramebuffer(RenderFramebufferTarget::Framebuffer, framebuffer);
-
-		unsigned int texture = 0;
-		renderDevice->CreateTextures(1, &texture);
-		renderDevice->BindTexture(RenderTextureTarget::Texture2d, texture);
-		renderDevice->SetTextureMinFilter(RenderTextureTarget::Texture2d, RenderTextureFilterMode::Linear);
-		renderDevice->SetTextureMagFilter(RenderTextureTarget::Texture2d, RenderTextureFilterMode::Linear);
-		renderDevice->SetTextureWrapModeU(RenderTextureTarget::Texture2d, RenderTextureWrapMode::ClampToEdge);
-		renderDevice->SetTextureWrapModeV(RenderTextureTarget::Texture2d, RenderTextureWrapMode::ClampToEdge);
-
-		RenderCommandData::SetTextureStorage2D storage{
-			RenderTextureTarget::Texture2d, 1, format, size.x, size.y
-		};
-		renderDevice->SetTextureStorage2D(&storage);
-
-		RenderCommandData::AttachFramebufferTexture2D attachTexture{
-			RenderFramebufferTarget::Framebuffer, RenderFramebufferAttachment::Color0,
-			RenderTextureTarget::Texture2d, texture, 0
-		};
-		renderDevice->AttachFramebufferTexture2D(&attachTexture);
-
-		TargetInfo& targetInfo = renderTargets[renderTargetCount];
-
-		targetInfo.target.id = renderTargetCount;
-		targetInfo.target.size = size;
-		targetInfo.target.colorFormat = format;
-		targetInfo.target.colorTexture = texture;
-		targetInfo.target.framebuffer = framebuffer;
+		unsigned int index = pair->second;
+		RemoveFromFreeList(index);
+
+		TargetInfo& targetInfo = renderTargets[index];
 		targetInfo.inUse = true;
 
-		renderTargetCount += 1;
+		stats.inUseCount += 1;
 
 		return targetInfo.target;
 	}
 
-	return RenderTarget{};
+	unsigned int framebuffer = 0;
+	renderDevice->CreateFramebuffers(1, &framebuffer);
+	renderDevice->BindFramebuffer(RenderFramebufferTarget::Framebuffer, framebuffer);
+
+	unsigned int texture = 0;
+	renderDevice->CreateTextures(1, &texture);
+	renderDevice->BindTexture(RenderTextureTarget::Texture2d, texture);
+	renderDevice->SetTextureMinFilter(RenderTextureTarget::Texture2d, RenderTextureFilterMode::Linear);
+	renderDevice->SetTextureMagFilter(RenderTextureTarget::Texture2d, RenderTextureFilterMode::Linear);
+	renderDevice->SetTextureWrapModeU(RenderTextureTarget::Texture2d, RenderTextureWrapMode::ClampToEdge);
+	renderDevice->SetTextureWrapModeV(RenderTextureTarget::Texture2d, RenderTextureWrapMode::ClampToEdge);
+
+	RenderCommandData::SetTextureStorage2D storage{
+		RenderTextureTarget::Texture2d, 1, format, size.x, size.y
+	};
+	renderDevice->SetTextureStorage2D(&storage);
+
+	RenderCommandData::AttachFramebufferTexture2D attachTexture{
+		RenderFramebufferTarget::Framebuffer, RenderFramebufferAttachment::Color0,
+		RenderTextureTarget::Texture2d, texture, 0
+	};
+	renderDevice->AttachFramebufferTexture2D(&attachTexture);
+
+	unsigned int index;
+
+	if (firstUnusedEntry != Null)
+	{
+		index = firstUnusedEntry;
+		firstUnusedEntry = renderTargets[index].nextFree;
+	}
+	else
+	{
+		index = renderTargets.GetCount();
+		renderTargets.PushBack();
+	}
+
+	TargetInfo& targetInfo = renderTargets[index];
+
+	targetInfo.target.id = index;
+	targetInfo.target.size = size;
+	targetInfo.target.colorFormat = format;
+	targetInfo.target.colorTexture = texture;
+	targetInfo.target.framebuffer = framebuffer;
+	targetInfo.key = key;
+	targetInfo.byteSize = static_cast<size_t>(size.x) * static_cast<size_t>(size.y) * GetBytesPerPixel(format);
+	targetInfo.lastUsedFrame = frameIndex;
+	targetInfo.prevFree = Null;
+	targetInfo.nextFree = Null;
+	targetInfo.allocated = true;
+	targetInfo.inUse = true;
+
+	stats.targetCount += 1;
+	stats.inUseCount += 1;
+	stats.currentBytes += targetInfo.byteSize;
+
+	if (stats.currentBytes > stats.peakBytes)
+		stats.peakBytes = stats.currentBytes;
+
+	return targetInfo.target;
 }
 
 void RenderTargetContainer::ReleaseRenderTarget(unsigned int renderTargetId)
 {
-	if (renderTargetId < renderTargetCount)
+	if (renderTargetId < renderTargets.GetCount() && renderTargets[renderTargetId].inUse)
 	{
-		renderTargets[renderTargetId].inUse = false;
+		TargetInfo& targetInfo = renderTargets[renderTargetId];
+		targetInfo.inUse = false;
+		targetInfo.lastUsedFrame = frameIndex;
+
+		AddToFreeList(renderTargetId);
+
+		stats.inUseCount -= 1;
+	}
+}
+
+void RenderTargetContainer::EndFrame()
+{
+	frameIndex += 1;
+
+	for (unsigned int i = 0, count = renderTargets.GetCount(); i < count; ++i)
+	{
+		const TargetInfo& targetInfo = renderTargets[i];
+
+		if (targetInfo.allocated && targetInfo.inUse == false &&
+			frameIndex - targetInfo.lastUsedFrame > evictionFrameCount)
+		{
+			RemoveFromFreeList(i);
+			DestroyTarget(i);
+
+			stats.evictedCount += 1;
+		}
+	}
+}
+
+void RenderTargetContainer::DestroyUnusedTargets()
+{
+	for (unsigned int i = 0, count = renderTargets.GetCount(); i < count; ++i)
+	{
+		if (renderTargets[i].allocated && renderTargets[i].inUse == false)
+		{
+			RemoveFromFreeList(i);
+			DestroyTarget(i);
+		}
 	}
 }
 
 bool RenderTargetContainer::ConfirmAllTargetsAreUnused()
 {
-	for (size_t i = 0; i < renderTargetCount; ++i)
+	for (unsigned int i = 0, count = renderTargets.GetCount(); i < count; ++i)
 	{
 		assert(renderTargets[i].inUse == false);
 
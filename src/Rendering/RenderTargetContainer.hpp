@@ -1,5 +1,11 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+
+#include "Core/Array.hpp"
+#include "Core/HashMap.hpp"
+
 #include "Math/Vec2.hpp"
 
 #include "Rendering/RenderDeviceEnums.hpp"
@@ -18,22 +24,74 @@ struct RenderTarget
 	unsigned int framebuffer;
 };
 
+/**
+ * Pool of render targets for intermediate results within a frame.
+ *
+ * Released targets are kept in a free list per size and format, so acquiring
+ * a target reuses one of the same size and format without searching. Targets
+ * that stay unused for a number of frames are destroyed, which also frees the
+ * targets of a previous framebuffer size after a resize.
+ */
 class RenderTargetContainer
 {
+public:
+	static const unsigned int DefaultEvictionFrameCount = 120;
+
+	struct Stats
+	{
+		// Targets that currently exist, and the ones acquired at the moment
+		unsigned int targetCount;
+		unsigned int inUseCount;
+
+		// Estimated video memory of the targets' textures, in bytes
+		size_t currentBytes;
+		size_t peakBytes;
+
+		// Targets destroyed because they stayed unused
+		unsigned int evictedCount;
+	};
+
 private:
-	static const size_t MaxRenderTargetCount = 32;
+	static const unsigned int Null = ~0u;
 
 	struct TargetInfo
 	{
 		RenderTarget target;
+
+		uint64_t key;
+		size_t byteSize;
+		uint64_t lastUsedFrame;
+
+		// Free list of the key if the target is released, or list of the
+		// unallocated entries if the entry has no target
+		unsigned int prevFree;
+		unsigned int nextFree;
+
+		bool allocated;
 		bool inUse;
 	};
 
 	Allocator* allocator;
 	RenderDevice* renderDevice;
 
-	TargetInfo* renderTargets;
-	size_t renderTargetCount;
+	Array<TargetInfo> renderTargets;
+
+	// Head of the free list of each size and format, most recently released first
+	HashMap<uint64_t, unsigned int> freeLists;
+
+	unsigned int firstUnusedEntry;
+
+	uint64_t frameIndex;
+	unsigned int evictionFrameCount;
+
+	Stats stats;
+
+	static uint64_t MakeKey(Vec2i size, RenderTextureSizedFormat format);
+	static size_t GetBytesPerPixel(RenderTextureSizedFormat format);
+
+	void AddToFreeList(unsigned int index);
+	void RemoveFromFreeList(unsigned int index);
+	void DestroyTarget(unsigned int index);
 
 public:
 	RenderTargetContainer(Allocator* allocator, RenderDevice* renderDevice);
@@ -42,5 +100,21 @@ public:
 	const RenderTarget& AcquireRenderTarget(Vec2i size, RenderTextureSizedFormat format);
 	void ReleaseRenderTarget(unsigned int renderTargetId);
 
+	/**
+	 * Advance the frame count and destroy the targets that haven't been used
+	 * within the eviction frame count.
+	 */
+	void EndFrame();
+
+	/**
+	 * Destroy all targets that aren't in use, e.g. after the framebuffer has
+	 * been resized and the old sizes won't be used again.
+	 */
+	void DestroyUnusedTargets();
+
+	void SetEvictionFrameCount(unsigned int frameCount) { evictionFrameCount = frameCount; }
+
+	const Stats& GetStats() const { return stats; }
+
 	bool ConfirmAllTargetsAreUnused();
 };
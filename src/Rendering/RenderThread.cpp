@@ -0,0 +1,166 @@
+#include "Rendering/RenderThread.hpp"
+
+#include <new>
+
+#include "Memory/Allocator.hpp"
+
+#include "Rendering/RenderCaptureReplayer.hpp"
+#include "Rendering/RenderDeviceRecorder.hpp"
+
+#include "System/Window.hpp"
+
+RenderThread::RenderThread(Allocator* allocator, Allocator* threadAllocator, Window* window,
+	RenderDevice* device, unsigned int queueDepth) :
+	allocator(allocator),
+	threadAllocator(threadAllocator),
+	window(window),
+	device(device),
+	packets(nullptr),
+	queueDepth(queueDepth),
+	submittedCount(0),
+	completedCount(0),
+	exitRequested(false),
+	lastFrameStats{}
+{
+	if (this->queueDepth < 1)
+		this->queueDepth = 1;
+	else if (this->queueDepth > MaxQueueDepth)
+		this->queueDepth = MaxQueueDepth;
+
+	void* packetBuffer = allocator->Allocate(sizeof(FramePacket) * this->queueDepth);
+	packets = static_cast<FramePacket*>(packetBuffer);
+
+	for (unsigned int i = 0; i < this->queueDepth; ++i)
+		new (packets + i) FramePacket(allocator);
+
+	thread = std::thread(&RenderThread::ThreadMain, this);
+}
+
+RenderThread::~RenderThread()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		exitRequested = true;
+	}
+
+	packetSubmitted.notify_one();
+	thread.join();
+
+	for (unsigned int i = 0; i < queueDepth; ++i)
+		packets[i].~FramePacket();
+
+	allocator->Deallocate(packets);
+}
+
+double RenderThread::ToMilliseconds(Clock::duration duration)
+{
+	return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+void RenderThread::Submit(RenderDeviceRecorder* recorder, bool present)
+{
+	Clock::time_point waitStart = Clock::now();
+	FramePacket* packet;
+
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		packetCompleted.wait(lock, [this]()
+		{
+			return submittedCount - completedCount < queueDepth;
+		});
+
+		packet = &packets[submittedCount % queueDepth];
+	}
+
+	Clock::time_point submitTime = Clock::now();
+
+	// The render thread is done with the packet, so its memory can be recorded into
+	packet->commands.Clear();
+	recorder->SwapCommandStream(packet->commands);
+
+	packet->submitTime = submitTime;
+	packet->submitWaitMilliseconds = ToMilliseconds(submitTime - waitStart);
+	packet->present = present;
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		submittedCount += 1;
+	}
+
+	packetSubmitted.notify_one();
+}
+
+RenderThread::Stats RenderThread::GetStats()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	Stats stats = lastFrameStats;
+	stats.packetsInFlight = static_cast<unsigned int>(submittedCount - completedCount);
+
+	return stats;
+}
+
+void RenderThread::ThreadMain()
+{
+	window->MakeContextCurrent();
+
+	{
+		// Objects created by the packets are mapped to device objects, so the
+		// same replayer has to execute every packet
+		RenderCaptureReplayer replayer(threadAllocator, device);
+		replayer.SetTimingEnabled(false);
+
+		for (;;)
+		{
+			FramePacket* packet;
+
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				packetSubmitted.wait(lock, [this]()
+				{
+					return submittedCount > completedCount || exitRequested;
+				});
+
+				// Packets submitted before the exit request are still executed
+				if (submittedCount == completedCount)
+					break;
+
+				packet = &packets[completedCount % queueDepth];
+			}
+
+			Clock::time_point replayStart = Clock::now();
+
+			// The stream comes from the recorder, so it is always complete
+			replayer.Replay(packet->commands.GetData(), packet->commands.GetCount());
+
+			Clock::time_point swapStart = Clock::now();
+
+			if (packet->present)
+				window->SwapBuffers();
+
+			Clock::time_point frameEnd = Clock::now();
+
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+
+				if (packet->present)
+				{
+					Stats& stats = lastFrameStats;
+					stats.submitWaitMilliseconds = packet->submitWaitMilliseconds;
+					stats.queueMilliseconds = ToMilliseconds(replayStart - packet->submitTime);
+					stats.replayMilliseconds = ToMilliseconds(swapStart - replayStart);
+					stats.swapMilliseconds = ToMilliseconds(frameEnd - swapStart);
+					stats.latencyMilliseconds = ToMilliseconds(frameEnd - packet->submitTime);
+					stats.packetSize = packet->commands.GetCount();
+				}
+
+				completedCount += 1;
+			}
+
+			packetCompleted.notify_one();
+		}
+	}
+
+	// The window is destroyed on the main thread
+	Window::ReleaseCurrentContext();
+}
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+#include "Core/Array.hpp"
+
+class Allocator;
+class RenderDevice;
+class RenderDeviceRecorder;
+class Window;
+
+/**
+ * Submits frames to the GPU on a thread that owns the window's OpenGL context.
+ *
+ * The game thread renders into a RenderDeviceRecorder that runs as a null
+ * device. At the end of each frame the recorded commands are handed over as a
+ * frame packet, which the render thread replays on the OpenGL device before
+ * swapping buffers. The game thread can update and record the next frame while
+ * the render thread submits the previous one.
+ *
+ * At most <queueDepth> packets can be waiting or in progress on the render
+ * thread. Submitting another packet blocks until the oldest one is presented,
+ * which bounds the latency between recording and presenting a frame.
+ */
+class RenderThread
+{
+public:
+	static const unsigned int MaxQueueDepth = 3;
+
+	struct Stats
+	{
+		// Time the game thread waited for a free packet
+		double submitWaitMilliseconds;
+
+		// Time from submitting the packet until the render thread started it
+		double queueMilliseconds;
+
+		// Time the render thread spent executing the packet's commands
+		double replayMilliseconds;
+
+		// Time the render thread spent swapping buffers
+		double swapMilliseconds;
+
+		// Time from submitting the packet until its frame was presented
+		double latencyMilliseconds;
+
+		// Size of the packet's command stream in bytes
+		size_t packetSize;
+
+		// Packets submitted but not yet presented when the stats were read
+		unsigned int packetsInFlight;
+	};
+
+private:
+	using Clock = std::chrono::high_resolution_clock;
+
+	struct FramePacket
+	{
+		Array<uint8_t> commands;
+		Clock::time_point submitTime;
+		double submitWaitMilliseconds;
+		bool present;
+
+		explicit FramePacket(Allocator* allocator) : commands(allocator) {}
+	};
+
+	Allocator* allocator;
+	Allocator* threadAllocator;
+	Window* window;
+	RenderDevice* device;
+
+	FramePacket* packets;
+	unsigned int queueDepth;
+
+	// Packets are used in order, so the counts locate the packets in the queue
+	uint64_t submittedCount;
+	uint64_t completedCount;
+	bool exitRequested;
+
+	std::mutex mutex;
+	std::condition_variable packetSubmitted;
+	std::condition_variable packetCompleted;
+
+	Stats lastFrameStats;
+
+	std::thread thread;
+
+	void ThreadMain();
+
+	static double ToMilliseconds(Clock::duration duration);
+
+public:
+	/**
+	 * Start a render thread that replays packets on <device> and presents them
+	 * to <window>. The window's context must not be current on any other thread.
+	 * Packets are allocated from <allocator>, which is only used on the calling
+	 * thread, while <threadAllocator> is only used on the render thread.
+	 */
+	RenderThread(Allocator* allocator, Allocator* threadAllocator, Window* window,
+		RenderDevice* device, unsigned int queueDepth);
+
+	/**
+	 * Executes the packets that have been submitted and stops the thread.
+	 */
+	~RenderThread();
+
+	RenderThread(const RenderThread&) = delete;
+	RenderThread& operator=(const RenderThread&) = delete;
+
+	/**
+	 * Hand the commands <recorder> has recorded over to the render thread.
+	 * The recorder continues recording into the memory of a previous packet.
+	 * If <present> is true, the buffers are swapped after the commands.
+	 */
+	void Submit(RenderDeviceRecorder* recorder, bool present);
+
+	/**
+	 * Stats of the most recently presented frame
+	 */
+	Stats GetStats();
+};
@@ -1,10 +1,21 @@
 #pragma once
 
+#include "Math/Mat3x4.hpp"
 #include "Math/Mat4x4.hpp"
 #include "Math/Rectangle.hpp"
 #include "Math/Vec3.hpp"
 #include "Math/Frustum.hpp"
 
+// How the projected size of an object is estimated for minimum size culling
+enum class RenderViewportSizeEstimate
+{
+	// Project all 8 bounding box corners
+	BoxCorners,
+
+	// Use the exact projection of the bounding box's bounding sphere
+	BoundingSphere
+};
+
 struct RenderViewport
 {
 	Vec3f position;
@@ -12,9 +23,14 @@ struct RenderViewport
 
 	float farMinusNear;
 	float minusNear;
+
+	// Objects are culled when the area of their screen space bounding
+	// rectangle is less than the square of this size in pixels
 	float objectMinScreenSizePx;
+	RenderViewportSizeEstimate objectSizeEstimate;
 
-	Mat4x4f viewToWorld;
+	// Affine, so the view matrix can be computed with a cheap affine inverse
+	Mat3x4f viewToWorld;
 	Mat4x4f view;
 	Mat4x4f projection;
 	Mat4x4f viewProjection;
@@ -26,4 +42,8 @@ struct RenderViewport
 	unsigned int framebufferIndex;
 
 	unsigned int uniformBlockObject;
+
+	// Incremented whenever the view, projection or culling parameters of the
+	// viewport change, so results computed on an earlier frame can be reused
+	unsigned int transformEpoch;
 };
@@ -3,10 +3,12 @@
 #include <cstring>
 #include <cstdio>
 
+#include "Core/JobSystem.hpp"
 #include "Core/Sort.hpp"
 
 #include "Debug/Debug.hpp"
 #include "Debug/DebugVectorRenderer.hpp"
+#include "Debug/LogHelper.hpp"
 
 #include "Engine/Engine.hpp"
 
@@ -21,7 +23,9 @@
 #include "Rendering/BloomEffect.hpp"
 #include "Rendering/Camera.hpp"
 #include "Rendering/CascadedShadowMap.hpp"
+#include "Rendering/DrawBatchBuilder.hpp"
 #include "Rendering/LightManager.hpp"
+#include "Rendering/OcclusionCuller.hpp"
 #include "Rendering/PostProcessRenderer.hpp"
 #include "Rendering/PostProcessRenderPass.hpp"
 #include "Rendering/RenderCommandData.hpp"
@@ -40,8 +44,6 @@
 
 #include "Scene/Scene.hpp"
 
-#include "System/Window.hpp"
-
 struct RendererFramebuffer
 {
 	unsigned int framebuffer;
@@ -50,6 +52,43 @@ struct RendererFramebuffer
 	int height;
 };
 
+struct RendererViewportCullState
+{
+	// Parameters the viewport was culled with on the last frame
+	Mat4x4f view;
+	Mat4x4f projection;
+	FrustumPlanes frustum;
+	Vec2i size;
+	float objectMinScreenSizePx;
+	RenderViewportSizeEstimate objectSizeEstimate;
+
+	// transformEpoch of the viewport when its cached visibility was calculated,
+	// zero when the viewport has no valid cached visibility
+	unsigned int cachedEpoch;
+
+	bool operator==(const RendererViewportCullState& other) const
+	{
+		for (unsigned int i = 0; i < 16; ++i)
+			if (view.m[i] != other.view.m[i] || projection.m[i] != other.projection.m[i])
+				return false;
+
+		for (unsigned int i = 0; i < 6; ++i)
+		{
+			const Plane& a = frustum.planes[i];
+			const Plane& b = other.frustum.planes[i];
+
+			if (a.normal.x != b.normal.x || a.normal.y != b.normal.y ||
+				a.normal.z != b.normal.z || a.distance != b.distance)
+				return false;
+		}
+
+		return size.x == other.size.x && size.y == other.size.y &&
+			objectMinScreenSizePx == other.objectMinScreenSizePx &&
+			objectSizeEstimate == other.objectSizeEstimate &&
+			cachedEpoch == other.cachedEpoch;
+	}
+};
+
 struct TonemapUniformBlock
 {
 	alignas(16) float exposure;
@@ -57,32 +96,55 @@ struct TonemapUniformBlock
 
 Renderer::Renderer(
 	Allocator* allocator,
+	JobSystem* jobSystem,
 	RenderDevice* renderDevice,
 	LightManager* lightManager,
 	ShaderManager* shaderManager,
 	MeshManager* meshManager,
 	MaterialManager* materialManager) :
 	allocator(allocator),
+	jobSystem(jobSystem),
 	device(renderDevice),
 	renderTargetContainer(nullptr),
 	ssao(nullptr),
 	bloomEffect(nullptr),
+	occlusionCuller(nullptr),
 	framebufferData(nullptr),
 	framebufferCount(0),
 	framebufferTextures(nullptr),
 	framebufferTextureCount(0),
 	viewportData(nullptr),
+	viewportCullState(nullptr),
 	viewportCount(0),
 	viewportIndexFullscreen(0),
-	objectUniformBuffers(allocator),
+	objectTransformBuffer(renderDevice, RenderBufferTarget::ShaderStorageBuffer, ObjectBufferFramesInFlight),
+	objectTransformSlots(allocator),
+	batchDraws(allocator),
+	batchBuilder(allocator),
+	indirectCommandBuffer(renderDevice, RenderBufferTarget::DrawIndirectBuffer, ObjectBufferFramesInFlight),
+	renderGraph(allocator),
+	graphResources{},
+	graphRenderTargets(allocator),
+	graphScene(nullptr),
+	nextCommandIndex(0),
+	nextBatchIndex(0),
 	entityMap(allocator),
+	boundsTree(allocator),
 	lightManager(lightManager),
 	shaderManager(shaderManager),
 	meshManager(meshManager),
 	materialManager(materialManager),
 	lockCullingCamera(false),
 	commandList(allocator),
+	renderOrder(commandList.renderOrder),
+	rejectedDrawsReported(false),
+	stateChangeStats{},
 	objectVisibility(allocator),
+	objectVisibilityStride(0),
+	objectDirty(allocator),
+	dirtyObjectCount(0),
+	occlusionVisibility(allocator),
+	occluderCount(0),
 	lightResultArray(allocator),
 	customRenderers(allocator)
 {
@@ -97,6 +159,8 @@ Renderer::Renderer(
 	bloomEffect = allocator->MakeNew<BloomEffect>(
 		allocator, renderDevice, shaderManager, postProcessRenderer);
 
+	occlusionCuller = allocator->MakeNew<OcclusionCuller>(allocator);
+
 	fullscreenMesh = MeshId{ 0 };
 	lightingShaderId = ShaderId{ 0 };
 	tonemappingShaderId = ShaderId{ 0 };
@@ -111,11 +175,14 @@ Renderer::Renderer(
 	shadowDepthTextureIndex = 0;
 	lightAccumulationTextureIndex = 0;
 
-	objectUniformBlockStride = 0;
-	objectsPerUniformBuffer = 0;
+	objectBufferAlignment = 0;
+	objectIndexSize = 0;
+	objectModelOffset = 0;
+	objectModelSize = 0;
+	instancingThreshold = 2;
 
-	deferredLightingCallback = AddCustomRenderer(this);
-	postProcessCallback = AddCustomRenderer(this);
+	for (unsigned int i = 0; i < MaxViewportCount; ++i)
+		lastVisibleObjectCount[i] = 0;
 
 	data = InstanceData{};
 	data.count = 1; // Reserve index 0 as RenderObjectId::Null value
@@ -128,25 +195,30 @@ Renderer::~Renderer()
 	this->Deinitialize();
 
 	allocator->Deallocate(data.buffer);
+	allocator->MakeDelete(occlusionCuller);
 	allocator->Deallocate(bloomEffect);
 	allocator->Deallocate(ssao);
-	allocator->Deallocate(renderTargetContainer);
+	allocator->MakeDelete(renderTargetContainer);
 }
 
-void Renderer::Initialize(Window* window, EntityManager* entityManager)
+void Renderer::Initialize(const Vec2i& frameSize, EntityManager* entityManager)
 {
 	device->SetClipBehavior(RenderClipOriginMode::LowerLeft, RenderClipDepthMode::ZeroToOne);
 
-	int aligment = 0;
-	device->GetIntegerValue(RenderDeviceParameter::UniformBufferOffsetAlignment, &aligment);
+	int storageAlignment = 0;
+	device->GetIntegerValue(RenderDeviceParameter::ShaderStorageBufferOffsetAlignment, &storageAlignment);
+	objectBufferAlignment = static_cast<unsigned int>(storageAlignment);
 
-	objectUniformBlockStride = (sizeof(TransformUniformBlock) + aligment - 1) / aligment * aligment;
-	objectsPerUniformBuffer = ObjectUniformBufferSize / objectUniformBlockStride;
+	const unsigned int initialObjectDraws = 4096;
+	objectTransformBuffer.Initialize(
+		initialObjectDraws * (sizeof(unsigned int) + sizeof(Mat4x4f)), objectBufferAlignment);
 
-	Vec2i frameBufferSizei = window->GetFrameBufferSize();
+	const unsigned int initialIndirectCommands = 1024;
+	indirectCommandBuffer.Initialize(
+		initialIndirectCommands * sizeof(RenderCommandData::DrawIndexedIndirectCommand), 16);
 
 	postProcessRenderer->Initialize();
-	ssao->Initialize(frameBufferSizei);
+	ssao->Initialize(frameSize);
 
 	bloomEffect->Initialize();
 
@@ -174,6 +246,13 @@ void Renderer::Initialize(Window* window, EntityManager* entityManager)
 		void* buf = this->allocator->Allocate(sizeof(RenderViewport) * MaxViewportCount);
 		viewportData = static_cast<RenderViewport*>(buf);
 
+		void* cullBuf = this->allocator->Allocate(sizeof(RendererViewportCullState) * MaxViewportCount);
+		viewportCullState = static_cast<RendererViewportCullState*>(cullBuf);
+
+		// Value-initialized, so cachedEpoch is zero and no viewport has cached visibility
+		for (unsigned int i = 0; i < MaxViewportCount; ++i)
+			new (&viewportCullState[i]) RendererViewportCullState{};
+
 		// Create uniform buffer objects
 		unsigned int buffers[MaxViewportCount];
 		device->CreateBuffers(MaxViewportCount, buffers);
@@ -181,32 +260,228 @@ void Renderer::Initialize(Window* window, EntityManager* entityManager)
 		for (size_t i = 0; i < MaxViewportCount; ++i)
 		{
 			viewportData[i].uniformBlockObject = buffers[i];
+			viewportData[i].transformEpoch = 1;
 			device->BindBuffer(RenderBufferTarget::UniformBuffer, viewportData[i].uniformBlockObject);
 			device->SetBufferData(RenderBufferTarget::UniformBuffer, sizeof(ViewportUniformBlock), nullptr, RenderBufferUsage::DynamicDraw);
 		}
 	}
 
 	{
-		// Create geometry framebuffer and textures
+		// Create geometry framebuffer, its textures are created with the
+		// other frame sized textures below
 
 		framebufferCount += 1;
 
 		RendererFramebuffer& gbuffer = framebufferData[FramebufferIndexGBuffer];
-		gbuffer.width = frameBufferSizei.x;
-		gbuffer.height = frameBufferSizei.y;
-
-		// Create and bind framebuffer
-
 		device->CreateFramebuffers(1, &gbuffer.framebuffer);
-		device->BindFramebuffer(RenderFramebufferTarget::Framebuffer, gbuffer.framebuffer);
-
-		unsigned int gbufferTextureCount = 4;
-		device->CreateTextures(gbufferTextureCount, &framebufferTextures[framebufferTextureCount]);
 
 		gBufferAlbedoTextureIndex = framebufferTextureCount++;
 		gBufferNormalTextureIndex = framebufferTextureCount++;
 		gBufferMaterialTextureIndex = framebufferTextureCount++;
 		fullscreenDepthTextureIndex = framebufferTextureCount++;
+	}
+
+	{
+		// Create shadow framebuffer
+
+		int shadowSide = CascadedShadowMap::GetShadowCascadeResolution();
+		unsigned int shadowCascadeCount = CascadedShadowMap::GetCascadeCount();
+		Vec2i size(shadowSide * shadowCascadeCount, shadowSide);
+
+		framebufferCount += 1;
+
+		RendererFramebuffer& framebuffer = framebufferData[FramebufferIndexShadow];
+		framebuffer.width = size.x;
+		framebuffer.height = size.y;
+
+		// Create and bind framebuffer
+
+		device->CreateFramebuffers(1, &framebuffer.framebuffer);
+		device->BindFramebuffer(RenderFramebufferTarget::Framebuffer, framebuffer.framebuffer);
+
+		// We aren't rendering to any color attachments
+		RenderFramebufferAttachment drawBuffers = RenderFramebufferAttachment::None;
+		device->SetFramebufferDrawBuffers(1, &drawBuffers);
+
+		// Create texture
+		device->CreateTextures(1, &framebufferTextures[framebufferTextureCount]);
+		
+		shadowDepthTextureIndex = framebufferTextureCount++;
+
+		// Create and attach depth buffer
+		unsigned int depthTexture = framebufferTextures[shadowDepthTextureIndex];
+		device->BindTexture(RenderTextureTarget::Texture2d, depthTexture);
+
+		RenderCommandData::SetTextureStorage2D depthTextureStorage{
+			RenderTextureTarget::Texture2d, 1, RenderTextureSizedFormat::D32F, size.x, size.y
+		};
+		device->SetTextureStorage2D(&depthTextureStorage);
+
+		device->SetTextureMinFilter(RenderTextureTarget::Texture2d, RenderTextureFilterMode::Linear);
+		device->SetTextureMagFilter(RenderTextureTarget::Texture2d, RenderTextureFilterMode::Linear);
+		device->SetTextureWrapModeU(RenderTextureTarget::Texture2d, RenderTextureWrapMode::ClampToEdge);
+		device->SetTextureWrapModeV(RenderTextureTarget::Texture2d, RenderTextureWrapMode::ClampToEdge);
+		device->SetTextureCompareMode(RenderTextureTarget::Texture2d, RenderTextureCompareMode::CompareRefToTexture);
+		device->SetTextureCompareFunc(RenderTextureTarget::Texture2d, RenderDepthCompareFunc::GreaterThanOrEqual);
+
+		RenderCommandData::AttachFramebufferTexture2D depthFramebufferTexture{
+			RenderFramebufferTarget::Framebuffer, RenderFramebufferAttachment::Depth,
+			RenderTextureTarget::Texture2d, depthTexture, 0
+		};
+		device->AttachFramebufferTexture2D(&depthFramebufferTexture);
+
+		// Clear texture and framebuffer binds
+		device->BindTexture(RenderTextureTarget::Texture2d, 0);
+		device->BindFramebuffer(RenderFramebufferTarget::Framebuffer, 0);
+	}
+
+	{
+		// HDR light accumulation framebuffer
+
+		framebufferCount += 1;
+
+		RendererFramebuffer& framebuffer = framebufferData[FramebufferIndexLightAcc];
+		device->CreateFramebuffers(1, &framebuffer.framebuffer);
+
+		lightAccumulationTextureIndex = framebufferTextureCount++;
+	}
+
+	CreateFrameSizedTextures(frameSize);
+	
+	{
+		// Set up uniform buffer for tonemapping pass
+
+		device->CreateBuffers(1, &tonemapUniformBufferId);
+		device->BindBuffer(RenderBufferTarget::UniformBuffer, tonemapUniformBufferId);
+		device->SetBufferData(RenderBufferTarget::UniformBuffer, sizeof(TonemapUniformBlock), nullptr, RenderBufferUsage::DynamicDraw);
+	}
+
+	{
+		// Create opaque lighting pass uniform buffer
+
+		device->CreateBuffers(1, &lightingUniformBufferId);
+		device->BindBuffer(RenderBufferTarget::UniformBuffer, lightingUniformBufferId);
+		device->SetBufferData(RenderBufferTarget::UniformBuffer, sizeof(LightingUniformBlock), nullptr, RenderBufferUsage::DynamicDraw);
+	}
+
+	{
+		// Create screen filling quad
+		fullscreenMesh = meshManager->CreateMesh();
+		MeshPresets::UploadPlane(meshManager, fullscreenMesh);
+	}
+	
+	{
+		const char* path = "res/materials/deferred_geometry/shadow_depth.material.json";
+		shadowMaterial = materialManager->GetIdByPath(StringRef(path));
+	}
+
+	{
+		const char* path = "res/shaders/deferred_lighting/lighting.shader.json";
+		lightingShaderId = shaderManager->GetIdByPath(StringRef(path));
+	}
+
+	{
+		const char* path = "res/shaders/post_process/tonemap.shader.json";
+		tonemappingShaderId = shaderManager->GetIdByPath(StringRef(path));
+	}
+
+	// Create skybox entity
+	{
+		skyboxEntity = entityManager->Create();
+
+		RenderObjectId skyboxRenderObj = AddRenderObject(skyboxEntity);
+
+		MeshId skyboxMesh = meshManager->CreateMesh();
+		MeshPresets::UploadCube(meshManager, skyboxMesh);
+		SetMeshId(skyboxRenderObj, skyboxMesh);
+
+		// Expand skybox extents to make sure it is always rendered
+		BoundingBox skyboxBounds;
+		skyboxBounds.extents = Vec3f(1e9, 1e9, 1e9);
+		SetObjectBounds(skyboxRenderObj.i, skyboxBounds);
+	}
+}
+
+void Renderer::Deinitialize()
+{
+	if (fullscreenMesh.IsValid())
+	{
+		meshManager->RemoveMesh(fullscreenMesh);
+		fullscreenMesh = MeshId{ 0 };
+	}
+
+	if (lightingUniformBufferId != 0)
+	{
+		device->DestroyBuffers(1, &lightingUniformBufferId);
+		lightingUniformBufferId = 0;
+	}
+
+	indirectCommandBuffer.Deinitialize();
+	objectTransformBuffer.Deinitialize();
+
+	renderTargetContainer->DestroyUnusedTargets();
+
+	if (framebufferData != nullptr)
+	{
+		for (unsigned int i = 0; i < framebufferCount; ++i)
+		{
+			RendererFramebuffer& fb = framebufferData[i];
+
+			if (fb.framebuffer != 0)
+			{
+				device->DestroyFramebuffers(1, &fb.framebuffer);
+
+				fb.framebuffer = 0;
+			}
+		}
+
+		this->allocator->Deallocate(framebufferData);
+		framebufferData = nullptr;
+		framebufferCount = 0;
+	}
+
+	if (framebufferTextures != nullptr)
+	{
+		device->DestroyTextures(framebufferTextureCount, framebufferTextures);
+
+		this->allocator->Deallocate(framebufferTextures);
+		framebufferTextures = nullptr;
+		framebufferTextureCount = 0;
+	}
+
+	if (viewportData != nullptr)
+	{
+		for (size_t i = 0; i < MaxViewportCount; ++i)
+		{
+			if (viewportData[i].uniformBlockObject != 0)
+			{
+				device->DestroyBuffers(1, &(viewportData[i].uniformBlockObject));
+				viewportData[i].uniformBlockObject = 0;
+			}
+		}
+
+		this->allocator->Deallocate(viewportData);
+		viewportData = nullptr;
+		viewportCount = 0;
+
+		this->allocator->Deallocate(viewportCullState);
+		viewportCullState = nullptr;
+	}
+}
+
+void Renderer::CreateFrameSizedTextures(const Vec2i& frameSize)
+{
+	{
+		// Geometry framebuffer textures
+
+		RendererFramebuffer& gbuffer = framebufferData[FramebufferIndexGBuffer];
+		gbuffer.width = frameSize.x;
+		gbuffer.height = frameSize.y;
+
+		device->BindFramebuffer(RenderFramebufferTarget::Framebuffer, gbuffer.framebuffer);
+
+		// G-buffer texture indices are consecutive
+		device->CreateTextures(4, &framebufferTextures[gBufferAlbedoTextureIndex]);
 
 		RenderFramebufferAttachment colAtt[3] = {
 			RenderFramebufferAttachment::Color0,
@@ -292,86 +567,24 @@ void Renderer::Initialize(Window* window, EntityManager* entityManager)
 			RenderTextureTarget::Texture2d, depthTexture, 0
 		};
 		device->AttachFramebufferTexture2D(&depthAttachTexture);
-
-		framebufferTextureCount += gbufferTextureCount;
 	}
 
 	{
-		// Create shadow framebuffer
-
-		int shadowSide = CascadedShadowMap::GetShadowCascadeResolution();
-		unsigned int shadowCascadeCount = CascadedShadowMap::GetCascadeCount();
-		Vec2i size(shadowSide * shadowCascadeCount, shadowSide);
+		// Light accumulation framebuffer texture
 
-		framebufferCount += 1;
+		RendererFramebuffer& lightAcc = framebufferData[FramebufferIndexLightAcc];
+		lightAcc.width = frameSize.x;
+		lightAcc.height = frameSize.y;
 
-		RendererFramebuffer& framebuffer = framebufferData[FramebufferIndexShadow];
-		framebuffer.width = size.x;
-		framebuffer.height = size.y;
-
-		// Create and bind framebuffer
-
-		device->CreateFramebuffers(1, &framebuffer.framebuffer);
-		device->BindFramebuffer(RenderFramebufferTarget::Framebuffer, framebuffer.framebuffer);
-
-		// We aren't rendering to any color attachments
-		RenderFramebufferAttachment drawBuffers = RenderFramebufferAttachment::None;
-		device->SetFramebufferDrawBuffers(1, &drawBuffers);
-
-		// Create texture
-		device->CreateTextures(1, &framebufferTextures[framebufferTextureCount]);
-		
-		shadowDepthTextureIndex = framebufferTextureCount++;
-
-		// Create and attach depth buffer
-		unsigned int depthTexture = framebufferTextures[shadowDepthTextureIndex];
-		device->BindTexture(RenderTextureTarget::Texture2d, depthTexture);
-
-		RenderCommandData::SetTextureStorage2D depthTextureStorage{
-			RenderTextureTarget::Texture2d, 1, RenderTextureSizedFormat::D32F, size.x, size.y
-		};
-		device->SetTextureStorage2D(&depthTextureStorage);
+		device->BindFramebuffer(RenderFramebufferTarget::Framebuffer, lightAcc.framebuffer);
 
-		device->SetTextureMinFilter(RenderTextureTarget::Texture2d, RenderTextureFilterMode::Linear);
-		device->SetTextureMagFilter(RenderTextureTarget::Texture2d, RenderTextureFilterMode::Linear);
-		device->SetTextureWrapModeU(RenderTextureTarget::Texture2d, RenderTextureWrapMode::ClampToEdge);
-		device->SetTextureWrapModeV(RenderTextureTarget::Texture2d, RenderTextureWrapMode::ClampToEdge);
-		device->SetTextureCompareMode(RenderTextureTarget::Texture2d, RenderTextureCompareMode::CompareRefToTexture);
-		device->SetTextureCompareFunc(RenderTextureTarget::Texture2d, RenderDepthCompareFunc::GreaterThanOrEqual);
-
-		RenderCommandData::AttachFramebufferTexture2D depthFramebufferTexture{
-			RenderFramebufferTarget::Framebuffer, RenderFramebufferAttachment::Depth,
-			RenderTextureTarget::Texture2d, depthTexture, 0
-		};
-		device->AttachFramebufferTexture2D(&depthFramebufferTexture);
-
-		// Clear texture and framebuffer binds
-		device->BindTexture(RenderTextureTarget::Texture2d, 0);
-		device->BindFramebuffer(RenderFramebufferTarget::Framebuffer, 0);
-	}
-
-	{
-		// HDR light accumulation framebuffer
-
-		framebufferCount += 1;
-
-		RendererFramebuffer& framebuffer = framebufferData[FramebufferIndexLightAcc];
-		framebuffer.width = frameBufferSizei.x;
-		framebuffer.height = frameBufferSizei.y;
-
-		// Create and bind framebuffer
-
-		device->CreateFramebuffers(1, &framebuffer.framebuffer);
-		device->BindFramebuffer(RenderFramebufferTarget::Framebuffer, framebuffer.framebuffer);
-
-		device->CreateTextures(1, &framebufferTextures[framebufferTextureCount]);
-		lightAccumulationTextureIndex = framebufferTextureCount++;
+		device->CreateTextures(1, &framebufferTextures[lightAccumulationTextureIndex]);
 		unsigned int lightAccTexture = framebufferTextures[lightAccumulationTextureIndex];
 
 		device->BindTexture(RenderTextureTarget::Texture2d, lightAccTexture);
 
 		RenderCommandData::SetTextureStorage2D storage{
-			RenderTextureTarget::Texture2d, 1, RenderTextureSizedFormat::RGB16F, framebuffer.width, framebuffer.height
+			RenderTextureTarget::Texture2d, 1, RenderTextureSizedFormat::RGB16F, lightAcc.width, lightAcc.height
 		};
 		device->SetTextureStorage2D(&storage);
 
@@ -392,151 +605,366 @@ void Renderer::Initialize(Window* window, EntityManager* entityManager)
 		};
 		device->AttachFramebufferTexture2D(&depthAttachTexture);
 	}
-	
-	{
-		// Set up uniform buffer for tonemapping pass
 
-		device->CreateBuffers(1, &tonemapUniformBufferId);
-		device->BindBuffer(RenderBufferTarget::UniformBuffer, tonemapUniformBufferId);
-		device->SetBufferData(RenderBufferTarget::UniformBuffer, sizeof(TonemapUniformBlock), nullptr, RenderBufferUsage::DynamicDraw);
-	}
+	device->BindTexture(RenderTextureTarget::Texture2d, 0);
+	device->BindFramebuffer(RenderFramebufferTarget::Framebuffer, 0);
+}
 
-	{
-		// Create opaque lighting pass uniform buffer
+void Renderer::SetFrameSize(const Vec2i& frameSize)
+{
+	const RendererFramebuffer& gbuffer = framebufferData[FramebufferIndexGBuffer];
 
-		device->CreateBuffers(1, &lightingUniformBufferId);
-		device->BindBuffer(RenderBufferTarget::UniformBuffer, lightingUniformBufferId);
-		device->SetBufferData(RenderBufferTarget::UniformBuffer, sizeof(LightingUniformBlock), nullptr, RenderBufferUsage::DynamicDraw);
-	}
+	// A minimized window has an empty framebuffer, keep the old size until it's restored
+	if (frameSize.x <= 0 || frameSize.y <= 0 ||
+		(frameSize.x == gbuffer.width && frameSize.y == gbuffer.height))
+		return;
 
+	// Texture storage is immutable, so the textures are recreated at the new size
+	device->DestroyTextures(4, &framebufferTextures[gBufferAlbedoTextureIndex]);
+	device->DestroyTextures(1, &framebufferTextures[lightAccumulationTextureIndex]);
+
+	CreateFrameSizedTextures(frameSize);
+
+	ssao->SetFramebufferSize(frameSize);
+
+	// Pooled targets of the old size would otherwise stay around until they're evicted
+	renderTargetContainer->DestroyUnusedTargets();
+}
+
+void Renderer::Render(Scene* scene)
+{
+	unsigned int objectDrawCount = PopulateCommandList(scene);
+	BuildDrawBatches(objectDrawCount);
+	UpdateUniformBuffers();
+
+	if (batchBuilder.GetIndirectCommands().GetCount() > 0)
+		device->BindBuffer(RenderBufferTarget::DrawIndirectBuffer, indirectCommandBuffer.GetBufferId());
+
+	// Object transforms are bound once for all draws of the frame
+	if (batchBuilder.GetBatches().GetCount() > 0)
 	{
-		// Create screen filling quad
-		fullscreenMesh = meshManager->CreateMesh();
-		MeshPresets::UploadPlane(meshManager, fullscreenMesh);
-	}
-	
-	{
-		const char* path = "res/materials/deferred_geometry/shadow_depth.material.json";
-		shadowMaterial = materialManager->GetIdByPath(StringRef(path));
+		unsigned int transformBuffer = objectTransformBuffer.GetBufferId();
+		intptr_t frameOffset = objectTransformBuffer.GetFrameOffset();
+
+		RenderCommandData::BindBufferRange bindIndices{
+			RenderBufferTarget::ShaderStorageBuffer, UniformBlockBinding::ObjectIndex,
+			transformBuffer, frameOffset, objectIndexSize
+		};
+
+		RenderCommandData::BindBufferRange bindModels{
+			RenderBufferTarget::ShaderStorageBuffer, UniformBlockBinding::Object,
+			transformBuffer, frameOffset + static_cast<intptr_t>(objectModelOffset), objectModelSize
+		};
+
+		device->BindBufferRange(&bindIndices);
+		device->BindBufferRange(&bindModels);
 	}
 
+	stateChangeStats = StateChangeStats{};
+
+	graphScene = scene;
+
+	BuildRenderGraph();
+	ExecuteRenderGraph();
+
+	graphScene = nullptr;
+
+	commandList.Clear();
+
+	// Regions written this frame can be reused once the GPU passes these fences
+	objectTransformBuffer.EndFrame();
+	indirectCommandBuffer.EndFrame();
+
+	renderTargetContainer->ConfirmAllTargetsAreUnused();
+	renderTargetContainer->EndFrame();
+}
+
+void Renderer::BuildRenderGraph()
+{
+	using TextureDesc = RenderGraph::TextureDesc;
+	using Access = RenderGraphAccess;
+
+	renderGraph.Clear();
+
+	const RendererFramebuffer& gbuffer = framebufferData[FramebufferIndexGBuffer];
+	const RendererFramebuffer& shadow = framebufferData[FramebufferIndexShadow];
+	const RendererFramebuffer& lightAcc = framebufferData[FramebufferIndexLightAcc];
+
+	Vec2i frameSize(gbuffer.width, gbuffer.height);
+	Vec2i shadowSize(shadow.width, shadow.height);
+
+	// Framebuffers of the renderer are imported, so they're never aliased
+
+	GraphResources& res = graphResources;
+
+	res.shadowDepth = renderGraph.ImportTexture("Shadow depth",
+		TextureDesc{ shadowSize, RenderTextureSizedFormat::D32F },
+		framebufferTextures[shadowDepthTextureIndex], shadow.framebuffer);
+
+	res.gBufferAlbedo = renderGraph.ImportTexture("G-buffer albedo",
+		TextureDesc{ frameSize, RenderTextureSizedFormat::SRGB8 },
+		framebufferTextures[gBufferAlbedoTextureIndex], gbuffer.framebuffer);
+
+	res.gBufferNormal = renderGraph.ImportTexture("G-buffer normal",
+		TextureDesc{ frameSize, RenderTextureSizedFormat::RG16 },
+		framebufferTextures[gBufferNormalTextureIndex], gbuffer.framebuffer);
+
+	res.gBufferMaterial = renderGraph.ImportTexture("G-buffer material",
+		TextureDesc{ frameSize, RenderTextureSizedFormat::RGB8 },
+		framebufferTextures[gBufferMaterialTextureIndex], gbuffer.framebuffer);
+
+	res.depth = renderGraph.ImportTexture("Depth",
+		TextureDesc{ frameSize, RenderTextureSizedFormat::D32F },
+		framebufferTextures[fullscreenDepthTextureIndex], gbuffer.framebuffer);
+
+	res.lightAccumulation = renderGraph.ImportTexture("Light accumulation",
+		TextureDesc{ frameSize, RenderTextureSizedFormat::RGB16F },
+		framebufferTextures[lightAccumulationTextureIndex], lightAcc.framebuffer);
+
+	res.backbuffer = renderGraph.ImportTexture("Backbuffer",
+		TextureDesc{ frameSize, RenderTextureSizedFormat::RGBA8 }, 0, 0);
+
+	res.objectTransforms = renderGraph.ImportBuffer("Object transforms", objectTransformBuffer.GetBufferId());
+
+	renderGraph.MarkOutput(res.backbuffer);
+
+	// Shadow cascades, preceded by the render state of the frame
+
+	RenderGraphPassId shadowPass = renderGraph.AddPass("Shadows", ExecuteGraphPass, this, GraphPass_Shadows);
+	renderGraph.AddAccess(shadowPass, res.objectTransforms, Access::StorageRead);
+	renderGraph.AddAccess(shadowPass, res.shadowDepth, Access::RenderTargetWrite);
+
+	// Opaque objects to the g-buffer
+
+	RenderGraphPassId geometryPass = renderGraph.AddPass("Opaque geometry", ExecuteGraphPass, this, GraphPass_Geometry);
+	renderGraph.AddAccess(geometryPass, res.objectTransforms, Access::StorageRead);
+	renderGraph.AddAccess(geometryPass, res.gBufferAlbedo, Access::RenderTargetWrite);
+	renderGraph.AddAccess(geometryPass, res.gBufferNormal, Access::RenderTargetWrite);
+	renderGraph.AddAccess(geometryPass, res.gBufferMaterial, Access::RenderTargetWrite);
+	renderGraph.AddAccess(geometryPass, res.depth, Access::RenderTargetWrite);
+
+	ScreenSpaceAmbientOcclusion::RenderParams ssaoParams;
+	ssaoParams.normalTexture = res.gBufferNormal;
+	ssaoParams.depthTexture = res.depth;
+	ssaoParams.projection = graphScene->GetActiveCamera()->parameters;
+	res.ambientOcclusion = ssao->AddPasses(&renderGraph, ssaoParams);
+
+	// Deferred lighting
+
+	RenderGraphPassId lightingPass = renderGraph.AddPass("Lighting", ExecuteGraphPass, this, GraphPass_Lighting);
+	renderGraph.AddAccess(lightingPass, res.gBufferAlbedo, Access::ShaderRead);
+	renderGraph.AddAccess(lightingPass, res.gBufferNormal, Access::ShaderRead);
+	renderGraph.AddAccess(lightingPass, res.gBufferMaterial, Access::ShaderRead);
+	renderGraph.AddAccess(lightingPass, res.depth, Access::ShaderRead);
+	renderGraph.AddAccess(lightingPass, res.ambientOcclusion, Access::ShaderRead);
+	renderGraph.AddAccess(lightingPass, res.shadowDepth, Access::ShaderRead);
+	renderGraph.AddAccess(lightingPass, res.lightAccumulation, Access::RenderTargetWrite);
+
+	// Skybox and transparent objects on top of the lit image
+
+	RenderGraphPassId forwardPass = renderGraph.AddPass("Skybox and transparent", ExecuteGraphPass, this, GraphPass_Forward);
+	renderGraph.AddAccess(forwardPass, res.objectTransforms, Access::StorageRead);
+	renderGraph.AddAccess(forwardPass, res.depth, Access::RenderTargetRead);
+	renderGraph.AddAccess(forwardPass, res.lightAccumulation, Access::RenderTargetBlend);
+
+	bloomEffect->AddPasses(&renderGraph, res.lightAccumulation, res.lightAccumulation);
+
+	RenderGraphPassId tonemapPass = renderGraph.AddPass("Tonemapping", ExecuteGraphPass, this, GraphPass_Tonemapping);
+	renderGraph.AddAccess(tonemapPass, res.lightAccumulation, Access::ShaderRead);
+	renderGraph.AddAccess(tonemapPass, res.backbuffer, Access::RenderTargetWrite);
+}
+
+void Renderer::ExecuteRenderGraph()
+{
+	renderGraph.Compile();
+
+	// Transient textures that share a physical texture share a render target
+
+	graphRenderTargets.Clear();
+
+	for (unsigned int i = 0, count = renderGraph.GetPhysicalTextureCount(); i < count; ++i)
 	{
-		const char* path = "res/shaders/deferred_lighting/lighting.shader.json";
-		lightingShaderId = shaderManager->GetIdByPath(StringRef(path));
+		const RenderGraph::TextureDesc& desc = renderGraph.GetPhysicalTextureDesc(i);
+		const RenderTarget& target = renderTargetContainer->AcquireRenderTarget(desc.size, desc.format);
+
+		renderGraph.SetPhysicalTexture(i, target.colorTexture, target.framebuffer);
+		graphRenderTargets.PushBack(target.id);
 	}
 
+	nextCommandIndex = 0;
+	nextBatchIndex = 0;
+
+	for (unsigned int i = 0, count = renderGraph.GetCompiledPassCount(); i < count; ++i)
 	{
-		const char* path = "res/shaders/post_process/tonemap.shader.json";
-		tonemappingShaderId = shaderManager->GetIdByPath(StringRef(path));
+		IssueGraphBarriers(renderGraph.GetCompiledPass(i));
+		renderGraph.ExecutePass(i);
 	}
 
-	// Create skybox entity
+	for (unsigned int i = 0, count = graphRenderTargets.GetCount(); i < count; ++i)
+		renderTargetContainer->ReleaseRenderTarget(graphRenderTargets[i]);
+}
+
+void Renderer::IssueGraphBarriers(const RenderGraph::CompiledPass& pass)
+{
+	// OpenGL orders framebuffer writes with the draws that follow them, so
+	// only writes through image stores and storage buffers need barriers
+
+	RenderCommandData::MemoryBarrier memoryBarrier{};
+	bool barrierNeeded = false;
+
+	const RenderGraph::Barrier* barriers = renderGraph.GetBarriers() + pass.firstBarrier;
+
+	for (unsigned int i = 0; i < pass.barrierCount; ++i)
 	{
-		skyboxEntity = entityManager->Create();
+		const RenderGraph::Barrier& barrier = barriers[i];
 
-		RenderObjectId skyboxRenderObj = AddRenderObject(skyboxEntity);
+		if (barrier.sourceAccess != RenderGraphAccess::StorageWrite)
+			continue;
 
-		MeshId skyboxMesh = meshManager->CreateMesh();
-		MeshPresets::UploadCube(meshManager, skyboxMesh);
-		SetMeshId(skyboxRenderObj, skyboxMesh);
+		bool texture = renderGraph.IsTexture(barrier.resource);
+		barrierNeeded = true;
 
-		// Expand skybox extents to make sure it is always rendered
-		BoundingBox skyboxBounds;
-		skyboxBounds.extents = Vec3f(1e9, 1e9, 1e9);
-		data.bounds[skyboxRenderObj.i] = skyboxBounds;
+		switch (barrier.destinationAccess)
+		{
+		case RenderGraphAccess::ShaderRead:
+			if (texture)
+				memoryBarrier.textureFetch = true;
+			else
+				memoryBarrier.uniform = true;
+			break;
+
+		case RenderGraphAccess::StorageRead:
+		case RenderGraphAccess::StorageWrite:
+			if (texture)
+				memoryBarrier.shaderImageAccess = true;
+			else
+				memoryBarrier.shaderStorage = true;
+			break;
+
+		case RenderGraphAccess::RenderTargetRead:
+		case RenderGraphAccess::RenderTargetWrite:
+		case RenderGraphAccess::RenderTargetBlend:
+			memoryBarrier.framebuffer = true;
+			break;
+		}
 	}
+
+	if (barrierNeeded)
+		device->MemoryBarrier(memoryBarrier);
 }
 
-void Renderer::Deinitialize()
+void Renderer::ExecuteGraphPass(void* userData, unsigned int graphPass)
 {
-	if (fullscreenMesh.IsValid())
-	{
-		meshManager->RemoveMesh(fullscreenMesh);
-		fullscreenMesh = MeshId{ 0 };
-	}
+	static_cast<Renderer*>(userData)->RenderGraphPass(graphPass);
+}
 
-	if (lightingUniformBufferId != 0)
-	{
-		device->DestroyBuffers(1, &lightingUniformBufferId);
-		lightingUniformBufferId = 0;
-	}
+void Renderer::RenderGraphPass(unsigned int graphPass)
+{
+	unsigned int fsvp = viewportIndexFullscreen;
 
-	if (objectUniformBuffers.GetCount() > 0)
+	switch (graphPass)
 	{
-		device->DestroyBuffers(objectUniformBuffers.GetCount(), objectUniformBuffers.GetData());
-		objectUniformBuffers.Clear();
-	}
-
-	if (framebufferData != nullptr)
+	case GraphPass_Shadows:
+		// Shadow viewports come before the fullscreen viewport
+		RenderCommands(0, FindCommandIndex(fsvp, RenderPass::OpaqueGeometry));
+		break;
+
+	case GraphPass_Geometry:
+		RenderCommands(FindCommandIndex(fsvp, RenderPass::OpaqueGeometry),
+			FindCommandIndex(fsvp, RenderPass::OpaqueLighting));
+		break;
+
+	case GraphPass_Lighting:
+		RenderDeferredLighting();
+		RenderCommands(FindCommandIndex(fsvp, RenderPass::OpaqueLighting),
+			FindCommandIndex(fsvp, RenderPass::Skybox));
+		break;
+
+	case GraphPass_Forward:
 	{
-		for (unsigned int i = 0; i < framebufferCount; ++i)
-		{
-			RendererFramebuffer& fb = framebufferData[i];
+		const RendererFramebuffer& fb = framebufferData[FramebufferIndexLightAcc];
 
-			if (fb.framebuffer != 0)
-			{
-				device->DestroyFramebuffers(1, &fb.framebuffer);
+		RenderCommandData::BindFramebufferData bindFramebuffer{
+			RenderFramebufferTarget::Framebuffer, fb.framebuffer
+		};
+		device->BindFramebuffer(&bindFramebuffer);
 
-				fb.framebuffer = 0;
-			}
-		}
+		RenderCommandData::ViewportData viewport{ 0, 0, fb.width, fb.height };
+		device->Viewport(&viewport);
 
-		this->allocator->Deallocate(framebufferData);
-		framebufferData = nullptr;
-		framebufferCount = 0;
+		RenderCommands(FindCommandIndex(fsvp, RenderPass::Skybox),
+			FindCommandIndex(fsvp, RenderPass::PostProcess));
 	}
+		break;
 
-	if (framebufferTextures != nullptr)
-	{
-		device->DestroyTextures(framebufferTextureCount, framebufferTextures);
-
-		this->allocator->Deallocate(framebufferTextures);
-		framebufferTextures = nullptr;
-		framebufferTextureCount = 0;
+	case GraphPass_Tonemapping:
+		RenderTonemapping();
+		RenderCommands(FindCommandIndex(fsvp, RenderPass::PostProcess), commandList.commands.GetCount());
+		break;
 	}
+}
 
-	if (viewportData != nullptr)
+unsigned int Renderer::FindCommandIndex(unsigned int viewport, RenderPass pass) const
+{
+	uint64_t key = 0;
+	renderOrder.viewportIndex.AssignValue(key, viewport);
+	renderOrder.viewportPass.AssignValue(key, static_cast<uint64_t>(pass));
+
+	// Find the first command that isn't less than the key
+	const uint64_t* commands = commandList.commands.GetData();
+	unsigned int first = 0;
+	unsigned int count = commandList.commands.GetCount();
+
+	while (count > 0)
 	{
-		for (size_t i = 0; i < MaxViewportCount; ++i)
+		unsigned int step = count / 2;
+
+		if (commands[first + step] < key)
 		{
-			if (viewportData[i].uniformBlockObject != 0)
-			{
-				device->DestroyBuffers(1, &(viewportData[i].uniformBlockObject));
-				viewportData[i].uniformBlockObject = 0;
-			}
+			first += step + 1;
+			count -= step + 1;
 		}
-
-		this->allocator->Deallocate(viewportData);
-		viewportData = nullptr;
-		viewportCount = 0;
+		else
+			count = step;
 	}
+
+	return first;
 }
 
-void Renderer::Render(Scene* scene)
+void Renderer::RenderCommands(unsigned int begin, unsigned int end)
 {
-	unsigned int objectDrawCount = PopulateCommandList(scene);
-	UpdateUniformBuffers(objectDrawCount);
+	const Array<DrawBatchBuilder::Batch>& batches = batchBuilder.GetBatches();
+	const uint64_t* commands = commandList.commands.GetData();
+
+	// Skip the batches of commands that no executed pass covered
+	for (unsigned int commandIdx = nextCommandIndex; commandIdx < begin; ++commandIdx)
+	{
+		uint64_t command = commands[commandIdx];
+
+		if (IsDrawCommand(command) && renderOrder.GetMaterialId(command) != RenderOrderConfiguration::CallbackMaterialId)
+		{
+			commandIdx += batches[nextBatchIndex].drawCount - 1;
+			nextBatchIndex += 1;
+		}
+	}
 
-	int objectDrawsProcessed = 0;
+	intptr_t indirectFrameOffset = indirectCommandBuffer.GetFrameOffset();
 
 	unsigned int lastVpIdx = MaxViewportCount;
 	unsigned int lastShaderProgram = 0;
-	MeshDrawData* draw = nullptr;
 	MeshId lastMeshId = MeshId{ 0 };
 	MaterialId lastMaterialId = MaterialId{ 0 };
 
-	TransformUniformBlock objectUniforms;
+	ResetBoundMaterialTextures();
 
-	uint64_t* itr = commandList.commands.GetData();
-	uint64_t* end = itr + commandList.commands.GetCount();
-	for (; itr != end; ++itr)
+	for (unsigned int commandIdx = begin; commandIdx < end; ++commandIdx)
 	{
-		uint64_t command = *itr;
+		uint64_t command = commands[commandIdx];
 
 		// If command is not control command, draw object
 		if (ParseControlCommand(command) == false)
 		{
-			unsigned int mat = renderOrder.materialId.GetValue(command);
+			unsigned int mat = renderOrder.GetMaterialId(command);
 			unsigned int vpIdx = renderOrder.viewportIndex.GetValue(command);
 			const RenderViewport& viewport = viewportData[vpIdx];
 
@@ -563,37 +991,36 @@ void Renderer::Render(Scene* scene)
 					{
 						device->UseShaderProgram(matData.cachedShaderDeviceId);
 						lastShaderProgram = matData.cachedShaderDeviceId;
+						stateChangeStats.shaderProgramChanges += 1;
 					}
 
+					stateChangeStats.materialChanges += 1;
+
 					BindMaterialTextures(matData);
 
 					// Bind material uniform block to shader
 					device->BindBufferBase(RenderBufferTarget::UniformBuffer, UniformBlockBinding::Material, matData.uniformBufferObject);
 				}
 
-				// Bind object transform uniform block to shader
-
-				int bufferIndex = objectDrawsProcessed / objectsPerUniformBuffer;
-				int objectInBuffer = objectDrawsProcessed % objectsPerUniformBuffer;
-
-				RenderCommandData::BindBufferRange bind{
-					RenderBufferTarget::UniformBuffer, UniformBlockBinding::Object,
-					objectUniformBuffers[bufferIndex], objectInBuffer * objectUniformBlockStride, objectUniformBlockStride
-				};
-
-				device->BindBufferRange(&bind);
+				const DrawBatchBuilder::Batch& batch = batches[nextBatchIndex];
+				nextBatchIndex += 1;
 
 				MeshId mesh = data.mesh[objIdx];
+				const DrawBatchBuilder::Draw& firstDraw = batchDraws[batch.firstDraw];
 
 				if (mesh != lastMeshId)
 				{
 					lastMeshId = mesh;
-					draw = meshManager->GetDrawData(mesh);
-					device->BindVertexArray(draw->vertexArrayObject);
+					device->BindVertexArray(firstDraw.vertexArray);
+					stateChangeStats.vertexArrayChanges += 1;
 				}
-				device->DrawIndexed(draw->primitiveMode, draw->count, draw->indexType);
 
-				objectDrawsProcessed += 1;
+				stateChangeStats.drawCalls += 1;
+
+				DrawBatchBuilder::DrawBatch(device, batch, firstDraw, indirectFrameOffset);
+
+				// Skip the other draw commands of the batch
+				commandIdx += batch.drawCount - 1;
 			}
 			else // Render with callback
 			{
@@ -609,31 +1036,26 @@ void Renderer::Render(Scene* scene)
 						params.viewport = &viewport;
 						params.callbackId = callbackId;
 						params.command = command;
-						params.scene = scene;
+						params.scene = graphScene;
 
 						customRenderer->RenderCustom(params);
 
 						// Reset state cache
 						lastVpIdx = MaxViewportCount;
 						lastShaderProgram = 0;
-						draw = nullptr;
 						lastMeshId = MeshId{ 0 };
 						lastMaterialId = MaterialId{ 0 };
-
-						// TODO: manage sampler state more robustly
-						device->BindSampler(0, 0);
+						ResetBoundMaterialTextures();
 					}
 				}
 			}
 		}
 	}
 
-	commandList.Clear();
-
-	renderTargetContainer->ConfirmAllTargetsAreUnused();
+	nextCommandIndex = end;
 }
 
-void Renderer::BindMaterialTextures(const MaterialData& material) const
+void Renderer::BindMaterialTextures(const MaterialData& material)
 {
 	unsigned int usedTextures = 0;
 
@@ -648,6 +1070,15 @@ void Renderer::BindMaterialTextures(const MaterialData& material) const
 			device->SetActiveTextureUnit(usedTextures);
 			device->BindTexture(u.textureTarget, u.textureName);
 			device->SetUniformInt(u.uniformLocation, usedTextures);
+
+			if (usedTextures >= TrackedTextureUnitCount)
+				stateChangeStats.textureChanges += 1;
+			else if (boundMaterialTextures[usedTextures] != u.textureName)
+			{
+				boundMaterialTextures[usedTextures] = u.textureName;
+				stateChangeStats.textureChanges += 1;
+			}
+
 			++usedTextures;
 			break;
 
@@ -657,6 +1088,12 @@ void Renderer::BindMaterialTextures(const MaterialData& material) const
 	}
 }
 
+void Renderer::ResetBoundMaterialTextures()
+{
+	for (unsigned int i = 0; i < TrackedTextureUnitCount; ++i)
+		boundMaterialTextures[i] = 0;
+}
+
 void Renderer::BindTextures(const ShaderData& shader, unsigned int count,
 	const uint32_t* nameHashes, const unsigned int* textures)
 {
@@ -672,19 +1109,9 @@ void Renderer::BindTextures(const ShaderData& shader, unsigned int count,
 	}
 }
 
-void Renderer::RenderCustom(const CustomRenderer::RenderParams& params)
-{
-	if (params.callbackId == deferredLightingCallback)
-		RenderDeferredLighting(params);
-	else if (params.callbackId == postProcessCallback)
-		RenderPostProcess(params);
-}
-
-void Renderer::RenderDeferredLighting(const CustomRenderer::RenderParams& params)
+void Renderer::RenderDeferredLighting()
 {
-	// Both SSAO and deferred lighting passes use these
-
-	Scene* scene = params.scene;
+	Scene* scene = graphScene;
 	ProjectionParameters projParams = scene->GetActiveCamera()->parameters;
 
 	const RendererFramebuffer& lightAccFramebuffer = framebufferData[FramebufferIndexLightAcc];
@@ -697,12 +1124,6 @@ void Renderer::RenderDeferredLighting(const CustomRenderer::RenderParams& params
 
 	device->DepthTestDisable();
 
-	ScreenSpaceAmbientOcclusion::RenderParams ssaoRenderParams;
-	ssaoRenderParams.normalTexture = framebufferTextures[gBufferNormalTextureIndex];
-	ssaoRenderParams.depthTexture = framebufferTextures[fullscreenDepthTextureIndex];
-	ssaoRenderParams.projection = projParams;
-	ssao->Render(ssaoRenderParams);
-
 	// Deferred lighting
 
 	PostProcessRenderPass deferredPass;
@@ -718,7 +1139,7 @@ void Renderer::RenderDeferredLighting(const CustomRenderer::RenderParams& params
 	deferredPass.textureIds[1] = framebufferTextures[gBufferNormalTextureIndex];
 	deferredPass.textureIds[2] = framebufferTextures[gBufferMaterialTextureIndex];
 	deferredPass.textureIds[3] = framebufferTextures[fullscreenDepthTextureIndex];
-	deferredPass.textureIds[4] = ssao->GetResultTextureId();
+	deferredPass.textureIds[4] = renderGraph.GetTexture(graphResources.ambientOcclusion);
 	deferredPass.textureIds[5] = framebufferTextures[shadowDepthTextureIndex];
 
 	deferredPass.samplerIds[0] = 0;
@@ -741,25 +1162,9 @@ void Renderer::RenderDeferredLighting(const CustomRenderer::RenderParams& params
 	deferredPass.enableBlending = false;
 
 	postProcessRenderer->RenderPass(deferredPass);
-
-	ssao->ReleaseResult();
-}
-
-void Renderer::RenderPostProcess(const CustomRenderer::RenderParams& params)
-{
-	RenderBloom(params);
-	RenderTonemapping(params);
-}
-
-void Renderer::RenderBloom(const CustomRenderer::RenderParams& params)
-{
-	unsigned int sourceTexture = framebufferTextures[lightAccumulationTextureIndex];
-	const RendererFramebuffer& fb = framebufferData[FramebufferIndexLightAcc];
-
-	bloomEffect->Render(sourceTexture, fb.framebuffer, Vec2i(fb.width, fb.height));
 }
 
-void Renderer::RenderTonemapping(const CustomRenderer::RenderParams& params)
+void Renderer::RenderTonemapping()
 {
 	device->BlendingDisable();
 	device->DepthTestDisable();
@@ -771,7 +1176,7 @@ void Renderer::RenderTonemapping(const CustomRenderer::RenderParams& params)
 
 	RenderCommandData::BindFramebufferData bindFramebufferCommand;
 	bindFramebufferCommand.target = RenderFramebufferTarget::Framebuffer;
-	bindFramebufferCommand.framebuffer = 0;
+	bindFramebufferCommand.framebuffer = renderGraph.GetFramebuffer(graphResources.backbuffer);
 	device->BindFramebuffer(&bindFramebufferCommand);
 
 	const ShaderData& shader = shaderManager->GetShaderData(tonemappingShaderId);
@@ -786,7 +1191,7 @@ void Renderer::RenderTonemapping(const CustomRenderer::RenderParams& params)
 
 	{
 		uint32_t textureNameHashes[] = { "light_acc_map"_hash };
-		unsigned int textureIds[] = { framebufferTextures[lightAccumulationTextureIndex] };
+		unsigned int textureIds[] = { renderGraph.GetTexture(graphResources.lightAccumulation) };
 		BindTextures(shader, 1, textureNameHashes, textureIds);
 	}
 
@@ -913,7 +1318,7 @@ void Renderer::UpdateLightingDataToUniformBuffer(
 	// Update transforms and split depths for each shadow cascade
 	for (size_t vpIdx = 0; vpIdx < shadowCascadeCount; ++vpIdx)
 	{
-		Mat4x4f viewToLight = viewportData[vpIdx].viewProjection * fsvp.viewToWorld;
+		Mat4x4f viewToLight = viewportData[vpIdx].viewProjection * fsvp.viewToWorld.ToMat4x4();
 		Mat4x4f shadowMat = bias * viewToLight;
 
 		uniformsOut.shadowMatrices[vpIdx] = shadowMat;
@@ -928,83 +1333,132 @@ void Renderer::UpdateLightingDataToUniformBuffer(
 	uniformsOut.shadowBiasClamp = 0.01f;
 }
 
-void Renderer::UpdateUniformBuffers(unsigned int objectDrawCount)
+void Renderer::BuildDrawBatches(unsigned int objectDrawCount)
 {
-	unsigned int buffersRequired = (objectDrawCount + objectsPerUniformBuffer - 1) / objectsPerUniformBuffer;
+	batchDraws.Clear();
+	batchDraws.Reserve(objectDrawCount);
 
-	// Create new object transform uniform buffers if needed
-	if (buffersRequired > objectUniformBuffers.GetCount())
+	uint64_t* itr = commandList.commands.GetData();
+	uint64_t* end = itr + commandList.commands.GetCount();
+	for (; itr != end; ++itr)
 	{
-		unsigned int currentCount = objectUniformBuffers.GetCount();
-		objectUniformBuffers.Resize(buffersRequired);
+		uint64_t command = *itr;
+		unsigned int mat = renderOrder.GetMaterialId(command);
 
-		unsigned int addCount = buffersRequired - currentCount;
-		device->CreateBuffers(addCount, objectUniformBuffers.GetData() + currentCount);
+		if (IsDrawCommand(command) == false || mat == RenderOrderConfiguration::CallbackMaterialId)
+			continue;
 
-		for (unsigned int i = currentCount; i < buffersRequired; ++i)
-		{
-			device->BindBuffer(RenderBufferTarget::UniformBuffer, objectUniformBuffers[i]);
+		unsigned int objIdx = renderOrder.renderObject.GetValue(command);
+		MeshId mesh = data.mesh[objIdx];
+		const MeshDrawData* meshDraw = meshManager->GetDrawData(mesh);
+		const MaterialData& material = materialManager->GetMaterialData(MaterialId{ mat });
+
+		DrawBatchBuilder::Draw draw;
+		draw.viewport = renderOrder.viewportIndex.GetValue(command);
+		draw.pass = renderOrder.viewportPass.GetValue(command);
+		draw.material = mat;
+		draw.mesh = mesh.i;
+		draw.vertexArray = meshDraw->vertexArrayObject;
+		draw.indexCount = meshDraw->count;
+		draw.primitiveMode = meshDraw->primitiveMode;
+		draw.indexType = meshDraw->indexType;
+
+		if (material.indirect)
+			draw.type = DrawBatchType::Indirect;
+		else if (material.instancing)
+			draw.type = DrawBatchType::Instanced;
+		else
+			draw.type = DrawBatchType::Single;
+
+		batchDraws.PushBack(draw);
+	}
 
-			RenderCommandData::SetBufferStorage setStorage{};
-			setStorage.target = RenderBufferTarget::UniformBuffer;
-			setStorage.size = ObjectUniformBufferSize;
-			setStorage.dynamicStorage = true;
-			setStorage.mapWriteAccess = true;
+	DrawBatchBuilder::Params params;
+	params.instancingThreshold = instancingThreshold;
 
-			device->SetBufferStorage(&setStorage);
-		}
+	batchBuilder.Build(params, batchDraws.GetCount(), batchDraws.GetData());
+}
+
+void Renderer::UpdateUniformBuffers()
+{
+	const Array<RenderCommandData::DrawIndexedIndirectCommand>& indirect = batchBuilder.GetIndirectCommands();
+	size_t indirectSize = indirect.GetCount() * sizeof(RenderCommandData::DrawIndexedIndirectCommand);
+
+	// Each object is stored once, no matter how many viewports draw it
+	unsigned int drawCount = batchDraws.GetCount();
+	unsigned int maxModelCount = std::min(drawCount, data.count);
+	size_t alignment = objectBufferAlignment;
+
+	objectIndexSize = drawCount * sizeof(unsigned int);
+	objectModelOffset = (objectIndexSize + alignment - 1) / alignment * alignment;
+
+	// Wait for the regions of this frame to be released by the GPU
+	objectTransformBuffer.BeginFrame(objectModelOffset + maxModelCount * sizeof(Mat4x4f));
+	indirectCommandBuffer.BeginFrame(indirectSize);
+
+	// Upload indirect draw commands
+	if (indirectSize > 0)
+	{
+		std::memcpy(indirectCommandBuffer.GetFrameData(), indirect.GetData(), indirectSize);
+		indirectCommandBuffer.AddBytesWritten(indirectSize);
+	}
+
+	if (objectTransformSlots.GetCount() < data.count)
+	{
+		unsigned int currentCount = objectTransformSlots.GetCount();
+		objectTransformSlots.Resize(data.allocated);
+
+		for (unsigned int i = currentCount; i < data.allocated; ++i)
+			objectTransformSlots[i] = ~0u;
 	}
 
-	int mappedBufferIndex = -1;
-	char* mappedBuffer = nullptr;
-	int objectDrawsProcessed = 0;
+	char* frameData = objectTransformBuffer.GetFrameData();
+	unsigned int* indices = reinterpret_cast<unsigned int*>(frameData);
+	Mat4x4f* models = reinterpret_cast<Mat4x4f*>(frameData + objectModelOffset);
+
+	unsigned int drawIndex = 0;
+	unsigned int modelCount = 0;
 
 	uint64_t* itr = commandList.commands.GetData();
 	uint64_t* end = itr + commandList.commands.GetCount();
 	for (; itr != end; ++itr)
 	{
 		uint64_t command = *itr;
-		unsigned int mat = renderOrder.materialId.GetValue(command);
-		unsigned int vpIdx = renderOrder.viewportIndex.GetValue(command);
-		unsigned int objIdx = renderOrder.renderObject.GetValue(command);
+		unsigned int mat = renderOrder.GetMaterialId(command);
 
 		// Is regular draw command
-		if (IsDrawCommand(command) && mat != RenderOrderConfiguration::CallbackMaterialId)
-		{
-			int bufferIndex = objectDrawsProcessed / objectsPerUniformBuffer;
-			int objectInBuffer = objectDrawsProcessed % objectsPerUniformBuffer;
+		if (IsDrawCommand(command) == false || mat == RenderOrderConfiguration::CallbackMaterialId)
+			continue;
 
-			if (bufferIndex != mappedBufferIndex)
-			{
-				if (mappedBufferIndex >= 0)
-					device->UnmapBuffer(RenderBufferTarget::UniformBuffer);
-
-				device->BindBuffer(RenderBufferTarget::UniformBuffer, objectUniformBuffers[bufferIndex]);
+		unsigned int objIdx = renderOrder.renderObject.GetValue(command);
+		unsigned int slot = objectTransformSlots[objIdx];
 
-				RenderCommandData::MapBufferRange map{};
-				map.target = RenderBufferTarget::UniformBuffer;
-				map.offset = 0;
-				map.length = ObjectUniformBufferSize;
-				map.writeAccess = true;
-				map.invalidateBuffer = true;
+		if (slot == ~0u)
+		{
+			slot = modelCount;
+			modelCount += 1;
 
-				mappedBuffer = static_cast<char*>(device->MapBufferRange(&map));
-				mappedBufferIndex = bufferIndex;
-			}
+			objectTransformSlots[objIdx] = slot;
+			models[slot] = data.transform[objIdx];
+		}
 
-			TransformUniformBlock* tu = reinterpret_cast<TransformUniformBlock*>(mappedBuffer + objectUniformBlockStride * objectInBuffer);
+		indices[drawIndex] = slot;
+		drawIndex += 1;
+	}
 
-			const Mat4x4f& model = data.transform[objIdx];
-			tu->MVP = viewportData[vpIdx].viewProjection * model;
-			tu->MV = viewportData[vpIdx].view * model;
-			tu->M = model;
+	// Reset the slots of the objects that were drawn for the next frame
+	for (itr = commandList.commands.GetData(); itr != end; ++itr)
+	{
+		uint64_t command = *itr;
+		unsigned int mat = renderOrder.GetMaterialId(command);
 
-			objectDrawsProcessed += 1;
-		}
+		if (IsDrawCommand(command) && mat != RenderOrderConfiguration::CallbackMaterialId)
+			objectTransformSlots[renderOrder.renderObject.GetValue(command)] = ~0u;
 	}
 
-	if (mappedBufferIndex >= 0)
-		device->UnmapBuffer(RenderBufferTarget::UniformBuffer);
+	objectModelSize = modelCount * sizeof(Mat4x4f);
+
+	objectTransformBuffer.AddBytesWritten(objectIndexSize + objectModelSize);
 }
 
 bool Renderer::IsDrawCommand(uint64_t orderKey)
@@ -1151,15 +1605,16 @@ float CalculateDepth(const Vec3f& objPos, const Vec3f& eyePos, const Vec3f& eyeF
 
 unsigned int Renderer::PopulateCommandList(Scene* scene)
 {
-	const float mainViewportMinObjectSize = 50.0f;
-	const float shadowViewportMinObjectSize = 30.0f;
+	const float mainViewportMinObjectSize = 7.0f;
+	const float shadowViewportMinObjectSize = 5.5f;
 
 	// Get camera transforms
 
 	Camera* renderCamera = scene->GetActiveCamera();
 	const ProjectionParameters& projectionParams = renderCamera->parameters;
 	SceneObjectId cameraObject = scene->Lookup(renderCamera->GetEntity());
-	Mat4x4f cameraTransform = scene->GetWorldTransform(cameraObject);
+	const Mat3x4f& cameraWorldTransform = scene->GetWorldTransform(cameraObject);
+	Mat4x4f cameraTransform = cameraWorldTransform.ToMat4x4();
 
 	Mat4x4f cullingCameraTransform = lockCullingCamera ? lockCullingCameraTransform : cameraTransform;
 
@@ -1221,8 +1676,9 @@ unsigned int Renderer::PopulateCommandList(Scene* scene)
 				vp.farMinusNear = lightProjections[cascade].far - lightProjections[cascade].near;
 				vp.minusNear = -lightProjections[cascade].near;
 				vp.objectMinScreenSizePx = shadowViewportMinObjectSize;
-				vp.viewToWorld = cascadeViewTransforms[cascade];
-				vp.view = vp.viewToWorld.GetInverse();
+				vp.objectSizeEstimate = RenderViewportSizeEstimate::BoundingSphere;
+				vp.viewToWorld = Mat3x4f(cascadeViewTransforms[cascade]);
+				vp.view = vp.viewToWorld.GetAffineInverse().ToMat4x4();
 				vp.projection = lightProjections[cascade].GetProjectionMatrix(reverseDepth);
 				vp.viewProjection = vp.projection * vp.view;
 				vp.viewportRectangle.size = shadowCascadeSize;
@@ -1259,7 +1715,8 @@ unsigned int Renderer::PopulateCommandList(Scene* scene)
 		vp.farMinusNear = renderCamera->parameters.far - renderCamera->parameters.near;
 		vp.minusNear = -renderCamera->parameters.near;
 		vp.objectMinScreenSizePx = mainViewportMinObjectSize;
-		vp.viewToWorld = cameraTransform;
+		vp.objectSizeEstimate = RenderViewportSizeEstimate::BoundingSphere;
+		vp.viewToWorld = cameraWorldTransform;
 		vp.view = Camera::GetViewMatrix(vp.viewToWorld);
 		vp.projection = projectionParams.GetProjectionMatrix(reverseDepth);
 		vp.viewProjection = vp.projection * vp.view;
@@ -1281,10 +1738,8 @@ unsigned int Renderer::PopulateCommandList(Scene* scene)
 	const FrustumPlanes& fullscreenFrustum = viewportData[viewportIndexFullscreen].frustum;
 
 	RenderPass g_pass = RenderPass::OpaqueGeometry;
-	RenderPass l_pass = RenderPass::OpaqueLighting;
 	RenderPass s_pass = RenderPass::Skybox;
 	RenderPass t_pass = RenderPass::Transparent;
-	RenderPass p_pass = RenderPass::PostProcess;
 
 	using ctrl = RenderControlType;
 
@@ -1406,8 +1861,7 @@ unsigned int Renderer::PopulateCommandList(Scene* scene)
 
 	// PASS: OPAQUE LIGHTING
 
-	// Draw lighting pass
-	commandList.AddDrawWithCallback(fsvp, l_pass, 0.0f, deferredLightingCallback);
+	// Lighting is drawn by the render graph before the commands of the pass
 
 	// PASS: SKYBOX
 
@@ -1433,30 +1887,191 @@ unsigned int Renderer::PopulateCommandList(Scene* scene)
 
 	// PASS: POST PROCESS
 
-	// Draw HDR tonemapping pass
-	commandList.AddDrawWithCallback(fsvp, p_pass, 0.0f, postProcessCallback);
+	// Bloom and tonemapping are drawn by the render graph
 
 	// Create draw commands for render objects in scene
 
 	unsigned int visRequired = BitPack::CalculateRequired(data.count);
-	objectVisibility.Resize(visRequired * viewportCount);
+
+	// Visibility is laid out by allocated object count, so cached results stay
+	// in place until the render objects are reallocated
+	unsigned int visStride = BitPack::CalculateRequired(data.allocated);
+
+	if (visStride != objectVisibilityStride)
+	{
+		objectVisibility.Resize(visStride * MaxViewportCount);
+		objectVisibilityStride = visStride;
+
+		for (unsigned int vpIdx = 0; vpIdx < MaxViewportCount; ++vpIdx)
+			viewportCullState[vpIdx].cachedEpoch = 0;
+	}
 
 	const unsigned int compareTrIdx = static_cast<unsigned int>(TransparencyType::AlphaTest);
 
 	BitPack* vis[MaxViewportCount];
 
 	for (size_t vpIdx = 0, count = viewportCount; vpIdx < count; ++vpIdx)
+		vis[vpIdx] = objectVisibility.GetData() + visStride * vpIdx;
+
+	// Viewports that haven't changed since the last frame only cull the objects
+	// that have moved, unless so many have moved that a full pass is cheaper.
+	// Of the rest, viewports that had few visible objects on the last frame
+	// query the bounding volume tree. The rest scan all objects with the SIMD
+	// kernels, which is faster when most objects are visible.
+	enum class CullMode { Cached, Tree, Linear };
+	CullMode cullMode[MaxViewportCount];
+
+	for (unsigned int vpIdx = 0; vpIdx < viewportCount; ++vpIdx)
+	{
+		UpdateViewportEpoch(vpIdx);
+
+		RendererViewportCullState& state = viewportCullState[vpIdx];
+
+		if (state.cachedEpoch == viewportData[vpIdx].transformEpoch && dirtyObjectCount * 4 < data.count)
+			cullMode[vpIdx] = CullMode::Cached;
+		else if (lastVisibleObjectCount[vpIdx] * 4 < data.count)
+			cullMode[vpIdx] = CullMode::Tree;
+		else
+			cullMode[vpIdx] = CullMode::Linear;
+
+		state.cachedEpoch = viewportData[vpIdx].transformEpoch;
+	}
+
+	// Unused viewports don't see the dirty objects of this frame
+	for (unsigned int vpIdx = viewportCount; vpIdx < MaxViewportCount; ++vpIdx)
+		viewportCullState[vpIdx].cachedEpoch = 0;
+
+	jobSystem->ParallelFor(viewportCount, 1, [&](unsigned int begin, unsigned int end)
+	{
+		for (unsigned int vpIdx = begin; vpIdx < end; ++vpIdx)
+		{
+			if (cullMode[vpIdx] == CullMode::Cached)
+			{
+				const RenderViewport& vp = viewportData[vpIdx];
+				const Vec2i& size = vp.viewportRectangle.size;
+				Vec2f sizePx(static_cast<float>(size.x), static_cast<float>(size.y));
+				bool sphere = vp.objectSizeEstimate == RenderViewportSizeEstimate::BoundingSphere;
+
+				BitPack* visOut = vis[vpIdx];
+				const BitPack* dirty = objectDirty.GetData();
+
+				for (unsigned int packIdx = 0; packIdx < visRequired; ++packIdx)
+				{
+					if (dirty[packIdx].data == 0)
+						continue;
+
+					unsigned int first = packIdx * BitPack::BitsPerPack;
+					unsigned int last = std::min(first + BitPack::BitsPerPack, data.count);
+
+					for (unsigned int objIdx = first; objIdx < last; ++objIdx)
+					{
+						if (((dirty[packIdx].data >> BitPack::CellIndex(objIdx)) & BitPack::ValueMask) == 0)
+							continue;
+
+						BitPack result{ 0 };
+
+						if (sphere)
+							Intersect::FrustumAABBMinSphereSize(vp.frustum, vp.view, vp.projection, sizePx,
+								vp.objectMinScreenSizePx, 1, &data.bounds[objIdx], &result);
+						else
+							Intersect::FrustumAABBMinSize(vp.frustum, vp.viewProjection, sizePx,
+								vp.objectMinScreenSizePx, 1, &data.bounds[objIdx], &result);
+
+						BitPack::Set(visOut, objIdx, result.data != 0);
+					}
+				}
+
+				continue;
+			}
+
+			if (cullMode[vpIdx] != CullMode::Tree)
+				continue;
+
+			const FrustumPlanes& frustum = viewportData[vpIdx].frustum;
+			BitPack* visOut = vis[vpIdx];
+
+			std::memset(visOut, 0, visRequired * sizeof(BitPack));
+
+			boundsTree.QueryFrustum(frustum, [&](unsigned int objIdx, unsigned int planeMask)
+			{
+				// Tree leaves have fattened bounds, so test the actual bounds
+				// unless the leaf was already known to be fully inside
+				const BoundingBox& bounds = data.bounds[objIdx];
+
+				if (planeMask == 0 || AABBTree::TestPlanes(frustum, bounds.center, bounds.extents, planeMask))
+					BitPack::Set(visOut, objIdx, true);
+			});
+		}
+	});
+
+	// Cull each viewport in chunks of objects, so that both viewports and large
+	// object ranges can be processed in parallel. Chunk size must be a multiple
+	// of BitPack::BitsPerPack so that no two jobs write to the same BitPack.
+	const unsigned int objectsPerChunk = 2048;
+	unsigned int chunksPerViewport = (data.count + objectsPerChunk - 1) / objectsPerChunk;
+
+	jobSystem->ParallelFor(viewportCount * chunksPerViewport, 1, [&](unsigned int begin, unsigned int end)
 	{
-		vis[vpIdx] = objectVisibility.GetData() + visRequired * vpIdx;
+		for (unsigned int jobIdx = begin; jobIdx < end; ++jobIdx)
+		{
+			unsigned int vpIdx = jobIdx / chunksPerViewport;
+
+			// Dirty objects of cached viewports have already been culled
+			if (cullMode[vpIdx] == CullMode::Cached)
+				continue;
+
+			unsigned int firstObject = (jobIdx % chunksPerViewport) * objectsPerChunk;
+			unsigned int objectCount = std::min(objectsPerChunk, data.count - firstObject);
+
+			const RenderViewport& vp = viewportData[vpIdx];
+			const Vec2i& size = vp.viewportRectangle.size;
+			Vec2f sizePx(static_cast<float>(size.x), static_cast<float>(size.y));
+			bool sphere = vp.objectSizeEstimate == RenderViewportSizeEstimate::BoundingSphere;
+
+			BitPack* visOut = vis[vpIdx] + firstObject / BitPack::BitsPerPack;
+
+			if (cullMode[vpIdx] == CullMode::Tree)
+			{
+				// Frustum test has been done, only reject small objects
+				const BoundingBox* bounds = data.bounds + firstObject;
+
+				if (sphere)
+					Intersect::RejectSmallAABBSphere(vp.view, vp.projection, sizePx,
+						vp.objectMinScreenSizePx, objectCount, bounds, visOut);
+				else
+					Intersect::RejectSmallAABB(vp.viewProjection, sizePx,
+						vp.objectMinScreenSizePx, objectCount, bounds, visOut);
+			}
+			else
+			{
+				BoundingBoxSoA bounds = data.boundsSoA.Offset(firstObject);
+
+				if (sphere)
+					Intersect::FrustumAABBMinSphereSizeSoA(vp.frustum, vp.view, vp.projection, sizePx,
+						vp.objectMinScreenSizePx, objectCount, bounds, visOut);
+				else
+					Intersect::FrustumAABBMinSizeSoA(vp.frustum, vp.viewProjection, sizePx,
+						vp.objectMinScreenSizePx, objectCount, bounds, visOut);
+			}
+		}
+	});
 
-		const FrustumPlanes& frustum = viewportData[vpIdx].frustum;
-		const Mat4x4f& viewProjection = viewportData[vpIdx].viewProjection;
-		const Vec2i viewPortSize = viewportData[vpIdx].viewportRectangle.size;
-		float minSize = viewportData[vpIdx].objectMinScreenSizePx / (viewPortSize.x * viewPortSize.y);
+	std::memset(objectDirty.GetData(), 0, objectDirty.GetCount() * sizeof(BitPack));
+	dirtyObjectCount = 0;
 
-		Intersect::FrustumAABBMinSize(frustum, viewProjection, minSize, data.count, data.bounds, vis[vpIdx]);
+	if (occlusionCuller->IsEnabled() && occluderCount > 0)
+	{
+		// Occlusion depends on other objects, so keep it out of the cached results
+		occlusionVisibility.Resize(visRequired);
+		std::memcpy(occlusionVisibility.GetData(), vis[fsvp], visRequired * sizeof(BitPack));
+		vis[fsvp] = occlusionVisibility.GetData();
+
+		CullOccludedObjects(viewportData[fsvp], vis[fsvp]);
 	}
 
+	for (unsigned int vpIdx = 0; vpIdx < viewportCount; ++vpIdx)
+		lastVisibleObjectCount[vpIdx] = 0;
+
 	unsigned int objectDrawCount = 0;
 
 	for (unsigned int i = 1; i < data.count; ++i)
@@ -1473,9 +2088,10 @@ unsigned int Renderer::PopulateCommandList(Scene* scene)
 
 				float depth = CalculateDepth(objPos, vp.position, vp.forward, vp.farMinusNear, vp.minusNear);
 
-				commandList.AddDraw(vpIdx, RenderPass::OpaqueGeometry, depth, shadowMaterial, i);
+				commandList.AddDraw(vpIdx, RenderPass::OpaqueGeometry, depth, shadowMaterial, data.mesh[i], i);
 
 				objectDrawCount += 1;
+				lastVisibleObjectCount[vpIdx] += 1;
 			}
 		}
 
@@ -1488,9 +2104,10 @@ unsigned int Renderer::PopulateCommandList(Scene* scene)
 			float depth = CalculateDepth(objPos, vp.position, vp.forward, vp.farMinusNear, vp.minusNear);
 
 			RenderPass pass = static_cast<RenderPass>(o.transparency);
-			commandList.AddDraw(fsvp, pass, depth, o.material, i);
+			commandList.AddDraw(fsvp, pass, depth, o.material, data.mesh[i], i);
 
 			objectDrawCount += 1;
+			lastVisibleObjectCount[fsvp] += 1;
 		}
 	}
 
@@ -1508,11 +2125,88 @@ unsigned int Renderer::PopulateCommandList(Scene* scene)
 		}
 	}
 
+	if (commandList.rejectedDrawCount > 0 && rejectedDrawsReported == false)
+	{
+		Log::Warning("Objects with material IDs that don't fit in the render order key are not drawn");
+		rejectedDrawsReported = true;
+	}
+
 	commandList.Sort();
 
 	return objectDrawCount;
 }
 
+void Renderer::CullOccludedObjects(const RenderViewport& viewport, BitPack* visibility)
+{
+	occlusionCuller->BeginFrame(viewport.viewProjection);
+
+	// Pick the visible occluders with the largest projected size. The size is
+	// estimated as bounding sphere radius divided by distance, compared squared.
+	struct OccluderCandidate
+	{
+		unsigned int object;
+		float score;
+	};
+
+	const unsigned int MaxOccluders = 64;
+	OccluderCandidate selected[MaxOccluders];
+	unsigned int selectedCount = 0;
+	unsigned int budget = std::min(occlusionCuller->GetOccluderBudget(), MaxOccluders);
+	unsigned int candidateCount = 0;
+
+	for (unsigned int i = 1; i < data.count; ++i)
+	{
+		if (data.occluder[i] == false || BitPack::Get(visibility, i) == false)
+			continue;
+
+		candidateCount += 1;
+
+		const BoundingBox& bounds = data.bounds[i];
+		Vec3f toObject = bounds.center - viewport.position;
+		float distanceSq = std::max(Vec3f::Dot(toObject, toObject), 1e-6f);
+		float score = Vec3f::Dot(bounds.extents, bounds.extents) / distanceSq;
+
+		if (selectedCount == budget && (budget == 0 || score <= selected[budget - 1].score))
+			continue;
+
+		// Insert in descending score order
+		unsigned int pos = selectedCount < budget ? selectedCount++ : budget - 1;
+
+		while (pos > 0 && selected[pos - 1].score < score)
+		{
+			selected[pos] = selected[pos - 1];
+			pos -= 1;
+		}
+
+		selected[pos] = OccluderCandidate{ i, score };
+	}
+
+	occlusionCuller->AddOccluderCandidates(candidateCount);
+
+	for (unsigned int i = 0; i < selectedCount; ++i)
+	{
+		unsigned int obj = selected[i].object;
+		const BoundingBox* meshBounds = meshManager->GetBoundingBox(data.mesh[obj]);
+
+		Mat4x4f boxToWorld = data.transform[obj] *
+			Mat4x4f::Translate(meshBounds->center) * Mat4x4f::Scale(meshBounds->extents * 2.0f);
+
+		occlusionCuller->RasterizeOccluder(boxToWorld);
+	}
+
+	occlusionCuller->EndOccluders();
+
+	if (occlusionCuller->GetOccluderCount() == 0)
+		return;
+
+	for (unsigned int i = 1; i < data.count; ++i)
+	{
+		if (data.occluder[i] == false && BitPack::Get(visibility, i) &&
+			occlusionCuller->IsOccluded(data.bounds[i]))
+			BitPack::Set(visibility, i, false);
+	}
+}
+
 void Renderer::ReallocateRenderObjects(unsigned int required)
 {
 	if (required <= data.allocated)
@@ -1525,7 +2219,7 @@ void Renderer::ReallocateRenderObjects(unsigned int required)
 
 	InstanceData newData;
 	unsigned int bytes = required * (sizeof(Entity) + sizeof(MeshId) + sizeof(RenderOrderData) +
-		sizeof(BoundingBox) + sizeof(Mat4x4f));
+		sizeof(BoundingBox) + sizeof(Mat4x4f) + sizeof(float) * 6 + sizeof(unsigned int) + sizeof(bool));
 
 	newData.buffer = this->allocator->Allocate(bytes);
 	newData.count = data.count;
@@ -1536,6 +2230,14 @@ void Renderer::ReallocateRenderObjects(unsigned int required)
 	newData.order = reinterpret_cast<RenderOrderData*>(newData.mesh + required);
 	newData.bounds = reinterpret_cast<BoundingBox*>(newData.order + required);
 	newData.transform = reinterpret_cast<Mat4x4f*>(newData.bounds + required);
+	newData.boundsSoA.centerX = reinterpret_cast<float*>(newData.transform + required);
+	newData.boundsSoA.centerY = newData.boundsSoA.centerX + required;
+	newData.boundsSoA.centerZ = newData.boundsSoA.centerY + required;
+	newData.boundsSoA.extentX = newData.boundsSoA.centerZ + required;
+	newData.boundsSoA.extentY = newData.boundsSoA.extentX + required;
+	newData.boundsSoA.extentZ = newData.boundsSoA.extentY + required;
+	newData.treeProxy = reinterpret_cast<unsigned int*>(newData.boundsSoA.extentZ + required);
+	newData.occluder = reinterpret_cast<bool*>(newData.treeProxy + required);
 
 	if (data.buffer != nullptr)
 	{
@@ -1544,11 +2246,83 @@ void Renderer::ReallocateRenderObjects(unsigned int required)
 		std::memcpy(newData.order, data.order, data.count * sizeof(RenderOrderData));
 		std::memcpy(newData.bounds, data.bounds, data.count * sizeof(BoundingBox));
 		std::memcpy(newData.transform, data.transform, data.count * sizeof(Mat4x4f));
+		std::memcpy(newData.boundsSoA.centerX, data.boundsSoA.centerX, data.count * sizeof(float));
+		std::memcpy(newData.boundsSoA.centerY, data.boundsSoA.centerY, data.count * sizeof(float));
+		std::memcpy(newData.boundsSoA.centerZ, data.boundsSoA.centerZ, data.count * sizeof(float));
+		std::memcpy(newData.boundsSoA.extentX, data.boundsSoA.extentX, data.count * sizeof(float));
+		std::memcpy(newData.boundsSoA.extentY, data.boundsSoA.extentY, data.count * sizeof(float));
+		std::memcpy(newData.boundsSoA.extentZ, data.boundsSoA.extentZ, data.count * sizeof(float));
+		std::memcpy(newData.treeProxy, data.treeProxy, data.count * sizeof(unsigned int));
+		std::memcpy(newData.occluder, data.occluder, data.count * sizeof(bool));
 
 		this->allocator->Deallocate(data.buffer);
 	}
 
 	data = newData;
+
+	unsigned int dirtyCount = objectDirty.GetCount();
+	objectDirty.Resize(BitPack::CalculateRequired(required));
+	std::memset(objectDirty.GetData() + dirtyCount, 0, (objectDirty.GetCount() - dirtyCount) * sizeof(BitPack));
+}
+
+void Renderer::SetObjectBounds(unsigned int index, const BoundingBox& bounds)
+{
+	data.bounds[index] = bounds;
+	data.boundsSoA.Set(index, bounds);
+
+	if (data.treeProxy[index] == AABBTree::Null)
+		data.treeProxy[index] = boundsTree.CreateProxy(bounds, index);
+	else
+		boundsTree.MoveProxy(data.treeProxy[index], bounds);
+
+	SetObjectDirty(index);
+}
+
+void Renderer::SetOccluder(RenderObjectId id, bool occluder)
+{
+	if (data.occluder[id.i] != occluder)
+	{
+		data.occluder[id.i] = occluder;
+
+		if (occluder)
+			occluderCount += 1;
+		else
+			occluderCount -= 1;
+	}
+}
+
+void Renderer::SetObjectDirty(unsigned int index)
+{
+	BitPack& pack = objectDirty[BitPack::PackIndex(index)];
+	unsigned int cell = BitPack::CellIndex(index);
+
+	if (pack.Get(cell) == false)
+	{
+		pack.Set(cell, true);
+		dirtyObjectCount += 1;
+	}
+}
+
+void Renderer::UpdateViewportEpoch(unsigned int viewportIndex)
+{
+	RenderViewport& vp = viewportData[viewportIndex];
+
+	RendererViewportCullState current;
+	current.view = vp.view;
+	current.projection = vp.projection;
+	current.frustum = vp.frustum;
+	current.size = vp.viewportRectangle.size;
+	current.objectMinScreenSizePx = vp.objectMinScreenSizePx;
+	current.objectSizeEstimate = vp.objectSizeEstimate;
+
+	RendererViewportCullState& last = viewportCullState[viewportIndex];
+	current.cachedEpoch = last.cachedEpoch;
+
+	if ((current == last) == false)
+	{
+		vp.transformEpoch += 1;
+		last = current;
+	}
 }
 
 RenderObjectId Renderer::AddRenderObject(Entity entity)
@@ -1573,6 +2347,11 @@ void Renderer::AddRenderObject(unsigned int count, const Entity* entities, Rende
 		mapPair->second.i = id;
 
 		data.entity[id] = e;
+		data.treeProxy[id] = AABBTree::Null;
+		data.occluder[id] = false;
+
+		// New objects have no cached visibility
+		SetObjectDirty(id);
 
 		renderObjectIdsOut[i].i = id;
 	}
@@ -1608,25 +2387,20 @@ void Renderer::RemoveCustomRenderer(unsigned int callbackId)
 	}
 }
 
-void Renderer::NotifyUpdatedTransforms(unsigned int count, const Entity* entities, const Mat4x4f* transforms)
+void Renderer::NotifyUpdatedTransforms(unsigned int count, const unsigned int* componentIndices,
+	const Mat4x4f* transforms)
 {
-	for (unsigned int entityIdx = 0; entityIdx < count; ++entityIdx)
+	for (unsigned int updateIdx = 0; updateIdx < count; ++updateIdx)
 	{
-		Entity entity = entities[entityIdx];
-		RenderObjectId obj = this->Lookup(entity);
-
-		if (obj.IsNull() == false)
-		{
-			unsigned int dataIdx = obj.i;
+		unsigned int dataIdx = componentIndices[updateIdx];
 
-			// Recalculate bounding box
-			MeshId meshId = data.mesh[dataIdx];
-			BoundingBox* bounds = meshManager->GetBoundingBox(meshId);
-			data.bounds[dataIdx] = bounds->Transform(transforms[entityIdx]);
+		// Recalculate bounding box
+		MeshId meshId = data.mesh[dataIdx];
+		BoundingBox* bounds = meshManager->GetBoundingBox(meshId);
+		SetObjectBounds(dataIdx, bounds->Transform(transforms[updateIdx]));
 
-			// Set world transform
-			data.transform[dataIdx] = transforms[entityIdx];
-		}
+		// Set world transform
+		data.transform[dataIdx] = transforms[updateIdx];
 	}
 }
 
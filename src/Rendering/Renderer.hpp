@@ -1,11 +1,13 @@
 #pragma once
 
+#include "Core/AABBTree.hpp"
 #include "Core/Array.hpp"
 #include "Core/BitPack.hpp"
 #include "Core/HashMap.hpp"
 
 #include "Entity/Entity.hpp"
 
+#include "Math/BoundingBox.hpp"
 #include "Math/Mat4x4.hpp"
 #include "Math/Vec3.hpp"
 #include "Math/Vec2.hpp"
@@ -15,14 +17,18 @@
 #include "Resources/ShaderId.hpp"
 
 #include "Rendering/CustomRenderer.hpp"
+#include "Rendering/DrawBatchBuilder.hpp"
 #include "Rendering/Light.hpp"
+#include "Rendering/PersistentRingBuffer.hpp"
 #include "Rendering/RenderCommandList.hpp"
 #include "Rendering/RendererData.hpp"
+#include "Rendering/RenderGraph.hpp"
 #include "Rendering/RenderOrder.hpp"
 
 #include "Scene/ITransformUpdateReceiver.hpp"
 
 class Allocator;
+class JobSystem;
 class Camera;
 class LightManager;
 class ShaderManager;
@@ -31,16 +37,16 @@ class MaterialManager;
 class EntityManager;
 class RenderDevice;
 class Scene;
-class Window;
 class DebugVectorRenderer;
 class CustomRenderer;
 class ScreenSpaceAmbientOcclusion;
 class BloomEffect;
+class OcclusionCuller;
 class PostProcessRenderer;
 class RenderTargetContainer;
 
-struct BoundingBox;
 struct RendererFramebuffer;
+struct RendererViewportCullState;
 struct RenderViewport;
 struct MaterialData;
 struct ShaderData;
@@ -48,8 +54,19 @@ struct ProjectionParameters;
 struct LightingUniformBlock;
 struct PostProcessRenderPass;
 
-class Renderer : public ITransformUpdateReceiver, public CustomRenderer
+class Renderer : public ITransformUpdateReceiver
 {
+public:
+	// Changes of the state that object draws depend on, counted per frame
+	struct StateChangeStats
+	{
+		unsigned int shaderProgramChanges;
+		unsigned int materialChanges;
+		unsigned int vertexArrayChanges;
+		unsigned int textureChanges;
+		unsigned int drawCalls;
+	};
+
 private:
 
 	static const unsigned int MaxViewportCount = 8;
@@ -60,15 +77,17 @@ private:
 	static const unsigned int FramebufferIndexShadow = 1;
 	static const unsigned int FramebufferIndexLightAcc = 2;
 
-	static const unsigned int ObjectUniformBufferSize = 512 * 1024;
+	static const unsigned int ObjectBufferFramesInFlight = 3;
 
 	Allocator* allocator;
+	JobSystem* jobSystem;
 	RenderDevice* device;
 	RenderTargetContainer* renderTargetContainer;
 	PostProcessRenderer* postProcessRenderer;
 
 	ScreenSpaceAmbientOcclusion* ssao;
 	BloomEffect* bloomEffect;
+	OcclusionCuller* occlusionCuller;
 
 	RendererFramebuffer* framebufferData;
 	unsigned int framebufferCount;
@@ -77,6 +96,7 @@ private:
 	unsigned int framebufferTextureCount;
 
 	RenderViewport* viewportData;
+	RendererViewportCullState* viewportCullState;
 	unsigned int viewportCount;
 	unsigned int viewportIndexFullscreen;
 
@@ -94,13 +114,67 @@ private:
 	unsigned int shadowDepthTextureIndex;
 	unsigned int lightAccumulationTextureIndex;
 
-	Array<unsigned int> objectUniformBuffers;
+	// Object transforms, one region per frame in flight. A region holds an
+	// index for each object draw, followed by the model matrix of each object
+	// drawn in the frame.
+	PersistentRingBuffer objectTransformBuffer;
+
+	unsigned int objectBufferAlignment;
+
+	// Layout of the current frame's region of objectTransformBuffer
+	size_t objectIndexSize;
+	size_t objectModelOffset;
+	size_t objectModelSize;
+
+	// Slot of each render object in this frame's model matrices, or ~0u
+	Array<unsigned int> objectTransformSlots;
 
-	size_t objectUniformBlockStride;
-	unsigned int objectsPerUniformBuffer;
+	// Object draws of the sorted command list, grouped into draw calls
+	Array<DrawBatchBuilder::Draw> batchDraws;
+	DrawBatchBuilder batchBuilder;
 
-	unsigned int deferredLightingCallback;
-	unsigned int postProcessCallback;
+	PersistentRingBuffer indirectCommandBuffer;
+
+	// Minimum number of consecutive draws of the same mesh and material that
+	// are combined into an instanced draw
+	unsigned int instancingThreshold;
+
+	// Passes of the frame, rebuilt every frame
+	RenderGraph renderGraph;
+
+	enum
+	{
+		GraphPass_Shadows,
+		GraphPass_Geometry,
+		GraphPass_Lighting,
+		GraphPass_Forward,
+		GraphPass_Tonemapping
+	};
+
+	struct GraphResources
+	{
+		RenderGraphResourceId shadowDepth;
+		RenderGraphResourceId gBufferAlbedo;
+		RenderGraphResourceId gBufferNormal;
+		RenderGraphResourceId gBufferMaterial;
+		RenderGraphResourceId depth;
+		RenderGraphResourceId ambientOcclusion;
+		RenderGraphResourceId lightAccumulation;
+		RenderGraphResourceId backbuffer;
+		RenderGraphResourceId objectTransforms;
+	}
+	graphResources;
+
+	// Render targets acquired for the transient textures of the graph
+	Array<unsigned int> graphRenderTargets;
+
+	// Scene being rendered by the graph passes
+	Scene* graphScene;
+
+	// Position of the graph passes in the sorted command list. Passes are
+	// executed in order, so draw batches are found from the previous pass.
+	unsigned int nextCommandIndex;
+	unsigned int nextBatchIndex;
 
 	struct InstanceData
 	{
@@ -113,12 +187,21 @@ private:
 		RenderOrderData* order;
 		BoundingBox* bounds;
 		Mat4x4f* transform;
+
+		// Mirror of bounds for the SIMD culling kernels
+		BoundingBoxSoA boundsSoA;
+
+		// Leaf in boundsTree, AABBTree::Null until bounds have been set
+		unsigned int* treeProxy;
+
+		// Object's mesh fills its bounding box and can hide other objects
+		bool* occluder;
 	}
 	data;
 
 	HashMap<unsigned int, RenderObjectId> entityMap;
 
-	RenderOrderConfiguration renderOrder;
+	AABBTree boundsTree;
 
 	LightManager* lightManager;
 	ShaderManager* shaderManager;
@@ -129,7 +212,38 @@ private:
 	Mat4x4f lockCullingCameraTransform;
 
 	RenderCommandList commandList;
+
+	// Sort key layout of commandList
+	const RenderOrderConfiguration& renderOrder;
+
+	// Set after the first warning about draws the command list rejected
+	bool rejectedDrawsReported;
+
+	StateChangeStats stateChangeStats;
+
+	// Texture bound to each unit by material draws, used to count texture changes
+	static const unsigned int TrackedTextureUnitCount = 16;
+	unsigned int boundMaterialTextures[TrackedTextureUnitCount];
+
+	// Visibility results per viewport, kept between frames. A viewport's
+	// results are reused while its transformEpoch stays the same, and only
+	// objects set in objectDirty are culled again.
 	Array<BitPack> objectVisibility;
+	unsigned int objectVisibilityStride;
+
+	// Objects whose bounds have changed since the last frame
+	Array<BitPack> objectDirty;
+	unsigned int dirtyObjectCount;
+
+	// Main viewport visibility after occlusion culling
+	Array<BitPack> occlusionVisibility;
+
+	// Number of objects marked with SetOccluder, occlusion culling is skipped when zero
+	unsigned int occluderCount;
+
+	// Number of objects each viewport had draw commands for on the last frame,
+	// used to choose between a tree query and a linear scan when culling
+	unsigned int lastVisibleObjectCount[MaxViewportCount];
 
 	Array<LightId> lightResultArray;
 
@@ -138,8 +252,14 @@ private:
 	Entity skyboxEntity;
 
 	void ReallocateRenderObjects(unsigned int required);
+	void SetObjectBounds(unsigned int index, const BoundingBox& bounds);
+	void SetObjectDirty(unsigned int index);
+
+	// Advance the viewport's transformEpoch if its culling parameters changed
+	void UpdateViewportEpoch(unsigned int viewportIndex);
 
-	void BindMaterialTextures(const MaterialData& material) const;
+	void BindMaterialTextures(const MaterialData& material);
+	void ResetBoundMaterialTextures();
 	void BindTextures(const ShaderData& shader, unsigned int count,
 		const uint32_t* nameHashes, const unsigned int* textures);
 
@@ -149,34 +269,84 @@ private:
 	// Returns the number of object draw commands added
 	unsigned int PopulateCommandList(Scene* scene);
 
-	void UpdateUniformBuffers(unsigned int objectDrawCount);
+	// Clear the visibility of objects hidden behind occluders in a viewport
+	void CullOccludedObjects(const RenderViewport& viewport, BitPack* visibility);
+
+	// Group the object draws of the sorted command list into draw calls
+	void BuildDrawBatches(unsigned int objectDrawCount);
+
+	void UpdateUniformBuffers();
 
 	bool IsDrawCommand(uint64_t orderKey);
 	bool ParseControlCommand(uint64_t orderKey);
 
-	void RenderDeferredLighting(const CustomRenderer::RenderParams& params);
-	void RenderPostProcess(const CustomRenderer::RenderParams& params);
-	void RenderBloom(const CustomRenderer::RenderParams& params);
-	void RenderTonemapping(const CustomRenderer::RenderParams& params);
+	// Declare the passes of the deferred pipeline
+	// Create the textures of the framebuffers that match the frame size
+	void CreateFrameSizedTextures(const Vec2i& frameSize);
+
+	void BuildRenderGraph();
+	void ExecuteRenderGraph();
+	void IssueGraphBarriers(const RenderGraph::CompiledPass& pass);
+
+	static void ExecuteGraphPass(void* userData, unsigned int graphPass);
+	void RenderGraphPass(unsigned int graphPass);
+
+	// Index of the first command of the viewport's pass in the sorted command list
+	unsigned int FindCommandIndex(unsigned int viewport, RenderPass pass) const;
+
+	// Execute the sorted commands in the range [begin, end)
+	void RenderCommands(unsigned int begin, unsigned int end);
+
+	void RenderDeferredLighting();
+	void RenderTonemapping();
 
 	void DebugRender(DebugVectorRenderer* vectorRenderer);
 	
 public:
-	Renderer(Allocator* allocator, RenderDevice* renderDevice,
+	Renderer(Allocator* allocator, JobSystem* jobSystem, RenderDevice* renderDevice,
 		LightManager* lightManager, ShaderManager* shaderManager,
 		MeshManager* meshManager, MaterialManager* materialManager);
 	~Renderer();
 
-	void Initialize(Window* window, EntityManager* entityManager);
+	void Initialize(const Vec2i& frameSize, EntityManager* entityManager);
 	void Deinitialize();
 
+	/**
+	 * Resize the framebuffers that match the frame size, e.g. after the window
+	 * has been resized. Does nothing if the size hasn't changed.
+	 */
+	void SetFrameSize(const Vec2i& frameSize);
+
 	void SetLockCullingCamera(bool lockEnable) { lockCullingCamera = lockEnable; }
 	const Mat4x4f& GetCullingCameraTransform() { return lockCullingCameraTransform; }
 
 	// Render the specified scene to the active OpenGL context
 	void Render(Scene* scene);
 
-	virtual void NotifyUpdatedTransforms(unsigned int count, const Entity* entities, const Mat4x4f* transforms);
+	/**
+	 * Set whether the draws of a pass are sorted by depth or by material and
+	 * mesh first. Transparent passes are always sorted by depth.
+	 */
+	void SetSortOrder(RenderPass pass, RenderOrderSort sort) { commandList.renderOrder.SetSortOrder(pass, sort); }
+	RenderOrderSort GetSortOrder(RenderPass pass) const { return commandList.renderOrder.GetSortOrder(pass); }
+
+	// State changes of the object draws of the last frame
+	const StateChangeStats& GetStateChangeStats() const { return stateChangeStats; }
+
+	const PersistentRingBuffer::Stats& GetTransformBufferStats() const
+	{
+		return objectTransformBuffer.GetStats();
+	}
+
+	const PersistentRingBuffer::Stats& GetIndirectBufferStats() const
+	{
+		return indirectCommandBuffer.GetStats();
+	}
+
+	RenderTargetContainer* GetRenderTargetContainer() { return renderTargetContainer; }
+
+	virtual void NotifyUpdatedTransforms(unsigned int count, const unsigned int* componentIndices,
+		const Mat4x4f* transforms);
 
 	// Render object management
 
@@ -199,7 +369,24 @@ public:
 		data.order[id.i] = order;
 	}
 
-	virtual void RenderCustom(const CustomRenderer::RenderParams& params) override final;
+	/**
+	 * Mark an object as an occluder for CPU occlusion culling. No object is
+	 * an occluder by default, and the occlusion culler must also be enabled.
+	 * Occluders are rasterized as their mesh's bounding box, so only objects
+	 * that are solid and fill their bounds, such as walls and buildings,
+	 * should be marked. Concave or hollow meshes, like arches and rooms,
+	 * would hide objects that are actually visible through them.
+	 */
+	void SetOccluder(RenderObjectId id, bool occluder);
+
+	OcclusionCuller* GetOcclusionCuller() { return occlusionCuller; }
+
+	/**
+	 * Set the minimum number of consecutive draws of the same mesh and
+	 * material that are combined into an instanced draw. Only materials whose
+	 * shader enables instancing are instanced.
+	 */
+	void SetInstancingThreshold(unsigned int threshold) { instancingThreshold = threshold; }
 
 	// Custom renderer management
 	unsigned int AddCustomRenderer(CustomRenderer* customRenderer);
@@ -8,7 +8,6 @@
 #include "Rendering/PostProcessRenderer.hpp"
 #include "Rendering/PostProcessRenderPass.hpp"
 #include "Rendering/RenderDevice.hpp"
-#include "Rendering/RenderTargetContainer.hpp"
 #include "Rendering/RenderViewport.hpp"
 
 #include "Resources/ShaderManager.hpp"
@@ -22,10 +21,12 @@ ScreenSpaceAmbientOcclusion::ScreenSpaceAmbientOcclusion(
 	renderDevice(renderDevice),
 	shaderManager(shaderManager),
 	postProcessRenderer(postProcessRenderer),
+	renderGraph(nullptr),
+	renderParams{},
+	occlusionTexture{ 0 },
+	resultTexture{ 0 },
 	kernel(allocator)
 {
-	resultRenderTargetId = 0;
-	resultTextureId = 0;
 
 	kernelSize = 16;
 
@@ -127,31 +128,54 @@ void ScreenSpaceAmbientOcclusion::Deinitialize()
 	}
 }
 
-void ScreenSpaceAmbientOcclusion::Render(const RenderParams& params)
+RenderGraphResourceId ScreenSpaceAmbientOcclusion::AddPasses(RenderGraph* graph, const RenderParams& params)
 {
-	// Update uniforms
+	renderGraph = graph;
+	renderParams = params;
+
+	RenderGraph::TextureDesc desc{ framebufferSize, RenderTextureSizedFormat::R8 };
+	occlusionTexture = graph->CreateTexture("SSAO occlusion", desc);
+	resultTexture = graph->CreateTexture("SSAO result", desc);
+
+	RenderGraphPassId occlusionPass = graph->AddPass("SSAO occlusion", ExecutePass, this, PassIdx_Occlusion);
+	graph->AddAccess(occlusionPass, params.normalTexture, RenderGraphAccess::ShaderRead);
+	graph->AddAccess(occlusionPass, params.depthTexture, RenderGraphAccess::ShaderRead);
+	graph->AddAccess(occlusionPass, occlusionTexture, RenderGraphAccess::RenderTargetWrite);
+
+	RenderGraphPassId blurPass = graph->AddPass("SSAO blur", ExecutePass, this, PassIdx_Blur);
+	graph->AddAccess(blurPass, occlusionTexture, RenderGraphAccess::ShaderRead);
+	graph->AddAccess(blurPass, resultTexture, RenderGraphAccess::RenderTargetWrite);
+
+	return resultTexture;
+}
 
-	UpdateUniformBuffers(params.projection);
+void ScreenSpaceAmbientOcclusion::ExecutePass(void* userData, unsigned int passIndex)
+{
+	ScreenSpaceAmbientOcclusion* ssao = static_cast<ScreenSpaceAmbientOcclusion*>(userData);
 
-	// Get render targets
+	if (passIndex == PassIdx_Occlusion)
+		ssao->RenderOcclusion();
+	else
+		ssao->RenderBlur();
+}
 
-	RenderTargetContainer* renderTargetContainer = postProcessRenderer->GetRenderTargetContainer();
+void ScreenSpaceAmbientOcclusion::RenderOcclusion()
+{
+	// Update uniforms
 
-	RenderTextureSizedFormat format = RenderTextureSizedFormat::R8;
-	RenderTarget occlusionTarget = renderTargetContainer->AcquireRenderTarget(framebufferSize, format);
-	RenderTarget blurTarget = renderTargetContainer->AcquireRenderTarget(framebufferSize, format);
+	UpdateUniformBuffers(renderParams.projection);
 
-	PostProcessRenderPass renderPasses[PassCount];
+	renderDevice->DepthTestDisable();
 
 	// SSAO occlusion pass
 
-	PostProcessRenderPass& occlusionPass = renderPasses[PassIdx_Occlusion];
+	PostProcessRenderPass occlusionPass;
 
 	occlusionPass.textureNameHashes[0] = "g_normal"_hash;
 	occlusionPass.textureNameHashes[1] = "g_depth"_hash;
 	occlusionPass.textureNameHashes[2] = "noise_texture"_hash;
-	occlusionPass.textureIds[0] = params.normalTexture;
-	occlusionPass.textureIds[1] = params.depthTexture;
+	occlusionPass.textureIds[0] = renderGraph->GetTexture(renderParams.normalTexture);
+	occlusionPass.textureIds[1] = renderGraph->GetTexture(renderParams.depthTexture);
 	occlusionPass.textureIds[2] = noiseTextureId;
 	occlusionPass.samplerIds[0] = 0;
 	occlusionPass.samplerIds[1] = 0;
@@ -163,17 +187,24 @@ void ScreenSpaceAmbientOcclusion::Render(const RenderParams& params)
 	occlusionPass.uniformBufferRangeStart = 0;
 	occlusionPass.uniformBufferRangeSize = sizeof(OcclusionUniformBlock);
 
-	occlusionPass.framebufferId = occlusionTarget.framebuffer;
+	occlusionPass.framebufferId = renderGraph->GetFramebuffer(occlusionTexture);
 	occlusionPass.viewportSize = framebufferSize;
 	occlusionPass.shaderId = shaderIds[PassIdx_Occlusion];
 	occlusionPass.enableBlending = false;
 
+	postProcessRenderer->RenderPass(occlusionPass);
+}
+
+void ScreenSpaceAmbientOcclusion::RenderBlur()
+{
+	renderDevice->DepthTestDisable();
+
 	// SSAO blur pass
 
-	PostProcessRenderPass& blurPass = renderPasses[PassIdx_Blur];
+	PostProcessRenderPass blurPass;
 
 	blurPass.textureNameHashes[0] = "occlusion_map"_hash;
-	blurPass.textureIds[0] = occlusionTarget.colorTexture;
+	blurPass.textureIds[0] = renderGraph->GetTexture(occlusionTexture);
 	blurPass.samplerIds[0] = 0;
 	blurPass.textureCount = 1;
 
@@ -182,31 +213,12 @@ void ScreenSpaceAmbientOcclusion::Render(const RenderParams& params)
 	blurPass.uniformBufferRangeStart = 0;
 	blurPass.uniformBufferRangeSize = sizeof(OcclusionUniformBlock);
 
-	blurPass.framebufferId = blurTarget.framebuffer;
+	blurPass.framebufferId = renderGraph->GetFramebuffer(resultTexture);
 	blurPass.viewportSize = framebufferSize;
 	blurPass.shaderId = shaderIds[PassIdx_Blur];
 	blurPass.enableBlending = false;
 
-	postProcessRenderer->RenderPasses(PassCount, renderPasses);
-
-	renderTargetContainer->ReleaseRenderTarget(occlusionTarget.id);
-
-	resultRenderTargetId = blurTarget.id;
-	resultTextureId = blurTarget.colorTexture;
-}
-
-unsigned int ScreenSpaceAmbientOcclusion::GetResultTextureId()
-{
-	return resultTextureId;
-}
-
-void ScreenSpaceAmbientOcclusion::ReleaseResult()
-{
-	RenderTargetContainer* renderTargetContainer = postProcessRenderer->GetRenderTargetContainer();
-	renderTargetContainer->ReleaseRenderTarget(resultRenderTargetId);
-
-	resultRenderTargetId = 0;
-	resultTextureId = 0;
+	postProcessRenderer->RenderPass(blurPass);
 }
 
 void ScreenSpaceAmbientOcclusion::UpdateUniformBuffers(const ProjectionParameters& projection) const
@@ -8,6 +8,7 @@
 #include "Math/Mat4x4.hpp"
 #include "Math/Projection.hpp"
 
+#include "Rendering/RenderGraph.hpp"
 #include "Rendering/StaticUniformBuffer.hpp"
 
 #include "Resources/ShaderId.hpp"
@@ -17,15 +18,13 @@ class RenderDevice;
 class ShaderManager;
 class PostProcessRenderer;
 
-struct RenderTarget;
-
 class ScreenSpaceAmbientOcclusion
 {
 public:
 	struct RenderParams
 	{
-		unsigned int normalTexture;
-		unsigned int depthTexture;
+		RenderGraphResourceId normalTexture;
+		RenderGraphResourceId depthTexture;
 		ProjectionParameters projection;
 	};
 
@@ -54,8 +53,11 @@ private:
 	ShaderManager* shaderManager;
 	PostProcessRenderer* postProcessRenderer;
 
-	unsigned int resultRenderTargetId;
-	unsigned int resultTextureId;
+	// Graph the passes were last added to, and its resources
+	const RenderGraph* renderGraph;
+	RenderParams renderParams;
+	RenderGraphResourceId occlusionTexture;
+	RenderGraphResourceId resultTexture;
 
 	Array<Vec3f> kernel;
 
@@ -76,6 +78,10 @@ private:
 
 	void UpdateUniformBuffers(const ProjectionParameters& projection) const;
 
+	static void ExecutePass(void* userData, unsigned int passIndex);
+	void RenderOcclusion();
+	void RenderBlur();
+
 public:
 	ScreenSpaceAmbientOcclusion(
 		Allocator* allocator,
@@ -88,8 +94,12 @@ public:
 	void Initialize(Vec2i framebufferResolution);
 	void Deinitialize();
 
-	void Render(const RenderParams& params);
+	void SetFramebufferSize(Vec2i size) { framebufferSize = size; }
 
-	unsigned int GetResultTextureId();
-	void ReleaseResult();
+	/**
+	 * Add the occlusion and blur passes to <graph>. The passes are executed
+	 * with the graph, which has to stay alive until then.
+	 * Returns the blurred occlusion texture.
+	 */
+	RenderGraphResourceId AddPasses(RenderGraph* graph, const RenderParams& params);
 };
@@ -29,6 +29,7 @@ namespace UniformBlockBinding
 	static constexpr unsigned int Viewport = 1;
 	static constexpr unsigned int Material = 2;
 	static constexpr unsigned int Object = 3;
+	static constexpr unsigned int ObjectIndex = 4;
 };
 
 struct LightingUniformBlock
@@ -0,0 +1,188 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "Core/Buffer.hpp"
+
+#include "Debug/PerformanceTimer.hpp"
+
+#include "Memory/Memory.hpp"
+
+#include "Rendering/RenderCaptureFile.hpp"
+#include "Rendering/RenderCaptureReplayer.hpp"
+#include "Rendering/RenderDeviceOpenGL.hpp"
+#include "Rendering/RenderDeviceRecorder.hpp"
+#include "Rendering/RenderDeviceStateFilter.hpp"
+
+#include "System/Window.hpp"
+
+struct ReplayOptions
+{
+	const char* capturePath;
+	unsigned int loopCount;
+
+	// Replay on RenderDeviceRecorder instead of OpenGL
+	bool nullDevice;
+
+	// Replay through RenderDeviceStateFilter
+	bool filterState;
+};
+
+static void PrintUsage()
+{
+	std::printf("Usage: kokko_replay <capture file> [-loops <count>] [-null] [-filter]\n"
+		"  -loops <count>  Number of times to replay the captured frame, default 100\n"
+		"  -null           Replay on a null device instead of OpenGL\n"
+		"  -filter         Drop redundant state changes like the engine does\n");
+}
+
+static bool ParseOptions(int argc, char** argv, ReplayOptions& optionsOut)
+{
+	optionsOut.capturePath = nullptr;
+	optionsOut.loopCount = 100;
+	optionsOut.nullDevice = false;
+	optionsOut.filterState = false;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		if (std::strcmp(argv[i], "-loops") == 0 && i + 1 < argc)
+			optionsOut.loopCount = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
+		else if (std::strcmp(argv[i], "-null") == 0)
+			optionsOut.nullDevice = true;
+		else if (std::strcmp(argv[i], "-filter") == 0)
+			optionsOut.filterState = true;
+		else if (argv[i][0] != '-' && optionsOut.capturePath == nullptr)
+			optionsOut.capturePath = argv[i];
+		else
+			return false;
+	}
+
+	return optionsOut.capturePath != nullptr && optionsOut.loopCount > 0;
+}
+
+static void PrintStats(const RenderCaptureReplayer& replayer, unsigned int loopCount, double frameMilliseconds)
+{
+	using Category = RenderCaptureReplayer::Category;
+
+	std::printf("%-10s %12s %14s %12s\n", "Category", "Calls/frame", "Time/frame ms", "ns/call");
+
+	uint64_t totalNanoseconds = 0;
+
+	for (size_t i = 0; i < static_cast<size_t>(Category::Count); ++i)
+	{
+		Category category = static_cast<Category>(i);
+		const RenderCaptureReplayer::CategoryStats& stats = replayer.GetCategoryStats(category);
+
+		if (stats.callCount == 0)
+			continue;
+
+		totalNanoseconds += stats.nanoseconds;
+
+		std::printf("%-10s %12u %14.4f %12.1f\n", RenderCaptureReplayer::GetCategoryName(category),
+			stats.callCount / loopCount, stats.nanoseconds / (loopCount * 1000000.0),
+			stats.nanoseconds / static_cast<double>(stats.callCount));
+	}
+
+	std::printf("Submission time per frame: %.4f ms\n", totalNanoseconds / (loopCount * 1000000.0));
+	std::printf("Replay time per frame: %.4f ms\n", frameMilliseconds);
+}
+
+static int Replay(Allocator* allocator, const ReplayOptions& options)
+{
+	Buffer<unsigned char> file(allocator);
+	size_t streamOffset = 0;
+	RenderCaptureFile::Header header;
+
+	if (RenderCaptureFile::Read(options.capturePath, file, streamOffset, header) == false)
+	{
+		std::printf("Reading capture %s failed\n", options.capturePath);
+		return -1;
+	}
+
+	const uint8_t* stream = file.Data() + streamOffset;
+	size_t frameStart = static_cast<size_t>(header.frameStart);
+	size_t frameSize = static_cast<size_t>(header.streamSize) - frameStart;
+
+	// OpenGL needs a context, which needs a window
+	Window* window = nullptr;
+	RenderDevice* device = nullptr;
+
+	if (options.nullDevice)
+		device = allocator->MakeNew<RenderDeviceRecorder>(allocator, nullptr);
+	else
+	{
+		window = allocator->MakeNew<Window>(allocator);
+
+		if (window->Initialize(1920, 1080, "Kokko Replay") == false)
+		{
+			std::printf("Creating a window failed\n");
+			allocator->MakeDelete(window);
+			return -1;
+		}
+
+		// Don't wait for vertical sync between loops
+		window->SetSwapInterval(0);
+
+		device = allocator->MakeNew<RenderDeviceOpenGL>();
+	}
+
+	RenderDeviceStateFilter* filter = nullptr;
+	if (options.filterState)
+		filter = allocator->MakeNew<RenderDeviceStateFilter>(device);
+
+	int result = 0;
+
+	{
+		RenderCaptureReplayer replayer(allocator, filter != nullptr ? filter : device);
+
+		// Create the objects the frame uses, this isn't measured
+		if (replayer.Replay(stream, frameStart))
+		{
+			replayer.ResetCategoryStats();
+
+			PerformanceTimer frameTimer;
+
+			for (unsigned int i = 0; i < options.loopCount && result == 0; ++i)
+			{
+				if (replayer.Replay(stream + frameStart, frameSize) == false)
+					result = -1;
+
+				if (window != nullptr)
+					window->Swap();
+			}
+
+			if (result == 0)
+				PrintStats(replayer, options.loopCount, frameTimer.ElapsedSeconds() * 1000.0 / options.loopCount);
+		}
+		else
+			result = -1;
+
+		if (result != 0)
+			std::printf("Capture %s is malformed\n", options.capturePath);
+	}
+
+	allocator->MakeDelete(filter);
+	allocator->MakeDelete(device);
+	allocator->MakeDelete(window);
+
+	return result;
+}
+
+int main(int argc, char** argv)
+{
+	ReplayOptions options;
+
+	if (ParseOptions(argc, argv, options) == false)
+	{
+		PrintUsage();
+		return -1;
+	}
+
+	Memory::InitializeMemorySystem();
+
+	int result = Replay(Memory::GetDefaultAllocator(), options);
+
+	Memory::DeinitializeMemorySystem();
+
+	return result;
+}
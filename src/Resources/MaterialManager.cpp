@@ -99,6 +99,8 @@ MaterialId MaterialManager::CreateMaterial()
 
 	data.material[id.i].transparency = TransparencyType::Opaque;
 	data.material[id.i].shaderId = ShaderId{};
+	data.material[id.i].instancing = false;
+	data.material[id.i].indirect = false;
 	data.material[id.i].cachedShaderDeviceId = 0;
 	data.material[id.i].uniformBufferObject = 0;
 	data.material[id.i].uniforms = UniformList();
@@ -118,6 +120,8 @@ MaterialId MaterialManager::CreateCopy(MaterialId copyFrom)
 	SetShader(id, origMaterial.shaderId);
 	MaterialData& newMaterial = data.material[id.i];
 
+	newMaterial.instancing = origMaterial.instancing;
+
 	// Copy buffer uniform data
 	std::memcpy(newMaterial.uniformData, origMaterial.uniformData, origMaterial.uniforms.uniformDataSize);
 
@@ -198,6 +202,8 @@ void MaterialManager::SetShader(MaterialId id, ShaderId shaderId)
 	material.shaderId = shaderId;
 	material.cachedShaderDeviceId = shader.driverId;
 	material.transparency = shader.transparencyType;
+	material.instancing = shader.instancing;
+	material.indirect = shader.indirect;
 
 	// Copy uniform information
 
@@ -547,6 +553,13 @@ bool MaterialManager::LoadFromConfiguration(MaterialId id, char* config)
 	MaterialData& material = data.material[id.i];
 	const ShaderData& shader = shaderManager->GetShaderData(shaderId);
 
+	// Instancing can be disabled per material, but only enabled by the shader
+	MemberItr instancingItr = doc.FindMember("instancing");
+
+	if (instancingItr != doc.MemberEnd() && instancingItr->value.IsBool() &&
+		instancingItr->value.GetBool() == false)
+		material.instancing = false;
+
 	MemberItr variablesItr = doc.FindMember("variables");
 	const rapidjson::Value* varValue = nullptr;
 	bool variablesArrayIsValid = variablesItr != doc.MemberEnd() && variablesItr->value.IsArray();
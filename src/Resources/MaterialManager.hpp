@@ -20,6 +20,13 @@ struct MaterialData
 {
 	TransparencyType transparency;
 	ShaderId shaderId;
+
+	// Draws of the same mesh can be combined into instanced draws
+	bool instancing;
+
+	// Objects must be drawn with multi-draw indirect, set by the shader
+	bool indirect;
+
 	unsigned int cachedShaderDeviceId;
 
 	unsigned int uniformBufferObject;
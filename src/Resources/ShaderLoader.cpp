@@ -129,12 +129,6 @@ static bool ProcessSource(
 	std::memcpy(dest, versionStr.str, versionStr.len);
 	dest += versionStr.len;
 
-	if (uniformBlock.str != nullptr)
-	{
-		std::memcpy(dest, uniformBlock.str, uniformBlock.len);
-		dest += uniformBlock.len;
-	}
-
 	if (includePaths != nullptr)
 	{
 		for (auto itr = includePaths->Begin(), end = includePaths->End(); itr != end; ++itr)
@@ -147,6 +141,14 @@ static bool ProcessSource(
 		}
 	}
 
+	// Material uniform block goes after includes, so that their #extension
+	// directives come before any declarations
+	if (uniformBlock.str != nullptr)
+	{
+		std::memcpy(dest, uniformBlock.str, uniformBlock.len);
+		dest += uniformBlock.len;
+	}
+
 	std::strcpy(dest, mainFile.Data());
 
 	return true;
@@ -540,6 +542,20 @@ bool ShaderLoader::LoadFromConfiguration(
 		}
 	}
 
+	shaderOut.instancing = false;
+
+	MemberItr instancingItr = config.FindMember("instancing");
+
+	if (instancingItr != config.MemberEnd() && instancingItr->value.IsBool())
+		shaderOut.instancing = instancingItr->value.GetBool();
+
+	shaderOut.indirect = false;
+
+	MemberItr indirectItr = config.FindMember("indirect");
+
+	if (indirectItr != config.MemberEnd() && indirectItr->value.IsBool())
+		shaderOut.indirect = indirectItr->value.GetBool();
+
 	static const size_t MaxUniformCount = 32;
 	AddUniforms_UniformData uniforms[MaxUniformCount];
 	unsigned int uniformCount = 0;
@@ -85,6 +85,8 @@ ShaderId ShaderManager::CreateShader()
 	data.shader[id.i].buffer = nullptr;
 	data.shader[id.i].uniformBlockDefinition = StringRef();
 	data.shader[id.i].transparencyType = TransparencyType::Opaque;
+	data.shader[id.i].instancing = false;
+	data.shader[id.i].indirect = false;
 	data.shader[id.i].driverId = 0;
 	data.shader[id.i].uniforms = UniformList();
 
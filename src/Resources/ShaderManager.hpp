@@ -20,6 +20,12 @@ struct ShaderData
 
 	TransparencyType transparencyType;
 
+	// Objects can be combined into instanced draws
+	bool instancing;
+
+	// Objects can be combined into multi-draw indirect calls
+	bool indirect;
+
 	unsigned int driverId;
 
 	UniformList uniforms;
@@ -1,10 +1,15 @@
 #pragma once
 
-struct Entity;
 struct Mat4x4f;
 
 class ITransformUpdateReceiver
 {
 public:
-	virtual void NotifyUpdatedTransforms(unsigned int count, const Entity* entities, const Mat4x4f* transforms) = 0;
+	/**
+	 * Receive the world transforms of components attached to scene objects
+	 * with Scene::AttachComponent. Component indices are sorted in ascending
+	 * order, and an index can appear more than once, with the latest transform last.
+	 */
+	virtual void NotifyUpdatedTransforms(unsigned int count, const unsigned int* componentIndices,
+		const Mat4x4f* transforms) = 0;
 };
@@ -1,6 +1,10 @@
 #include "Scene/Scene.hpp"
 
 #include <cassert>
+#include <cstring>
+
+#include "Core/JobSystem.hpp"
+#include "Core/Sort.hpp"
 
 #include "Memory/Allocator.hpp"
 #include "Math/Math.hpp"
@@ -11,9 +15,18 @@ const SceneObjectId SceneObjectId::Null = SceneObjectId{};
 Scene::Scene(Allocator* allocator, unsigned int sceneId):
 	allocator(allocator),
 	entityMap(allocator),
-	updatedEntities(allocator),
+	transformReceiverCount(0),
+	updateKeys(allocator),
+	updateKeyScratch(allocator),
 	updatedTransforms(allocator),
+	notifyComponents(allocator),
+	notifyTransforms(allocator),
+	jobEdgeWords(allocator),
+	hierarchyOrderDirty(false),
+	orderedObjects(allocator),
+	newIndices(allocator),
 	sceneId(sceneId),
+	skyboxMaterial(MaterialId{ 0 }),
 	activeCamera(nullptr)
 {
 	data = InstanceData{};
@@ -29,17 +42,66 @@ Scene::~Scene()
 
 Scene& Scene::operator=(Scene&& other)
 {
-	this->sceneId = other.sceneId;
+	// Swap the object data, so that <other> frees our old buffer
+	InstanceData oldData = this->data;
 	this->data = other.data;
+	other.data = oldData;
+
+	entityMap.Swap(other.entityMap);
+
+	// Changes that haven't been sent to the receivers yet move with the scene
+	updateKeys.Swap(other.updateKeys);
+	updatedTransforms.Swap(other.updatedTransforms);
+
+	this->sceneId = other.sceneId;
+	this->hierarchyOrderDirty = other.hierarchyOrderDirty;
+	this->skyboxMaterial = other.skyboxMaterial;
 	this->activeCamera = other.activeCamera;
 
+	for (unsigned int i = 0; i < other.transformReceiverCount; ++i)
+		this->transformReceivers[i] = other.transformReceivers[i];
+	this->transformReceiverCount = other.transformReceiverCount;
+
 	other.sceneId = 0;
-	other.data = InstanceData{}; // Zero-initialize
+	other.updateKeys.Clear();
+	other.updatedTransforms.Clear();
+	other.hierarchyOrderDirty = false;
+	other.skyboxMaterial = MaterialId{ 0 };
+	other.transformReceiverCount = 0;
 	other.activeCamera = nullptr;
 
 	return *this;
 }
 
+Scene::InstanceData Scene::AllocateInstanceData(unsigned int allocated)
+{
+	InstanceData newData;
+	const unsigned objectBytes = sizeof(Entity) + sizeof(Mat3x4f) + sizeof(Transformf) + 4 * sizeof(SceneObjectId) +
+		MaxTransformReceivers * sizeof(unsigned int);
+	const size_t dirtyBytes = GetDirtyWordCount(allocated) * sizeof(uint64_t);
+	newData.buffer = allocator->Allocate(allocated * objectBytes + dirtyBytes);
+	newData.count = 0;
+	newData.allocated = allocated;
+
+	newData.entity = static_cast<Entity*>(newData.buffer);
+	newData.world = reinterpret_cast<Mat3x4f*>(newData.entity + allocated);
+	newData.local = reinterpret_cast<Transformf*>(newData.world + allocated);
+	newData.parent = reinterpret_cast<SceneObjectId*>(newData.local + allocated);
+	newData.firstChild = newData.parent + allocated;
+	newData.nextSibling = newData.firstChild + allocated;
+	newData.prevSibling = newData.nextSibling + allocated;
+	newData.component[0] = reinterpret_cast<unsigned int*>(newData.prevSibling + allocated);
+
+	for (unsigned int receiver = 1; receiver < MaxTransformReceivers; ++receiver)
+		newData.component[receiver] = newData.component[receiver - 1] + allocated;
+
+	newData.dirty = reinterpret_cast<uint64_t*>(newData.component[MaxTransformReceivers - 1] + allocated);
+
+	std::memset(newData.dirty, 0, dirtyBytes);
+
+	return newData;
+}
+
 void Scene::Reallocate(unsigned int required)
 {
 	if (required <= data.allocated)
@@ -50,41 +112,38 @@ void Scene::Reallocate(unsigned int required)
 	// Reserve same amount in entity map
 	entityMap.Reserve(required);
 
-	InstanceData newData;
-	const unsigned objectBytes = sizeof(Entity) + 2 * sizeof(Mat4x4f) + 4 * sizeof(SceneObjectId);
-	newData.buffer = allocator->Allocate(required * objectBytes);
+	InstanceData newData = AllocateInstanceData(required);
 	newData.count = data.count;
-	newData.allocated = required;
-
-	newData.entity = static_cast<Entity*>(newData.buffer);
-	newData.local = reinterpret_cast<Mat4x4f*>(newData.entity + required);
-	newData.world = newData.local + required;
-	newData.parent = reinterpret_cast<SceneObjectId*>(newData.world + required);
-	newData.firstChild = newData.parent + required;
-	newData.nextSibling = newData.firstChild + required;
-	newData.prevSibling = newData.nextSibling + required;
 
 	if (data.buffer != nullptr)
 	{
 		std::memcpy(newData.entity, data.entity, data.count * sizeof(Entity));
-		std::memcpy(newData.local, data.local, data.count * sizeof(Mat4x4f));
-		std::memcpy(newData.world, data.world, data.count * sizeof(Mat4x4f));
+		std::memcpy(newData.world, data.world, data.count * sizeof(Mat3x4f));
+		std::memcpy(newData.local, data.local, data.count * sizeof(Transformf));
 		std::memcpy(newData.parent, data.parent, data.count * sizeof(SceneObjectId));
 		std::memcpy(newData.firstChild, data.firstChild, data.count * sizeof(SceneObjectId));
 		std::memcpy(newData.nextSibling, data.nextSibling, data.count * sizeof(SceneObjectId));
 		std::memcpy(newData.prevSibling, data.prevSibling, data.count * sizeof(SceneObjectId));
 
+		for (unsigned int receiver = 0; receiver < MaxTransformReceivers; ++receiver)
+			std::memcpy(newData.component[receiver], data.component[receiver], data.count * sizeof(unsigned int));
+
+		std::memcpy(newData.dirty, data.dirty, GetDirtyWordCount(data.count) * sizeof(uint64_t));
+
 		allocator->Deallocate(data.buffer);
 	}
 	else
 	{
 		newData.entity[SceneObjectId::Null.i] = Entity{};
-		newData.local[SceneObjectId::Null.i] = Mat4x4f();
-		newData.world[SceneObjectId::Null.i] = Mat4x4f();
+		newData.world[SceneObjectId::Null.i] = Mat3x4f();
+		newData.local[SceneObjectId::Null.i] = Transformf();
 		newData.parent[SceneObjectId::Null.i] = SceneObjectId::Null;
 		newData.firstChild[SceneObjectId::Null.i] = SceneObjectId::Null;
 		newData.nextSibling[SceneObjectId::Null.i] = SceneObjectId::Null;
 		newData.prevSibling[SceneObjectId::Null.i] = SceneObjectId::Null;
+
+		for (unsigned int receiver = 0; receiver < MaxTransformReceivers; ++receiver)
+			newData.component[receiver][SceneObjectId::Null.i] = 0;
 	}
 
 	data = newData;
@@ -105,25 +164,44 @@ void Scene::AddSceneObject(unsigned int count, Entity* entities, SceneObjectId*
 		mapPair->second = SceneObjectId { id };
 
 		data.entity[id] = e;
-		data.local[id] = Mat4x4f();
-		data.world[id] = Mat4x4f();
+		data.world[id] = Mat3x4f();
+		data.local[id] = Transformf();
 		data.parent[id] = SceneObjectId::Null;
 		data.firstChild[id] = SceneObjectId::Null;
 		data.nextSibling[id] = SceneObjectId::Null;
 		data.prevSibling[id] = SceneObjectId::Null;
 
+		for (unsigned int receiver = 0; receiver < MaxTransformReceivers; ++receiver)
+			data.component[receiver][id] = 0;
+
+		SetDirty(id);
+
 		idsOut[i].i = id;
 	}
 
 	data.count += count;
-
-	updatedEntities.InsertUnique(reinterpret_cast<unsigned int*>(entities), count);
 }
 
 void Scene::RemoveSceneObject(SceneObjectId id)
 {
 	assert(IsValidId(id));
 
+	SceneObjectId removedParent = data.parent[id.i];
+	SceneObjectId removedFirstChild = data.firstChild[id.i];
+
+	// Children of the object become root objects
+	for (SceneObjectId child = data.firstChild[id.i]; IsValidId(child);)
+	{
+		SceneObjectId nextChild = data.nextSibling[child.i];
+
+		data.parent[child.i] = SceneObjectId::Null;
+		data.nextSibling[child.i] = SceneObjectId::Null;
+		data.prevSibling[child.i] = SceneObjectId::Null;
+		SetDirty(child.i);
+
+		child = nextChild;
+	}
+
 	// Remove references
 	{
 		SceneObjectId parent = data.parent[id.i];
@@ -149,13 +227,17 @@ void Scene::RemoveSceneObject(SceneObjectId id)
 		}
 	}
 
+	HashMap<unsigned int, SceneObjectId>::KeyValuePair* removedPair = entityMap.Lookup(data.entity[id.i].id);
+	if (removedPair != nullptr)
+		entityMap.Remove(removedPair);
+
 	// Swap last item in the removed object's place
 
-	if (data.count > 1) // We still have objects other than the root
-	{
-		SceneObjectId swap;
-		swap.i = data.count - 1;
+	SceneObjectId swap;
+	swap.i = data.count - 1;
 
+	if (swap.i != id.i)
+	{
 		SceneObjectId parent = data.parent[swap.i];
 		SceneObjectId firstChild = data.firstChild[swap.i];
 		SceneObjectId prevSibling = data.prevSibling[swap.i];
@@ -183,15 +265,37 @@ void Scene::RemoveSceneObject(SceneObjectId id)
 		// Update swap objects data to the removed objects place
 
 		data.entity[id.i] = data.entity[swap.i];
-		data.local[id.i] = data.local[swap.i];
 		data.world[id.i] = data.world[swap.i];
+		data.local[id.i] = data.local[swap.i];
 		data.parent[id.i] = parent;
 		data.firstChild[id.i] = firstChild;
 		data.prevSibling[id.i] = prevSibling;
 		data.nextSibling[id.i] = nextSibling;
 
-		--data.count;
+		for (unsigned int receiver = 0; receiver < MaxTransformReceivers; ++receiver)
+			data.component[receiver][id.i] = data.component[receiver][swap.i];
+
+		if (IsDirty(swap.i))
+			SetDirty(id.i);
+		else
+			ClearDirty(id.i);
+
+		HashMap<unsigned int, SceneObjectId>::KeyValuePair* swapPair = entityMap.Lookup(data.entity[id.i].id);
+		if (swapPair != nullptr)
+			swapPair->second = id;
+
+		// Moving a root object without children to the place of another one keeps the order
+		if (IsValidId(parent) || IsValidId(firstChild) || IsValidId(removedParent))
+			hierarchyOrderDirty = true;
 	}
+
+	// The children are now root objects in the middle of the old hierarchy
+	if (IsValidId(removedFirstChild))
+		hierarchyOrderDirty = true;
+
+	ClearDirty(swap.i);
+
+	--data.count;
 }
 
 void Scene::SetParent(SceneObjectId id, SceneObjectId parent)
@@ -228,6 +332,9 @@ void Scene::SetParent(SceneObjectId id, SceneObjectId parent)
 
 		// Create references for new position in hierarchy
 
+		data.prevSibling[id.i] = SceneObjectId::Null;
+		data.nextSibling[id.i] = SceneObjectId::Null;
+
 		if (IsValidId(parent)) // New parent isn't root
 		{
 			SceneObjectId parentsChild = data.firstChild[parent.i];
@@ -237,82 +344,335 @@ void Scene::SetParent(SceneObjectId id, SceneObjectId parent)
 				data.prevSibling[parentsChild.i] = id;
 
 			// Set this object as the first child of the new parent
+			data.nextSibling[id.i] = parentsChild;
 			data.firstChild[parent.i] = id;
 		}
 
 		// Finally set the new parent
 		data.parent[id.i] = parent;
+		SetDirty(id.i);
+
+		// The object and its descendants must move next to the new parent
+		hierarchyOrderDirty = true;
 	}
 }
 
-void Scene::SetLocalTransform(SceneObjectId id, const Mat4x4f& transform)
+unsigned int Scene::FindTransformReceiver(ITransformUpdateReceiver* receiver) const
+{
+	for (unsigned int i = 0; i < transformReceiverCount; ++i)
+		if (transformReceivers[i] == receiver)
+			return i;
+
+	return transformReceiverCount;
+}
+
+void Scene::AttachComponent(ITransformUpdateReceiver* receiver, SceneObjectId id, unsigned int componentIndex)
+{
+	assert(IsValidId(id));
+
+	// Component index shares the update key with the receiver and transform indices
+	assert(componentIndex != 0 && componentIndex < (1u << 30));
+
+	unsigned int receiverIndex = FindTransformReceiver(receiver);
+
+	if (receiverIndex == transformReceiverCount)
+	{
+		assert(transformReceiverCount < MaxTransformReceivers);
+
+		transformReceivers[transformReceiverCount] = receiver;
+		transformReceiverCount += 1;
+	}
+
+	data.component[receiverIndex][id.i] = componentIndex;
+
+	// The receiver gets the current world transform with the next update
+	SetDirty(id.i);
+}
+
+void Scene::DetachComponent(ITransformUpdateReceiver* receiver, SceneObjectId id)
+{
+	assert(IsValidId(id));
+
+	unsigned int receiverIndex = FindTransformReceiver(receiver);
+
+	if (receiverIndex < transformReceiverCount)
+		data.component[receiverIndex][id.i] = 0;
+}
+
+void Scene::SetLocalTransform(SceneObjectId id, const Transformf& transform)
 {
 	assert(IsValidId(id));
 
 	data.local[id.i] = transform;
+	SetDirty(id.i);
+}
+
+void Scene::RestoreHierarchyOrder()
+{
+	unsigned int count = data.count;
+
+	orderedObjects.Resize(count);
+	newIndices.Resize(count);
+
+	// Order each root object's hierarchy depth-first, so that parents come
+	// before their children and every hierarchy is stored in one range
+
+	unsigned int orderedCount = 0;
+	orderedObjects[orderedCount++] = SceneObjectId::Null.i;
+
+	for (unsigned int root = 1; root < count; ++root)
+	{
+		if (IsValidId(data.parent[root]))
+			continue;
+
+		SceneObjectId current = SceneObjectId{ root };
+
+		while (true)
+		{
+			orderedObjects[orderedCount++] = current.i;
+
+			if (IsValidId(data.firstChild[current.i]))
+			{
+				current = data.firstChild[current.i];
+				continue;
+			}
 
-	SceneObjectId parent = data.parent[id.i];
+			// Find the next sibling of the object or of its closest ancestor that has one
+			while (current.i != root && IsValidId(data.nextSibling[current.i]) == false)
+				current = data.parent[current.i];
 
-	// No check needed for invalid parent, because root index has valid transforms
-	Mat4x4f parentTransform = data.world[parent.i];
+			if (current.i == root)
+				break;
 
-	// Set world transform for specified object
-	data.world[id.i] = data.local[id.i] * parentTransform;
+			current = data.nextSibling[current.i];
+		}
+	}
 
-	// Set the entity as updated
-	updatedEntities.InsertUnique(data.entity[id.i].id);
+	assert(orderedCount == count);
 
-	// Set world transforms for all children of the specified object
+	for (unsigned int i = 0; i < count; ++i)
+		newIndices[orderedObjects[i]] = i;
 
-	SceneObjectId current = data.firstChild[id.i];
-	SceneObjectId lastValid;
+	InstanceData newData = AllocateInstanceData(data.allocated);
+	newData.count = count;
 
-	while (IsValidId(current))
+	for (unsigned int i = 0; i < count; ++i)
 	{
-		data.world[id.i] = data.local[id.i] * parentTransform;
+		unsigned int oldIndex = orderedObjects[i];
 
-		// Set the entity as updated
-		updatedEntities.InsertUnique(data.entity[id.i].id);
+		newData.entity[i] = data.entity[oldIndex];
+		newData.world[i] = data.world[oldIndex];
+		newData.local[i] = data.local[oldIndex];
+		newData.parent[i].i = newIndices[data.parent[oldIndex].i];
+		newData.firstChild[i].i = newIndices[data.firstChild[oldIndex].i];
+		newData.nextSibling[i].i = newIndices[data.nextSibling[oldIndex].i];
+		newData.prevSibling[i].i = newIndices[data.prevSibling[oldIndex].i];
 
-		// Move to child
-		lastValid = current;
-		current = data.firstChild[current.i];
+		for (unsigned int receiver = 0; receiver < MaxTransformReceivers; ++receiver)
+			newData.component[receiver][i] = data.component[receiver][oldIndex];
 
-		// No children for <current>
-		if (IsValidId(current) == false)
-		{
-			// Move to next sibling
-			current = data.nextSibling[lastValid.i];
+		if (IsDirty(oldIndex))
+			newData.dirty[i / DirtyWordBits] |= 1ULL << (i % DirtyWordBits);
+
+		if (i != oldIndex)
+			entityMap.Lookup(newData.entity[i].id)->second.i = i;
+	}
+
+	allocator->Deallocate(data.buffer);
+	data = newData;
+
+	hierarchyOrderDirty = false;
+}
 
-			// Enter if no more siblings, find next parent's valid sibling
-			// Break out when we find a valid object or hit the specified object
-			while (IsValidId(current) == false && lastValid.i != id.i)
+unsigned int Scene::FindNextRoot(unsigned int index) const
+{
+	unsigned int count = data.count;
+
+	while (index < count && IsValidId(data.parent[index]))
+		++index;
+
+	return index;
+}
+
+void Scene::UpdateWorldTransformRange(unsigned int begin, unsigned int end, DirtyEdgeWords& edgeWordsOut)
+{
+	if (begin >= end)
+	{
+		edgeWordsOut = DirtyEdgeWords{};
+		return;
+	}
+
+	// A parent's world transform is final before any of its children are
+	// visited, and a parent that was updated marks its children dirty.
+	// The words at both ends of the range can hold bits of other jobs' objects,
+	// so they are only updated in local copies and merged after all jobs.
+
+	const SceneObjectId* parents = data.parent;
+	const Transformf* localTransforms = data.local;
+	Mat3x4f* worldTransforms = data.world;
+	uint64_t* dirty = data.dirty;
+
+	const unsigned int firstWord = begin / DirtyWordBits;
+	const unsigned int lastWord = (end - 1) / DirtyWordBits;
+
+	uint64_t firstBits = dirty[firstWord];
+	uint64_t lastBits = dirty[lastWord];
+
+	for (unsigned int word = firstWord; word <= lastWord; ++word)
+	{
+		uint64_t bits = word == firstWord ? firstBits : (word == lastWord ? lastBits : dirty[word]);
+
+		unsigned int wordStart = word * DirtyWordBits;
+		unsigned int rangeStart = wordStart > begin ? wordStart : begin;
+		unsigned int rangeEnd = wordStart + DirtyWordBits < end ? wordStart + DirtyWordBits : end;
+
+		for (unsigned int i = rangeStart; i < rangeEnd; ++i)
+		{
+			unsigned int parent = parents[i].i;
+			unsigned int parentWord = parent / DirtyWordBits;
+			uint64_t parentBits;
+
+			// Root objects have no parent to inherit changes from
+			if (parent == SceneObjectId::Null.i)
+				parentBits = 0;
+			else if (parentWord == word)
+				parentBits = bits;
+			else if (parentWord == firstWord)
+				parentBits = firstBits;
+			else
+				parentBits = dirty[parentWord];
+
+			uint64_t bit = 1ULL << (i - wordStart);
+
+			if ((bits & bit) != 0 || ((parentBits >> (parent % DirtyWordBits)) & 1) != 0)
 			{
-				lastValid = data.parent[lastValid.i];
-				current = data.nextSibling[lastValid.i];
+				worldTransforms[i] = worldTransforms[parent] * localTransforms[i].GetMatrix();
+				bits |= bit;
 			}
 		}
+
+		if (word == firstWord)
+			firstBits = bits;
+		else if (word == lastWord)
+			lastBits = bits;
+		else
+			dirty[word] = bits;
 	}
+
+	edgeWordsOut.firstWord = firstWord;
+	edgeWordsOut.lastWord = lastWord;
+	edgeWordsOut.firstBits = firstBits;
+	edgeWordsOut.lastBits = firstWord == lastWord ? firstBits : lastBits;
 }
 
-void Scene::NotifyUpdatedTransforms(unsigned int receiverCount, ITransformUpdateReceiver** updateReceivers)
+void Scene::UpdateWorldTransforms(JobSystem* jobSystem)
 {
-	unsigned int updateCount = updatedEntities.GetCount();
-	updatedTransforms.Resize(updateCount);
+	if (hierarchyOrderDirty)
+		RestoreHierarchyOrder();
+
+	const unsigned int ObjectsPerJob = 2048;
+
+	unsigned int objectCount = data.count - 1;
+
+	if (jobSystem != nullptr && objectCount > ObjectsPerJob)
+	{
+		unsigned int jobCount = (objectCount + ObjectsPerJob - 1) / ObjectsPerJob;
+		jobEdgeWords.Resize(jobCount);
 
-	Entity* entities = reinterpret_cast<Entity*>(updatedEntities.GetData());
+		// ParallelFor can run the whole range as one job
+		for (unsigned int job = 0; job < jobCount; ++job)
+			jobEdgeWords[job] = DirtyEdgeWords{};
 
-	for (unsigned int i = 0; i < updateCount; ++i)
+		// Each job extends its range to the next root object, so hierarchies
+		// aren't split between jobs and no object is written by two jobs
+		jobSystem->ParallelFor(objectCount, ObjectsPerJob, [this](unsigned int begin, unsigned int end)
+		{
+			DirtyEdgeWords& edgeWords = jobEdgeWords[begin / ObjectsPerJob];
+			UpdateWorldTransformRange(FindNextRoot(begin + 1), FindNextRoot(end + 1), edgeWords);
+		});
+	}
+	else
 	{
-		SceneObjectId obj = this->Lookup(entities[i]);
-		updatedTransforms[i] = this->GetWorldTransform(obj);
+		jobEdgeWords.Resize(1);
+		UpdateWorldTransformRange(1, data.count, jobEdgeWords[0]);
 	}
 
-	for (unsigned int i = 0; i < receiverCount; ++i)
+	for (unsigned int job = 0, jobCount = jobEdgeWords.GetCount(); job < jobCount; ++job)
 	{
-		updateReceivers[i]->NotifyUpdatedTransforms(updateCount, entities, updatedTransforms.GetData());
+		const DirtyEdgeWords& edgeWords = jobEdgeWords[job];
+		data.dirty[edgeWords.firstWord] |= edgeWords.firstBits;
+		data.dirty[edgeWords.lastWord] |= edgeWords.lastBits;
+	}
+
+	// Record the changes of objects that have components, regardless of which
+	// jobs updated them. Only the world transforms are copied here, sorting is
+	// left to NotifyUpdatedTransforms.
+
+	size_t wordCount = GetDirtyWordCount(data.count);
+
+	for (size_t word = 0; word < wordCount; ++word)
+	{
+		uint64_t bits = data.dirty[word];
+
+		for (unsigned int bitIndex = 0; bits != 0; ++bitIndex, bits >>= 1)
+		{
+			if ((bits & 1) == 0)
+				continue;
+
+			unsigned int index = static_cast<unsigned int>(word * DirtyWordBits + bitIndex);
+			uint64_t transformIndex = updatedTransforms.GetCount();
+			bool hasComponents = false;
+
+			for (unsigned int receiver = 0; receiver < transformReceiverCount; ++receiver)
+			{
+				uint64_t component = data.component[receiver][index];
+
+				if (component != 0)
+				{
+					updateKeys.PushBack((static_cast<uint64_t>(receiver) << 62) | (component << 32) | transformIndex);
+					hasComponents = true;
+				}
+			}
+
+			if (hasComponents)
+				updatedTransforms.PushBack(data.world[index]);
+		}
+	}
+
+	std::memset(data.dirty, 0, wordCount * sizeof(uint64_t));
+}
+
+void Scene::NotifyUpdatedTransforms()
+{
+	unsigned int keyCount = updateKeys.GetCount();
+	updateKeyScratch.Resize(keyCount);
+
+	// Changes of the same component from several updates stay in update order,
+	// so the receiver processes the latest one last
+	RadixSortAsc(updateKeys.GetData(), updateKeyScratch.GetData(), keyCount);
+
+	const uint64_t ComponentMask = (1ULL << 30) - 1;
+	const uint64_t TransformMask = (1ULL << 32) - 1;
+
+	unsigned int keyIndex = 0;
+
+	for (unsigned int receiver = 0; receiver < transformReceiverCount; ++receiver)
+	{
+		notifyComponents.Clear();
+		notifyTransforms.Clear();
+
+		for (; keyIndex < keyCount && (updateKeys[keyIndex] >> 62) == receiver; ++keyIndex)
+		{
+			uint64_t key = updateKeys[keyIndex];
+			notifyComponents.PushBack(static_cast<unsigned int>((key >> 32) & ComponentMask));
+			notifyTransforms.PushBack(updatedTransforms[static_cast<unsigned int>(key & TransformMask)].ToMat4x4());
+		}
+
+		if (notifyComponents.GetCount() > 0)
+			transformReceivers[receiver]->NotifyUpdatedTransforms(
+				notifyComponents.GetCount(), notifyComponents.GetData(), notifyTransforms.GetData());
 	}
 
-	updatedEntities.Clear();
+	updateKeys.Clear();
 	updatedTransforms.Clear();
 }
@@ -1,19 +1,22 @@
 #pragma once
 
+#include <cstdint>
+
 #include "Core/HashMap.hpp"
 #include "Core/Array.hpp"
-#include "Core/SortedArray.hpp"
 #include "Core/Color.hpp"
 
 #include "Entity/Entity.hpp"
 
-#include "Math/Mat4x4.hpp"
+#include "Math/Mat3x4.hpp"
+#include "Math/Transform.hpp"
 
 #include "Resources/MaterialData.hpp"
 
 class Camera;
 class Allocator;
 class ITransformUpdateReceiver;
+class JobSystem;
 
 struct SceneObjectId
 {
@@ -24,6 +27,9 @@ struct SceneObjectId
 
 class Scene
 {
+public:
+	static const unsigned int MaxTransformReceivers = 4;
+
 private:
 	Allocator* allocator;
 
@@ -34,18 +40,58 @@ private:
 		void *buffer;
 
 		Entity* entity;
-		Mat4x4f* local;
-		Mat4x4f* world;
+		Mat3x4f* world;
+		Transformf* local;
 		SceneObjectId* parent;
 		SceneObjectId* firstChild;
 		SceneObjectId* nextSibling;
 		SceneObjectId* prevSibling;
+
+		// Component index of the object in each transform receiver, 0 if the
+		// object has no component in that receiver
+		unsigned int* component[MaxTransformReceivers];
+
+		// Bit per object, set if the local transform or parent changed since
+		// the last world transform update. Bits of unused objects are zero.
+		uint64_t* dirty;
 	}
 	data;
 
 	HashMap<unsigned int, SceneObjectId> entityMap;
-	SortedArray<unsigned int> updatedEntities;
-	Array<Mat4x4f> updatedTransforms;
+
+	ITransformUpdateReceiver* transformReceivers[MaxTransformReceivers];
+	unsigned int transformReceiverCount;
+
+	// Changes since the last NotifyUpdatedTransforms. Each key holds the
+	// receiver index, the component index and the index of the world transform
+	// in updatedTransforms, so that sorting the keys groups the changes by
+	// receiver and orders them by component index.
+	Array<uint64_t> updateKeys;
+	Array<uint64_t> updateKeyScratch;
+	Array<Mat3x4f> updatedTransforms;
+
+	// Sorted changes of one receiver at a time, see NotifyUpdatedTransforms
+	Array<unsigned int> notifyComponents;
+	Array<Mat4x4f> notifyTransforms;
+
+	// Dirty words at both ends of a job's range of objects, which can also
+	// hold bits of the neighbouring jobs' objects
+	struct DirtyEdgeWords
+	{
+		unsigned int firstWord;
+		unsigned int lastWord;
+		uint64_t firstBits;
+		uint64_t lastBits;
+	};
+
+	Array<DirtyEdgeWords> jobEdgeWords;
+
+	// Set when the objects are no longer stored in hierarchy order, see UpdateWorldTransforms
+	bool hierarchyOrderDirty;
+
+	// Scratch data used when restoring the hierarchy order
+	Array<unsigned int> orderedObjects;
+	Array<unsigned int> newIndices;
 
 	unsigned int sceneId;
 
@@ -53,10 +99,42 @@ private:
 
 	Camera* activeCamera;
 
+	InstanceData AllocateInstanceData(unsigned int allocated);
 	void Reallocate(unsigned int required);
 
+	void RestoreHierarchyOrder();
+
+	// Skip forward to the first root object at or after <index>
+	unsigned int FindNextRoot(unsigned int index) const;
+
+	void UpdateWorldTransformRange(unsigned int begin, unsigned int end, DirtyEdgeWords& edgeWordsOut);
+
 	static bool IsValidId(SceneObjectId id) { return id.i != 0; }
 
+	unsigned int FindTransformReceiver(ITransformUpdateReceiver* receiver) const;
+
+	static const unsigned int DirtyWordBits = 64;
+
+	static size_t GetDirtyWordCount(unsigned int objectCount)
+	{
+		return (objectCount + DirtyWordBits - 1) / DirtyWordBits;
+	}
+
+	void SetDirty(unsigned int index)
+	{
+		data.dirty[index / DirtyWordBits] |= 1ULL << (index % DirtyWordBits);
+	}
+
+	void ClearDirty(unsigned int index)
+	{
+		data.dirty[index / DirtyWordBits] &= ~(1ULL << (index % DirtyWordBits));
+	}
+
+	bool IsDirty(unsigned int index) const
+	{
+		return ((data.dirty[index / DirtyWordBits] >> (index % DirtyWordBits)) & 1) != 0;
+	}
+
 public:
 	Scene(Allocator* allocator, unsigned int sceneId);
 	~Scene();
@@ -86,12 +164,46 @@ public:
 
 	void SetParent(SceneObjectId id, SceneObjectId parent);
 
-	void SetLocalTransform(SceneObjectId id, const Mat4x4f& transform);
-
-	const Mat4x4f& GetWorldTransform(SceneObjectId id) { return data.world[id.i]; }
-	const Mat4x4f& GetLocalTransform(SceneObjectId id) { return data.local[id.i]; }
-
-	void NotifyUpdatedTransforms(unsigned int receiverCount, ITransformUpdateReceiver** updateReceivers);
+	/**
+	 * Map the object to a component of <receiver>, so that changes to the
+	 * object's world transform are sent to the receiver with <componentIndex>.
+	 * The mapping is stored with the object, so it follows the object when
+	 * scene object IDs change and is dropped when the object is removed.
+	 * Component index 0 is reserved for a null value, and an object can have
+	 * one component in each receiver. Up to MaxTransformReceivers receivers
+	 * are supported per scene.
+	 */
+	void AttachComponent(ITransformUpdateReceiver* receiver, SceneObjectId id, unsigned int componentIndex);
+	void DetachComponent(ITransformUpdateReceiver* receiver, SceneObjectId id);
+
+	/**
+	 * Set the transform of the object relative to its parent. World transforms
+	 * of the object and its descendants are updated in UpdateWorldTransforms.
+	 */
+	void SetLocalTransform(SceneObjectId id, const Transformf& transform);
+
+	/**
+	 * Update the world transforms of the objects whose local transform or
+	 * parent changed, and of their descendants. Objects are stored depth-first,
+	 * so parents come before their children and the descendants of each root
+	 * object are stored together. The update is a linear pass over the objects,
+	 * split between the jobs of <jobSystem> at root object boundaries. Pass
+	 * nullptr to update on the calling thread. Scene object IDs can change if
+	 * the order has to be restored after SetParent or RemoveSceneObject, so
+	 * they must be looked up again afterwards.
+	 */
+	void UpdateWorldTransforms(JobSystem* jobSystem);
+
+	// World transforms are valid as of the last UpdateWorldTransforms
+	const Mat3x4f& GetWorldTransform(SceneObjectId id) { return data.world[id.i]; }
+	const Transformf& GetLocalTransform(SceneObjectId id) { return data.local[id.i]; }
+
+	/**
+	 * Send the world transforms updated since the last call to the receivers
+	 * of the objects' components, in ascending order of component index.
+	 * Receivers get the transforms expanded to Mat4x4f.
+	 */
+	void NotifyUpdatedTransforms();
 
 	void SetSkyboxMaterial(MaterialId materialId) { skyboxMaterial = materialId; }
 	MaterialId GetSkyboxMaterial() const { return skyboxMaterial; }
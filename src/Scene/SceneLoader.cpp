@@ -74,7 +74,7 @@ void SceneLoader::CreateObjects(ValueItr itr, ValueItr end)
 			MemberItr componentsItr = itr->FindMember("components");
 			if (componentsItr != itr->MemberEnd() && componentsItr->value.IsArray())
 			{
-				CreateComponents(componentsItr->value.Begin(), componentsItr->value.End(), entity);
+				CreateComponents(componentsItr->value.Begin(), componentsItr->value.End(), entity, sceneObj);
 			}
 		}
 	}
@@ -94,7 +94,7 @@ void SceneLoader::CreateChildObjects(ValueItr itr, ValueItr end, SceneObjectId p
 			MemberItr componentsItr = itr->FindMember("components");
 			if (componentsItr != itr->MemberEnd() && componentsItr->value.IsArray())
 			{
-				CreateComponents(componentsItr->value.Begin(), componentsItr->value.End(), entity);
+				CreateComponents(componentsItr->value.Begin(), componentsItr->value.End(), entity, sceneObj);
 			}
 		}
 	}
@@ -102,27 +102,25 @@ void SceneLoader::CreateChildObjects(ValueItr itr, ValueItr end, SceneObjectId p
 
 void SceneLoader::CreateSceneObject(ValueItr itr, SceneObjectId sceneObject)
 {
-	Mat4x4f transform;
+	Transformf transform;
 
 	rapidjson::Value::ConstMemberIterator scaleItr = itr->FindMember("scale");
 	if (scaleItr != itr->MemberEnd())
 	{
-		Vec3f scale = ValueSerialization::Deserialize_Vec3f(scaleItr->value);
-		transform = Mat4x4f::Scale(scale) * transform;
+		transform.scale = ValueSerialization::Deserialize_Vec3f(scaleItr->value);
 	}
 
 	rapidjson::Value::ConstMemberIterator rotItr = itr->FindMember("rotation");
 	if (rotItr != itr->MemberEnd())
 	{
 		Vec3f rot = ValueSerialization::Deserialize_Vec3f(rotItr->value);
-		transform = Mat4x4f::RotateEuler(Math::DegreesToRadians(rot)) * transform;
+		transform.rotation = Quatf::RotateEuler(Math::DegreesToRadians(rot));
 	}
 
 	rapidjson::Value::ConstMemberIterator positionItr = itr->FindMember("position");
 	if (positionItr != itr->MemberEnd())
 	{
-		Vec3f pos = ValueSerialization::Deserialize_Vec3f(positionItr->value);
-		transform = Mat4x4f::Translate(pos) * transform;
+		transform.translation = ValueSerialization::Deserialize_Vec3f(positionItr->value);
 	}
 
 	scene->SetLocalTransform(sceneObject, transform);
@@ -137,7 +135,7 @@ void SceneLoader::CreateSceneObject(ValueItr itr, SceneObjectId sceneObject)
 	}
 }
 
-void SceneLoader::CreateComponents(ValueItr itr, ValueItr end, Entity entity)
+void SceneLoader::CreateComponents(ValueItr itr, ValueItr end, Entity entity, SceneObjectId sceneObject)
 {
 	for (; itr != end; ++itr)
 	{
@@ -152,11 +150,11 @@ void SceneLoader::CreateComponents(ValueItr itr, ValueItr end, Entity entity)
 				switch (typeHash)
 				{
 				case "renderObject"_hash:
-					CreateRenderObject(itr, entity);
+					CreateRenderObject(itr, entity, sceneObject);
 					break;
 
 				case "light"_hash:
-					CreateLight(itr, entity);
+					CreateLight(itr, entity, sceneObject);
 					break;
 
 				default:
@@ -170,7 +168,7 @@ void SceneLoader::CreateComponents(ValueItr itr, ValueItr end, Entity entity)
 	}
 }
 
-void SceneLoader::CreateRenderObject(ValueItr itr, Entity entity)
+void SceneLoader::CreateRenderObject(ValueItr itr, Entity entity, SceneObjectId sceneObject)
 {
 	MemberItr meshItr = itr->FindMember("mesh");
 	MemberItr materialItr = itr->FindMember("material");
@@ -194,10 +192,19 @@ void SceneLoader::CreateRenderObject(ValueItr itr, Entity entity)
 		data.transparency = materialManager->GetMaterialData(matId).transparency;
 
 		renderer->SetOrderData(renderObj, data);
+
+		// Only objects that are solid and fill their bounds should be occluders
+		MemberItr occluderItr = itr->FindMember("occluder");
+		if (occluderItr != itr->MemberEnd() && occluderItr->value.IsBool())
+		{
+			renderer->SetOccluder(renderObj, occluderItr->value.GetBool());
+		}
+
+		scene->AttachComponent(renderer, sceneObject, renderObj.i);
 	}
 }
 
-void SceneLoader::CreateLight(ValueItr itr, Entity entity)
+void SceneLoader::CreateLight(ValueItr itr, Entity entity, SceneObjectId sceneObject)
 {
 	LightType type;
 
@@ -273,4 +280,6 @@ void SceneLoader::CreateLight(ValueItr itr, Entity entity)
 
 	if (type == LightType::Spot)
 		lightManager->SetSpotAngle(lightId, Math::DegreesToRadians(angle));
+
+	scene->AttachComponent(lightManager, sceneObject, lightId.i);
 }
@@ -30,9 +30,9 @@ private:
 	void CreateChildObjects(ValueItr begin, ValueItr end, SceneObjectId parent);
 	void CreateSceneObject(ValueItr itr, SceneObjectId sceneObject);
 
-	void CreateComponents(ValueItr itr, ValueItr end, Entity entity);
-	void CreateRenderObject(ValueItr itr, Entity entity);
-	void CreateLight(ValueItr itr, Entity entity);
+	void CreateComponents(ValueItr itr, ValueItr end, Entity entity, SceneObjectId sceneObject);
+	void CreateRenderObject(ValueItr itr, Entity entity, SceneObjectId sceneObject);
+	void CreateLight(ValueItr itr, Entity entity, SceneObjectId sceneObject);
 
 public:
 	SceneLoader(Engine* engine, Scene* scene);
@@ -77,6 +77,8 @@ unsigned int SceneManager::CreateScene()
 
 		for (unsigned int i = 0; i < sceneCount; ++i)
 		{
+			// Move into a constructed scene, so that it can take over the old scene's arrays
+			new(&newScenes[i]) Scene(allocator, 0);
 			newScenes[i] = std::move(this->scenes[i]);
 			this->scenes[i].~Scene();
 		}
@@ -0,0 +1,250 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+#include "Core/Array.hpp"
+#include "Core/JobSystem.hpp"
+
+#include "Debug/PerformanceTimer.hpp"
+
+#include "Entity/Entity.hpp"
+
+#include "Math/Mat4x4.hpp"
+#include "Math/Transform.hpp"
+
+#include "Memory/Memory.hpp"
+
+#include "Scene/ITransformUpdateReceiver.hpp"
+#include "Scene/Scene.hpp"
+
+struct BenchmarkOptions
+{
+	unsigned int nodeCount;
+	unsigned int frameCount;
+
+	// Worker threads in addition to the main thread
+	unsigned int workerThreadCount;
+};
+
+enum class HierarchyShape
+{
+	// Long chains of single children
+	Deep,
+
+	// Roots with many direct children
+	Wide
+};
+
+enum class UpdatePattern
+{
+	// Every root moves, so every object is updated
+	Roots,
+
+	// A small fraction of all objects move
+	Sparse
+};
+
+class BenchmarkReceiver : public ITransformUpdateReceiver
+{
+public:
+	unsigned int updateCount;
+
+	BenchmarkReceiver() : updateCount(0)
+	{
+	}
+
+	virtual void NotifyUpdatedTransforms(unsigned int count, const unsigned int*, const Mat4x4f*)
+	{
+		updateCount += count;
+	}
+};
+
+static void PrintUsage()
+{
+	std::printf("Usage: kokko_scene_benchmark [-nodes <count>] [-frames <count>] [-threads <count>]\n"
+		"  -nodes <count>    Number of scene objects in each hierarchy, default 100000\n"
+		"  -frames <count>   Number of frames to update, default 100\n"
+		"  -threads <count>  Number of worker threads, default one less than the hardware threads\n");
+}
+
+static bool ParseOptions(int argc, char** argv, BenchmarkOptions& optionsOut)
+{
+	optionsOut.nodeCount = 100000;
+	optionsOut.frameCount = 100;
+
+	unsigned int hardwareThreads = std::thread::hardware_concurrency();
+	optionsOut.workerThreadCount = hardwareThreads > 1 ? hardwareThreads - 1 : 0;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		if (std::strcmp(argv[i], "-nodes") == 0 && i + 1 < argc)
+			optionsOut.nodeCount = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
+		else if (std::strcmp(argv[i], "-frames") == 0 && i + 1 < argc)
+			optionsOut.frameCount = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
+		else if (std::strcmp(argv[i], "-threads") == 0 && i + 1 < argc)
+			optionsOut.workerThreadCount = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
+		else
+			return false;
+	}
+
+	return optionsOut.nodeCount >= 1000 && optionsOut.frameCount > 0;
+}
+
+static unsigned int NextRandom(unsigned int& state)
+{
+	state = state * 1664525u + 1013904223u;
+	return state >> 8;
+}
+
+/**
+ * Create the hierarchy with object IDs in shuffled order, so that children
+ * are often added before their parents and the scene has to restore its order.
+ * Node n of the hierarchy gets the entity n + 1 and the component n + 1 in
+ * <receiver>, and roots are the nodes whose parent is themselves in <parentsOut>.
+ */
+static void BuildHierarchy(Allocator* allocator, Scene& scene, ITransformUpdateReceiver* receiver,
+	HierarchyShape shape, unsigned int nodeCount, Array<unsigned int>& parentsOut)
+{
+	const unsigned int rootCount = nodeCount / 1000;
+	const unsigned int nodesPerRoot = nodeCount / rootCount;
+
+	parentsOut.Resize(nodeCount);
+
+	for (unsigned int i = 0; i < nodeCount; ++i)
+	{
+		unsigned int root = i / nodesPerRoot;
+		unsigned int rootNode = root < rootCount ? root * nodesPerRoot : i;
+
+		if (i == rootNode)
+			parentsOut[i] = i;
+		else if (shape == HierarchyShape::Deep)
+			parentsOut[i] = i - 1;
+		else
+			parentsOut[i] = rootNode;
+	}
+
+	Array<unsigned int> addOrder(allocator);
+	addOrder.Resize(nodeCount);
+
+	for (unsigned int i = 0; i < nodeCount; ++i)
+		addOrder[i] = i;
+
+	unsigned int randomState = 1;
+	for (unsigned int i = nodeCount - 1; i > 0; --i)
+	{
+		unsigned int j = NextRandom(randomState) % (i + 1);
+		unsigned int temp = addOrder[i];
+		addOrder[i] = addOrder[j];
+		addOrder[j] = temp;
+	}
+
+	for (unsigned int i = 0; i < nodeCount; ++i)
+		scene.AddSceneObject(Entity::Make(addOrder[i] + 1, 0));
+
+	for (unsigned int i = 0; i < nodeCount; ++i)
+	{
+		SceneObjectId object = scene.Lookup(Entity::Make(i + 1, 0));
+
+		if (parentsOut[i] != i)
+			scene.SetParent(object, scene.Lookup(Entity::Make(parentsOut[i] + 1, 0)));
+
+		Transformf local = Transformf::Translate(Vec3f(0.0f, 1.0f, 0.0f));
+		scene.SetLocalTransform(object, local);
+		scene.AttachComponent(receiver, object, i + 1);
+	}
+}
+
+static void RunBenchmark(Allocator* allocator, JobSystem* jobSystem, const BenchmarkOptions& options,
+	HierarchyShape shape, UpdatePattern pattern)
+{
+	Scene scene(allocator, 1);
+	Array<unsigned int> parents(allocator);
+
+	BenchmarkReceiver receiver;
+
+	BuildHierarchy(allocator, scene, &receiver, shape, options.nodeCount, parents);
+
+	// The first update restores the hierarchy order and updates every object
+	PerformanceTimer buildTimer;
+	scene.UpdateWorldTransforms(jobSystem);
+	double buildMilliseconds = buildTimer.ElapsedSeconds() * 1000.0;
+
+	scene.NotifyUpdatedTransforms();
+	receiver.updateCount = 0;
+
+	// Entities that move each frame
+	Array<Entity> moving(allocator);
+
+	if (pattern == UpdatePattern::Roots)
+	{
+		for (unsigned int i = 0; i < options.nodeCount; ++i)
+			if (parents[i] == i)
+				moving.PushBack(Entity::Make(i + 1, 0));
+	}
+	else
+	{
+		unsigned int randomState = 2;
+		for (unsigned int i = 0, count = options.nodeCount / 100; i < count; ++i)
+			moving.PushBack(Entity::Make(NextRandom(randomState) % options.nodeCount + 1, 0));
+	}
+
+	double updateSeconds = 0.0;
+	double notifySeconds = 0.0;
+
+	for (unsigned int frame = 0; frame < options.frameCount; ++frame)
+	{
+		PerformanceTimer updateTimer;
+
+		Transformf local = Transformf::Translate(Vec3f(static_cast<float>(frame), 1.0f, 0.0f));
+
+		for (unsigned int i = 0, count = moving.GetCount(); i < count; ++i)
+			scene.SetLocalTransform(scene.Lookup(moving[i]), local);
+
+		scene.UpdateWorldTransforms(jobSystem);
+
+		updateSeconds += updateTimer.ElapsedSeconds();
+
+		PerformanceTimer notifyTimer;
+		scene.NotifyUpdatedTransforms();
+		notifySeconds += notifyTimer.ElapsedSeconds();
+	}
+
+	std::printf("%-5s %-7s %10u %12.3f %12.4f %12.4f\n",
+		shape == HierarchyShape::Deep ? "Deep" : "Wide",
+		pattern == UpdatePattern::Roots ? "Roots" : "Sparse",
+		receiver.updateCount / options.frameCount, buildMilliseconds,
+		updateSeconds * 1000.0 / options.frameCount, notifySeconds * 1000.0 / options.frameCount);
+}
+
+int main(int argc, char** argv)
+{
+	BenchmarkOptions options;
+
+	if (ParseOptions(argc, argv, options) == false)
+	{
+		PrintUsage();
+		return -1;
+	}
+
+	Memory::InitializeMemorySystem();
+
+	Allocator* allocator = Memory::GetDefaultAllocator();
+
+	std::printf("Worker threads: %u\n", options.workerThreadCount);
+	std::printf("%-5s %-7s %10s %12s %12s %12s\n",
+		"Shape", "Moves", "Updates", "First ms", "Update ms", "Notify ms");
+
+	{
+		JobSystem jobSystem(allocator, options.workerThreadCount);
+
+		RunBenchmark(allocator, &jobSystem, options, HierarchyShape::Deep, UpdatePattern::Roots);
+		RunBenchmark(allocator, &jobSystem, options, HierarchyShape::Deep, UpdatePattern::Sparse);
+		RunBenchmark(allocator, &jobSystem, options, HierarchyShape::Wide, UpdatePattern::Roots);
+		RunBenchmark(allocator, &jobSystem, options, HierarchyShape::Wide, UpdatePattern::Sparse);
+	}
+
+	Memory::DeinitializeMemorySystem();
+
+	return 0;
+}
@@ -14,7 +14,8 @@ Window::Window(Allocator* allocator) :
 	allocator(allocator),
 	windowHandle(nullptr),
 	inputManager(nullptr),
-	currentSwapInterval(0)
+	currentSwapInterval(0),
+	swapIntervalChanged(false)
 {
 }
 
@@ -85,10 +86,33 @@ void Window::UpdateInput()
 
 void Window::Swap()
 {
+	this->SwapBuffers();
+	this->PollEvents();
+}
+
+void Window::SwapBuffers()
+{
+	if (swapIntervalChanged.exchange(false))
+		glfwSwapInterval(currentSwapInterval.load());
+
 	glfwSwapBuffers(windowHandle);
+}
+
+void Window::PollEvents()
+{
 	glfwPollEvents();
 }
 
+void Window::MakeContextCurrent()
+{
+	glfwMakeContextCurrent(windowHandle);
+}
+
+void Window::ReleaseCurrentContext()
+{
+	glfwMakeContextCurrent(nullptr);
+}
+
 Vec2i Window::GetFrameBufferSize()
 {
 	int width, height;
@@ -137,7 +161,11 @@ Mat4x4f Window::GetScreenSpaceProjectionMatrix()
 void Window::SetSwapInterval(int swapInterval)
 {
 	this->currentSwapInterval = swapInterval;
-	glfwSwapInterval(swapInterval);
+
+	if (glfwGetCurrentContext() == windowHandle)
+		glfwSwapInterval(swapInterval);
+	else
+		swapIntervalChanged = true;
 }
 
 Window* Window::GetWindowObject(GLFWwindow* windowHandle)
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <atomic>
+
 #include "Math/Vec2.hpp"
 #include "Math/Mat4x4.hpp"
 
@@ -16,7 +18,10 @@ private:
 	
 	InputManager* inputManager;
 
-	int currentSwapInterval;
+	// The context can be current on another thread than the one that
+	// changes the swap interval, so the change is applied on the next swap
+	std::atomic<int> currentSwapInterval;
+	std::atomic<bool> swapIntervalChanged;
 	
 public:
 	Window(Allocator* allocator);
@@ -26,6 +31,28 @@ public:
 	bool ShouldClose();
 	void UpdateInput();
 	void Swap();
+
+	/*
+	Swap buffers without processing window events. Can be called on any thread
+	that has the window's context current.
+	*/
+	void SwapBuffers();
+
+	/*
+	Process window events. Must be called on the main thread.
+	*/
+	void PollEvents();
+
+	/*
+	Make the window's OpenGL context current on the calling thread.
+	The context can only be current on one thread at a time.
+	*/
+	void MakeContextCurrent();
+
+	/*
+	Detach the current OpenGL context from the calling thread
+	*/
+	static void ReleaseCurrentContext();
 	
 	/*
 	Get framebuffer size in pixels
@@ -52,7 +79,7 @@ public:
 	0: vsync off, 1: vsync every refresh, n: vsync once every n refreshes
 	*/
 	void SetSwapInterval(int swapInterval);
-	int GetSwapInterval() const { return currentSwapInterval; }
+	int GetSwapInterval() const { return currentSwapInterval.load(); }
 
 	InputManager* GetInputManager() { return inputManager; }
 	
@@ -0,0 +1,250 @@
+#include "Test/Test.hpp"
+
+#include "Core/Array.hpp"
+
+#include "Rendering/DrawBatchBuilder.hpp"
+
+using Draw = DrawBatchBuilder::Draw;
+using Batch = DrawBatchBuilder::Batch;
+
+static Draw MakeDraw(DrawBatchType type, unsigned int material, unsigned int mesh, unsigned int vertexArray)
+{
+	Draw draw;
+	draw.viewport = 0;
+	draw.pass = 0;
+	draw.material = material;
+	draw.mesh = mesh;
+	draw.vertexArray = vertexArray;
+	draw.indexCount = 6 + mesh;
+	draw.primitiveMode = RenderPrimitiveMode::Triangles;
+	draw.indexType = RenderIndexType::UnsignedShort;
+	draw.type = type;
+	return draw;
+}
+
+static bool BatchIs(const Batch& batch, DrawBatchType type, unsigned int firstDraw, unsigned int drawCount)
+{
+	return batch.type == type && batch.firstDraw == firstDraw && batch.drawCount == drawCount;
+}
+
+// Batches must cover every draw exactly once and in order
+static bool BatchesCoverDraws(const Array<Batch>& batches, unsigned int drawCount)
+{
+	unsigned int next = 0;
+
+	for (unsigned int i = 0, count = batches.GetCount(); i < count; ++i)
+	{
+		if (batches[i].firstDraw != next || batches[i].drawCount == 0)
+			return false;
+
+		next += batches[i].drawCount;
+	}
+
+	return next == drawCount;
+}
+
+static void TestEmpty(Test::Context& context, DrawBatchBuilder& builder, const DrawBatchBuilder::Params& params)
+{
+	builder.Build(params, 0, nullptr);
+
+	KOKKO_TEST_CHECK(context, builder.GetBatches().GetCount() == 0);
+	KOKKO_TEST_CHECK(context, builder.GetIndirectCommands().GetCount() == 0);
+}
+
+static void TestSingle(Test::Context& context, DrawBatchBuilder& builder, const DrawBatchBuilder::Params& params)
+{
+	// Identical draws are never combined if the material doesn't allow it
+	Draw draws[3];
+	for (Draw& draw : draws)
+		draw = MakeDraw(DrawBatchType::Single, 1, 1, 10);
+
+	builder.Build(params, 3, draws);
+	const Array<Batch>& batches = builder.GetBatches();
+
+	KOKKO_TEST_CHECK(context, batches.GetCount() == 3);
+	KOKKO_TEST_CHECK(context, BatchesCoverDraws(batches, 3));
+	KOKKO_TEST_CHECK(context, builder.GetIndirectCommands().GetCount() == 0);
+
+	for (unsigned int i = 0; i < batches.GetCount(); ++i)
+		KOKKO_TEST_CHECK(context, BatchIs(batches[i], DrawBatchType::Single, i, 1));
+}
+
+static void TestInstanced(Test::Context& context, DrawBatchBuilder& builder, const DrawBatchBuilder::Params& params)
+{
+	Array<Draw> draws(context.allocator);
+
+	// Run of 4 with the same mesh and material
+	for (unsigned int i = 0; i < 4; ++i)
+		draws.PushBack(MakeDraw(DrawBatchType::Instanced, 1, 1, 10));
+
+	// Different mesh with the same vertex array ends the run
+	draws.PushBack(MakeDraw(DrawBatchType::Instanced, 1, 2, 10));
+	draws.PushBack(MakeDraw(DrawBatchType::Instanced, 1, 2, 10));
+
+	// Different material ends the run
+	draws.PushBack(MakeDraw(DrawBatchType::Instanced, 2, 2, 10));
+	draws.PushBack(MakeDraw(DrawBatchType::Instanced, 2, 2, 10));
+
+	// Different pass ends the run
+	Draw passDraw = MakeDraw(DrawBatchType::Instanced, 2, 2, 10);
+	passDraw.pass = 1;
+	draws.PushBack(passDraw);
+	draws.PushBack(passDraw);
+
+	// Different viewport ends the run
+	Draw viewportDraw = passDraw;
+	viewportDraw.viewport = 1;
+	draws.PushBack(viewportDraw);
+	draws.PushBack(viewportDraw);
+
+	// Same mesh and material, but the second one doesn't allow instancing
+	draws.PushBack(MakeDraw(DrawBatchType::Instanced, 3, 3, 11));
+	draws.PushBack(MakeDraw(DrawBatchType::Single, 3, 3, 11));
+
+	builder.Build(params, draws.GetCount(), draws.GetData());
+	const Array<Batch>& batches = builder.GetBatches();
+
+	KOKKO_TEST_CHECK(context, BatchesCoverDraws(batches, draws.GetCount()));
+	KOKKO_TEST_CHECK(context, builder.GetIndirectCommands().GetCount() == 0);
+
+	if (batches.GetCount() == 7)
+	{
+		KOKKO_TEST_CHECK(context, BatchIs(batches[0], DrawBatchType::Instanced, 0, 4));
+		KOKKO_TEST_CHECK(context, BatchIs(batches[1], DrawBatchType::Instanced, 4, 2));
+		KOKKO_TEST_CHECK(context, BatchIs(batches[2], DrawBatchType::Instanced, 6, 2));
+		KOKKO_TEST_CHECK(context, BatchIs(batches[3], DrawBatchType::Instanced, 8, 2));
+		KOKKO_TEST_CHECK(context, BatchIs(batches[4], DrawBatchType::Instanced, 10, 2));
+
+		// Run of one is below the threshold
+		KOKKO_TEST_CHECK(context, BatchIs(batches[5], DrawBatchType::Single, 12, 1));
+		KOKKO_TEST_CHECK(context, BatchIs(batches[6], DrawBatchType::Single, 13, 1));
+	}
+	else
+		KOKKO_TEST_CHECK(context, batches.GetCount() == 7);
+}
+
+static void TestInstancingThreshold(Test::Context& context, DrawBatchBuilder& builder)
+{
+	Draw draws[5];
+	for (Draw& draw : draws)
+		draw = MakeDraw(DrawBatchType::Instanced, 1, 1, 10);
+
+	DrawBatchBuilder::Params params;
+
+	// A run exactly as long as the threshold is instanced
+	params.instancingThreshold = 5;
+	builder.Build(params, 5, draws);
+
+	KOKKO_TEST_CHECK(context, builder.GetBatches().GetCount() == 1);
+	KOKKO_TEST_CHECK(context, BatchIs(builder.GetBatches()[0], DrawBatchType::Instanced, 0, 5));
+
+	// A shorter run is split into single draws
+	params.instancingThreshold = 6;
+	builder.Build(params, 5, draws);
+	const Array<Batch>& batches = builder.GetBatches();
+
+	KOKKO_TEST_CHECK(context, batches.GetCount() == 5);
+	KOKKO_TEST_CHECK(context, BatchesCoverDraws(batches, 5));
+
+	for (unsigned int i = 0; i < batches.GetCount(); ++i)
+		KOKKO_TEST_CHECK(context, batches[i].type == DrawBatchType::Single);
+}
+
+static void TestIndirect(Test::Context& context, DrawBatchBuilder& builder, const DrawBatchBuilder::Params& params)
+{
+	Array<Draw> draws(context.allocator);
+
+	// Different meshes in the same vertex array share a batch
+	draws.PushBack(MakeDraw(DrawBatchType::Indirect, 1, 1, 10));
+	draws.PushBack(MakeDraw(DrawBatchType::Indirect, 1, 2, 10));
+	draws.PushBack(MakeDraw(DrawBatchType::Indirect, 1, 3, 10));
+
+	// Different vertex array ends the batch
+	draws.PushBack(MakeDraw(DrawBatchType::Indirect, 1, 4, 11));
+
+	// Different index type ends the batch
+	Draw indexDraw = MakeDraw(DrawBatchType::Indirect, 1, 4, 11);
+	indexDraw.indexType = RenderIndexType::UnsignedInt;
+	draws.PushBack(indexDraw);
+
+	// Different primitive mode ends the batch
+	Draw primitiveDraw = indexDraw;
+	primitiveDraw.primitiveMode = RenderPrimitiveMode::Lines;
+	draws.PushBack(primitiveDraw);
+
+	// Instanced draw between indirect ones
+	draws.PushBack(MakeDraw(DrawBatchType::Instanced, 1, 5, 12));
+	draws.PushBack(MakeDraw(DrawBatchType::Indirect, 1, 5, 12));
+
+	builder.Build(params, draws.GetCount(), draws.GetData());
+	const Array<Batch>& batches = builder.GetBatches();
+	const auto& commands = builder.GetIndirectCommands();
+
+	KOKKO_TEST_CHECK(context, BatchesCoverDraws(batches, draws.GetCount()));
+
+	if (batches.GetCount() == 6)
+	{
+		KOKKO_TEST_CHECK(context, BatchIs(batches[0], DrawBatchType::Indirect, 0, 3));
+		KOKKO_TEST_CHECK(context, BatchIs(batches[1], DrawBatchType::Indirect, 3, 1));
+		KOKKO_TEST_CHECK(context, BatchIs(batches[2], DrawBatchType::Indirect, 4, 1));
+		KOKKO_TEST_CHECK(context, BatchIs(batches[3], DrawBatchType::Indirect, 5, 1));
+		KOKKO_TEST_CHECK(context, BatchIs(batches[4], DrawBatchType::Single, 6, 1));
+		KOKKO_TEST_CHECK(context, BatchIs(batches[5], DrawBatchType::Indirect, 7, 1));
+
+		// Indirect commands of each batch are consecutive, starting from firstIndirectCommand
+		KOKKO_TEST_CHECK(context, batches[0].firstIndirectCommand == 0);
+		KOKKO_TEST_CHECK(context, batches[1].firstIndirectCommand == 3);
+		KOKKO_TEST_CHECK(context, batches[2].firstIndirectCommand == 4);
+		KOKKO_TEST_CHECK(context, batches[3].firstIndirectCommand == 5);
+		KOKKO_TEST_CHECK(context, batches[5].firstIndirectCommand == 6);
+	}
+	else
+		KOKKO_TEST_CHECK(context, batches.GetCount() == 6);
+
+	// One command per indirect draw, locating the draw with the base instance
+	KOKKO_TEST_CHECK(context, commands.GetCount() == 7);
+
+	const unsigned int indirectDraws[] = { 0, 1, 2, 3, 4, 5, 7 };
+
+	for (unsigned int i = 0; i < commands.GetCount() && i < 7; ++i)
+	{
+		const Draw& draw = draws[indirectDraws[i]];
+
+		KOKKO_TEST_CHECK(context, commands[i].count == static_cast<unsigned int>(draw.indexCount));
+		KOKKO_TEST_CHECK(context, commands[i].instanceCount == 1);
+		KOKKO_TEST_CHECK(context, commands[i].firstIndex == 0);
+		KOKKO_TEST_CHECK(context, commands[i].baseVertex == 0);
+		KOKKO_TEST_CHECK(context, commands[i].baseInstance == indirectDraws[i]);
+	}
+}
+
+static void TestRebuild(Test::Context& context, DrawBatchBuilder& builder, const DrawBatchBuilder::Params& params)
+{
+	// Building again replaces the previous batches and commands
+	Draw indirect[2] = {
+		MakeDraw(DrawBatchType::Indirect, 1, 1, 10),
+		MakeDraw(DrawBatchType::Indirect, 1, 2, 10)
+	};
+
+	builder.Build(params, 2, indirect);
+	builder.Build(params, 1, indirect);
+
+	KOKKO_TEST_CHECK(context, builder.GetBatches().GetCount() == 1);
+	KOKKO_TEST_CHECK(context, builder.GetIndirectCommands().GetCount() == 1);
+}
+
+void Test::TestDrawBatchBuilder(Context& context)
+{
+	DrawBatchBuilder builder(context.allocator);
+
+	DrawBatchBuilder::Params params;
+	params.instancingThreshold = 2;
+
+	TestEmpty(context, builder, params);
+	TestSingle(context, builder, params);
+	TestInstanced(context, builder, params);
+	TestInstancingThreshold(context, builder);
+	TestIndirect(context, builder, params);
+	TestRebuild(context, builder, params);
+	TestEmpty(context, builder, params);
+}
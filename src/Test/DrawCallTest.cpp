@@ -0,0 +1,172 @@
+#include "Test/Test.hpp"
+
+#include "Core/Array.hpp"
+
+#include "Rendering/DrawBatchBuilder.hpp"
+#include "Rendering/RenderDeviceRecorder.hpp"
+
+using Draw = DrawBatchBuilder::Draw;
+using Stats = RenderDeviceRecorder::Stats;
+
+static unsigned int GetCallCount(const Stats& stats, RenderDeviceRecorder::Call call)
+{
+	return stats.callCounts[static_cast<size_t>(call)];
+}
+
+static void AddDraws(Array<Draw>& draws, unsigned int count, unsigned int viewport,
+	unsigned int material, unsigned int mesh, DrawBatchType type)
+{
+	for (unsigned int i = 0; i < count; ++i)
+	{
+		Draw draw;
+		draw.viewport = viewport;
+		draw.pass = 0;
+		draw.material = material;
+		draw.mesh = mesh;
+		draw.vertexArray = 100 + mesh;
+		draw.indexCount = 36 * mesh;
+		draw.primitiveMode = RenderPrimitiveMode::Triangles;
+		draw.indexType = RenderIndexType::UnsignedShort;
+		draw.type = type;
+		draws.PushBack(draw);
+	}
+}
+
+/*
+* Sorted draws of a scene like the one App::Initialize creates: 200 pillars
+* with the same mesh and material, and a few unique objects. Everything is
+* drawn in the main viewport and in one shadow cascade.
+*/
+static void CreatePillarScene(Array<Draw>& draws, DrawBatchType pillarType, DrawBatchType otherType)
+{
+	draws.Clear();
+
+	for (unsigned int viewport = 0; viewport < 2; ++viewport)
+	{
+		AddDraws(draws, 200, viewport, 1, 1, pillarType);
+		AddDraws(draws, 1, viewport, 2, 2, otherType);
+		AddDraws(draws, 1, viewport, 2, 3, otherType);
+		AddDraws(draws, 1, viewport, 3, 4, otherType);
+	}
+}
+
+/*
+* Submit the batches of <draws> to a null device the way Renderer::RenderCommands
+* does, binding the shader and vertex array only when they change.
+*/
+static Stats SubmitDraws(Allocator* allocator, const Array<Draw>& draws, unsigned int instancingThreshold)
+{
+	DrawBatchBuilder builder(allocator);
+
+	DrawBatchBuilder::Params params;
+	params.instancingThreshold = instancingThreshold;
+	builder.Build(params, draws.GetCount(), draws.GetData());
+
+	RenderDeviceRecorder device(allocator, nullptr);
+
+	const auto& indirectCommands = builder.GetIndirectCommands();
+	if (indirectCommands.GetCount() > 0)
+	{
+		unsigned int buffer = 0;
+		device.CreateBuffers(1, &buffer);
+		device.BindBuffer(RenderBufferTarget::DrawIndirectBuffer, buffer);
+		device.SetBufferData(RenderBufferTarget::DrawIndirectBuffer,
+			indirectCommands.GetCount() * sizeof(RenderCommandData::DrawIndexedIndirectCommand),
+			indirectCommands.GetData(), RenderBufferUsage::StaticDraw);
+	}
+
+	device.ResetStats();
+
+	unsigned int lastMaterial = 0;
+	unsigned int lastMesh = 0;
+
+	const Array<DrawBatchBuilder::Batch>& batches = builder.GetBatches();
+	for (unsigned int i = 0, count = batches.GetCount(); i < count; ++i)
+	{
+		const DrawBatchBuilder::Batch& batch = batches[i];
+		const Draw& firstDraw = draws[batch.firstDraw];
+
+		if (firstDraw.material != lastMaterial)
+		{
+			device.UseShaderProgram(firstDraw.material);
+			lastMaterial = firstDraw.material;
+		}
+
+		if (firstDraw.mesh != lastMesh)
+		{
+			device.BindVertexArray(firstDraw.vertexArray);
+			lastMesh = firstDraw.mesh;
+		}
+
+		DrawBatchBuilder::DrawBatch(&device, batch, firstDraw, 0);
+	}
+
+	return device.GetStats();
+}
+
+void Test::TestDrawCalls(Context& context)
+{
+	using Call = RenderDeviceRecorder::Call;
+
+	Array<Draw> draws(context.allocator);
+
+	CreatePillarScene(draws, DrawBatchType::Single, DrawBatchType::Single);
+	const unsigned int drawCount = draws.GetCount();
+	Stats single = SubmitDraws(context.allocator, draws, 2);
+
+	// Without batching every object is its own draw call
+	KOKKO_TEST_CHECK(context, single.drawCalls == drawCount);
+	KOKKO_TEST_CHECK(context, single.drawnInstances == drawCount);
+
+	const unsigned int shaderChanges = GetCallCount(single, Call::UseShaderProgram);
+	const unsigned int vertexArrayChanges = GetCallCount(single, Call::BindVertexArray);
+
+	// Instancing and indirect draws must cut draw calls by an order of magnitude,
+	// draw every object once, and not add state changes
+	const DrawBatchType batchedTypes[] = { DrawBatchType::Instanced, DrawBatchType::Indirect };
+
+	for (DrawBatchType type : batchedTypes)
+	{
+		CreatePillarScene(draws, type, type);
+		Stats batched = SubmitDraws(context.allocator, draws, 2);
+
+		KOKKO_TEST_CHECK(context, batched.drawCalls * 10 <= single.drawCalls);
+		KOKKO_TEST_CHECK(context, batched.drawnInstances == drawCount);
+		KOKKO_TEST_CHECK(context, GetCallCount(batched, Call::UseShaderProgram) == shaderChanges);
+		KOKKO_TEST_CHECK(context, GetCallCount(batched, Call::BindVertexArray) <= vertexArrayChanges);
+	}
+
+	{
+		CreatePillarScene(draws, DrawBatchType::Instanced, DrawBatchType::Instanced);
+		Stats instanced = SubmitDraws(context.allocator, draws, 2);
+
+		// One instanced draw per viewport for the pillars, the unique objects are drawn singly
+		KOKKO_TEST_CHECK(context, instanced.drawCalls == 8);
+		KOKKO_TEST_CHECK(context, GetCallCount(instanced, Call::DrawIndexedInstancedBaseInstance) == 8);
+	}
+
+	{
+		CreatePillarScene(draws, DrawBatchType::Indirect, DrawBatchType::Indirect);
+		Stats indirect = SubmitDraws(context.allocator, draws, 2);
+
+		// Indirect draws only need the same vertex array, so different meshes can share a call
+		KOKKO_TEST_CHECK(context, GetCallCount(indirect, Call::MultiDrawIndexedIndirect) == indirect.drawCalls);
+		KOKKO_TEST_CHECK(context, indirect.drawCalls == 8);
+	}
+
+	{
+		// A material that opts out of instancing keeps one draw call per object
+		CreatePillarScene(draws, DrawBatchType::Single, DrawBatchType::Instanced);
+		Stats optOut = SubmitDraws(context.allocator, draws, 2);
+
+		KOKKO_TEST_CHECK(context, optOut.drawCalls == drawCount);
+	}
+
+	{
+		// Runs shorter than the threshold are not instanced
+		CreatePillarScene(draws, DrawBatchType::Instanced, DrawBatchType::Instanced);
+		Stats highThreshold = SubmitDraws(context.allocator, draws, 201);
+
+		KOKKO_TEST_CHECK(context, highThreshold.drawCalls == drawCount);
+	}
+}
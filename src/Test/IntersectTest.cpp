@@ -0,0 +1,149 @@
+#include "Test/Test.hpp"
+
+#include <cstdint>
+#include <cstring>
+
+#include "Core/Array.hpp"
+#include "Core/BitPack.hpp"
+
+#include "Math/BoundingBox.hpp"
+#include "Math/Frustum.hpp"
+#include "Math/Intersect3D.hpp"
+#include "Math/Mat4x4.hpp"
+#include "Math/Projection.hpp"
+
+static bool PacksEqual(const Array<BitPack>& a, const Array<BitPack>& b)
+{
+	return std::memcmp(a.GetData(), b.GetData(), a.GetCount() * sizeof(BitPack)) == 0;
+}
+
+static void CheckSizeEstimates(Test::Context& context, ProjectionType projectionType, uint64_t& state)
+{
+	const unsigned int count = 5000;
+	const unsigned int packCount = BitPack::CalculateRequired(count);
+
+	ProjectionParameters params;
+	params.projection = projectionType;
+	params.height = projectionType == ProjectionType::Perspective ? Test::NextRandomFloat(state, 0.5f, 2.0f) : 40.0f;
+	params.aspect = Test::NextRandomFloat(state, 0.5f, 2.5f);
+	params.near = 0.1f;
+	params.far = 200.0f;
+
+	Vec3f eye(Test::NextRandomFloat(state, -50.0f, 50.0f), Test::NextRandomFloat(state, -50.0f, 50.0f),
+		Test::NextRandomFloat(state, -50.0f, 50.0f));
+	Vec3f angles(Test::NextRandomFloat(state, -3.0f, 3.0f), Test::NextRandomFloat(state, -3.0f, 3.0f),
+		Test::NextRandomFloat(state, -3.0f, 3.0f));
+	Mat4x4f cameraTransform = Mat4x4f::Translate(eye) * Mat4x4f::RotateEuler(angles);
+
+	FrustumPlanes frustum;
+	frustum.Update(params, cameraTransform);
+
+	Mat4x4f view = cameraTransform.GetInverse();
+	Mat4x4f projection = params.GetProjectionMatrix(true);
+	Mat4x4f viewProjection = projection * view;
+	Vec2f viewportSize(Test::NextRandomFloat(state, 320.0f, 2560.0f), Test::NextRandomFloat(state, 240.0f, 1440.0f));
+	float minimumSizePx = Test::NextRandomFloat(state, 1.0f, 20.0f);
+
+	Array<BoundingBox> boxes(context.allocator);
+	Array<float> soaData(context.allocator);
+	boxes.Resize(count);
+	soaData.Resize(count * 6);
+
+	BoundingBoxSoA soa{
+		soaData.GetData() + count * 0, soaData.GetData() + count * 1, soaData.GetData() + count * 2,
+		soaData.GetData() + count * 3, soaData.GetData() + count * 4, soaData.GetData() + count * 5
+	};
+
+	// Spread boxes around the camera, with extents from well below to well
+	// above the size threshold and some boxes crossing the near plane
+	for (unsigned int i = 0; i < count; ++i)
+	{
+		float size = Test::NextRandomFloat(state, 0.001f, 2.0f);
+		size = size * size;
+
+		BoundingBox& box = boxes[i];
+		box.center = eye + Vec3f(Test::NextRandomFloat(state, -100.0f, 100.0f),
+			Test::NextRandomFloat(state, -100.0f, 100.0f), Test::NextRandomFloat(state, -100.0f, 100.0f));
+		box.extents = Vec3f(size * Test::NextRandomFloat(state, 0.1f, 1.0f),
+			size * Test::NextRandomFloat(state, 0.1f, 1.0f), size * Test::NextRandomFloat(state, 0.1f, 1.0f));
+
+		soa.Set(i, box);
+	}
+
+	Array<BitPack> corners(context.allocator);
+	Array<BitPack> cornersSoA(context.allocator);
+	Array<BitPack> sphere(context.allocator);
+	Array<BitPack> sphereSoA(context.allocator);
+	Array<BitPack> rejected(context.allocator);
+	corners.Resize(packCount);
+	cornersSoA.Resize(packCount);
+	sphere.Resize(packCount);
+	sphereSoA.Resize(packCount);
+	rejected.Resize(packCount);
+
+	for (unsigned int i = 0; i < packCount; ++i)
+	{
+		corners[i].data = 0;
+		sphere[i].data = 0;
+		rejected[i].data = 0;
+	}
+
+	Intersect::FrustumAABBMinSize(frustum, viewProjection, viewportSize, minimumSizePx,
+		count, boxes.GetData(), corners.GetData());
+	Intersect::FrustumAABBMinSizeSoA(frustum, viewProjection, viewportSize, minimumSizePx,
+		count, soa, cornersSoA.GetData());
+	Intersect::FrustumAABBMinSphereSize(frustum, view, projection, viewportSize, minimumSizePx,
+		count, boxes.GetData(), sphere.GetData());
+	Intersect::FrustumAABBMinSphereSizeSoA(frustum, view, projection, viewportSize, minimumSizePx,
+		count, soa, sphereSoA.GetData());
+
+	KOKKO_TEST_CHECK(context, PacksEqual(corners, cornersSoA));
+	KOKKO_TEST_CHECK(context, PacksEqual(sphere, sphereSoA));
+
+	// Size rejection after plain frustum culling gives the same result
+	Intersect::FrustumAABB(frustum, count, boxes.GetData(), rejected.GetData());
+
+	unsigned int frustumVisible = 0;
+	for (unsigned int i = 0; i < count; ++i)
+		frustumVisible += BitPack::Get(rejected.GetData(), i) ? 1 : 0;
+
+	Intersect::RejectSmallAABBSphere(view, projection, viewportSize, minimumSizePx,
+		count, boxes.GetData(), rejected.GetData());
+
+	KOKKO_TEST_CHECK(context, PacksEqual(sphere, rejected));
+
+	// The sphere estimate is conservative: it never rejects a box that the
+	// corner estimate keeps
+	unsigned int falseRejections = 0;
+	unsigned int cornersVisible = 0;
+	unsigned int sphereVisible = 0;
+
+	for (unsigned int i = 0; i < count; ++i)
+	{
+		bool cornersKeep = BitPack::Get(corners.GetData(), i);
+		bool sphereKeep = BitPack::Get(sphere.GetData(), i);
+
+		if (cornersKeep && sphereKeep == false)
+			falseRejections += 1;
+
+		cornersVisible += cornersKeep ? 1 : 0;
+		sphereVisible += sphereKeep ? 1 : 0;
+	}
+
+	KOKKO_TEST_CHECK(context, falseRejections == 0);
+
+	// Make sure the scene actually exercises the size test
+	KOKKO_TEST_CHECK(context, cornersVisible > 0);
+	KOKKO_TEST_CHECK(context, cornersVisible < frustumVisible);
+}
+
+void Test::TestIntersect(Context& context)
+{
+	uint64_t state = 0x9e3779b97f4a7c15ULL;
+
+	for (unsigned int iteration = 0; iteration < 20; ++iteration)
+	{
+		CheckSizeEstimates(context, ProjectionType::Perspective, state);
+		CheckSizeEstimates(context, ProjectionType::Orthographic, state);
+	}
+}
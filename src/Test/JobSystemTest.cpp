@@ -0,0 +1,112 @@
+#include "Test/Test.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+
+#include "Core/Array.hpp"
+#include "Core/JobSystem.hpp"
+
+static void CheckParallelForCoverage(Test::Context& context, JobSystem& jobSystem)
+{
+	const unsigned int counts[] = { 0, 1, 7, 1000, 100000 };
+	const unsigned int grains[] = { 1, 3, 64, 1000, 200000 };
+
+	const unsigned int maxCount = 100000;
+	std::atomic<unsigned int>* visits = new std::atomic<unsigned int>[maxCount];
+
+	for (unsigned int count : counts)
+	{
+		for (unsigned int grain : grains)
+		{
+			for (unsigned int i = 0; i < count; ++i)
+				visits[i].store(0);
+
+			std::atomic<unsigned int> oversizedRanges(0);
+
+			jobSystem.ParallelFor(count, grain, [&](unsigned int begin, unsigned int end)
+			{
+				if (end - begin > grain)
+					oversizedRanges.fetch_add(1);
+
+				for (unsigned int i = begin; i < end; ++i)
+					visits[i].fetch_add(1);
+			});
+
+			unsigned int wrongVisits = 0;
+			for (unsigned int i = 0; i < count; ++i)
+				if (visits[i].load() != 1)
+					wrongVisits += 1;
+
+			KOKKO_TEST_CHECK(context, wrongVisits == 0);
+
+			if (jobSystem.GetWorkerCount() > 1)
+				KOKKO_TEST_CHECK(context, oversizedRanges.load() == 0);
+		}
+	}
+
+	delete[] visits;
+}
+
+void Test::TestJobSystem(Context& context)
+{
+	// Runs everything on the calling thread
+	{
+		JobSystem jobSystem(context.allocator, 0);
+		CheckParallelForCoverage(context, jobSystem);
+	}
+
+	{
+		JobSystem jobSystem(context.allocator, 3);
+		CheckParallelForCoverage(context, jobSystem);
+
+		// ParallelFor pushes all jobs to the calling thread's queue, so any job
+		// that runs on another thread was stolen. Each job sleeps, which gives
+		// the workers time to wake up even on a single core.
+		std::mutex threadMutex;
+		std::thread::id threadIds[64];
+		unsigned int threadIdCount = 0;
+
+		std::thread::id callingThread = std::this_thread::get_id();
+
+		jobSystem.ParallelFor(64, 1, [&](unsigned int begin, unsigned int end)
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+			std::lock_guard<std::mutex> lock(threadMutex);
+			threadIds[begin] = std::this_thread::get_id();
+			threadIdCount += end - begin;
+		});
+
+		unsigned int stolenCount = 0;
+		for (unsigned int i = 0; i < threadIdCount; ++i)
+			if (threadIds[i] != callingThread)
+				stolenCount += 1;
+
+		KOKKO_TEST_CHECK(context, threadIdCount == 64);
+		KOKKO_TEST_CHECK(context, stolenCount > 0);
+
+		// More jobs than a queue can hold run right away on the submitting thread
+		const unsigned int jobCount = 5000;
+		std::atomic<unsigned int> runCount(0);
+
+		auto jobFunction = [](void* userData, unsigned int begin, unsigned int end)
+		{
+			static_cast<std::atomic<unsigned int>*>(userData)->fetch_add(end - begin);
+		};
+
+		Array<JobSystem::Job> jobs(context.allocator);
+		jobs.Resize(jobCount);
+
+		for (unsigned int i = 0; i < jobCount; ++i)
+			jobs[i] = JobSystem::Job{ jobFunction, &runCount, i, i + 1, nullptr };
+
+		JobCounter counter;
+		jobSystem.Submit(jobCount, jobs.GetData(), &counter);
+		jobSystem.Wait(&counter);
+
+		KOKKO_TEST_CHECK(context, counter.IsComplete());
+		KOKKO_TEST_CHECK(context, runCount.load() == jobCount);
+	}
+}
@@ -0,0 +1,142 @@
+#include "Test/Test.hpp"
+
+#include <cmath>
+#include <cstdint>
+
+#include "Math/Mat3x3.hpp"
+#include "Math/Mat3x4.hpp"
+#include "Math/Mat4x4.hpp"
+#include "Math/Quat.hpp"
+#include "Math/Transform.hpp"
+
+static Vec3f NextRandomVec3(uint64_t& state, float min, float max)
+{
+	float x = Test::NextRandomFloat(state, min, max);
+	float y = Test::NextRandomFloat(state, min, max);
+	float z = Test::NextRandomFloat(state, min, max);
+	return Vec3f(x, y, z);
+}
+
+static float MaxDifference(const float* a, const float* b, unsigned int count)
+{
+	float result = 0.0f;
+
+	for (unsigned int i = 0; i < count; ++i)
+		result = std::fmax(result, std::fabs(a[i] - b[i]));
+
+	return result;
+}
+
+static float MaxDifference(const Mat4x4f& a, const Mat4x4f& b)
+{
+	return MaxDifference(a.ValuePointer(), b.ValuePointer(), 16);
+}
+
+static float MaxDifference(const Mat3x3f& a, const Mat3x3f& b)
+{
+	return MaxDifference(a.ValuePointer(), b.ValuePointer(), 9);
+}
+
+static float MaxDifference(const Vec3f& a, const Vec3f& b)
+{
+	return MaxDifference(a.ValuePointer(), b.ValuePointer(), 3);
+}
+
+// Quaternion rotations match the rotation matrices they replace
+static void CheckQuaternions(Test::Context& context, uint64_t& state)
+{
+	float eulerError = 0.0f;
+	float axisError = 0.0f;
+	float productError = 0.0f;
+	float conjugateError = 0.0f;
+	float vectorError = 0.0f;
+
+	for (unsigned int i = 0; i < 1000; ++i)
+	{
+		Vec3f anglesA = NextRandomVec3(state, -3.0f, 3.0f);
+		Vec3f anglesB = NextRandomVec3(state, -3.0f, 3.0f);
+
+		Quatf qa = Quatf::RotateEuler(anglesA);
+		Quatf qb = Quatf::RotateEuler(anglesB);
+		Mat3x3f ma = Mat3x3f::RotateEuler(anglesA);
+		Mat3x3f mb = Mat3x3f::RotateEuler(anglesB);
+
+		eulerError = std::fmax(eulerError, MaxDifference(qa.ToMat3x3(), ma));
+
+		// Axis doesn't have to be normalized
+		Vec3f axis = NextRandomVec3(state, -1.0f, 1.0f) + Vec3f(0.0f, 0.0f, 1.5f);
+		float angle = Test::NextRandomFloat(state, -3.0f, 3.0f);
+		axisError = std::fmax(axisError, MaxDifference(
+			Mat4x4f(Quatf::RotateAroundAxis(axis, angle).ToMat3x3()), Mat4x4f::RotateAroundAxis(axis, angle)));
+
+		productError = std::fmax(productError, MaxDifference((qa * qb).ToMat3x3(), ma * mb));
+		conjugateError = std::fmax(conjugateError, MaxDifference(qa.GetConjugate().ToMat3x3(), ma.GetTransposed()));
+
+		Vec3f v = NextRandomVec3(state, -1.0f, 1.0f);
+		vectorError = std::fmax(vectorError, MaxDifference(qa * v, ma * v));
+	}
+
+	KOKKO_TEST_CHECK(context, eulerError < 1e-5f);
+	KOKKO_TEST_CHECK(context, axisError < 1e-5f);
+	KOKKO_TEST_CHECK(context, productError < 1e-5f);
+	KOKKO_TEST_CHECK(context, conjugateError < 1e-5f);
+	KOKKO_TEST_CHECK(context, vectorError < 1e-5f);
+}
+
+// TRS transforms and 3x4 affine matrices match the equivalent 4x4 matrices
+static void CheckAffineTransforms(Test::Context& context, uint64_t& state)
+{
+	float matrixError = 0.0f;
+	float productError = 0.0f;
+	float pointError = 0.0f;
+	float inverseError = 0.0f;
+	float rigidInverseError = 0.0f;
+
+	for (unsigned int i = 0; i < 1000; ++i)
+	{
+		Vec3f translation = NextRandomVec3(state, -10.0f, 10.0f);
+		Vec3f angles = NextRandomVec3(state, -3.0f, 3.0f);
+		Vec3f scale = NextRandomVec3(state, 0.2f, 3.2f);
+
+		Transformf a(translation, Quatf::RotateEuler(angles), scale);
+		Mat4x4f expectedA = Mat4x4f::Translate(translation) * Mat4x4f::RotateEuler(angles) * Mat4x4f::Scale(scale);
+		matrixError = std::fmax(matrixError, MaxDifference(a.GetMatrix().ToMat4x4(), expectedA));
+
+		// Non-uniform scale of the child makes the product sheared
+		Transformf b(NextRandomVec3(state, -1.0f, 1.0f), Quatf::RotateEuler(NextRandomVec3(state, -1.0f, 1.0f)),
+			Vec3f(1.0f, 2.0f, 0.5f));
+		Mat3x4f product = a.GetMatrix() * b.GetMatrix();
+
+		// Error grows with the magnitude of the translation
+		float magnitude = 1.0f + std::fabs(translation.x) + std::fabs(translation.y) + std::fabs(translation.z);
+		productError = std::fmax(productError,
+			MaxDifference(product.ToMat4x4(), expectedA * b.GetMatrix().ToMat4x4()) / magnitude);
+
+		Vec3f point = NextRandomVec3(state, -1.0f, 1.0f);
+		Mat3x4f pointTranslation(Mat3x3f(), point);
+		pointError = std::fmax(pointError,
+			MaxDifference(product.TransformPoint(point), (product * pointTranslation).GetTranslation()) / magnitude);
+
+		inverseError = std::fmax(inverseError,
+			MaxDifference((product * product.GetAffineInverse()).ToMat4x4(), Mat4x4f()));
+
+		// Without scale the result matches the rigid inverse of Mat4x4f
+		Mat4x4f rigid = Mat4x4f::Translate(translation) * Mat4x4f::RotateEuler(angles);
+		rigidInverseError = std::fmax(rigidInverseError,
+			MaxDifference(Mat3x4f(rigid).GetAffineInverse().ToMat4x4(), rigid.GetInverse()));
+	}
+
+	KOKKO_TEST_CHECK(context, matrixError < 1e-4f);
+	KOKKO_TEST_CHECK(context, productError < 1e-5f);
+	KOKKO_TEST_CHECK(context, pointError < 1e-5f);
+	KOKKO_TEST_CHECK(context, inverseError < 1e-4f);
+	KOKKO_TEST_CHECK(context, rigidInverseError < 1e-4f);
+}
+
+void Test::TestMath(Context& context)
+{
+	uint64_t state = 0x9e3779b97f4a7c15;
+
+	CheckQuaternions(context, state);
+	CheckAffineTransforms(context, state);
+}
@@ -0,0 +1,84 @@
+#include "Test/Test.hpp"
+
+#include "Math/BoundingBox.hpp"
+#include "Math/Mat4x4.hpp"
+#include "Math/Math.hpp"
+#include "Math/Projection.hpp"
+
+#include "Rendering/OcclusionCuller.hpp"
+
+static BoundingBox MakeBox(const Vec3f& center, const Vec3f& extents)
+{
+	BoundingBox box;
+	box.center = center;
+	box.extents = extents;
+	return box;
+}
+
+// Camera at the origin looking towards -Z, so the view matrix is identity
+static Mat4x4f MakeViewProjection()
+{
+	ProjectionParameters params;
+	params.projection = ProjectionType::Perspective;
+	params.height = Math::DegreesToRadians(60.0f);
+	params.near = 0.1f;
+	params.far = 100.0f;
+	params.SetAspectRatio(2.0f, 1.0f);
+
+	return params.GetProjectionMatrix(false);
+}
+
+static void TestWall(Test::Context& context)
+{
+	OcclusionCuller culler(context.allocator, 256, 128);
+	culler.BeginFrame(MakeViewProjection());
+
+	// 8 x 8 wall, 10 units in front of the camera
+	culler.RasterizeOccluder(Mat4x4f::Translate(Vec3f(0.0f, 0.0f, -10.0f)) * Mat4x4f::Scale(Vec3f(8.0f, 8.0f, 0.5f)));
+	culler.EndOccluders();
+
+	KOKKO_TEST_CHECK(context, culler.GetOccluderCount() == 1);
+	KOKKO_TEST_CHECK(context, culler.GetStats().facesRasterized > 0);
+
+	KOKKO_TEST_CHECK(context, culler.IsOccluded(MakeBox(Vec3f(0.0f, 0.0f, -20.0f), Vec3f(1.0f, 1.0f, 1.0f))));
+	KOKKO_TEST_CHECK(context, culler.IsOccluded(MakeBox(Vec3f(-2.0f, 1.0f, -30.0f), Vec3f(2.0f, 2.0f, 2.0f))));
+
+	// In front of the wall
+	KOKKO_TEST_CHECK(context, culler.IsOccluded(MakeBox(Vec3f(0.0f, 0.0f, -5.0f), Vec3f(1.0f, 1.0f, 1.0f))) == false);
+
+	// Behind the wall but beside it, and partially behind it
+	KOKKO_TEST_CHECK(context, culler.IsOccluded(MakeBox(Vec3f(30.0f, 0.0f, -20.0f), Vec3f(1.0f, 1.0f, 1.0f))) == false);
+	KOKKO_TEST_CHECK(context, culler.IsOccluded(MakeBox(Vec3f(8.0f, 0.0f, -20.0f), Vec3f(1.0f, 1.0f, 1.0f))) == false);
+
+	// Flat box on the front face of the wall is visible, and so is a box that reaches the camera
+	KOKKO_TEST_CHECK(context, culler.IsOccluded(MakeBox(Vec3f(0.0f, 0.0f, -9.75f), Vec3f(1.0f, 1.0f, 0.0f))) == false);
+	KOKKO_TEST_CHECK(context, culler.IsOccluded(MakeBox(Vec3f(0.0f, 0.0f, -20.0f), Vec3f(1.0f, 1.0f, 20.0f))) == false);
+
+	const OcclusionCuller::Stats& stats = culler.GetStats();
+	KOKKO_TEST_CHECK(context, stats.objectsTested == 7);
+	KOKKO_TEST_CHECK(context, stats.objectsOccluded == 2);
+
+	// Nothing is occluded without occluders
+	culler.BeginFrame(MakeViewProjection());
+	culler.EndOccluders();
+	KOKKO_TEST_CHECK(context, culler.IsOccluded(MakeBox(Vec3f(0.0f, 0.0f, -20.0f), Vec3f(1.0f, 1.0f, 1.0f))) == false);
+}
+
+// Occluders that cross the near plane are skipped
+static void TestNearPlane(Test::Context& context)
+{
+	OcclusionCuller culler(context.allocator, 256, 128);
+	culler.BeginFrame(MakeViewProjection());
+
+	culler.RasterizeOccluder(Mat4x4f::Scale(Vec3f(8.0f, 8.0f, 8.0f)));
+	culler.EndOccluders();
+
+	KOKKO_TEST_CHECK(context, culler.GetOccluderCount() == 0);
+	KOKKO_TEST_CHECK(context, culler.IsOccluded(MakeBox(Vec3f(0.0f, 0.0f, -20.0f), Vec3f(1.0f, 1.0f, 1.0f))) == false);
+}
+
+void Test::TestOcclusionCuller(Context& context)
+{
+	TestWall(context);
+	TestNearPlane(context);
+}
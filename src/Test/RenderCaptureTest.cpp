@@ -0,0 +1,253 @@
+#include "Test/Test.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+#include "Core/Buffer.hpp"
+
+#include "Rendering/RenderCaptureFile.hpp"
+#include "Rendering/RenderCaptureReplayer.hpp"
+#include "Rendering/RenderDeviceRecorder.hpp"
+
+#include "System/IncludeOpenGL.hpp"
+
+using Call = RenderDeviceRecorder::Call;
+
+// Recording device whose fences are signaled only after a number of waits time out
+class DelayedFenceDevice : public RenderDeviceRecorder
+{
+public:
+	unsigned int timeoutsLeft;
+	unsigned int waitCount;
+	bool lastWaitFlushed;
+
+	DelayedFenceDevice(Allocator* allocator, unsigned int timeouts) :
+		RenderDeviceRecorder(allocator, nullptr),
+		timeoutsLeft(timeouts),
+		waitCount(0),
+		lastWaitFlushed(false)
+	{
+	}
+
+	virtual RenderSyncWaitResult ClientWaitSync(RenderSyncObject sync, bool flushCommands, uint64_t timeoutNanoseconds) override
+	{
+		RenderDeviceRecorder::ClientWaitSync(sync, flushCommands, timeoutNanoseconds);
+
+		waitCount += 1;
+		lastWaitFlushed = flushCommands;
+
+		if (timeoutsLeft == 0)
+			return RenderSyncWaitResult::ConditionSatisfied;
+
+		timeoutsLeft -= 1;
+		return RenderSyncWaitResult::TimeoutExpired;
+	}
+};
+
+static const size_t UniformBufferSize = 256;
+static const size_t VertexBufferSize = 96;
+
+static void FillPattern(uint8_t* data, size_t size, uint8_t seed)
+{
+	for (size_t i = 0; i < size; ++i)
+		data[i] = static_cast<uint8_t>(seed + i * 7);
+}
+
+static bool CheckPattern(const uint8_t* data, size_t size, uint8_t seed)
+{
+	for (size_t i = 0; i < size; ++i)
+		if (data[i] != static_cast<uint8_t>(seed + i * 7))
+			return false;
+
+	return true;
+}
+
+// Creates the objects the frame uses, like the engine does while loading
+static void RecordSetup(RenderDeviceRecorder& device, unsigned int* buffersOut, unsigned int& textureOut)
+{
+	device.CreateBuffers(2, buffersOut);
+
+	// Persistently mapped uniform buffer, like the transform ring buffer
+	device.BindBuffer(RenderBufferTarget::UniformBuffer, buffersOut[0]);
+	RenderCommandData::SetBufferStorage storage{
+		RenderBufferTarget::UniformBuffer, UniformBufferSize, nullptr, false, false, true, true, true
+	};
+	device.SetBufferStorage(&storage);
+
+	uint8_t vertices[VertexBufferSize];
+	FillPattern(vertices, VertexBufferSize, 3);
+	device.BindBuffer(RenderBufferTarget::VertexBuffer, buffersOut[1]);
+	device.SetBufferData(RenderBufferTarget::VertexBuffer, VertexBufferSize, vertices, RenderBufferUsage::StaticDraw);
+
+	static const uint8_t pixels[64] = {};
+	device.CreateTextures(1, &textureOut);
+	device.BindTexture(RenderTextureTarget::Texture2d, textureOut);
+	RenderCommandData::SetTextureImage2D image{
+		RenderTextureTarget::Texture2d, 0, GL_RGBA, 4, 4, GL_RGBA, GL_UNSIGNED_BYTE, pixels
+	};
+	device.SetTextureImage2D(&image);
+}
+
+static void RecordFrame(RenderDeviceRecorder& device, const unsigned int* buffers, unsigned int texture)
+{
+	RenderSyncObject fence = device.FenceSync();
+	device.ClientWaitSync(fence, true, 1000000);
+	device.DeleteSync(fence);
+
+	RenderCommandData::MapBufferRange persistentMap{
+		RenderBufferTarget::UniformBuffer, 0, UniformBufferSize, false, true, false, false, false, false, true, true
+	};
+	device.BindBuffer(RenderBufferTarget::UniformBuffer, buffers[0]);
+	uint8_t* uniforms = static_cast<uint8_t*>(device.MapBufferRange(&persistentMap));
+	FillPattern(uniforms, UniformBufferSize, 11);
+
+	// Binding the range records the mapped contents
+	RenderCommandData::BindBufferRange range{
+		RenderBufferTarget::UniformBuffer, 0, buffers[0], 0, UniformBufferSize
+	};
+	device.BindBufferRange(&range);
+
+	// Temporary mapping is uploaded when it's unmapped
+	RenderCommandData::MapBufferRange vertexMap{
+		RenderBufferTarget::VertexBuffer, 32, 32, false, true, true, false, false, false, false, false
+	};
+	device.BindBuffer(RenderBufferTarget::VertexBuffer, buffers[1]);
+	uint8_t* vertices = static_cast<uint8_t*>(device.MapBufferRange(&vertexMap));
+	FillPattern(vertices, 32, 5);
+	device.UnmapBuffer(RenderBufferTarget::VertexBuffer);
+
+	uint8_t subData[16];
+	FillPattern(subData, sizeof(subData), 9);
+	device.SetBufferSubData(RenderBufferTarget::VertexBuffer, 64, sizeof(subData), subData);
+
+	device.SetActiveTextureUnit(0);
+	device.BindTexture(RenderTextureTarget::Texture2d, texture);
+	device.Draw(RenderPrimitiveMode::Triangles, 0, 3);
+	device.DrawInstanced(RenderPrimitiveMode::Triangles, 0, 6, 4);
+	device.DrawIndexedInstanced(RenderPrimitiveMode::Triangles, 36, RenderIndexType::UnsignedShort, 10);
+}
+
+static void TestRoundTrip(Test::Context& context)
+{
+	static const char* const CapturePath = "kokko_test_capture.kcap";
+
+	RenderDeviceRecorder recorder(context.allocator, nullptr);
+	recorder.SetRecording(true);
+
+	unsigned int buffers[2];
+	unsigned int texture = 0;
+	RecordSetup(recorder, buffers, texture);
+
+	size_t frameStart = recorder.GetCommandStream().GetCount();
+	RecordFrame(recorder, buffers, texture);
+
+	KOKKO_TEST_CHECK(context, RenderCaptureFile::Write(CapturePath, recorder.GetCommandStream(), frameStart));
+
+	Buffer<unsigned char> file(context.allocator);
+	size_t streamOffset = 0;
+	RenderCaptureFile::Header header;
+	bool read = RenderCaptureFile::Read(CapturePath, file, streamOffset, header);
+	std::remove(CapturePath);
+
+	KOKKO_TEST_CHECK(context, read);
+	if (read == false)
+		return;
+
+	KOKKO_TEST_CHECK(context, header.frameStart == frameStart);
+	KOKKO_TEST_CHECK(context, header.streamSize == recorder.GetCommandStream().GetCount());
+
+	RenderDeviceRecorder replayed(context.allocator, nullptr);
+
+	{
+		RenderCaptureReplayer replayer(context.allocator, &replayed);
+		const uint8_t* stream = file.Data() + streamOffset;
+		size_t streamSize = static_cast<size_t>(header.streamSize);
+
+		// Replay the setup and the frame separately, like kokko_replay does
+		KOKKO_TEST_CHECK(context, replayer.Replay(stream, frameStart));
+		KOKKO_TEST_CHECK(context, replayer.Replay(stream + frameStart, streamSize - frameStart));
+	}
+
+	const RenderDeviceRecorder::Stats& expected = recorder.GetStats();
+	const RenderDeviceRecorder::Stats& actual = replayed.GetStats();
+
+	// Mapped contents are written to the replayed mapping, not through the device
+	for (size_t i = 0; i < static_cast<size_t>(Call::Count); ++i)
+	{
+		if (static_cast<Call>(i) == Call::WriteMappedBuffer)
+			continue;
+
+		if (actual.callCounts[i] != expected.callCounts[i])
+			context.Fail(__FILE__, __LINE__, RenderDeviceRecorder::GetCallName(static_cast<Call>(i)));
+	}
+
+	KOKKO_TEST_CHECK(context, expected.callCounts[static_cast<size_t>(Call::WriteMappedBuffer)] == 2);
+	KOKKO_TEST_CHECK(context, actual.callCounts[static_cast<size_t>(Call::WriteMappedBuffer)] == 0);
+	KOKKO_TEST_CHECK(context, actual.bytesUploaded == expected.bytesUploaded);
+	KOKKO_TEST_CHECK(context, actual.drawCalls == expected.drawCalls);
+	KOKKO_TEST_CHECK(context, actual.drawnInstances == expected.drawnInstances);
+
+	// Replayed buffers have the contents written through the mappings. Both
+	// recorders hand out object IDs in creation order, so the IDs match.
+	RenderCommandData::MapBufferRange readMap{
+		RenderBufferTarget::UniformBuffer, 0, UniformBufferSize, true, false, false, false, false, false, false, false
+	};
+	replayed.BindBuffer(RenderBufferTarget::UniformBuffer, buffers[0]);
+	const uint8_t* uniforms = static_cast<const uint8_t*>(replayed.MapBufferRange(&readMap));
+	KOKKO_TEST_CHECK(context, uniforms != nullptr && CheckPattern(uniforms, UniformBufferSize, 11));
+
+	readMap.target = RenderBufferTarget::VertexBuffer;
+	readMap.length = VertexBufferSize;
+	replayed.BindBuffer(RenderBufferTarget::VertexBuffer, buffers[1]);
+	const uint8_t* vertices = static_cast<const uint8_t*>(replayed.MapBufferRange(&readMap));
+
+	KOKKO_TEST_CHECK(context, vertices != nullptr);
+	if (vertices != nullptr)
+	{
+		KOKKO_TEST_CHECK(context, CheckPattern(vertices, 32, 3));
+		KOKKO_TEST_CHECK(context, CheckPattern(vertices + 32, 32, 5));
+		KOKKO_TEST_CHECK(context, CheckPattern(vertices + 64, 16, 9));
+	}
+}
+
+// A recorded poll is replayed as a blocking wait, because the null device of
+// the render thread reports every fence as signaled when it's recorded
+static void TestFenceWait(Test::Context& context)
+{
+	RenderDeviceRecorder recorder(context.allocator, nullptr);
+	recorder.SetRecording(true);
+
+	RenderSyncObject fence = recorder.FenceSync();
+	KOKKO_TEST_CHECK(context, recorder.ClientWaitSync(fence, false, 0) == RenderSyncWaitResult::AlreadySignaled);
+	recorder.DeleteSync(fence);
+
+	const Array<uint8_t>& packet = recorder.GetCommandStream();
+
+	DelayedFenceDevice delayed(context.allocator, 3);
+	{
+		RenderCaptureReplayer replayer(context.allocator, &delayed);
+		KOKKO_TEST_CHECK(context, replayer.Replay(packet.GetData(), packet.GetCount()));
+	}
+
+	KOKKO_TEST_CHECK(context, delayed.timeoutsLeft == 0);
+	KOKKO_TEST_CHECK(context, delayed.waitCount == 4);
+	KOKKO_TEST_CHECK(context, delayed.lastWaitFlushed);
+	KOKKO_TEST_CHECK(context, delayed.GetStats().callCounts[static_cast<size_t>(Call::DeleteSync)] == 1);
+
+	// A fence that is already signaled is waited on once
+	DelayedFenceDevice signaled(context.allocator, 0);
+	{
+		RenderCaptureReplayer replayer(context.allocator, &signaled);
+		KOKKO_TEST_CHECK(context, replayer.Replay(packet.GetData(), packet.GetCount()));
+	}
+
+	KOKKO_TEST_CHECK(context, signaled.waitCount == 1);
+	KOKKO_TEST_CHECK(context, signaled.lastWaitFlushed == false);
+}
+
+void Test::TestRenderCapture(Context& context)
+{
+	TestRoundTrip(context);
+	TestFenceWait(context);
+}
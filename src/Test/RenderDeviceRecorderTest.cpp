@@ -0,0 +1,80 @@
+#include "Test/Test.hpp"
+
+#include <cstdint>
+
+#include "Rendering/RenderDeviceRecorder.hpp"
+
+#include "System/IncludeOpenGL.hpp"
+
+static uint64_t UploadImage(RenderDeviceRecorder& device, int width, int height,
+	unsigned int format, unsigned int type, const void* pixels)
+{
+	device.ResetStats();
+
+	RenderCommandData::SetTextureImage2D image{
+		RenderTextureTarget::Texture2d, 0, format, width, height, format, type, pixels
+	};
+	device.SetTextureImage2D(&image);
+
+	return device.GetStats().bytesUploaded;
+}
+
+static uint64_t UploadSubImage(RenderDeviceRecorder& device, int width, int height,
+	RenderTextureBaseFormat format, RenderTextureDataType type, const void* pixels)
+{
+	device.ResetStats();
+
+	RenderCommandData::SetTextureSubImage2D image{
+		RenderTextureTarget::Texture2d, 0, 0, 0, width, height, format, type, pixels
+	};
+	device.SetTextureSubImage2D(&image);
+
+	return device.GetStats().bytesUploaded;
+}
+
+void Test::TestRenderDeviceRecorder(Context& context)
+{
+	RenderDeviceRecorder device(context.allocator, nullptr);
+	device.SetRecording(true);
+
+	// Large enough for every upload below
+	static const uint8_t pixels[1024] = {};
+
+	// Rows are aligned to 4 bytes, except for the last one
+	KOKKO_TEST_CHECK(context, UploadImage(device, 3, 2, GL_RGB, GL_UNSIGNED_BYTE, pixels) == 12 + 9);
+	KOKKO_TEST_CHECK(context, UploadImage(device, 5, 3, GL_RED, GL_UNSIGNED_BYTE, pixels) == 8 * 2 + 5);
+	KOKKO_TEST_CHECK(context, UploadImage(device, 4, 4, GL_RGBA, GL_UNSIGNED_BYTE, pixels) == 64);
+	KOKKO_TEST_CHECK(context, UploadImage(device, 2, 2, GL_BGRA, GL_FLOAT, pixels) == 64);
+	KOKKO_TEST_CHECK(context, UploadImage(device, 3, 1, GL_RG, GL_HALF_FLOAT, pixels) == 12);
+	KOKKO_TEST_CHECK(context, UploadImage(device, 3, 3, GL_RGB, GL_UNSIGNED_SHORT_5_6_5, pixels) == 8 * 2 + 6);
+	KOKKO_TEST_CHECK(context, UploadImage(device, 2, 2, GL_DEPTH_STENCIL, GL_UNSIGNED_INT_24_8, pixels) == 16);
+	KOKKO_TEST_CHECK(context, UploadImage(device, 0, 4, GL_RGBA, GL_UNSIGNED_BYTE, pixels) == 0);
+	KOKKO_TEST_CHECK(context, UploadImage(device, 4, 4, GL_RGBA, GL_UNSIGNED_BYTE, nullptr) == 0);
+
+	KOKKO_TEST_CHECK(context, UploadSubImage(device, 3, 3, RenderTextureBaseFormat::R,
+		RenderTextureDataType::UnsignedShort, pixels) == 8 * 2 + 6);
+	KOKKO_TEST_CHECK(context, UploadSubImage(device, 4, 4, RenderTextureBaseFormat::RG,
+		RenderTextureDataType::UnsignedShort, pixels) == 64);
+	KOKKO_TEST_CHECK(context, UploadSubImage(device, 2, 2, RenderTextureBaseFormat::RGBA,
+		RenderTextureDataType::Float, pixels) == 64);
+	KOKKO_TEST_CHECK(context, UploadSubImage(device, 2, 2, RenderTextureBaseFormat::Depth,
+		RenderTextureDataType::Float, pixels) == 16);
+
+	// The payload is recorded after the command arguments, prefixed by its size
+	device.ClearCommandStream();
+	UploadImage(device, 3, 2, GL_RGB, GL_UNSIGNED_BYTE, pixels);
+
+	using Header = RenderDeviceRecorder::CommandHeader;
+	const Array<uint8_t>& stream = device.GetCommandStream();
+
+	KOKKO_TEST_CHECK(context, stream.GetCount() ==
+		sizeof(Header) + sizeof(RenderCommandData::SetTextureImage2D) + sizeof(uint64_t) + 21);
+
+	if (stream.GetCount() >= sizeof(Header))
+	{
+		const Header* header = reinterpret_cast<const Header*>(stream.GetData());
+
+		KOKKO_TEST_CHECK(context, header->call == static_cast<uint32_t>(RenderDeviceRecorder::Call::SetTextureImage2D));
+		KOKKO_TEST_CHECK(context, sizeof(Header) + header->size == stream.GetCount());
+	}
+}
@@ -0,0 +1,253 @@
+#include "Test/Test.hpp"
+
+#include "Rendering/RenderDeviceRecorder.hpp"
+#include "Rendering/RenderDeviceStateFilter.hpp"
+
+using FilterCall = RenderDeviceStateFilter::Call;
+using RecorderCall = RenderDeviceRecorder::Call;
+
+static unsigned int GetCallCount(const RenderDeviceRecorder& device, RecorderCall call)
+{
+	return device.GetStats().callCounts[static_cast<size_t>(call)];
+}
+
+static bool CountsAre(const RenderDeviceStateFilter& filter, FilterCall call, unsigned int forwarded, unsigned int elided)
+{
+	const RenderDeviceStateFilter::CallCounter& counter = filter.GetCallCounter(call);
+	return counter.forwarded == forwarded && counter.elided == elided;
+}
+
+static void BindRange(RenderDevice& device, unsigned int bindingPoint, unsigned int buffer, intptr_t offset, size_t length)
+{
+	RenderCommandData::BindBufferRange range{ RenderBufferTarget::UniformBuffer, bindingPoint, buffer, offset, length };
+	device.BindBufferRange(&range);
+}
+
+static void TestRepeatedBinds(Test::Context& context, RenderDeviceRecorder& device, RenderDeviceStateFilter& filter)
+{
+	unsigned int program = filter.CreateShaderProgram();
+	unsigned int textures[2];
+	filter.CreateTextures(2, textures);
+
+	for (unsigned int i = 0; i < 3; ++i)
+	{
+		filter.UseShaderProgram(program);
+		filter.DepthTestEnable();
+		filter.BlendFunction(RenderBlendFactor::SrcAlpha, RenderBlendFactor::OneMinusSrcAlpha);
+	}
+
+	KOKKO_TEST_CHECK(context, CountsAre(filter, FilterCall::UseShaderProgram, 1, 2));
+	KOKKO_TEST_CHECK(context, CountsAre(filter, FilterCall::DepthTest, 1, 2));
+	KOKKO_TEST_CHECK(context, CountsAre(filter, FilterCall::BlendFunction, 1, 2));
+	KOKKO_TEST_CHECK(context, GetCallCount(device, RecorderCall::UseShaderProgram) == 1);
+	KOKKO_TEST_CHECK(context, GetCallCount(device, RecorderCall::DepthTestEnable) == 1);
+	KOKKO_TEST_CHECK(context, GetCallCount(device, RecorderCall::BlendFunction) == 1);
+
+	// Changed values are always forwarded
+	filter.DepthTestDisable();
+	filter.BlendFunction(RenderBlendFactor::One, RenderBlendFactor::One);
+	KOKKO_TEST_CHECK(context, CountsAre(filter, FilterCall::DepthTest, 2, 2));
+	KOKKO_TEST_CHECK(context, CountsAre(filter, FilterCall::BlendFunction, 2, 2));
+
+	// Texture bindings are tracked per unit
+	filter.SetActiveTextureUnit(0);
+	filter.BindTexture(RenderTextureTarget::Texture2d, textures[0]);
+	filter.BindTexture(RenderTextureTarget::Texture2d, textures[0]);
+	filter.SetActiveTextureUnit(1);
+	filter.BindTexture(RenderTextureTarget::Texture2d, textures[0]);
+	filter.SetActiveTextureUnit(0);
+	filter.BindTexture(RenderTextureTarget::Texture2d, textures[0]);
+	filter.BindTexture(RenderTextureTarget::Texture2d, textures[1]);
+
+	KOKKO_TEST_CHECK(context, CountsAre(filter, FilterCall::SetActiveTextureUnit, 3, 0));
+	KOKKO_TEST_CHECK(context, CountsAre(filter, FilterCall::BindTexture, 3, 2));
+	KOKKO_TEST_CHECK(context, GetCallCount(device, RecorderCall::BindTexture) == 3);
+
+	filter.DestroyTextures(2, textures);
+	filter.DestroyShaderProgram(program);
+}
+
+static void TestDestroyedObjects(Test::Context& context, RenderDeviceRecorder& device, RenderDeviceStateFilter& filter)
+{
+	unsigned int program = filter.CreateShaderProgram();
+	unsigned int texture, sampler, framebuffer, vertexArray, buffer;
+	filter.CreateTextures(1, &texture);
+	filter.CreateSamplers(1, &sampler);
+	filter.CreateFramebuffers(1, &framebuffer);
+	filter.CreateVertexArrays(1, &vertexArray);
+	filter.CreateBuffers(1, &buffer);
+
+	filter.UseShaderProgram(program);
+	filter.SetActiveTextureUnit(2);
+	filter.BindTexture(RenderTextureTarget::Texture2d, texture);
+	filter.BindSampler(2, sampler);
+	filter.BindFramebuffer(RenderFramebufferTarget::Framebuffer, framebuffer);
+	filter.BindVertexArray(vertexArray);
+	filter.BindBuffer(RenderBufferTarget::VertexBuffer, buffer);
+	filter.BindBufferBase(RenderBufferTarget::UniformBuffer, 1, buffer);
+
+	filter.DestroyShaderProgram(program);
+	filter.DestroyTextures(1, &texture);
+	filter.DestroySamplers(1, &sampler);
+	filter.DestroyFramebuffers(1, &framebuffer);
+	filter.DestroyVertexArrays(1, &vertexArray);
+	filter.DestroyBuffers(1, &buffer);
+
+	filter.ResetCallCounters();
+	device.ResetStats();
+
+	// A new object can get the ID of a deleted one, so the next bind must reach the device
+	filter.UseShaderProgram(program);
+	filter.BindTexture(RenderTextureTarget::Texture2d, texture);
+	filter.BindSampler(2, sampler);
+	filter.BindFramebuffer(RenderFramebufferTarget::Framebuffer, framebuffer);
+	filter.BindVertexArray(vertexArray);
+	filter.BindBuffer(RenderBufferTarget::VertexBuffer, buffer);
+	filter.BindBufferBase(RenderBufferTarget::UniformBuffer, 1, buffer);
+
+	KOKKO_TEST_CHECK(context, CountsAre(filter, FilterCall::UseShaderProgram, 1, 0));
+	KOKKO_TEST_CHECK(context, CountsAre(filter, FilterCall::BindTexture, 1, 0));
+	KOKKO_TEST_CHECK(context, CountsAre(filter, FilterCall::BindSampler, 1, 0));
+	KOKKO_TEST_CHECK(context, CountsAre(filter, FilterCall::BindFramebuffer, 1, 0));
+	KOKKO_TEST_CHECK(context, CountsAre(filter, FilterCall::BindVertexArray, 1, 0));
+	KOKKO_TEST_CHECK(context, CountsAre(filter, FilterCall::BindBuffer, 1, 0));
+	KOKKO_TEST_CHECK(context, CountsAre(filter, FilterCall::BindBufferBase, 1, 0));
+
+	// The active texture unit isn't an object, so it's still known
+	filter.SetActiveTextureUnit(2);
+	KOKKO_TEST_CHECK(context, CountsAre(filter, FilterCall::SetActiveTextureUnit, 0, 1));
+	KOKKO_TEST_CHECK(context, GetCallCount(device, RecorderCall::SetActiveTextureUnit) == 0);
+}
+
+static void TestVertexArrays(Test::Context& context, RenderDeviceStateFilter& filter)
+{
+	unsigned int vertexArrays[2];
+	unsigned int buffers[2];
+	filter.CreateVertexArrays(2, vertexArrays);
+	filter.CreateBuffers(2, buffers);
+
+	filter.BindVertexArray(vertexArrays[0]);
+	filter.BindBuffer(RenderBufferTarget::VertexBuffer, buffers[0]);
+	filter.BindBuffer(RenderBufferTarget::IndexBuffer, buffers[1]);
+	filter.BindBuffer(RenderBufferTarget::IndexBuffer, buffers[1]);
+
+	filter.ResetCallCounters();
+
+	// The index buffer binding belongs to the vertex array, the vertex buffer binding doesn't
+	filter.BindVertexArray(vertexArrays[1]);
+	filter.BindBuffer(RenderBufferTarget::IndexBuffer, buffers[1]);
+	filter.BindBuffer(RenderBufferTarget::VertexBuffer, buffers[0]);
+
+	KOKKO_TEST_CHECK(context, CountsAre(filter, FilterCall::BindVertexArray, 1, 0));
+	KOKKO_TEST_CHECK(context, CountsAre(filter, FilterCall::BindBuffer, 1, 1));
+
+	// Binding the same vertex array again keeps its index buffer binding
+	filter.BindVertexArray(vertexArrays[1]);
+	filter.BindBuffer(RenderBufferTarget::IndexBuffer, buffers[1]);
+
+	KOKKO_TEST_CHECK(context, CountsAre(filter, FilterCall::BindVertexArray, 1, 1));
+	KOKKO_TEST_CHECK(context, CountsAre(filter, FilterCall::BindBuffer, 1, 2));
+
+	// Deleting the bound vertex array also forgets its index buffer
+	filter.DestroyVertexArrays(1, &vertexArrays[1]);
+	filter.BindBuffer(RenderBufferTarget::IndexBuffer, buffers[1]);
+	filter.BindVertexArray(vertexArrays[0]);
+
+	KOKKO_TEST_CHECK(context, CountsAre(filter, FilterCall::BindBuffer, 2, 2));
+	KOKKO_TEST_CHECK(context, CountsAre(filter, FilterCall::BindVertexArray, 2, 1));
+
+	filter.DestroyVertexArrays(1, &vertexArrays[0]);
+	filter.DestroyBuffers(2, buffers);
+}
+
+static void TestBufferRanges(Test::Context& context, RenderDeviceRecorder& device, RenderDeviceStateFilter& filter)
+{
+	unsigned int buffers[2];
+	filter.CreateBuffers(2, buffers);
+
+	filter.ResetCallCounters();
+	device.ResetStats();
+
+	BindRange(filter, 0, buffers[0], 0, 256);
+	BindRange(filter, 0, buffers[0], 0, 256);
+	KOKKO_TEST_CHECK(context, CountsAre(filter, FilterCall::BindBufferRange, 1, 1));
+
+	// Offset, length, buffer and binding point each make a different binding
+	BindRange(filter, 0, buffers[0], 256, 256);
+	BindRange(filter, 0, buffers[0], 256, 512);
+	BindRange(filter, 0, buffers[1], 256, 512);
+	BindRange(filter, 1, buffers[1], 256, 512);
+	BindRange(filter, 0, buffers[1], 256, 512);
+	KOKKO_TEST_CHECK(context, CountsAre(filter, FilterCall::BindBufferRange, 5, 2));
+
+	// Whole buffer binding differs from any range of the same buffer
+	filter.BindBufferBase(RenderBufferTarget::UniformBuffer, 0, buffers[1]);
+	filter.BindBufferBase(RenderBufferTarget::UniformBuffer, 0, buffers[1]);
+	BindRange(filter, 0, buffers[1], 0, 0);
+	KOKKO_TEST_CHECK(context, CountsAre(filter, FilterCall::BindBufferBase, 1, 1));
+	KOKKO_TEST_CHECK(context, CountsAre(filter, FilterCall::BindBufferRange, 5, 3));
+
+	// Indexed binding also binds the buffer to the generic target
+	filter.BindBuffer(RenderBufferTarget::UniformBuffer, buffers[1]);
+	filter.BindBuffer(RenderBufferTarget::UniformBuffer, buffers[0]);
+	KOKKO_TEST_CHECK(context, CountsAre(filter, FilterCall::BindBuffer, 1, 1));
+
+	KOKKO_TEST_CHECK(context, GetCallCount(device, RecorderCall::BindBufferRange) == 5);
+	KOKKO_TEST_CHECK(context, GetCallCount(device, RecorderCall::BindBufferBase) == 1);
+	KOKKO_TEST_CHECK(context, GetCallCount(device, RecorderCall::BindBuffer) == 1);
+
+	// Deleting a buffer forgets its range bindings, but not the bindings of other buffers
+	filter.DestroyBuffers(1, &buffers[1]);
+	filter.BindBuffer(RenderBufferTarget::UniformBuffer, buffers[0]);
+	BindRange(filter, 1, buffers[1], 256, 512);
+	KOKKO_TEST_CHECK(context, CountsAre(filter, FilterCall::BindBufferRange, 6, 3));
+	KOKKO_TEST_CHECK(context, CountsAre(filter, FilterCall::BindBuffer, 1, 2));
+
+	filter.DestroyBuffers(1, &buffers[0]);
+}
+
+static void TestInvalidate(Test::Context& context, RenderDeviceRecorder& device, RenderDeviceStateFilter& filter)
+{
+	RenderCommandData::ViewportData viewport{ 0, 0, 640, 480 };
+
+	filter.Viewport(&viewport);
+	filter.CullFaceEnable();
+	filter.CullFaceBack();
+
+	filter.ResetCallCounters();
+	device.ResetStats();
+
+	filter.Viewport(&viewport);
+	filter.CullFaceEnable();
+	filter.CullFaceBack();
+
+	KOKKO_TEST_CHECK(context, CountsAre(filter, FilterCall::Viewport, 0, 1));
+	KOKKO_TEST_CHECK(context, CountsAre(filter, FilterCall::CullFace, 0, 1));
+	KOKKO_TEST_CHECK(context, CountsAre(filter, FilterCall::CullFaceMode, 0, 1));
+
+	// State changed behind the filter's back has to be sent again
+	filter.InvalidateState();
+
+	filter.Viewport(&viewport);
+	filter.CullFaceEnable();
+	filter.CullFaceBack();
+
+	KOKKO_TEST_CHECK(context, CountsAre(filter, FilterCall::Viewport, 1, 1));
+	KOKKO_TEST_CHECK(context, CountsAre(filter, FilterCall::CullFace, 1, 1));
+	KOKKO_TEST_CHECK(context, CountsAre(filter, FilterCall::CullFaceMode, 1, 1));
+	KOKKO_TEST_CHECK(context, GetCallCount(device, RecorderCall::Viewport) == 1);
+	KOKKO_TEST_CHECK(context, GetCallCount(device, RecorderCall::CullFaceEnable) == 1);
+	KOKKO_TEST_CHECK(context, GetCallCount(device, RecorderCall::CullFaceBack) == 1);
+}
+
+void Test::TestRenderDeviceStateFilter(Context& context)
+{
+	RenderDeviceRecorder device(context.allocator, nullptr);
+	RenderDeviceStateFilter filter(&device);
+
+	TestRepeatedBinds(context, device, filter);
+	TestDestroyedObjects(context, device, filter);
+	TestVertexArrays(context, filter);
+	TestBufferRanges(context, device, filter);
+	TestInvalidate(context, device, filter);
+}
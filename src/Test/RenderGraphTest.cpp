@@ -0,0 +1,228 @@
+#include "Test/Test.hpp"
+
+#include "Core/Array.hpp"
+
+#include "Rendering/RenderGraph.hpp"
+
+using TextureDesc = RenderGraph::TextureDesc;
+
+static const TextureDesc FullDesc{ Vec2i(1280, 720), RenderTextureSizedFormat::RGBA16F };
+static const TextureDesc HalfDesc{ Vec2i(640, 360), RenderTextureSizedFormat::RGBA16F };
+
+static void RecordPass(void* userData, unsigned int passData)
+{
+	static_cast<Array<unsigned int>*>(userData)->PushBack(passData);
+}
+
+static bool HasBarrier(const RenderGraph& graph, unsigned int compiledIdx, RenderGraphResourceId resource,
+	RenderGraphAccess source, RenderGraphAccess destination)
+{
+	const RenderGraph::CompiledPass& pass = graph.GetCompiledPass(compiledIdx);
+	const RenderGraph::Barrier* barriers = graph.GetBarriers() + pass.firstBarrier;
+
+	for (unsigned int i = 0; i < pass.barrierCount; ++i)
+		if (barriers[i].resource == resource && barriers[i].sourceAccess == source &&
+			barriers[i].destinationAccess == destination)
+			return true;
+
+	return false;
+}
+
+static void TestCulling(Test::Context& context, RenderGraph& graph)
+{
+	Array<unsigned int> executed(context.allocator);
+
+	graph.Clear();
+
+	RenderGraphResourceId backbuffer = graph.ImportTexture("Backbuffer", FullDesc, 1, 0);
+	RenderGraphResourceId readback = graph.ImportBuffer("Readback", 2);
+	RenderGraphResourceId scene = graph.CreateTexture("Scene", FullDesc);
+	RenderGraphResourceId unused = graph.CreateTexture("Unused", FullDesc);
+	graph.MarkOutput(backbuffer);
+
+	// Nothing reads the texture
+	RenderGraphPassId unusedPass = graph.AddPass("Unused", RecordPass, &executed, 0);
+	graph.AddAccess(unusedPass, unused, RenderGraphAccess::RenderTargetWrite);
+
+	RenderGraphPassId scenePass = graph.AddPass("Scene", RecordPass, &executed, 1);
+	graph.AddAccess(scenePass, scene, RenderGraphAccess::RenderTargetWrite);
+
+	// Overwritten by the next pass before anything reads it
+	RenderGraphPassId clearPass = graph.AddPass("Clear", RecordPass, &executed, 2);
+	graph.AddAccess(clearPass, backbuffer, RenderGraphAccess::RenderTargetWrite);
+
+	RenderGraphPassId resolvePass = graph.AddPass("Resolve", RecordPass, &executed, 3);
+	graph.AddAccess(resolvePass, scene, RenderGraphAccess::ShaderRead);
+	graph.AddAccess(resolvePass, backbuffer, RenderGraphAccess::RenderTargetWrite);
+
+	// Blending keeps the contents the previous pass wrote
+	RenderGraphPassId overlayPass = graph.AddPass("Overlay", RecordPass, &executed, 4);
+	graph.AddAccess(overlayPass, backbuffer, RenderGraphAccess::RenderTargetBlend);
+
+	// Writes nothing that is needed, but is kept for its side effect
+	RenderGraphPassId readbackPass = graph.AddPass("Readback", RecordPass, &executed, 5);
+	graph.AddAccess(readbackPass, scene, RenderGraphAccess::ShaderRead);
+	graph.AddAccess(readbackPass, readback, RenderGraphAccess::StorageWrite);
+	graph.SetSideEffect(readbackPass);
+
+	graph.Compile();
+
+	KOKKO_TEST_CHECK(context, graph.IsPassCulled(unusedPass));
+	KOKKO_TEST_CHECK(context, graph.IsPassCulled(scenePass) == false);
+	KOKKO_TEST_CHECK(context, graph.IsPassCulled(clearPass));
+	KOKKO_TEST_CHECK(context, graph.IsPassCulled(resolvePass) == false);
+	KOKKO_TEST_CHECK(context, graph.IsPassCulled(overlayPass) == false);
+	KOKKO_TEST_CHECK(context, graph.IsPassCulled(readbackPass) == false);
+	KOKKO_TEST_CHECK(context, graph.GetCompiledPassCount() == 4);
+
+	for (unsigned int i = 0, count = graph.GetCompiledPassCount(); i < count; ++i)
+		graph.ExecutePass(i);
+
+	// Live passes execute in the order they were added
+	KOKKO_TEST_CHECK(context, executed.GetCount() == 4);
+	if (executed.GetCount() == 4)
+	{
+		KOKKO_TEST_CHECK(context, executed[0] == 1);
+		KOKKO_TEST_CHECK(context, executed[1] == 3);
+		KOKKO_TEST_CHECK(context, executed[2] == 4);
+		KOKKO_TEST_CHECK(context, executed[3] == 5);
+	}
+
+	// Textures that only culled passes use get no physical texture
+	KOKKO_TEST_CHECK(context, graph.GetPhysicalTextureIndex(unused) == RenderGraph::Null);
+	KOKKO_TEST_CHECK(context, graph.GetPhysicalTextureIndex(scene) != RenderGraph::Null);
+	KOKKO_TEST_CHECK(context, graph.GetPhysicalTextureCount() == 1);
+
+	// Imported resources keep their objects
+	KOKKO_TEST_CHECK(context, graph.GetTexture(backbuffer) == 1);
+	KOKKO_TEST_CHECK(context, graph.GetBuffer(readback) == 2);
+	KOKKO_TEST_CHECK(context, graph.IsTexture(readback) == false);
+}
+
+static void TestBarriers(Test::Context& context, RenderGraph& graph)
+{
+	graph.Clear();
+
+	RenderGraphResourceId buffer = graph.ImportBuffer("Lights", 1);
+	RenderGraphResourceId output = graph.ImportTexture("Output", FullDesc, 2, 3);
+	graph.MarkOutput(output);
+	graph.MarkOutput(buffer);
+
+	// 0: Storage write with no earlier access
+	RenderGraphPassId cullPass = graph.AddPass("CullLights", nullptr, nullptr, 0);
+	graph.AddAccess(cullPass, buffer, RenderGraphAccess::StorageWrite);
+
+	// 1: Read after write
+	RenderGraphPassId shadePass = graph.AddPass("Shade", nullptr, nullptr, 0);
+	graph.AddAccess(shadePass, buffer, RenderGraphAccess::ShaderRead);
+	graph.AddAccess(shadePass, output, RenderGraphAccess::RenderTargetWrite);
+
+	// 2: The same kind of read has already waited for the write,
+	// a different kind of read has not
+	RenderGraphPassId debugPass = graph.AddPass("Debug", nullptr, nullptr, 0);
+	graph.AddAccess(debugPass, buffer, RenderGraphAccess::ShaderRead);
+	graph.AddAccess(debugPass, buffer, RenderGraphAccess::StorageRead);
+	graph.AddAccess(debugPass, output, RenderGraphAccess::RenderTargetBlend);
+
+	// 3: Write after read, and a read of the same pass gets no separate barrier
+	RenderGraphPassId updatePass = graph.AddPass("Update", nullptr, nullptr, 0);
+	graph.AddAccess(updatePass, buffer, RenderGraphAccess::StorageRead);
+	graph.AddAccess(updatePass, buffer, RenderGraphAccess::StorageWrite);
+
+	graph.Compile();
+
+	KOKKO_TEST_CHECK(context, graph.GetCompiledPassCount() == 4);
+	if (graph.GetCompiledPassCount() != 4)
+		return;
+
+	KOKKO_TEST_CHECK(context, graph.GetCompiledPass(0).barrierCount == 0);
+
+	KOKKO_TEST_CHECK(context, graph.GetCompiledPass(1).barrierCount == 1);
+	KOKKO_TEST_CHECK(context, HasBarrier(graph, 1, buffer,
+		RenderGraphAccess::StorageWrite, RenderGraphAccess::ShaderRead));
+
+	KOKKO_TEST_CHECK(context, graph.GetCompiledPass(2).barrierCount == 2);
+	KOKKO_TEST_CHECK(context, HasBarrier(graph, 2, buffer,
+		RenderGraphAccess::StorageWrite, RenderGraphAccess::StorageRead));
+	KOKKO_TEST_CHECK(context, HasBarrier(graph, 2, output,
+		RenderGraphAccess::RenderTargetWrite, RenderGraphAccess::RenderTargetBlend));
+
+	KOKKO_TEST_CHECK(context, graph.GetCompiledPass(3).barrierCount == 1);
+	KOKKO_TEST_CHECK(context, HasBarrier(graph, 3, buffer,
+		RenderGraphAccess::StorageRead, RenderGraphAccess::StorageWrite));
+}
+
+static void TestAliasing(Test::Context& context, RenderGraph& graph)
+{
+	graph.Clear();
+
+	RenderGraphResourceId output = graph.ImportTexture("Output", FullDesc, 1, 2);
+	graph.MarkOutput(output);
+
+	RenderGraphResourceId a = graph.CreateTexture("A", FullDesc);
+	RenderGraphResourceId b = graph.CreateTexture("B", FullDesc);
+	RenderGraphResourceId c = graph.CreateTexture("C", FullDesc);
+	RenderGraphResourceId half = graph.CreateTexture("Half", HalfDesc);
+
+	// A is live during passes 0-1, B during 1-2, C during 2-3
+	RenderGraphPassId pass0 = graph.AddPass("0", nullptr, nullptr, 0);
+	graph.AddAccess(pass0, a, RenderGraphAccess::RenderTargetWrite);
+
+	RenderGraphPassId pass1 = graph.AddPass("1", nullptr, nullptr, 0);
+	graph.AddAccess(pass1, a, RenderGraphAccess::ShaderRead);
+	graph.AddAccess(pass1, b, RenderGraphAccess::RenderTargetWrite);
+
+	RenderGraphPassId pass2 = graph.AddPass("2", nullptr, nullptr, 0);
+	graph.AddAccess(pass2, b, RenderGraphAccess::ShaderRead);
+	graph.AddAccess(pass2, c, RenderGraphAccess::RenderTargetWrite);
+	graph.AddAccess(pass2, half, RenderGraphAccess::RenderTargetWrite);
+
+	RenderGraphPassId pass3 = graph.AddPass("3", nullptr, nullptr, 0);
+	graph.AddAccess(pass3, c, RenderGraphAccess::ShaderRead);
+	graph.AddAccess(pass3, half, RenderGraphAccess::ShaderRead);
+	graph.AddAccess(pass3, output, RenderGraphAccess::RenderTargetWrite);
+
+	graph.Compile();
+
+	unsigned int physicalA = graph.GetPhysicalTextureIndex(a);
+	unsigned int physicalB = graph.GetPhysicalTextureIndex(b);
+	unsigned int physicalC = graph.GetPhysicalTextureIndex(c);
+	unsigned int physicalHalf = graph.GetPhysicalTextureIndex(half);
+
+	// A and C don't overlap, B overlaps both, and Half has a different description
+	KOKKO_TEST_CHECK(context, graph.GetPhysicalTextureCount() == 3);
+	KOKKO_TEST_CHECK(context, physicalA == physicalC);
+	KOKKO_TEST_CHECK(context, physicalA != physicalB);
+	KOKKO_TEST_CHECK(context, physicalHalf != physicalA && physicalHalf != physicalB);
+
+	if (graph.GetPhysicalTextureCount() != 3)
+		return;
+
+	KOKKO_TEST_CHECK(context, graph.GetPhysicalTextureDesc(physicalHalf) == HalfDesc);
+	KOKKO_TEST_CHECK(context, graph.GetPhysicalTextureDesc(physicalA) == FullDesc);
+
+	for (unsigned int i = 0; i < 3; ++i)
+		graph.SetPhysicalTexture(i, 10 + i, 20 + i);
+
+	// Aliased textures resolve to the same device objects
+	KOKKO_TEST_CHECK(context, graph.GetTexture(a) == 10 + physicalA);
+	KOKKO_TEST_CHECK(context, graph.GetTexture(c) == graph.GetTexture(a));
+	KOKKO_TEST_CHECK(context, graph.GetFramebuffer(c) == graph.GetFramebuffer(a));
+	KOKKO_TEST_CHECK(context, graph.GetFramebuffer(b) == 20 + physicalB);
+	KOKKO_TEST_CHECK(context, graph.GetTexture(output) == 1);
+	KOKKO_TEST_CHECK(context, graph.GetFramebuffer(output) == 2);
+}
+
+void Test::TestRenderGraph(Context& context)
+{
+	RenderGraph graph(context.allocator);
+
+	TestCulling(context, graph);
+	TestBarriers(context, graph);
+	TestAliasing(context, graph);
+
+	// Compiling again gives the same result
+	graph.Compile();
+	KOKKO_TEST_CHECK(context, graph.GetCompiledPassCount() == 4);
+	KOKKO_TEST_CHECK(context, graph.GetPhysicalTextureCount() == 3);
+}
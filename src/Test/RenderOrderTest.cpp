@@ -0,0 +1,141 @@
+#include "Test/Test.hpp"
+
+#include <cstdint>
+
+#include "Rendering/RenderCommandList.hpp"
+#include "Rendering/RenderOrder.hpp"
+
+using Config = RenderOrderConfiguration;
+
+static uint64_t MakeDrawKey(const Config& config, unsigned int viewport, RenderPass pass, float depth,
+	uint64_t material, uint64_t mesh, unsigned int renderObject)
+{
+	uint64_t passInt = static_cast<uint64_t>(pass);
+
+	uint64_t key = 0;
+	config.viewportIndex.AssignValue(key, viewport);
+	config.viewportPass.AssignValue(key, passInt);
+	config.command.AssignValue(key, static_cast<uint64_t>(RenderCommandType::Draw));
+	config.AssignDraw(key, passInt, depth, material, mesh);
+	config.renderObject.AssignValue(key, renderObject);
+	return key;
+}
+
+// Largest values of every field decode unchanged and don't leak into the other fields
+static void CheckFieldLimits(Test::Context& context, const Config& config, RenderPass pass)
+{
+	const uint64_t maxViewport = Config::ViewportIndexField::mask;
+	const uint64_t maxMaterial = Config::CallbackMaterialId - 1;
+	const uint64_t maxMesh = Config::DepthMajorMeshField::mask;
+	const uint64_t maxObject = Config::RenderObjectField::mask;
+
+	bool transparent = Config::IsTransparentPass(static_cast<uint64_t>(pass));
+
+	// Transparent depth is reversed, so that far objects are drawn first
+	uint64_t nearDepth = transparent ? Config::maxTransparentDepth : 0;
+	uint64_t farDepth = transparent ? 0 : Config::maxOpaqueDepth << Config::opaqueDepthShift;
+
+	uint64_t maxKey = MakeDrawKey(config, 7, pass, 1.0f, maxMaterial, maxMesh, static_cast<unsigned int>(maxObject));
+
+	KOKKO_TEST_CHECK(context, config.viewportIndex.GetValue(maxKey) == maxViewport);
+	KOKKO_TEST_CHECK(context, config.viewportPass.GetValue(maxKey) == static_cast<uint64_t>(pass));
+	KOKKO_TEST_CHECK(context, config.command.GetValue(maxKey) == static_cast<uint64_t>(RenderCommandType::Draw));
+	KOKKO_TEST_CHECK(context, config.GetMaterialId(maxKey) == maxMaterial);
+	KOKKO_TEST_CHECK(context, config.GetMeshId(maxKey) == maxMesh);
+	KOKKO_TEST_CHECK(context, config.GetDepth(maxKey) == farDepth);
+	KOKKO_TEST_CHECK(context, config.renderObject.GetValue(maxKey) == maxObject);
+
+	uint64_t minKey = MakeDrawKey(config, 0, pass, 0.0f, 0, 0, 0);
+
+	KOKKO_TEST_CHECK(context, config.viewportIndex.GetValue(minKey) == 0);
+	KOKKO_TEST_CHECK(context, config.GetMaterialId(minKey) == 0);
+	KOKKO_TEST_CHECK(context, config.GetMeshId(minKey) == 0);
+	KOKKO_TEST_CHECK(context, config.GetDepth(minKey) == nearDepth);
+	KOKKO_TEST_CHECK(context, config.renderObject.GetValue(minKey) == 0);
+
+	// Mesh IDs that don't fit are truncated without touching the neighbouring fields
+	uint64_t overflowKey = MakeDrawKey(config, 3, pass, 0.5f, 5, maxMesh + 2, 9);
+
+	KOKKO_TEST_CHECK(context, config.GetMeshId(overflowKey) == 1);
+	KOKKO_TEST_CHECK(context, config.GetMaterialId(overflowKey) == 5);
+	KOKKO_TEST_CHECK(context, config.GetDepth(overflowKey) == config.GetDepth(MakeDrawKey(config, 3, pass, 0.5f, 5, 1, 9)));
+	KOKKO_TEST_CHECK(context, config.renderObject.GetValue(overflowKey) == 9);
+}
+
+static void TestFieldLimits(Test::Context& context)
+{
+	Config config;
+
+	CheckFieldLimits(context, config, RenderPass::OpaqueGeometry);
+	CheckFieldLimits(context, config, RenderPass::Transparent);
+
+	config.SetSortOrder(RenderPass::OpaqueGeometry, RenderOrderSort::MaterialMajor);
+	CheckFieldLimits(context, config, RenderPass::OpaqueGeometry);
+}
+
+static void TestSortOrder(Test::Context& context)
+{
+	Config config;
+
+	KOKKO_TEST_CHECK(context, config.GetSortOrder(RenderPass::OpaqueGeometry) == RenderOrderSort::DepthMajor);
+
+	// Near object with a large material ID and far object with a small one
+	uint64_t nearKey = MakeDrawKey(config, 0, RenderPass::OpaqueGeometry, 0.0f, 20, 1, 0);
+	uint64_t farKey = MakeDrawKey(config, 0, RenderPass::OpaqueGeometry, 1.0f, 10, 1, 0);
+	KOKKO_TEST_CHECK(context, nearKey < farKey);
+
+	config.SetSortOrder(RenderPass::OpaqueGeometry, RenderOrderSort::MaterialMajor);
+	KOKKO_TEST_CHECK(context, config.GetSortOrder(RenderPass::OpaqueGeometry) == RenderOrderSort::MaterialMajor);
+
+	nearKey = MakeDrawKey(config, 0, RenderPass::OpaqueGeometry, 0.0f, 20, 1, 0);
+	farKey = MakeDrawKey(config, 0, RenderPass::OpaqueGeometry, 1.0f, 10, 1, 0);
+	KOKKO_TEST_CHECK(context, farKey < nearKey);
+
+	// Mesh comes before depth within a material
+	uint64_t firstMesh = MakeDrawKey(config, 0, RenderPass::OpaqueGeometry, 1.0f, 10, 1, 0);
+	uint64_t secondMesh = MakeDrawKey(config, 0, RenderPass::OpaqueGeometry, 0.0f, 10, 2, 0);
+	KOKKO_TEST_CHECK(context, firstMesh < secondMesh);
+
+	// Other passes keep their own order
+	KOKKO_TEST_CHECK(context, config.GetSortOrder(RenderPass::OpaqueLighting) == RenderOrderSort::DepthMajor);
+
+	// Transparent passes can't be sorted material-major
+	config.SetSortOrder(RenderPass::Transparent, RenderOrderSort::MaterialMajor);
+	KOKKO_TEST_CHECK(context, config.GetSortOrder(RenderPass::Transparent) == RenderOrderSort::DepthMajor);
+
+	config.SetSortOrder(RenderPass::OpaqueGeometry, RenderOrderSort::DepthMajor);
+	KOKKO_TEST_CHECK(context, config.GetSortOrder(RenderPass::OpaqueGeometry) == RenderOrderSort::DepthMajor);
+}
+
+static void TestRejectedDraws(Test::Context& context)
+{
+	RenderCommandList list(context.allocator);
+
+	const unsigned int callbackId = static_cast<unsigned int>(Config::CallbackMaterialId);
+
+	list.AddDraw(0, RenderPass::OpaqueGeometry, 0.5f, MaterialId{ callbackId - 1 }, MeshId{ 1 }, 0);
+	KOKKO_TEST_CHECK(context, list.commands.GetCount() == 1);
+	KOKKO_TEST_CHECK(context, list.rejectedDrawCount == 0);
+
+	// Material IDs at or above the callback ID would be mistaken for callbacks or other materials
+	list.AddDraw(0, RenderPass::OpaqueGeometry, 0.5f, MaterialId{ callbackId }, MeshId{ 1 }, 1);
+	list.AddDraw(0, RenderPass::Transparent, 0.5f, MaterialId{ callbackId + 1 }, MeshId{ 1 }, 2);
+	KOKKO_TEST_CHECK(context, list.commands.GetCount() == 1);
+	KOKKO_TEST_CHECK(context, list.rejectedDrawCount == 2);
+
+	list.AddDrawWithCallback(0, RenderPass::OpaqueGeometry, 0.5f, 3);
+	KOKKO_TEST_CHECK(context, list.commands.GetCount() == 2);
+	KOKKO_TEST_CHECK(context, list.renderOrder.GetMaterialId(list.commands[1]) == Config::CallbackMaterialId);
+	KOKKO_TEST_CHECK(context, list.renderOrder.renderObject.GetValue(list.commands[1]) == 3);
+
+	list.Clear();
+	KOKKO_TEST_CHECK(context, list.commands.GetCount() == 0);
+	KOKKO_TEST_CHECK(context, list.rejectedDrawCount == 0);
+}
+
+void Test::TestRenderOrder(Context& context)
+{
+	TestFieldLimits(context);
+	TestSortOrder(context);
+	TestRejectedDraws(context);
+}
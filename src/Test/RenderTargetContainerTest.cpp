@@ -0,0 +1,134 @@
+#include "Test/Test.hpp"
+
+#include "Core/Hash.hpp"
+
+#include "Rendering/RenderDeviceRecorder.hpp"
+#include "Rendering/RenderTargetContainer.hpp"
+
+using Call = RenderDeviceRecorder::Call;
+
+static unsigned int GetCallCount(const RenderDeviceRecorder& device, Call call)
+{
+	return device.GetStats().callCounts[static_cast<size_t>(call)];
+}
+
+static void TestReuse(Test::Context& context, RenderDeviceRecorder& device, RenderTargetContainer& container)
+{
+	const Vec2i size(256, 128);
+
+	const RenderTarget& first = container.AcquireRenderTarget(size, RenderTextureSizedFormat::RGBA8);
+	unsigned int firstId = first.id;
+	unsigned int firstTexture = first.colorTexture;
+
+	const RenderTarget& second = container.AcquireRenderTarget(size, RenderTextureSizedFormat::RGBA8);
+	unsigned int secondId = second.id;
+
+	// Targets in use are never shared
+	KOKKO_TEST_CHECK(context, firstId != secondId);
+	KOKKO_TEST_CHECK(context, container.GetStats().targetCount == 2);
+	KOKKO_TEST_CHECK(context, container.GetStats().inUseCount == 2);
+	KOKKO_TEST_CHECK(context, container.GetStats().currentBytes == 2 * 256 * 128 * 4);
+
+	container.ReleaseRenderTarget(firstId);
+	container.ReleaseRenderTarget(secondId);
+
+	KOKKO_TEST_CHECK(context, container.GetStats().inUseCount == 0);
+
+	unsigned int texturesCreated = GetCallCount(device, Call::CreateTextures);
+
+	// A released target of the same size and format is reused, most recently released first
+	const RenderTarget& reused = container.AcquireRenderTarget(size, RenderTextureSizedFormat::RGBA8);
+	KOKKO_TEST_CHECK(context, reused.id == secondId);
+	KOKKO_TEST_CHECK(context, GetCallCount(device, Call::CreateTextures) == texturesCreated);
+	unsigned int reusedId = reused.id;
+
+	// A different format or size needs a new target
+	const RenderTarget& otherFormat = container.AcquireRenderTarget(size, RenderTextureSizedFormat::RGBA16F);
+	unsigned int otherFormatId = otherFormat.id;
+	KOKKO_TEST_CHECK(context, otherFormatId != firstId && otherFormatId != secondId);
+	KOKKO_TEST_CHECK(context, GetCallCount(device, Call::CreateTextures) == texturesCreated + 1);
+
+	const RenderTarget& otherSize = container.AcquireRenderTarget(Vec2i(128, 256), RenderTextureSizedFormat::RGBA8);
+	unsigned int otherSizeId = otherSize.id;
+	KOKKO_TEST_CHECK(context, otherSize.colorTexture != firstTexture);
+	KOKKO_TEST_CHECK(context, GetCallCount(device, Call::CreateTextures) == texturesCreated + 2);
+
+	KOKKO_TEST_CHECK(context, container.GetStats().targetCount == 4);
+	KOKKO_TEST_CHECK(context, container.GetStats().peakBytes == container.GetStats().currentBytes);
+
+	container.ReleaseRenderTarget(reusedId);
+	container.ReleaseRenderTarget(otherFormatId);
+	container.ReleaseRenderTarget(otherSizeId);
+
+	KOKKO_TEST_CHECK(context, container.ConfirmAllTargetsAreUnused());
+}
+
+static void TestEviction(Test::Context& context, RenderDeviceRecorder& device, RenderTargetContainer& container)
+{
+	container.DestroyUnusedTargets();
+	container.SetEvictionFrameCount(2);
+
+	unsigned int kept = container.AcquireRenderTarget(Vec2i(64, 64), RenderTextureSizedFormat::R8).id;
+	unsigned int unused = container.AcquireRenderTarget(Vec2i(32, 32), RenderTextureSizedFormat::R8).id;
+	container.ReleaseRenderTarget(unused);
+	container.ReleaseRenderTarget(kept);
+	container.EndFrame();
+
+	unsigned int texturesDestroyed = GetCallCount(device, Call::DestroyTextures);
+
+	// Using a target every frame keeps it alive
+	for (unsigned int frame = 0; frame < 3; ++frame)
+	{
+		kept = container.AcquireRenderTarget(Vec2i(64, 64), RenderTextureSizedFormat::R8).id;
+		container.ReleaseRenderTarget(kept);
+		container.EndFrame();
+	}
+
+	KOKKO_TEST_CHECK(context, container.GetStats().targetCount == 1);
+	KOKKO_TEST_CHECK(context, container.GetStats().evictedCount == 1);
+	KOKKO_TEST_CHECK(context, container.GetStats().currentBytes == 64 * 64);
+	KOKKO_TEST_CHECK(context, GetCallCount(device, Call::DestroyTextures) == texturesDestroyed + 1);
+	KOKKO_TEST_CHECK(context, GetCallCount(device, Call::DestroyFramebuffers) ==
+		GetCallCount(device, Call::DestroyTextures));
+}
+
+static void TestDestroyUnused(Test::Context& context, RenderTargetContainer& container)
+{
+	container.DestroyUnusedTargets();
+
+	// Targets of the old frame size are released, one is still in use
+	unsigned int released = container.AcquireRenderTarget(Vec2i(1280, 720), RenderTextureSizedFormat::RGB16F).id;
+	unsigned int inUse = container.AcquireRenderTarget(Vec2i(1280, 720), RenderTextureSizedFormat::RGB16F).id;
+	container.ReleaseRenderTarget(released);
+
+	container.DestroyUnusedTargets();
+
+	KOKKO_TEST_CHECK(context, container.GetStats().targetCount == 1);
+	KOKKO_TEST_CHECK(context, container.GetStats().inUseCount == 1);
+	KOKKO_TEST_CHECK(context, container.GetStats().currentBytes == 1280 * 720 * 6);
+
+	// The destroyed target's entry is reused for the next new target
+	unsigned int resized = container.AcquireRenderTarget(Vec2i(1920, 1080), RenderTextureSizedFormat::RGB16F).id;
+	KOKKO_TEST_CHECK(context, resized == released);
+
+	container.ReleaseRenderTarget(resized);
+	container.ReleaseRenderTarget(inUse);
+	container.DestroyUnusedTargets();
+
+	KOKKO_TEST_CHECK(context, container.GetStats().targetCount == 0);
+	KOKKO_TEST_CHECK(context, container.GetStats().currentBytes == 0);
+}
+
+void Test::TestRenderTargetContainer(Context& context)
+{
+	// Free lists are keyed by 64-bit values, hashed a byte at a time as FNV-1a
+	KOKKO_TEST_CHECK(context, Hash::FNV1a_32(uint64_t{ 0 }) == 0x9be17165u);
+	KOKKO_TEST_CHECK(context, Hash::FNV1a_32(uint64_t{ 0x0123456789abcdef }) == 0xe39e4e75u);
+
+	RenderDeviceRecorder device(context.allocator, nullptr);
+	RenderTargetContainer container(context.allocator, &device);
+
+	TestReuse(context, device, container);
+	TestEviction(context, device, container);
+	TestDestroyUnused(context, container);
+}
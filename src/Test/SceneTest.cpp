@@ -0,0 +1,389 @@
+#include "Test/Test.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <utility>
+
+#include "Core/Array.hpp"
+#include "Core/JobSystem.hpp"
+
+#include "Entity/Entity.hpp"
+
+#include "Math/Mat4x4.hpp"
+#include "Math/Transform.hpp"
+
+#include "Scene/ITransformUpdateReceiver.hpp"
+#include "Scene/Scene.hpp"
+
+// Expected state of the scene, indexed by entity ID. Entity IDs are never reused.
+struct ReferenceScene
+{
+	Array<unsigned int> parent;
+	Array<Mat4x4f> local;
+	Array<bool> alive;
+
+	// Local transform or parent changed since the last NotifyUpdatedTransforms
+	Array<bool> changed;
+
+	Array<unsigned int> aliveEntities;
+
+	explicit ReferenceScene(Allocator* allocator) :
+		parent(allocator),
+		local(allocator),
+		alive(allocator),
+		changed(allocator),
+		aliveEntities(allocator)
+	{
+		// Entity ID 0 is null
+		parent.PushBack(0);
+		local.PushBack(Mat4x4f());
+		alive.PushBack(false);
+		changed.PushBack(false);
+	}
+};
+
+// Records the transforms it receives. Component indices are the entity IDs, or
+// if <componentBase> isn't zero, count down from it so that their order is the
+// opposite of the order of the objects.
+class RecordingReceiver : public ITransformUpdateReceiver
+{
+private:
+	unsigned int componentBase;
+
+	void Reserve(unsigned int entity)
+	{
+		while (attached.GetCount() <= entity)
+		{
+			attached.PushBack(false);
+			notified.PushBack(false);
+			transforms.PushBack(Mat4x4f());
+		}
+	}
+
+public:
+	Array<bool> attached;
+	Array<bool> notified;
+	Array<Mat4x4f> transforms;
+
+	// Component indices of every call were in ascending order
+	bool ascending;
+
+	RecordingReceiver(Allocator* allocator, unsigned int componentBase) :
+		componentBase(componentBase),
+		attached(allocator),
+		notified(allocator),
+		transforms(allocator),
+		ascending(true)
+	{
+	}
+
+	void Attach(Scene& scene, SceneObjectId id, unsigned int entity)
+	{
+		Reserve(entity);
+		attached[entity] = true;
+		scene.AttachComponent(this, id, componentBase != 0 ? componentBase - entity : entity);
+	}
+
+	void Detach(Scene& scene, SceneObjectId id, unsigned int entity)
+	{
+		attached[entity] = false;
+		scene.DetachComponent(this, id);
+	}
+
+	bool IsAttached(unsigned int entity) const { return entity < attached.GetCount() && attached[entity]; }
+	bool IsNotified(unsigned int entity) const { return entity < notified.GetCount() && notified[entity]; }
+
+	void Clear()
+	{
+		for (unsigned int i = 0, count = notified.GetCount(); i < count; ++i)
+			notified[i] = false;
+	}
+
+	virtual void NotifyUpdatedTransforms(unsigned int count, const unsigned int* componentIndices,
+		const Mat4x4f* updatedTransforms) override
+	{
+		for (unsigned int i = 0; i < count; ++i)
+		{
+			if (i > 0 && componentIndices[i] < componentIndices[i - 1])
+				ascending = false;
+
+			unsigned int index = componentIndices[i];
+			unsigned int entity = componentBase != 0 ? componentBase - index : index;
+			Reserve(entity);
+
+			// The latest transform of an object comes last
+			notified[entity] = true;
+			transforms[entity] = updatedTransforms[i];
+		}
+	}
+};
+
+// Every object has a component in the first receiver, and even entities in the second
+struct SceneReceivers
+{
+	RecordingReceiver all;
+	RecordingReceiver even;
+
+	explicit SceneReceivers(Allocator* allocator) :
+		all(allocator, 0),
+		even(allocator, 1000000)
+	{
+	}
+};
+
+static unsigned int RandomAliveIndex(const ReferenceScene& ref, uint64_t& state)
+{
+	return static_cast<unsigned int>(Test::NextRandom(state) % ref.aliveEntities.GetCount());
+}
+
+static Mat4x4f GetReferenceWorld(const ReferenceScene& ref, unsigned int entity)
+{
+	unsigned int parent = ref.parent[entity];
+	return parent != 0 ? GetReferenceWorld(ref, parent) * ref.local[entity] : ref.local[entity];
+}
+
+static bool IsAncestor(const ReferenceScene& ref, unsigned int ancestor, unsigned int entity)
+{
+	for (unsigned int parent = ref.parent[entity]; parent != 0; parent = ref.parent[parent])
+		if (parent == ancestor)
+			return true;
+
+	return false;
+}
+
+static bool IsChanged(const ReferenceScene& ref, unsigned int entity)
+{
+	for (; entity != 0; entity = ref.parent[entity])
+		if (ref.changed[entity])
+			return true;
+
+	return false;
+}
+
+static bool MatricesEqual(const Mat4x4f& a, const Mat4x4f& b)
+{
+	for (unsigned int i = 0; i < 16; ++i)
+		if (std::fabs(a[i] - b[i]) > 1e-3f)
+			return false;
+
+	return true;
+}
+
+static void AddObject(Scene& scene, ReferenceScene& ref, SceneReceivers& receivers)
+{
+	Entity entity = Entity::Make(ref.alive.GetCount(), 0);
+	SceneObjectId id = scene.AddSceneObject(entity);
+
+	receivers.all.Attach(scene, id, entity.id);
+	if (entity.id % 2 == 0)
+		receivers.even.Attach(scene, id, entity.id);
+
+	ref.parent.PushBack(0);
+	ref.local.PushBack(Mat4x4f());
+	ref.alive.PushBack(true);
+	ref.changed.PushBack(true);
+	ref.aliveEntities.PushBack(entity.id);
+}
+
+static void SetRandomTransform(Scene& scene, ReferenceScene& ref, unsigned int entity, uint64_t& state)
+{
+	Vec3f translation(static_cast<float>(Test::NextRandom(state) % 7), 1.0f, 2.0f);
+	Vec3f angles(0.3f * (Test::NextRandom(state) % 5), 0.1f * (Test::NextRandom(state) % 3), 0.0f);
+	Vec3f scale(1.0f, 0.5f + 0.25f * (Test::NextRandom(state) % 4), 1.0f);
+
+	Transformf transform(translation, Quatf::RotateEuler(angles), scale);
+	scene.SetLocalTransform(scene.Lookup(Entity{ entity }), transform);
+
+	ref.local[entity] = transform.GetMatrix().ToMat4x4();
+	ref.changed[entity] = true;
+}
+
+static void SetRandomParent(Scene& scene, ReferenceScene& ref, unsigned int entity, uint64_t& state)
+{
+	unsigned int parent = ref.aliveEntities[RandomAliveIndex(ref, state)];
+
+	if (Test::NextRandom(state) % 4 == 0)
+		parent = 0;
+
+	// The hierarchy can't have cycles
+	if (parent == entity || (parent != 0 && IsAncestor(ref, entity, parent)))
+		return;
+
+	SceneObjectId parentId = parent != 0 ? scene.Lookup(Entity{ parent }) : SceneObjectId::Null;
+	scene.SetParent(scene.Lookup(Entity{ entity }), parentId);
+
+	// Setting the same parent again is not a change
+	if (ref.parent[entity] != parent)
+		ref.changed[entity] = true;
+
+	ref.parent[entity] = parent;
+}
+
+static void RemoveObject(Scene& scene, ReferenceScene& ref, unsigned int aliveIndex)
+{
+	unsigned int entity = ref.aliveEntities[aliveIndex];
+	scene.RemoveSceneObject(scene.Lookup(Entity{ entity }));
+
+	// Children of the removed object become root objects
+	for (unsigned int i = 0, count = ref.aliveEntities.GetCount(); i < count; ++i)
+	{
+		unsigned int child = ref.aliveEntities[i];
+
+		if (ref.parent[child] == entity)
+		{
+			ref.parent[child] = 0;
+			ref.changed[child] = true;
+		}
+	}
+
+	ref.alive[entity] = false;
+	ref.aliveEntities[aliveIndex] = ref.aliveEntities.GetBack();
+	ref.aliveEntities.PopBack();
+}
+
+static void ApplyRandomChanges(Scene& scene, ReferenceScene& ref, SceneReceivers& receivers,
+	unsigned int changeCount, uint64_t& state)
+{
+	for (unsigned int i = 0; i < changeCount; ++i)
+	{
+		unsigned int op = static_cast<unsigned int>(Test::NextRandom(state) % 10);
+
+		if (op < 3 || ref.aliveEntities.GetCount() == 0)
+		{
+			AddObject(scene, ref, receivers);
+			continue;
+		}
+
+		unsigned int aliveIndex = RandomAliveIndex(ref, state);
+		unsigned int entity = ref.aliveEntities[aliveIndex];
+
+		if (op < 6)
+			SetRandomTransform(scene, ref, entity, state);
+		else if (op < 9)
+			SetRandomParent(scene, ref, entity, state);
+		else
+			RemoveObject(scene, ref, aliveIndex);
+	}
+}
+
+static void CheckWorldTransforms(Test::Context& context, Scene& scene, const ReferenceScene& ref)
+{
+	unsigned int missingCount = 0;
+	unsigned int mismatchCount = 0;
+
+	for (unsigned int i = 0, count = ref.aliveEntities.GetCount(); i < count; ++i)
+	{
+		unsigned int entity = ref.aliveEntities[i];
+
+		// Scene object IDs can change in UpdateWorldTransforms, so look them up again
+		SceneObjectId id = scene.Lookup(Entity{ entity });
+
+		if (id.i == SceneObjectId::Null.i)
+			missingCount += 1;
+		else if (MatricesEqual(scene.GetWorldTransform(id).ToMat4x4(), GetReferenceWorld(ref, entity)) == false)
+			mismatchCount += 1;
+	}
+
+	KOKKO_TEST_CHECK(context, missingCount == 0);
+	KOKKO_TEST_CHECK(context, mismatchCount == 0);
+}
+
+static void CheckNotifiedTransforms(Test::Context& context, const ReferenceScene& ref, RecordingReceiver& receiver)
+{
+	unsigned int missedCount = 0;
+	unsigned int unchangedCount = 0;
+	unsigned int mismatchCount = 0;
+
+	for (unsigned int i = 0, count = ref.aliveEntities.GetCount(); i < count; ++i)
+	{
+		unsigned int entity = ref.aliveEntities[i];
+		bool notified = receiver.IsNotified(entity);
+
+		// Objects with a component are notified if they or one of their ancestors
+		// changed. Removed objects can have been notified, which doesn't matter.
+		bool expected = receiver.IsAttached(entity) && IsChanged(ref, entity);
+
+		if (expected != notified)
+		{
+			if (notified)
+				unchangedCount += 1;
+			else
+				missedCount += 1;
+		}
+		else if (notified && MatricesEqual(receiver.transforms[entity], GetReferenceWorld(ref, entity)) == false)
+			mismatchCount += 1;
+	}
+
+	KOKKO_TEST_CHECK(context, missedCount == 0);
+	KOKKO_TEST_CHECK(context, unchangedCount == 0);
+	KOKKO_TEST_CHECK(context, mismatchCount == 0);
+	KOKKO_TEST_CHECK(context, receiver.ascending);
+
+	receiver.Clear();
+}
+
+// Detach some objects from the second receiver. Changes that were recorded
+// before detaching are still sent, so this is only done after notifying.
+static void DetachRandomObjects(Scene& scene, const ReferenceScene& ref, RecordingReceiver& receiver,
+	uint64_t& state)
+{
+	for (unsigned int i = 0; i < 3 && ref.aliveEntities.GetCount() > 0; ++i)
+	{
+		unsigned int entity = ref.aliveEntities[RandomAliveIndex(ref, state)];
+
+		if (receiver.IsAttached(entity))
+			receiver.Detach(scene, scene.Lookup(Entity{ entity }), entity);
+	}
+}
+
+static void RunRandomScene(Test::Context& context, JobSystem* jobSystem, unsigned int iterationCount,
+	unsigned int initialIterationCount, unsigned int initialChangeCount, unsigned int changeCount)
+{
+	Scene first(context.allocator, 1);
+	Scene second(context.allocator, 1);
+	Scene* scene = &first;
+	Scene* spare = &second;
+	ReferenceScene ref(context.allocator);
+	SceneReceivers receivers(context.allocator);
+
+	uint64_t state = 0x2545f4914f6cdd1d;
+
+	for (unsigned int iteration = 0; iteration < iterationCount; ++iteration)
+	{
+		unsigned int count = iteration < initialIterationCount ? initialChangeCount : changeCount;
+		ApplyRandomChanges(*scene, ref, receivers, count, state);
+
+		scene->UpdateWorldTransforms(jobSystem);
+
+		CheckWorldTransforms(context, *scene, ref);
+
+		// Changes of several updates accumulate until they're sent, and move
+		// with the scene in between
+		if (iteration % 3 == 1)
+		{
+			*spare = std::move(*scene);
+			std::swap(scene, spare);
+			continue;
+		}
+
+		scene->NotifyUpdatedTransforms();
+
+		CheckNotifiedTransforms(context, ref, receivers.all);
+		CheckNotifiedTransforms(context, ref, receivers.even);
+
+		for (unsigned int i = 0, changedCount = ref.changed.GetCount(); i < changedCount; ++i)
+			ref.changed[i] = false;
+
+		DetachRandomObjects(*scene, ref, receivers.even, state);
+	}
+}
+
+void Test::TestScene(Context& context)
+{
+	RunRandomScene(context, nullptr, 300, 0, 0, 20);
+
+	// Thousands of objects, so that the update is split between several jobs
+	// and a few edits per frame touch some of them
+	JobSystem jobSystem(context.allocator, 3);
+	RunRandomScene(context, &jobSystem, 40, 5, 3000, 20);
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstdint>
+
+class Allocator;
+
+namespace Test
+{
+	class Context
+	{
+	private:
+		const char* testName;
+		unsigned int failureCount;
+
+	public:
+		Allocator* allocator;
+
+		Context(Allocator* allocator, const char* testName) :
+			testName(testName),
+			failureCount(0),
+			allocator(allocator)
+		{
+		}
+
+		unsigned int GetFailureCount() const { return failureCount; }
+
+		void Fail(const char* file, int line, const char* expression);
+	};
+
+	// Deterministic 64-bit random numbers, so that failures can be reproduced
+	inline uint64_t NextRandom(uint64_t& state)
+	{
+		state ^= state << 13;
+		state ^= state >> 7;
+		state ^= state << 17;
+		return state;
+	}
+
+	inline float NextRandomFloat(uint64_t& state, float min, float max)
+	{
+		float unit = static_cast<float>(NextRandom(state) >> 40) / static_cast<float>(1 << 24);
+		return min + (max - min) * unit;
+	}
+
+	// Grouping of object draws into single, instanced and indirect batches
+	void TestDrawBatchBuilder(Context& context);
+
+	// Draw and state change counts of batched object draws, recorded with RenderDeviceRecorder
+	void TestDrawCalls(Context& context);
+
+	// Screen size rejection estimates agree between scalar and SoA code, and
+	// the bounding sphere estimate never rejects a box the corner estimate keeps
+	void TestIntersect(Context& context);
+
+	// Every index of ParallelFor is processed exactly once, and idle workers steal jobs
+	void TestJobSystem(Context& context);
+
+	// Quaternion rotations, TRS transforms and 3x4 affine products and inverses match the 4x4 matrix math
+	void TestMath(Context& context);
+
+	// Objects behind a rasterized occluder are culled, while objects in front
+	// of it, beside it or crossing the near plane stay visible
+	void TestOcclusionCuller(Context& context);
+
+	// Uploads and draws recorded to a capture file and replayed into another
+	// RenderDeviceRecorder make the same calls and upload the same data, and
+	// replayed fence waits block until the fence is signaled
+	void TestRenderCapture(Context& context);
+
+	// Pass culling, barriers and transient texture aliasing of a compiled RenderGraph
+	void TestRenderGraph(Context& context);
+
+	// Sort key fields decode unchanged at their limits, passes sort in their
+	// configured order, and draws with material IDs that don't fit are rejected
+	void TestRenderOrder(Context& context);
+
+	// Reuse, eviction and destruction of pooled render targets
+	void TestRenderTargetContainer(Context& context);
+
+	// World transforms of a randomly edited scene hierarchy match a reference
+	// model, updated on one thread and split between jobs, and exactly the
+	// objects whose transform or ancestors changed are sent to receivers,
+	// sorted by component index
+	void TestScene(Context& context);
+
+	// Upload sizes and command stream layout of RenderDeviceRecorder
+	void TestRenderDeviceRecorder(Context& context);
+
+	// Repeated state changes are dropped, and binds reach the device again
+	// after the bound object is deleted or the vertex array changes
+	void TestRenderDeviceStateFilter(Context& context);
+}
+
+// Record a failure with the location and text of <expression> if it is false
+#define KOKKO_TEST_CHECK(context, expression) \
+	((expression) ? (void)0 : (context).Fail(__FILE__, __LINE__, #expression))
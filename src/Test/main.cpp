@@ -0,0 +1,74 @@
+#include <cstdio>
+#include <cstring>
+
+#include "Memory/Memory.hpp"
+
+#include "Test/Test.hpp"
+
+struct TestInfo
+{
+	const char* name;
+	void(*function)(Test::Context& context);
+};
+
+static const TestInfo tests[] = {
+	{ "DrawBatchBuilder", Test::TestDrawBatchBuilder },
+	{ "DrawCalls", Test::TestDrawCalls },
+	{ "Intersect", Test::TestIntersect },
+	{ "JobSystem", Test::TestJobSystem },
+	{ "Math", Test::TestMath },
+	{ "OcclusionCuller", Test::TestOcclusionCuller },
+	{ "RenderCapture", Test::TestRenderCapture },
+	{ "RenderDeviceRecorder", Test::TestRenderDeviceRecorder },
+	{ "RenderDeviceStateFilter", Test::TestRenderDeviceStateFilter },
+	{ "RenderGraph", Test::TestRenderGraph },
+	{ "RenderOrder", Test::TestRenderOrder },
+	{ "RenderTargetContainer", Test::TestRenderTargetContainer },
+	{ "Scene", Test::TestScene }
+};
+
+static const unsigned int TestCount = sizeof(tests) / sizeof(tests[0]);
+
+void Test::Context::Fail(const char* file, int line, const char* expression)
+{
+	std::printf("%s:%d: %s: check failed: %s\n", file, line, testName, expression);
+	failureCount += 1;
+}
+
+int main(int argc, char** argv)
+{
+	Memory::InitializeMemorySystem();
+
+	Allocator* allocator = Memory::GetDefaultAllocator();
+
+	unsigned int runCount = 0;
+	unsigned int failedCount = 0;
+
+	for (unsigned int i = 0; i < TestCount; ++i)
+	{
+		bool selected = argc <= 1;
+
+		for (int arg = 1; arg < argc; ++arg)
+			if (std::strcmp(argv[arg], tests[i].name) == 0)
+				selected = true;
+
+		if (selected == false)
+			continue;
+
+		Test::Context context(allocator, tests[i].name);
+		tests[i].function(context);
+
+		runCount += 1;
+
+		if (context.GetFailureCount() > 0)
+			failedCount += 1;
+
+		std::printf("%-24s %s\n", tests[i].name, context.GetFailureCount() > 0 ? "FAILED" : "passed");
+	}
+
+	Memory::DeinitializeMemorySystem();
+
+	std::printf("%u of %u tests passed\n", runCount - failedCount, runCount);
+
+	return failedCount > 0 || runCount == 0 ? 1 : 0;
+}